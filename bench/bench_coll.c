@@ -0,0 +1,247 @@
+/**
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Collective latency benchmarks over all the members of a scon.
+ * Each record carries the member count, so runs at different
+ * sizes can be concatenated to get latency versus member count.
+ *
+ *   barrier   - back to back barriers
+ *   allgather - size bytes contributed by every member, swept
+ *   xcast     - rank 0 xcasts size bytes, swept. An xcast has no
+ *               global completion, so each iteration is closed with
+ *               a barrier and the barrier latency is subtracted
+ *
+ * With -a the allgathers run the algorithm of the given collectives
+ * component and are reported as op allgather/<component>, which is
+ * what bench/coll_tune reads to write a tuning file.
+ *
+ * Times are measured on rank 0.
+ */
+#include "bench_common.h"
+
+#include "src/util/name_fns.h"
+#include "src/buffer_ops/buffer_ops.h"
+#include "src/buffer_ops/types.h"
+
+#include <string.h>
+#include <unistd.h>
+
+static volatile unsigned int ncolls = 0;
+static volatile unsigned int nxcasts = 0;
+
+static void barrier_cbfunc(scon_status_t status, scon_handle_t scon_handle,
+                           scon_proc_t procs[], size_t nprocs,
+                           scon_info_t info[], size_t ninfo,
+                           void *cbdata)
+{
+    if (SCON_SUCCESS != status) {
+        fprintf(stderr, "bench: barrier failed with %d\n", status);
+    }
+    ncolls++;
+}
+
+static void allgather_cbfunc(scon_status_t status, scon_handle_t scon_handle,
+                             scon_proc_t procs[], size_t nprocs,
+                             scon_buffer_t *buf,
+                             scon_info_t info[], size_t ninfo,
+                             void *cbdata)
+{
+    if (SCON_SUCCESS != status) {
+        fprintf(stderr, "bench: allgather failed with %d\n", status);
+    }
+    ncolls++;
+}
+
+static void xcast_cbfunc(scon_status_t status, scon_handle_t scon_handle,
+                         scon_proc_t procs[], size_t nprocs,
+                         scon_buffer_t *buf, scon_msg_tag_t tag,
+                         scon_info_t info[], size_t ninfo,
+                         void *cbdata)
+{
+    bench_buffer_free(buf);
+}
+
+static void xcast_recv_cbfunc(scon_status_t status, scon_handle_t scon_handle,
+                              scon_proc_t *peer, scon_buffer_t *buf,
+                              scon_msg_tag_t tag, void *cbdata)
+{
+    nxcasts++;
+    /* the payload is ours once delivered */
+    scon_buffer_destruct(buf);
+}
+
+static void result_init(bench_result_t *res, const char *op, size_t size,
+                        unsigned int iters)
+{
+    memset(res, 0, sizeof(*res));
+    res->op = op;
+    res->members = bench_nmembers;
+    res->size = size;
+    res->iterations = iters;
+    res->min_us = 1e30;
+}
+
+static void result_add(bench_result_t *res, double dt)
+{
+    res->avg_us += dt;
+    if (dt < res->min_us) {
+        res->min_us = dt;
+    }
+    if (dt > res->max_us) {
+        res->max_us = dt;
+    }
+}
+
+/* returns the average barrier latency, used to correct the xcast */
+static double run_barrier(const bench_options_t *opts)
+{
+    bench_result_t res;
+    unsigned int i, done = ncolls;
+    double t0;
+
+    result_init(&res, "barrier", 0, opts->iterations);
+    bench_barrier();
+    for (i = 0; i < opts->warmup + opts->iterations; i++) {
+        t0 = bench_now_us();
+        scon_barrier(bench_handle, NULL, 0, barrier_cbfunc, NULL, NULL, 0);
+        bench_wait(&ncolls, ++done);
+        if (i >= opts->warmup) {
+            result_add(&res, bench_now_us() - t0);
+        }
+    }
+    res.avg_us /= opts->iterations;
+    res.msgs_per_sec = 1e6 / res.avg_us;
+    bench_report(&res);
+    return res.avg_us;
+}
+
+static void run_allgather(const bench_options_t *opts, const char *algorithm)
+{
+    bench_result_t res;
+    scon_buffer_t *buf;
+    scon_info_t *info;
+    size_t ninfo = 1;
+    unsigned int i, iters, done;
+    double t0;
+    size_t size;
+    static char op[80];
+
+    /* all members contribute the same size, so tell the
+     * library to pick the algorithm by it */
+    if (NULL != algorithm) {
+        ninfo = 2;
+    }
+    SCON_INFO_CREATE(info, ninfo);
+    if (NULL != algorithm) {
+        SCON_INFO_LOAD(&info[1], SCON_COLL_ALGORITHM, (char*)algorithm, SCON_STRING);
+        snprintf(op, sizeof(op), "allgather/%s", algorithm);
+    } else {
+        snprintf(op, sizeof(op), "allgather");
+    }
+    for (size = opts->min_size; size <= opts->max_size; size *= 2) {
+        iters = bench_iterations(opts, size);
+        buf = bench_buffer(size);
+        SCON_INFO_LOAD(&info[0], SCON_COLL_SIZE_HINT, &size, SCON_SIZE);
+        result_init(&res, op, size, iters);
+        done = ncolls;
+        bench_barrier();
+        for (i = 0; i < opts->warmup + iters; i++) {
+            t0 = bench_now_us();
+            scon_allgather(bench_handle, NULL, 0, buf, allgather_cbfunc, NULL, info, ninfo);
+            bench_wait(&ncolls, ++done);
+            if (i >= opts->warmup) {
+                result_add(&res, bench_now_us() - t0);
+            }
+        }
+        res.avg_us /= iters;
+        res.mbytes_per_sec = (double)size * bench_nmembers / res.avg_us;
+        bench_report(&res);
+        bench_buffer_free(buf);
+    }
+    SCON_INFO_FREE(info, ninfo);
+}
+
+static void run_xcast(const bench_options_t *opts, double barrier_us)
+{
+    bench_result_t res;
+    scon_buffer_t *buf;
+    unsigned int i, iters, rcvd;
+    double t0, dt;
+    size_t size;
+
+    scon_recv_nb(bench_handle, SCON_PROC_WILDCARD, BENCH_TAG_XCAST, true,
+                 xcast_recv_cbfunc, NULL, NULL, 0);
+    for (size = opts->min_size; size <= opts->max_size; size *= 2) {
+        iters = bench_iterations(opts, size);
+        result_init(&res, "xcast", size, iters);
+        rcvd = nxcasts;
+        bench_barrier();
+        for (i = 0; i < opts->warmup + iters; i++) {
+            buf = (0 == bench_rank) ? bench_buffer(size) : NULL;
+            t0 = bench_now_us();
+            if (0 == bench_rank) {
+                scon_xcast(bench_handle, NULL, 0, buf, BENCH_TAG_XCAST,
+                           xcast_cbfunc, NULL, NULL, 0);
+            }
+            bench_wait(&nxcasts, ++rcvd);
+            bench_barrier();
+            dt = bench_now_us() - t0 - barrier_us;
+            if (i >= opts->warmup) {
+                result_add(&res, (0 > dt) ? 0 : dt);
+            }
+        }
+        res.avg_us /= iters;
+        res.mbytes_per_sec = size / res.avg_us;
+        bench_report(&res);
+    }
+    scon_recv_cancel(bench_handle, SCON_PROC_WILDCARD, BENCH_TAG_XCAST);
+}
+
+int main(int argc, char **argv)
+{
+    bench_options_t opts;
+    const char *coll = "all";
+    const char *algorithm = NULL;
+    double barrier_us;
+    int opt;
+
+    bench_options_init(&opts);
+    opts.max_size = 64 * 1024;
+    while (-1 != (opt = getopt(argc, argv, BENCH_COMMON_OPTS "c:a:"))) {
+        if ('c' == opt) {
+            coll = optarg;
+        } else if ('a' == opt) {
+            algorithm = optarg;
+        } else if (!bench_options_parse(&opts, opt, optarg)) {
+            bench_usage(argv[0], " [-c barrier|allgather|xcast|all] [-a default|brucks|rcd]");
+            return 1;
+        }
+    }
+    if (0 == opts.min_size) {
+        opts.min_size = 1;
+    }
+    if (0 == opts.iterations) {
+        opts.iterations = 1;
+    }
+    if (SCON_SUCCESS != bench_init()) {
+        return 1;
+    }
+    bench_report_open(&opts, "coll");
+    /* the barrier latency is needed to correct the xcast */
+    barrier_us = run_barrier(&opts);
+    if (0 == strcmp(coll, "all") || 0 == strcmp(coll, "allgather")) {
+        run_allgather(&opts, algorithm);
+    }
+    if (0 == strcmp(coll, "all") || 0 == strcmp(coll, "xcast")) {
+        run_xcast(&opts, barrier_us);
+    }
+    bench_report_close();
+    bench_barrier();
+    bench_finalize();
+    return 0;
+}
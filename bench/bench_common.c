@@ -0,0 +1,246 @@
+/**
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+#include "bench_common.h"
+
+#include "src/util/name_fns.h"
+#include "src/buffer_ops/buffer_ops.h"
+#include "src/buffer_ops/types.h"
+
+#include <string.h>
+#include <sched.h>
+#include <time.h>
+
+scon_handle_t bench_handle = SCON_HANDLE_INVALID;
+unsigned int bench_nmembers = 0;
+unsigned int bench_rank = 0;
+
+static volatile unsigned int created = 0;
+static volatile unsigned int deleted = 0;
+static volatile unsigned int barriers = 0;
+static FILE *report = NULL;
+static const char *report_bench = NULL;
+static bench_format_t report_format = BENCH_FMT_CSV;
+static unsigned int nrecords = 0;
+
+void bench_options_init(bench_options_t *opts)
+{
+    opts->format = BENCH_FMT_CSV;
+    opts->output = NULL;
+    opts->iterations = 1000;
+    opts->warmup = 10;
+    opts->min_size = 1;
+    opts->max_size = 1 << 20;
+}
+
+bool bench_options_parse(bench_options_t *opts, int opt, const char *arg)
+{
+    switch (opt) {
+        case 'f':
+            if (0 == strcmp(arg, "json")) {
+                opts->format = BENCH_FMT_JSON;
+            } else if (0 == strcmp(arg, "csv")) {
+                opts->format = BENCH_FMT_CSV;
+            } else {
+                return false;
+            }
+            return true;
+        case 'o':
+            opts->output = strdup(arg);
+            return true;
+        case 'i':
+            opts->iterations = strtoul(arg, NULL, 10);
+            return true;
+        case 'w':
+            opts->warmup = strtoul(arg, NULL, 10);
+            return true;
+        case 'm':
+            opts->min_size = strtoul(arg, NULL, 10);
+            return true;
+        case 'M':
+            opts->max_size = strtoul(arg, NULL, 10);
+            return true;
+        default:
+            return false;
+    }
+}
+
+void bench_usage(const char *prog, const char *extra)
+{
+    fprintf(stderr, "usage: %s [-f csv|json] [-o file] [-i iterations] [-w warmup]\n"
+                    "          [-m min size] [-M max size]%s\n",
+            prog, (NULL == extra) ? "" : extra);
+}
+
+static void create_cbfunc(scon_status_t status, scon_handle_t scon_handle, void *cbdata)
+{
+    bench_handle = scon_handle;
+    created++;
+}
+
+static void delete_cbfunc(scon_status_t status, void *cbdata)
+{
+    deleted++;
+}
+
+int bench_init(void)
+{
+    scon_info_t *info;
+    size_t ninfo = 1;
+    int rc;
+
+    if (SCON_SUCCESS != (rc = scon_init(NULL, 0))) {
+        fprintf(stderr, "scon_init returned error %d\n", rc);
+        return rc;
+    }
+    scon_create(NULL, 0, NULL, 0, create_cbfunc, NULL);
+    bench_wait(&created, 1);
+    SCON_INFO_CREATE(info, ninfo);
+    SCON_INFO_LOAD(&info[0], SCON_NUM_MEMBERS, &bench_nmembers, SCON_UINT32);
+    if (SCON_SUCCESS != (rc = scon_get_info(bench_handle, &info, &ninfo))) {
+        SCON_INFO_FREE(info, 1);
+        return rc;
+    }
+    bench_nmembers = info[0].value.data.uint32;
+    SCON_INFO_FREE(info, 1);
+    bench_rank = SCON_PROC_MY_NAME->rank;
+    return SCON_SUCCESS;
+}
+
+void bench_finalize(void)
+{
+    unsigned int target = deleted + 1;
+
+    scon_delete(bench_handle, delete_cbfunc, NULL, NULL, 0);
+    bench_wait(&deleted, target);
+    scon_finalize();
+}
+
+double bench_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* the callbacks run in the library's progress thread, so we
+ * just spin here rather than sleep and add wakeup latency */
+void bench_wait(volatile unsigned int *counter, unsigned int target)
+{
+    while (*counter < target) {
+        sched_yield();
+    }
+}
+
+static void barrier_cbfunc(scon_status_t status, scon_handle_t scon_handle,
+                           scon_proc_t procs[], size_t nprocs,
+                           scon_info_t info[], size_t ninfo,
+                           void *cbdata)
+{
+    if (SCON_SUCCESS != status) {
+        fprintf(stderr, "bench: barrier failed with %d\n", status);
+    }
+    barriers++;
+}
+
+void bench_barrier(void)
+{
+    unsigned int target = barriers + 1;
+
+    scon_barrier(bench_handle, NULL, 0, barrier_cbfunc, NULL, NULL, 0);
+    bench_wait(&barriers, target);
+}
+
+scon_buffer_t* bench_buffer(size_t size)
+{
+    scon_buffer_t *buf;
+    char *payload;
+
+    buf = (scon_buffer_t*)malloc(sizeof(scon_buffer_t));
+    scon_buffer_construct(buf);
+    if (0 < size) {
+        payload = (char*)malloc(size);
+        memset(payload, 0xa5, size);
+        scon_buffer_load(buf, payload, size);
+    }
+    return buf;
+}
+
+void bench_buffer_free(scon_buffer_t *buf)
+{
+    scon_buffer_destruct(buf);
+    free(buf);
+}
+
+unsigned int bench_iterations(const bench_options_t *opts, size_t size)
+{
+    if (size > 64 * 1024 && opts->iterations > 100) {
+        return opts->iterations / 10;
+    }
+    return opts->iterations;
+}
+
+void bench_report_open(const bench_options_t *opts, const char *bench)
+{
+    if (0 != bench_rank) {
+        return;
+    }
+    report = stdout;
+    if (NULL != opts->output && NULL == (report = fopen(opts->output, "w"))) {
+        fprintf(stderr, "bench: cannot open %s, writing to stdout\n", opts->output);
+        report = stdout;
+    }
+    report_bench = bench;
+    report_format = opts->format;
+    nrecords = 0;
+    if (BENCH_FMT_CSV == report_format) {
+        fprintf(report, "benchmark,op,members,size,iterations,avg_us,min_us,max_us,"
+                        "mbytes_per_sec,msgs_per_sec\n");
+    } else {
+        fprintf(report, "[\n");
+    }
+}
+
+void bench_report(const bench_result_t *res)
+{
+    if (NULL == report) {
+        return;
+    }
+    if (BENCH_FMT_CSV == report_format) {
+        fprintf(report, "%s,%s,%u,%lu,%u,%.3f,%.3f,%.3f,%.3f,%.1f\n",
+                report_bench, res->op, res->members, (unsigned long)res->size,
+                res->iterations, res->avg_us, res->min_us, res->max_us,
+                res->mbytes_per_sec, res->msgs_per_sec);
+    } else {
+        fprintf(report, "%s  {\"benchmark\": \"%s\", \"op\": \"%s\", \"members\": %u, "
+                        "\"size\": %lu, \"iterations\": %u, \"avg_us\": %.3f, "
+                        "\"min_us\": %.3f, \"max_us\": %.3f, \"mbytes_per_sec\": %.3f, "
+                        "\"msgs_per_sec\": %.1f}",
+                (0 == nrecords) ? "" : ",\n",
+                report_bench, res->op, res->members, (unsigned long)res->size,
+                res->iterations, res->avg_us, res->min_us, res->max_us,
+                res->mbytes_per_sec, res->msgs_per_sec);
+    }
+    nrecords++;
+    fflush(report);
+}
+
+void bench_report_close(void)
+{
+    if (NULL == report) {
+        return;
+    }
+    if (BENCH_FMT_JSON == report_format) {
+        fprintf(report, "\n]\n");
+    }
+    if (stdout != report) {
+        fclose(report);
+    }
+    report = NULL;
+}
@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Shared harness for the SCON microbenchmarks. The programs are
+ * launched like the functional tests, one process per member, and
+ * rank 0 writes one record per measurement in CSV or JSON so that
+ * runs can be compared across releases.
+ */
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include "scon_config.h"
+#include "scon.h"
+#include "scon_common.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* user tags used by the benchmarks - well clear of the internal ones */
+#define BENCH_TAG_DATA    30000
+#define BENCH_TAG_ACK     30001
+#define BENCH_TAG_XCAST   30002
+
+/* options shared by all the benchmarks */
+#define BENCH_COMMON_OPTS "f:o:i:w:m:M:h"
+
+typedef enum {
+    BENCH_FMT_CSV,
+    BENCH_FMT_JSON
+} bench_format_t;
+
+typedef struct {
+    bench_format_t format;
+    /* output file, stdout if NULL */
+    char *output;
+    /* timed and untimed iterations per measurement */
+    unsigned int iterations;
+    unsigned int warmup;
+    /* message size sweep, doubling from min_size to max_size */
+    size_t min_size;
+    size_t max_size;
+} bench_options_t;
+
+/* one measurement - fields that don't apply are left 0 */
+typedef struct {
+    const char *op;
+    unsigned int members;
+    size_t size;
+    unsigned int iterations;
+    double avg_us;
+    double min_us;
+    double max_us;
+    double mbytes_per_sec;
+    double msgs_per_sec;
+} bench_result_t;
+
+extern scon_handle_t bench_handle;
+extern unsigned int bench_nmembers;
+extern unsigned int bench_rank;
+
+void bench_options_init(bench_options_t *opts);
+/* handle one of the BENCH_COMMON_OPTS, returns false if opt isn't one */
+bool bench_options_parse(bench_options_t *opts, int opt, const char *arg);
+void bench_usage(const char *prog, const char *extra);
+
+/* init the library and create a scon of all the members */
+int bench_init(void);
+void bench_finalize(void);
+
+/* microseconds on a monotonic clock */
+double bench_now_us(void);
+/* spin until *counter reaches target */
+void bench_wait(volatile unsigned int *counter, unsigned int target);
+/* blocking barrier across all members of the scon */
+void bench_barrier(void);
+/* buffer carrying size bytes of payload */
+scon_buffer_t* bench_buffer(size_t size);
+void bench_buffer_free(scon_buffer_t *buf);
+/* fewer iterations for large messages, as OSU does */
+unsigned int bench_iterations(const bench_options_t *opts, size_t size);
+
+/* result output, only rank 0 writes */
+void bench_report_open(const bench_options_t *opts, const char *bench);
+void bench_report(const bench_result_t *res);
+void bench_report_close(void);
+
+#endif
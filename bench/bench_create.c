@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Time scon_create and scon_delete of a scon spanning all the
+ * members, from the call until the completion callback on rank 0.
+ * Both are collective, so every member runs the same loop.
+ */
+#include "bench_common.h"
+
+#include <string.h>
+#include <unistd.h>
+
+static volatile unsigned int ncreated = 0;
+static volatile unsigned int ndeleted = 0;
+static volatile int last_status = SCON_SUCCESS;
+
+static void create_cbfunc(scon_status_t status, scon_handle_t scon_handle, void *cbdata)
+{
+    *(scon_handle_t*)cbdata = scon_handle;
+    last_status = status;
+    ncreated++;
+}
+
+static void delete_cbfunc(scon_status_t status, void *cbdata)
+{
+    last_status = status;
+    ndeleted++;
+}
+
+static void result_init(bench_result_t *res, const char *op, unsigned int iters)
+{
+    memset(res, 0, sizeof(*res));
+    res->op = op;
+    res->members = bench_nmembers;
+    res->iterations = iters;
+    res->min_us = 1e30;
+}
+
+static void result_add(bench_result_t *res, double dt)
+{
+    res->avg_us += dt;
+    if (dt < res->min_us) {
+        res->min_us = dt;
+    }
+    if (dt > res->max_us) {
+        res->max_us = dt;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bench_options_t opts;
+    bench_result_t create_res, delete_res;
+    scon_handle_t handle;
+    unsigned int i, nerrors = 0;
+    double t0;
+    int opt;
+
+    bench_options_init(&opts);
+    opts.iterations = 20;
+    opts.warmup = 2;
+    while (-1 != (opt = getopt(argc, argv, BENCH_COMMON_OPTS))) {
+        if (!bench_options_parse(&opts, opt, optarg)) {
+            bench_usage(argv[0], NULL);
+            return 1;
+        }
+    }
+    if (0 == opts.iterations) {
+        opts.iterations = 1;
+    }
+    if (SCON_SUCCESS != bench_init()) {
+        return 1;
+    }
+    bench_report_open(&opts, "create");
+    result_init(&create_res, "create", opts.iterations);
+    result_init(&delete_res, "delete", opts.iterations);
+    for (i = 0; i < opts.warmup + opts.iterations; i++) {
+        bench_barrier();
+        t0 = bench_now_us();
+        scon_create(NULL, 0, NULL, 0, create_cbfunc, &handle);
+        bench_wait(&ncreated, i + 1);
+        if (SCON_SUCCESS != last_status) {
+            fprintf(stderr, "bench: scon_create failed with %d\n", last_status);
+            nerrors++;
+            break;
+        }
+        if (i >= opts.warmup) {
+            result_add(&create_res, bench_now_us() - t0);
+        }
+        t0 = bench_now_us();
+        scon_delete(handle, delete_cbfunc, NULL, NULL, 0);
+        bench_wait(&ndeleted, i + 1);
+        if (i >= opts.warmup) {
+            result_add(&delete_res, bench_now_us() - t0);
+        }
+    }
+    if (0 == nerrors) {
+        create_res.avg_us /= opts.iterations;
+        delete_res.avg_us /= opts.iterations;
+        bench_report(&create_res);
+        bench_report(&delete_res);
+    }
+    bench_report_close();
+    bench_finalize();
+    return (0 == nerrors) ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+/**
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Time the hash functions for binary hash table keys over a sweep
+ * of key sizes - MCA variable names are a few tens of bytes, the
+ * collectives sequence table hashes whole procs arrays, which are
+ * nmembers * sizeof(scon_proc_t) bytes. Runs in a single process
+ * and does not init the library. Each record is the time of one
+ * hash. The avalanche of each function (output bits flipped by
+ * flipping one input bit, ideally half of them) goes to stderr.
+ */
+#include "bench_common.h"
+
+#include <string.h>
+#include <unistd.h>
+
+#include "src/class/scon_hash_key.h"
+
+typedef uint64_t (*hash_fn_t)(const void *key, size_t key_size);
+
+static const struct {
+    const char *name;
+    hash_fn_t fn;
+} hashes[] = {
+    {"mult31", scon_hash_key_mult31},
+    {"xx64", scon_hash_key_xx64}
+};
+#define NHASHES (sizeof(hashes) / sizeof(hashes[0]))
+
+static volatile uint64_t sink;
+
+static uint64_t rand64(uint64_t *state)
+{
+    /* splitmix64 - good enough to fill keys */
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void fill(unsigned char *buf, size_t size, uint64_t *state)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        buf[i] = (unsigned char)rand64(state);
+    }
+}
+
+static double avalanche(hash_fn_t fn, size_t size, unsigned int nkeys)
+{
+    unsigned char *key = (unsigned char*)malloc(size);
+    uint64_t state = 42, h0, h1;
+    unsigned long flipped = 0, trials = 0;
+    unsigned int k;
+    size_t bit;
+
+    for (k = 0; k < nkeys; k++) {
+        fill(key, size, &state);
+        h0 = fn(key, size);
+        for (bit = 0; bit < size * 8; bit++) {
+            key[bit / 8] ^= (unsigned char)(1 << (bit % 8));
+            h1 = fn(key, size);
+            key[bit / 8] ^= (unsigned char)(1 << (bit % 8));
+            flipped += __builtin_popcountll(h0 ^ h1);
+            trials++;
+        }
+    }
+    free(key);
+    return (double)flipped / trials;
+}
+
+int main(int argc, char **argv)
+{
+    bench_options_t opts;
+    bench_result_t res;
+    unsigned char *keys;
+    uint64_t state = 1;
+    size_t size, nkeys, n;
+    unsigned int i, iters, h;
+    double t0, dt;
+    int opt;
+
+    bench_options_init(&opts);
+    opts.iterations = 100000;
+    opts.warmup = 1000;
+    opts.min_size = 8;
+    opts.max_size = 64 * 1024;
+    while (-1 != (opt = getopt(argc, argv, BENCH_COMMON_OPTS))) {
+        if (!bench_options_parse(&opts, opt, optarg)) {
+            bench_usage(argv[0], NULL);
+            return 1;
+        }
+    }
+    if (0 == opts.iterations) {
+        opts.iterations = 1;
+    }
+    if (0 == opts.min_size) {
+        opts.min_size = 1;
+    }
+
+    /* hash a set of different keys in turn so the timing isn't of
+     * one key sitting in L1 - 1MB worth, at least 16 of them */
+    nkeys = (1 << 20) / opts.max_size;
+    if (16 > nkeys) {
+        nkeys = 16;
+    }
+    if (NULL == (keys = (unsigned char*)malloc(nkeys * opts.max_size))) {
+        fprintf(stderr, "bench_hash: cannot allocate the keys\n");
+        return 1;
+    }
+    fill(keys, nkeys * opts.max_size, &state);
+
+    bench_report_open(&opts, "hash");
+    for (size = opts.min_size; size <= opts.max_size; size *= 2) {
+        /* keep the bytes hashed per size about constant */
+        iters = opts.iterations;
+        if (64 < size) {
+            iters = (unsigned int)((uint64_t)opts.iterations * 64 / size);
+            if (100 > iters) {
+                iters = 100;
+            }
+        }
+        for (h = 0; h < NHASHES; h++) {
+            for (i = 0, n = 0; i < opts.warmup; i++, n = (n + 1) % nkeys) {
+                sink += hashes[h].fn(keys + n * opts.max_size, size);
+            }
+            t0 = bench_now_us();
+            for (i = 0, n = 0; i < iters; i++, n = (n + 1) % nkeys) {
+                sink += hashes[h].fn(keys + n * opts.max_size, size);
+            }
+            dt = bench_now_us() - t0;
+
+            memset(&res, 0, sizeof(res));
+            res.op = hashes[h].name;
+            res.members = 1;
+            res.size = size;
+            res.iterations = iters;
+            res.avg_us = dt / iters;
+            res.min_us = res.max_us = res.avg_us;
+            res.mbytes_per_sec = (double)size * iters / dt;
+            res.msgs_per_sec = iters / (dt / 1e6);
+            bench_report(&res);
+        }
+    }
+    bench_report_close();
+
+    for (h = 0; h < NHASHES; h++) {
+        fprintf(stderr, "bench_hash: %s avalanche %.2f bits on 8 byte keys, "
+                        "%.2f bits on %lu byte keys (ideal 32)\n",
+                hashes[h].name, avalanche(hashes[h].fn, 8, 256),
+                avalanche(hashes[h].fn, sizeof(scon_proc_t), 16),
+                (unsigned long)sizeof(scon_proc_t));
+    }
+    free(keys);
+    return 0;
+}
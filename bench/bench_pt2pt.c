@@ -0,0 +1,319 @@
+/**
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Point to point benchmarks, after the OSU ones:
+ *
+ *   latency  - ping-pong between ranks 0 and 1, half the round trip
+ *   bw       - rank 0 streams a window of messages to rank 1, which
+ *              acks each window
+ *   rate     - ranks 1..N each stream messages to rank 0, which
+ *              reports the aggregate message rate
+ *
+ * latency and bw sweep the message size, rate uses the min size.
+ */
+#include "bench_common.h"
+
+#include "src/util/name_fns.h"
+#include "src/buffer_ops/buffer_ops.h"
+#include "src/buffer_ops/types.h"
+
+#include <string.h>
+#include <unistd.h>
+
+static volatile unsigned int nrecvd = 0;
+static volatile unsigned int nacks = 0;
+static volatile unsigned int nsent = 0;
+
+static void recv_cbfunc(scon_status_t status, scon_handle_t scon_handle,
+                        scon_proc_t *peer, scon_buffer_t *buf,
+                        scon_msg_tag_t tag, void *cbdata)
+{
+    if (BENCH_TAG_ACK == tag) {
+        nacks++;
+    } else {
+        nrecvd++;
+    }
+    /* the payload is ours once delivered */
+    scon_buffer_destruct(buf);
+}
+
+/* the buffers are reused, so just count the completion */
+static void send_cbfunc(scon_status_t status, scon_handle_t scon_handle,
+                        scon_proc_t *peer, scon_buffer_t *buf,
+                        scon_msg_tag_t tag, void *cbdata)
+{
+    if (SCON_SUCCESS != status) {
+        fprintf(stderr, "bench: send to rank %u failed with %d\n", peer->rank, status);
+    }
+    nsent++;
+}
+
+static void set_peer(scon_proc_t *peer, unsigned int rank)
+{
+    memset(peer, 0, sizeof(*peer));
+    strncpy(peer->job_name, SCON_PROC_MY_NAME->job_name, SCON_MAX_JOBLEN);
+    peer->rank = rank;
+}
+
+static void send_one(scon_proc_t *peer, scon_buffer_t *buf, scon_msg_tag_t tag)
+{
+    int rc;
+
+    if (SCON_SUCCESS != (rc = scon_send_nb(bench_handle, peer, buf, tag,
+                                           send_cbfunc, NULL, NULL, 0))) {
+        fprintf(stderr, "bench: send failed with %d\n", rc);
+        nsent++;
+    }
+}
+
+static void run_latency(const bench_options_t *opts)
+{
+    bench_result_t res;
+    scon_proc_t peer;
+    scon_buffer_t *buf;
+    unsigned int i, iters, rcvd, sent;
+    double t0, dt;
+    size_t size;
+
+    if (1 < bench_rank) {
+        /* idle members just follow the barriers */
+        for (size = opts->min_size; size <= opts->max_size; size *= 2) {
+            bench_barrier();
+        }
+        return;
+    }
+    set_peer(&peer, 1 - bench_rank);
+    scon_recv_nb(bench_handle, &peer, BENCH_TAG_DATA, true, recv_cbfunc, NULL, NULL, 0);
+    for (size = opts->min_size; size <= opts->max_size; size *= 2) {
+        iters = bench_iterations(opts, size);
+        buf = bench_buffer(size);
+        memset(&res, 0, sizeof(res));
+        res.op = "latency";
+        res.members = 2;
+        res.size = size;
+        res.iterations = iters;
+        res.min_us = 1e30;
+        rcvd = nrecvd;
+        sent = nsent;
+        bench_barrier();
+        for (i = 0; i < opts->warmup + iters; i++) {
+            t0 = bench_now_us();
+            if (0 == bench_rank) {
+                send_one(&peer, buf, BENCH_TAG_DATA);
+                bench_wait(&nrecvd, ++rcvd);
+            } else {
+                bench_wait(&nrecvd, ++rcvd);
+                send_one(&peer, buf, BENCH_TAG_DATA);
+            }
+            /* the buffer can't be handed back to pt2pt until
+             * the previous send has completed */
+            bench_wait(&nsent, ++sent);
+            dt = (bench_now_us() - t0) / 2;
+            if (i < opts->warmup) {
+                continue;
+            }
+            res.avg_us += dt;
+            if (dt < res.min_us) {
+                res.min_us = dt;
+            }
+            if (dt > res.max_us) {
+                res.max_us = dt;
+            }
+        }
+        res.avg_us /= iters;
+        res.mbytes_per_sec = size / res.avg_us;
+        bench_report(&res);
+        bench_buffer_free(buf);
+    }
+    scon_recv_cancel(bench_handle, &peer, BENCH_TAG_DATA);
+}
+
+static void run_bw(const bench_options_t *opts, unsigned int window)
+{
+    bench_result_t res;
+    scon_proc_t peer;
+    scon_buffer_t **bufs, *ack;
+    unsigned int i, w, iters, rcvd, acks, sent;
+    double t0;
+    size_t size;
+
+    if (1 < bench_rank) {
+        for (size = opts->min_size; size <= opts->max_size; size *= 2) {
+            bench_barrier();
+        }
+        return;
+    }
+    set_peer(&peer, 1 - bench_rank);
+    scon_recv_nb(bench_handle, &peer, (0 == bench_rank) ? BENCH_TAG_ACK : BENCH_TAG_DATA,
+                 true, recv_cbfunc, NULL, NULL, 0);
+    bufs = (scon_buffer_t**)calloc(window, sizeof(scon_buffer_t*));
+    ack = bench_buffer(1);
+    for (size = opts->min_size; size <= opts->max_size; size *= 2) {
+        iters = bench_iterations(opts, size);
+        for (w = 0; w < window; w++) {
+            bufs[w] = bench_buffer(size);
+        }
+        memset(&res, 0, sizeof(res));
+        res.op = "bw";
+        res.members = 2;
+        res.size = size;
+        res.iterations = iters;
+        rcvd = nrecvd;
+        acks = nacks;
+        sent = nsent;
+        bench_barrier();
+        t0 = bench_now_us();
+        for (i = 0; i < opts->warmup + iters; i++) {
+            if (i == opts->warmup) {
+                t0 = bench_now_us();
+            }
+            if (0 == bench_rank) {
+                for (w = 0; w < window; w++) {
+                    send_one(&peer, bufs[w], BENCH_TAG_DATA);
+                }
+                bench_wait(&nacks, ++acks);
+                sent += window;
+                bench_wait(&nsent, sent);
+            } else {
+                rcvd += window;
+                bench_wait(&nrecvd, rcvd);
+                send_one(&peer, ack, BENCH_TAG_ACK);
+                bench_wait(&nsent, ++sent);
+            }
+        }
+        res.avg_us = (bench_now_us() - t0) / ((double)iters * window);
+        res.min_us = res.max_us = res.avg_us;
+        res.mbytes_per_sec = size / res.avg_us;
+        res.msgs_per_sec = 1e6 / res.avg_us;
+        bench_report(&res);
+        for (w = 0; w < window; w++) {
+            bench_buffer_free(bufs[w]);
+        }
+    }
+    bench_buffer_free(ack);
+    free(bufs);
+    scon_recv_cancel(bench_handle, &peer,
+                     (0 == bench_rank) ? BENCH_TAG_ACK : BENCH_TAG_DATA);
+}
+
+static void run_rate(const bench_options_t *opts, unsigned int nsenders,
+                     unsigned int window)
+{
+    bench_result_t res;
+    scon_proc_t peer;
+    scon_buffer_t **bufs;
+    unsigned int i, w, total, sent;
+    double t0;
+
+    if (0 == nsenders || nsenders >= bench_nmembers) {
+        nsenders = bench_nmembers - 1;
+    }
+    total = opts->warmup + opts->iterations;
+    set_peer(&peer, 0);
+    if (0 == bench_rank) {
+        scon_recv_nb(bench_handle, SCON_PROC_WILDCARD, BENCH_TAG_DATA, true,
+                     recv_cbfunc, NULL, NULL, 0);
+    }
+    bufs = (scon_buffer_t**)calloc(window, sizeof(scon_buffer_t*));
+    for (w = 0; w < window; w++) {
+        bufs[w] = bench_buffer(opts->min_size);
+    }
+    sent = nsent;
+    bench_barrier();
+    t0 = bench_now_us();
+    if (0 == bench_rank) {
+        bench_wait(&nrecvd, nsenders * opts->warmup);
+        t0 = bench_now_us();
+        bench_wait(&nrecvd, nsenders * total);
+        memset(&res, 0, sizeof(res));
+        res.op = "rate";
+        res.members = nsenders + 1;
+        res.size = opts->min_size;
+        res.iterations = opts->iterations;
+        res.avg_us = (bench_now_us() - t0) / ((double)nsenders * opts->iterations);
+        res.min_us = res.max_us = res.avg_us;
+        res.mbytes_per_sec = opts->min_size / res.avg_us;
+        res.msgs_per_sec = 1e6 / res.avg_us;
+        bench_report(&res);
+    } else if (bench_rank <= nsenders) {
+        /* keep up to window sends outstanding */
+        for (i = 0; i < total; i++) {
+            if (i >= window) {
+                bench_wait(&nsent, sent + i - window + 1);
+            }
+            send_one(&peer, bufs[i % window], BENCH_TAG_DATA);
+        }
+        bench_wait(&nsent, sent + total);
+    }
+    bench_barrier();
+    if (0 == bench_rank) {
+        scon_recv_cancel(bench_handle, SCON_PROC_WILDCARD, BENCH_TAG_DATA);
+    }
+    for (w = 0; w < window; w++) {
+        bench_buffer_free(bufs[w]);
+    }
+    free(bufs);
+}
+
+int main(int argc, char **argv)
+{
+    bench_options_t opts;
+    const char *test = "latency";
+    unsigned int window = 64, nsenders = 0;
+    int opt;
+
+    bench_options_init(&opts);
+    while (-1 != (opt = getopt(argc, argv, BENCH_COMMON_OPTS "t:W:N:"))) {
+        switch (opt) {
+            case 't':
+                test = optarg;
+                break;
+            case 'W':
+                window = strtoul(optarg, NULL, 10);
+                break;
+            case 'N':
+                nsenders = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                if (!bench_options_parse(&opts, opt, optarg)) {
+                    bench_usage(argv[0], " [-t latency|bw|rate] [-W window] [-N senders]");
+                    return 1;
+                }
+                break;
+        }
+    }
+    if (0 == window) {
+        window = 1;
+    }
+    if (0 == opts.min_size) {
+        opts.min_size = 1;
+    }
+    if (0 == opts.iterations) {
+        opts.iterations = 1;
+    }
+    if (SCON_SUCCESS != bench_init()) {
+        return 1;
+    }
+    if (2 > bench_nmembers) {
+        fprintf(stderr, "%s needs at least 2 members\n", argv[0]);
+        bench_finalize();
+        return 1;
+    }
+    bench_report_open(&opts, "pt2pt");
+    if (0 == strcmp(test, "bw")) {
+        run_bw(&opts, window);
+    } else if (0 == strcmp(test, "rate")) {
+        run_rate(&opts, nsenders, window);
+    } else {
+        run_latency(&opts);
+    }
+    bench_report_close();
+    bench_barrier();
+    bench_finalize();
+    return 0;
+}
@@ -0,0 +1,219 @@
+/**
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Write a collectives tuning file from bench_coll results:
+ *
+ *   bench_coll -c allgather -a default -o default.csv
+ *   bench_coll -c allgather -a brucks -o brucks.csv
+ *   ...at each member count of interest
+ *   coll_tune [-o tuning.conf] *.csv
+ *
+ * For every member count and size measured the fastest algorithm
+ * wins, and runs of sizes won by the same algorithm are merged into
+ * one rule. A member count covers everything up to the next one
+ * measured. The link latency and bandwidth are fitted to the Brucks
+ * results, which the library uses for the cases no rule covers. Point
+ * the collectives_base_tuning_file MCA param at the output.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define COLL_TUNE_NAMELEN 64
+
+typedef struct {
+    unsigned long members;
+    unsigned long size;
+    char component[COLL_TUNE_NAMELEN];
+    double avg_us;
+} point_t;
+
+static point_t *points = NULL;
+static size_t npoints = 0;
+
+/* Brucks least squares fit: t = latency * rounds + bytes / bandwidth */
+static double fit[5];
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-o output] results.csv...\n", prog);
+}
+
+static unsigned int ceil_log2(unsigned long n)
+{
+    unsigned int r = 0;
+
+    while ((1UL << r) < n) {
+        ++r;
+    }
+    return r;
+}
+
+static int add_point(unsigned long members, unsigned long size,
+                     const char *component, double avg_us)
+{
+    size_t n;
+    point_t *tmp;
+
+    for (n = 0; n < npoints; n++) {
+        if (points[n].members == members && points[n].size == size) {
+            if (avg_us < points[n].avg_us) {
+                snprintf(points[n].component, COLL_TUNE_NAMELEN, "%s", component);
+                points[n].avg_us = avg_us;
+            }
+            return 0;
+        }
+    }
+    if (NULL == (tmp = (point_t*)realloc(points, (npoints + 1) * sizeof(point_t)))) {
+        return -1;
+    }
+    points = tmp;
+    memset(&points[npoints], 0, sizeof(point_t));
+    points[npoints].members = members;
+    points[npoints].size = size;
+    snprintf(points[npoints].component, COLL_TUNE_NAMELEN, "%s", component);
+    points[npoints].avg_us = avg_us;
+    ++npoints;
+    return 0;
+}
+
+static int cmp_points(const void *a, const void *b)
+{
+    const point_t *pa = (const point_t*)a, *pb = (const point_t*)b;
+
+    if (pa->members != pb->members) {
+        return (pa->members < pb->members) ? -1 : 1;
+    }
+    if (pa->size != pb->size) {
+        return (pa->size < pb->size) ? -1 : 1;
+    }
+    return 0;
+}
+
+/* read the allgather/<component> records of a bench_coll csv */
+static int read_results(const char *path)
+{
+    char line[512], bench[64], op[COLL_TUNE_NAMELEN + 10], *comp;
+    unsigned long members, size;
+    unsigned int iters;
+    double avg_us, x1, x2;
+    FILE *in;
+
+    if (NULL == (in = fopen(path, "r"))) {
+        perror(path);
+        return -1;
+    }
+    while (NULL != fgets(line, sizeof(line), in)) {
+        if (6 != sscanf(line, "%63[^,],%73[^,],%lu,%lu,%u,%lf",
+                        bench, op, &members, &size, &iters, &avg_us)) {
+            /* header or not a record */
+            continue;
+        }
+        if (0 != strncmp(op, "allgather/", 10) || 0 == members) {
+            continue;
+        }
+        comp = op + 10;
+        if (0 != add_point(members, size, comp, avg_us)) {
+            fclose(in);
+            return -1;
+        }
+        if (0 == strcmp(comp, "brucks")) {
+            x1 = ceil_log2(members);
+            x2 = (double)(members - 1) * size;
+            fit[0] += x1 * x1;
+            fit[1] += x1 * x2;
+            fit[2] += x2 * x2;
+            fit[3] += x1 * avg_us;
+            fit[4] += x2 * avg_us;
+        }
+    }
+    fclose(in);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    char *output = NULL;
+    FILE *out = stdout;
+    size_t n, first, next, run;
+    double det, latency, usec_per_byte;
+    int opt, i;
+
+    while (-1 != (opt = getopt(argc, argv, "o:h"))) {
+        switch (opt) {
+            case 'o':
+                output = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+    for (i = optind; i < argc; i++) {
+        if (0 != read_results(argv[i])) {
+            return 1;
+        }
+    }
+    if (0 == npoints) {
+        fprintf(stderr, "%s: no allgather/<component> records found, "
+                "run bench_coll with -a\n", argv[0]);
+        return 1;
+    }
+    if (NULL != output && NULL == (out = fopen(output, "w"))) {
+        perror(output);
+        return 1;
+    }
+    qsort(points, npoints, sizeof(point_t), cmp_points);
+
+    fprintf(out, "# collectives tuning file written by coll_tune from");
+    for (i = optind; i < argc; i++) {
+        fprintf(out, " %s", argv[i]);
+    }
+    fprintf(out, "\n");
+    det = fit[0] * fit[2] - fit[1] * fit[1];
+    if (0 != det) {
+        latency = (fit[3] * fit[2] - fit[1] * fit[4]) / det;
+        usec_per_byte = (fit[0] * fit[4] - fit[1] * fit[3]) / det;
+        if (0 < latency && 0 < usec_per_byte) {
+            fprintf(out, "latency %d\n", (int)(latency + 0.5));
+            fprintf(out, "bandwidth %d\n", (int)(1.0 / usec_per_byte + 0.5));
+        }
+    }
+
+    /* one block of rules per member count */
+    for (first = 0; first < npoints; first = next) {
+        for (next = first; next < npoints && points[next].members == points[first].members; next++);
+        for (n = first; n < next; n = run) {
+            for (run = n + 1; run < next &&
+                 0 == strcmp(points[run].component, points[n].component); run++);
+            fprintf(out, "allgather %lu ", (0 == first) ? 1UL : points[first].members);
+            if (next < npoints) {
+                fprintf(out, "%lu ", points[next].members - 1);
+            } else {
+                fprintf(out, "max ");
+            }
+            fprintf(out, "%lu ", (n == first) ? 0UL : points[n].size);
+            if (run < next) {
+                fprintf(out, "%lu ", points[run].size - 1);
+            } else {
+                fprintf(out, "max ");
+            }
+            fprintf(out, "%s\n", points[n].component);
+        }
+    }
+    if (NULL != output) {
+        fclose(out);
+    }
+    free(points);
+    return 0;
+}
@@ -0,0 +1,641 @@
+/**
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Scale simulator for the SCON collectives. Replays the message
+ * schedule of each collective algorithm over thousands of virtual
+ * members on the in-memory loopback of sim_engine, and reports the
+ * message count, bytes, rounds and critical path time, so that the
+ * topology, radix and algorithm thresholds can be chosen for large
+ * deployments without a cluster.
+ *
+ * The real modules read the per-process globals (SCON_PROC_MY_NAME,
+ * scon_globals) and so need one process per member. The schedules
+ * here follow them:
+ *
+ *   xcast                - master relays down the routing tree
+ *   barrier-tree         - fan-in to the master, release by xcast
+ *   barrier-dissemination- ceil(log2 N) rounds of tokens to i + 2^k
+ *   allgather-tree       - buckets grow up the tree, result by xcast
+ *   allgather-rd         - recursive doubling, N a power of two
+ *   allgather-ring       - N-1 pipelined steps around the ring
+ *   allgather-brucks     - ceil(log2 N) rounds to i - 2^k
+ *   allreduce-tree       - fixed size fan-in, result by xcast
+ *   allreduce-rd         - recursive doubling with the 2r folding
+ *
+ * The routing tree is either the radix tree (-T radix -k radix) or
+ * the binomial tree, computed as in the topology components.
+ */
+#include "sim_engine.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef enum {
+    SIM_FMT_CSV,
+    SIM_FMT_JSON
+} sim_format_t;
+
+/* the routing tree, children stored contiguously per member */
+static struct {
+    const char *name;
+    uint32_t radix;
+    uint32_t *parent;
+    uint32_t *first_child;
+    uint32_t *children;
+    /* members under each member, itself included */
+    uint32_t *subtree;
+} tree;
+
+/* state of the collective being simulated */
+static struct {
+    uint32_t n;
+    size_t size;
+    uint32_t nsteps;
+    /* fan-in: contributions grow with the subtree, and what
+     * the master releases */
+    bool grow;
+    size_t release;
+    uint32_t *count;
+    uint32_t *step;
+    uint64_t *got;
+    /* recursive doubling: largest power of two not above n, n - p */
+    uint32_t p;
+    uint32_t r;
+} coll;
+
+static uint32_t ceil_log2(uint32_t n)
+{
+    uint32_t l = 0;
+
+    while ((1u << l) < n) {
+        l++;
+    }
+    return l;
+}
+
+static uint32_t floor_log2(uint32_t n)
+{
+    uint32_t l = 0;
+
+    while (n >>= 1) {
+        l++;
+    }
+    return l;
+}
+
+/* parent of rank in the radix tree - as in radix_update_topology */
+static uint32_t radix_parent(uint32_t rank, uint32_t radix)
+{
+    uint64_t sum = 1, nlevel = 1, nprev;
+
+    while (sum < (uint64_t)rank + 1) {
+        nlevel *= radix;
+        sum += nlevel;
+    }
+    sum -= nlevel;
+    nprev = nlevel / radix;
+    return (rank - sum) % nprev + (sum - nprev);
+}
+
+/* parent in the binomial tree is the rank with its top bit cleared */
+static uint32_t binomial_parent(uint32_t rank)
+{
+    return rank & ~(1u << floor_log2(rank));
+}
+
+static int tree_build(const char *name, uint32_t radix, uint32_t n)
+{
+    uint32_t i, *fill;
+
+    tree.name = name;
+    tree.radix = radix;
+    tree.parent = (uint32_t*)calloc(n, sizeof(uint32_t));
+    tree.first_child = (uint32_t*)calloc(n + 1, sizeof(uint32_t));
+    tree.children = (uint32_t*)calloc(n, sizeof(uint32_t));
+    tree.subtree = (uint32_t*)calloc(n, sizeof(uint32_t));
+    fill = (uint32_t*)calloc(n + 1, sizeof(uint32_t));
+    if (NULL == tree.parent || NULL == tree.first_child || NULL == tree.children ||
+        NULL == tree.subtree || NULL == fill) {
+        free(fill);
+        return -1;
+    }
+    for (i = 1; i < n; i++) {
+        tree.parent[i] = (0 == strcmp(name, "binomial")) ? binomial_parent(i) :
+                                                             radix_parent(i, radix);
+        tree.first_child[tree.parent[i] + 1]++;
+    }
+    for (i = 0; i < n; i++) {
+        tree.first_child[i + 1] += tree.first_child[i];
+        fill[i] = tree.first_child[i];
+    }
+    for (i = 1; i < n; i++) {
+        tree.children[fill[tree.parent[i]]++] = i;
+    }
+    /* parents always have lower ranks than their children */
+    for (i = n; 0 < i--; ) {
+        tree.subtree[i] += 1;
+        if (0 < i) {
+            tree.subtree[tree.parent[i]] += tree.subtree[i];
+        }
+    }
+    free(fill);
+    return 0;
+}
+
+static void tree_free(void)
+{
+    free(tree.parent);
+    free(tree.first_child);
+    free(tree.children);
+    free(tree.subtree);
+    memset(&tree, 0, sizeof(tree));
+}
+
+/* relay size bytes from member to all its children */
+static void send_children(sim_t *sim, uint32_t member, size_t size, uint32_t step)
+{
+    uint32_t c;
+
+    for (c = tree.first_child[member]; c < tree.first_child[member + 1]; c++) {
+        sim_send(sim, member, tree.children[c], size, step);
+    }
+}
+
+/**** xcast from the master ****/
+static void xcast_recv(sim_t *sim, const sim_msg_t *msg)
+{
+    send_children(sim, msg->dst, coll.size, 0);
+    sim_complete(sim, msg->dst);
+}
+
+static void xcast_start(sim_t *sim)
+{
+    send_children(sim, 0, coll.size, 0);
+    sim_complete(sim, 0);
+}
+
+/**** fan-in to the master followed by an xcast release ****/
+#define FANIN_STEP    0
+#define RELEASE_STEP  1
+
+static void fanin_progress(sim_t *sim, uint32_t member)
+{
+    if (coll.count[member] < tree.first_child[member + 1] - tree.first_child[member]) {
+        return;
+    }
+    if (0 == member) {
+        send_children(sim, 0, coll.release, RELEASE_STEP);
+        sim_complete(sim, 0);
+    } else {
+        sim_send(sim, member, tree.parent[member],
+                 coll.grow ? coll.size * tree.subtree[member] : coll.size, FANIN_STEP);
+    }
+}
+
+static void fanin_recv(sim_t *sim, const sim_msg_t *msg)
+{
+    if (RELEASE_STEP == msg->step) {
+        send_children(sim, msg->dst, coll.release, RELEASE_STEP);
+        sim_complete(sim, msg->dst);
+        return;
+    }
+    coll.count[msg->dst]++;
+    fanin_progress(sim, msg->dst);
+}
+
+static void fanin_start(sim_t *sim)
+{
+    uint32_t i;
+
+    for (i = 0; i < coll.n; i++) {
+        fanin_progress(sim, i);
+    }
+}
+
+/**** pairwise exchanges - a member sends step k once it has
+ * the data of step k-1, and is done after nsteps ****/
+typedef uint32_t (*peer_fn_t)(uint32_t member, uint32_t step);
+typedef size_t (*bytes_fn_t)(uint32_t member, uint32_t step);
+
+static peer_fn_t pair_peer;
+static bytes_fn_t pair_bytes;
+
+static void pair_progress(sim_t *sim, uint32_t member)
+{
+    while (coll.step[member] < coll.nsteps &&
+           (coll.got[member] & (1ull << coll.step[member]))) {
+        if (++coll.step[member] < coll.nsteps) {
+            sim_send(sim, member, pair_peer(member, coll.step[member]),
+                     pair_bytes(member, coll.step[member]), coll.step[member]);
+        }
+    }
+    if (coll.step[member] == coll.nsteps) {
+        sim_complete(sim, member);
+    }
+}
+
+static void pair_recv(sim_t *sim, const sim_msg_t *msg)
+{
+    coll.got[msg->dst] |= 1ull << msg->step;
+    pair_progress(sim, msg->dst);
+}
+
+static void pair_start(sim_t *sim)
+{
+    uint32_t i;
+
+    for (i = 0; i < coll.n; i++) {
+        sim_send(sim, i, pair_peer(i, 0), pair_bytes(i, 0), 0);
+    }
+}
+
+static uint32_t dissemination_peer(uint32_t member, uint32_t step)
+{
+    return (uint32_t)((member + (1ull << step)) % coll.n);
+}
+
+static size_t token_bytes(uint32_t member, uint32_t step)
+{
+    return 0;
+}
+
+static uint32_t brucks_peer(uint32_t member, uint32_t step)
+{
+    return (uint32_t)((member + coll.n - ((1ull << step) % coll.n)) % coll.n);
+}
+
+static size_t brucks_bytes(uint32_t member, uint32_t step)
+{
+    uint64_t have = 1ull << step;
+
+    /* the last round only carries what the peer is missing */
+    return coll.size * ((have < coll.n - have) ? have : coll.n - have);
+}
+
+static uint32_t rd_peer(uint32_t member, uint32_t step)
+{
+    return member ^ (1u << step);
+}
+
+static size_t rd_bytes(uint32_t member, uint32_t step)
+{
+    return coll.size << step;
+}
+
+/**** allgather around the ring ****/
+static void ring_recv(sim_t *sim, const sim_msg_t *msg)
+{
+    uint32_t me = msg->dst;
+
+    /* pass the block along until it has been everywhere */
+    if (msg->step + 1 < coll.n - 1) {
+        sim_send(sim, me, (me + 1) % coll.n, coll.size, msg->step + 1);
+    }
+    if (++coll.count[me] == coll.n - 1) {
+        sim_complete(sim, me);
+    }
+}
+
+static void ring_start(sim_t *sim)
+{
+    uint32_t i;
+
+    for (i = 0; i < coll.n; i++) {
+        sim_send(sim, i, (i + 1) % coll.n, coll.size, 0);
+    }
+}
+
+/**** allreduce by recursive doubling - as in the base engine,
+ * the first 2r members fold pairwise into the odd one (step 0),
+ * the p remaining exchange in steps 1..log2(p), and the odd
+ * ones hand the result back (step log2(p)+1) ****/
+static bool ard_folded(uint32_t member)
+{
+    return member < 2 * coll.r && 0 == member % 2;
+}
+
+static uint32_t ard_vrank(uint32_t member)
+{
+    return (member < 2 * coll.r) ? member / 2 : member - coll.r;
+}
+
+static uint32_t ard_real(uint32_t vrank)
+{
+    return (vrank < coll.r) ? 2 * vrank + 1 : vrank + coll.r;
+}
+
+/* step[] is the next exchange step to send */
+static void ard_progress(sim_t *sim, uint32_t member)
+{
+    uint32_t s;
+
+    while ((s = coll.step[member]) <= coll.nsteps &&
+           (coll.got[member] & (1ull << (s - 1)))) {
+        sim_send(sim, member, ard_real(ard_vrank(member) ^ (1u << (s - 1))),
+                 coll.size, s);
+        coll.step[member]++;
+    }
+    if (coll.step[member] == coll.nsteps + 1 &&
+        (coll.got[member] & (1ull << coll.nsteps))) {
+        if (member < 2 * coll.r) {
+            sim_send(sim, member, member - 1, coll.size, coll.nsteps + 1);
+        }
+        coll.step[member]++;
+        sim_complete(sim, member);
+    }
+}
+
+static void ard_recv(sim_t *sim, const sim_msg_t *msg)
+{
+    if (ard_folded(msg->dst)) {
+        /* the result handed back */
+        sim_complete(sim, msg->dst);
+        return;
+    }
+    coll.got[msg->dst] |= 1ull << msg->step;
+    ard_progress(sim, msg->dst);
+}
+
+static void ard_start(sim_t *sim)
+{
+    uint32_t i;
+
+    for (i = 0; i < coll.n; i++) {
+        if (ard_folded(i)) {
+            sim_send(sim, i, i + 1, coll.size, 0);
+            continue;
+        }
+        coll.step[i] = 1;
+        if (2 * coll.r <= i) {
+            /* nothing to fold in */
+            coll.got[i] |= 1;
+        }
+        ard_progress(sim, i);
+    }
+}
+
+/**** the algorithm table ****/
+typedef struct {
+    const char *name;
+    sim_recv_fn_t recv;
+    void (*start)(sim_t *sim);
+    /* messages the schedule sends, to stay within the limit */
+    uint64_t (*msgs)(uint32_t n);
+} sim_algo_t;
+
+static uint64_t tree_msgs(uint32_t n)
+{
+    return 2ull * n;
+}
+
+static uint64_t log_msgs(uint32_t n)
+{
+    return (uint64_t)n * ceil_log2(n);
+}
+
+static uint64_t ring_msgs(uint32_t n)
+{
+    return (uint64_t)n * (n - 1);
+}
+
+static const sim_algo_t algorithms[] = {
+    {"xcast", xcast_recv, xcast_start, tree_msgs},
+    {"barrier-tree", fanin_recv, fanin_start, tree_msgs},
+    {"barrier-dissemination", pair_recv, pair_start, log_msgs},
+    {"allgather-tree", fanin_recv, fanin_start, tree_msgs},
+    {"allgather-rd", pair_recv, pair_start, log_msgs},
+    {"allgather-ring", ring_recv, ring_start, ring_msgs},
+    {"allgather-brucks", pair_recv, pair_start, log_msgs},
+    {"allreduce-tree", fanin_recv, fanin_start, tree_msgs},
+    {"allreduce-rd", ard_recv, ard_start, log_msgs},
+    {NULL, NULL, NULL, NULL}
+};
+
+/* setup the per algorithm state, false if it doesn't apply at n */
+static bool coll_setup(const sim_algo_t *algo, uint32_t n, size_t size)
+{
+    coll.n = n;
+    coll.size = size;
+    coll.nsteps = 0;
+    coll.grow = false;
+    coll.release = size;
+    memset(coll.count, 0, n * sizeof(uint32_t));
+    memset(coll.step, 0, n * sizeof(uint32_t));
+    memset(coll.got, 0, n * sizeof(uint64_t));
+    if (0 == strcmp(algo->name, "barrier-tree")) {
+        coll.size = 0;
+        coll.release = 0;
+    } else if (0 == strcmp(algo->name, "allgather-tree")) {
+        coll.grow = true;
+        coll.release = size * n;
+    } else if (0 == strcmp(algo->name, "barrier-dissemination")) {
+        coll.size = 0;
+        coll.nsteps = ceil_log2(n);
+        pair_peer = dissemination_peer;
+        pair_bytes = token_bytes;
+    } else if (0 == strcmp(algo->name, "allgather-brucks")) {
+        coll.nsteps = ceil_log2(n);
+        pair_peer = brucks_peer;
+        pair_bytes = brucks_bytes;
+    } else if (0 == strcmp(algo->name, "allgather-rd")) {
+        if (0 != (n & (n - 1))) {
+            return false;
+        }
+        coll.nsteps = floor_log2(n);
+        pair_peer = rd_peer;
+        pair_bytes = rd_bytes;
+    } else if (0 == strcmp(algo->name, "allreduce-rd")) {
+        coll.p = 1u << floor_log2(n);
+        coll.r = n - coll.p;
+        coll.nsteps = floor_log2(n);
+    }
+    /* the paired schedules need at least one exchange */
+    if (pair_recv == algo->recv && 0 == coll.nsteps) {
+        return false;
+    }
+    return (0 != strcmp(algo->name, "allgather-ring") || 1 < n);
+}
+
+static void report(FILE *out, sim_format_t format, bool first, uint32_t n,
+                   const char *algo, size_t size, const sim_result_t *res)
+{
+    if (SIM_FMT_CSV == format) {
+        fprintf(out, "%u,%s,%u,%s,%lu,%llu,%llu,%u,%.3f,%.3f,%u\n",
+                n, tree.name, tree.radix, algo, (unsigned long)size,
+                (unsigned long long)res->msgs, (unsigned long long)res->bytes,
+                res->rounds, res->critical_path_us, res->avg_completion_us,
+                res->max_member_msgs);
+    } else {
+        fprintf(out, "%s  {\"members\": %u, \"topology\": \"%s\", \"radix\": %u, "
+                     "\"algorithm\": \"%s\", \"size\": %lu, \"messages\": %llu, "
+                     "\"bytes\": %llu, \"rounds\": %u, \"critical_path_us\": %.3f, "
+                     "\"avg_completion_us\": %.3f, \"max_member_msgs\": %u}",
+                first ? "" : ",\n", n, tree.name, tree.radix, algo,
+                (unsigned long)size, (unsigned long long)res->msgs,
+                (unsigned long long)res->bytes, res->rounds, res->critical_path_us,
+                res->avg_completion_us, res->max_member_msgs);
+    }
+}
+
+static bool selected(const char *list, const char *name)
+{
+    size_t len = strlen(name);
+    const char *p = list;
+
+    if (0 == strcmp(list, "all")) {
+        return true;
+    }
+    while (NULL != (p = strstr(p, name))) {
+        if ((p == list || ',' == p[-1]) && (',' == p[len] || '\0' == p[len])) {
+            return true;
+        }
+        p += len;
+    }
+    return false;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-n members[,members...]] [-T radix|binomial] [-k radix]\n"
+                    "          [-a algorithm[,algorithm...]|all] [-m min size] [-M max size]\n"
+                    "          [-L latency us] [-B MB/s] [-O overhead us] [-H header bytes]\n"
+                    "          [-x max messages] [-f csv|json] [-o file]\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    sim_model_t model = {2.0, 10000.0, 0.5, 64};
+    const char *members = "1024", *algos = "all", *topo = "radix";
+    uint32_t radix = 4, n;
+    size_t min_size = 8, max_size = 65536, size;
+    uint64_t max_msgs = 100000000ull;
+    sim_format_t format = SIM_FMT_CSV;
+    char *list, *tok, *save = NULL;
+    const sim_algo_t *algo;
+    sim_result_t res;
+    FILE *out = stdout;
+    bool first = true;
+    sim_t sim;
+    int opt, rc = 0;
+
+    while (-1 != (opt = getopt(argc, argv, "n:T:k:a:m:M:L:B:O:H:x:f:o:h"))) {
+        switch (opt) {
+            case 'n': members = optarg; break;
+            case 'T': topo = optarg; break;
+            case 'k': radix = strtoul(optarg, NULL, 10); break;
+            case 'a': algos = optarg; break;
+            case 'm': min_size = strtoul(optarg, NULL, 10); break;
+            case 'M': max_size = strtoul(optarg, NULL, 10); break;
+            case 'L': model.latency_us = strtod(optarg, NULL); break;
+            case 'B': model.mbytes_per_sec = strtod(optarg, NULL); break;
+            case 'O': model.overhead_us = strtod(optarg, NULL); break;
+            case 'H': model.header_bytes = strtoul(optarg, NULL, 10); break;
+            case 'x': max_msgs = strtoull(optarg, NULL, 10); break;
+            case 'f':
+                if (0 == strcmp(optarg, "json")) {
+                    format = SIM_FMT_JSON;
+                } else if (0 != strcmp(optarg, "csv")) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'o':
+                if (NULL == (out = fopen(optarg, "w"))) {
+                    fprintf(stderr, "%s: cannot open %s\n", argv[0], optarg);
+                    return 1;
+                }
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (0 != strcmp(topo, "radix") && 0 != strcmp(topo, "binomial")) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (2 > radix) {
+        radix = 2;
+    }
+    if (0 == min_size) {
+        min_size = 1;
+    }
+    if (0 >= model.mbytes_per_sec) {
+        model.mbytes_per_sec = 1;
+    }
+
+    if (SIM_FMT_CSV == format) {
+        fprintf(out, "members,topology,radix,algorithm,size,messages,bytes,rounds,"
+                     "critical_path_us,avg_completion_us,max_member_msgs\n");
+    } else {
+        fprintf(out, "[\n");
+    }
+    list = strdup(members);
+    for (tok = strtok_r(list, ",", &save); NULL != tok; tok = strtok_r(NULL, ",", &save)) {
+        if (0 == (n = strtoul(tok, NULL, 10))) {
+            continue;
+        }
+        if (0 != sim_init(&sim, &model, n) ||
+            0 != tree_build(topo, (0 == strcmp(topo, "binomial")) ? 2 : radix, n)) {
+            fprintf(stderr, "%s: out of memory at %u members\n", argv[0], n);
+            rc = 1;
+            break;
+        }
+        coll.count = (uint32_t*)calloc(n, sizeof(uint32_t));
+        coll.step = (uint32_t*)calloc(n, sizeof(uint32_t));
+        coll.got = (uint64_t*)calloc(n, sizeof(uint64_t));
+        for (algo = algorithms; NULL != algo->name; algo++) {
+            if (!selected(algos, algo->name)) {
+                continue;
+            }
+            if (algo->msgs(n) > max_msgs) {
+                fprintf(stderr, "%s: skipping %s at %u members, more than %llu messages\n",
+                        argv[0], algo->name, n, (unsigned long long)max_msgs);
+                continue;
+            }
+            for (size = min_size; size <= max_size; size *= 2) {
+                if (!coll_setup(algo, n, size)) {
+                    break;
+                }
+                sim_reset(&sim, algo->recv);
+                if (1 == n) {
+                    sim_complete(&sim, 0);
+                } else {
+                    algo->start(&sim);
+                }
+                sim_run(&sim, &res);
+                if (0 < res.incomplete) {
+                    fprintf(stderr, "%s: %s at %u members left %u members incomplete\n",
+                            argv[0], algo->name, n, res.incomplete);
+                    rc = 1;
+                }
+                report(out, format, first, n, algo->name, coll.size, &res);
+                first = false;
+                if (0 == coll.size) {
+                    /* barriers don't depend on the size */
+                    break;
+                }
+            }
+        }
+        free(coll.count);
+        free(coll.step);
+        free(coll.got);
+        tree_free();
+        sim_fini(&sim);
+    }
+    free(list);
+    if (SIM_FMT_JSON == format) {
+        fprintf(out, "\n]\n");
+    }
+    if (stdout != out) {
+        fclose(out);
+    }
+    return rc;
+}
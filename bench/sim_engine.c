@@ -0,0 +1,196 @@
+/**
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+#include "sim_engine.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+int sim_init(sim_t *sim, const sim_model_t *model, uint32_t nmembers)
+{
+    memset(sim, 0, sizeof(*sim));
+    sim->model = *model;
+    sim->nmembers = nmembers;
+    sim->clock = (double*)calloc(nmembers, sizeof(double));
+    sim->tx_free = (double*)calloc(nmembers, sizeof(double));
+    sim->rx_free = (double*)calloc(nmembers, sizeof(double));
+    sim->round = (uint32_t*)calloc(nmembers, sizeof(uint32_t));
+    sim->done = (double*)calloc(nmembers, sizeof(double));
+    sim->handled = (uint32_t*)calloc(nmembers, sizeof(uint32_t));
+    sim->heap_size = 1024;
+    sim->heap = (sim_msg_t*)malloc(sim->heap_size * sizeof(sim_msg_t));
+    if (NULL == sim->clock || NULL == sim->tx_free || NULL == sim->rx_free ||
+        NULL == sim->round || NULL == sim->done || NULL == sim->handled ||
+        NULL == sim->heap) {
+        sim_fini(sim);
+        return -1;
+    }
+    return 0;
+}
+
+void sim_fini(sim_t *sim)
+{
+    free(sim->clock);
+    free(sim->tx_free);
+    free(sim->rx_free);
+    free(sim->round);
+    free(sim->done);
+    free(sim->handled);
+    free(sim->heap);
+    memset(sim, 0, sizeof(*sim));
+}
+
+void sim_reset(sim_t *sim, sim_recv_fn_t recv)
+{
+    uint32_t i;
+
+    sim->recv = recv;
+    memset(sim->clock, 0, sim->nmembers * sizeof(double));
+    memset(sim->tx_free, 0, sim->nmembers * sizeof(double));
+    memset(sim->rx_free, 0, sim->nmembers * sizeof(double));
+    memset(sim->round, 0, sim->nmembers * sizeof(uint32_t));
+    memset(sim->handled, 0, sim->nmembers * sizeof(uint32_t));
+    for (i = 0; i < sim->nmembers; i++) {
+        sim->done[i] = -1;
+    }
+    sim->ndone = 0;
+    sim->nheap = 0;
+    sim->seq = 0;
+    sim->msgs = 0;
+    sim->bytes = 0;
+}
+
+static bool earlier(const sim_msg_t *a, const sim_msg_t *b)
+{
+    return a->time < b->time || (a->time == b->time && a->seq < b->seq);
+}
+
+static void heap_push(sim_t *sim, const sim_msg_t *msg)
+{
+    sim_msg_t *heap;
+    size_t i, parent;
+
+    if (sim->nheap == sim->heap_size) {
+        if (NULL == (heap = (sim_msg_t*)realloc(sim->heap, 2 * sim->heap_size * sizeof(sim_msg_t)))) {
+            abort();
+        }
+        sim->heap = heap;
+        sim->heap_size *= 2;
+    }
+    i = sim->nheap++;
+    while (0 < i) {
+        parent = (i - 1) / 2;
+        if (!earlier(msg, &sim->heap[parent])) {
+            break;
+        }
+        sim->heap[i] = sim->heap[parent];
+        i = parent;
+    }
+    sim->heap[i] = *msg;
+}
+
+static void heap_pop(sim_t *sim, sim_msg_t *msg)
+{
+    sim_msg_t last;
+    size_t i = 0, child;
+
+    *msg = sim->heap[0];
+    last = sim->heap[--sim->nheap];
+    while ((child = 2 * i + 1) < sim->nheap) {
+        if (child + 1 < sim->nheap && earlier(&sim->heap[child + 1], &sim->heap[child])) {
+            child++;
+        }
+        if (!earlier(&sim->heap[child], &last)) {
+            break;
+        }
+        sim->heap[i] = sim->heap[child];
+        i = child;
+    }
+    sim->heap[i] = last;
+}
+
+void sim_send(sim_t *sim, uint32_t src, uint32_t dst, size_t bytes, uint32_t step)
+{
+    sim_msg_t msg;
+    double start;
+
+    bytes += sim->model.header_bytes;
+    /* the CPU is busy for the overhead, the link until the
+     * last byte is out */
+    start = (sim->clock[src] > sim->tx_free[src]) ? sim->clock[src] : sim->tx_free[src];
+    sim->clock[src] = start + sim->model.overhead_us;
+    sim->tx_free[src] = sim->clock[src] + bytes / sim->model.mbytes_per_sec;
+    msg.time = sim->tx_free[src] + sim->model.latency_us;
+    msg.seq = sim->seq++;
+    msg.src = src;
+    msg.dst = dst;
+    msg.bytes = bytes;
+    msg.round = sim->round[src] + 1;
+    msg.step = step;
+    sim->msgs++;
+    sim->bytes += bytes;
+    sim->handled[src]++;
+    heap_push(sim, &msg);
+}
+
+void sim_complete(sim_t *sim, uint32_t member)
+{
+    if (0 > sim->done[member]) {
+        sim->done[member] = sim->clock[member];
+        sim->ndone++;
+    }
+}
+
+void sim_run(sim_t *sim, sim_result_t *res)
+{
+    sim_msg_t msg;
+    double arrival;
+    uint32_t i;
+
+    while (0 < sim->nheap) {
+        heap_pop(sim, &msg);
+        /* the incoming link is shared by everyone sending to dst */
+        arrival = sim->rx_free[msg.dst] + msg.bytes / sim->model.mbytes_per_sec;
+        if (arrival < msg.time) {
+            arrival = msg.time;
+        }
+        sim->rx_free[msg.dst] = arrival;
+        if (sim->clock[msg.dst] < arrival) {
+            sim->clock[msg.dst] = arrival;
+        }
+        sim->clock[msg.dst] += sim->model.overhead_us;
+        if (sim->round[msg.dst] < msg.round) {
+            sim->round[msg.dst] = msg.round;
+        }
+        sim->handled[msg.dst]++;
+        sim->recv(sim, &msg);
+    }
+
+    memset(res, 0, sizeof(*res));
+    res->msgs = sim->msgs;
+    res->bytes = sim->bytes;
+    for (i = 0; i < sim->nmembers; i++) {
+        if (0 > sim->done[i]) {
+            res->incomplete++;
+            continue;
+        }
+        if (res->critical_path_us < sim->done[i]) {
+            res->critical_path_us = sim->done[i];
+        }
+        if (res->rounds < sim->round[i]) {
+            res->rounds = sim->round[i];
+        }
+        res->avg_completion_us += sim->done[i];
+        if (res->max_member_msgs < sim->handled[i]) {
+            res->max_member_msgs = sim->handled[i];
+        }
+    }
+    if (0 < sim->ndone) {
+        res->avg_completion_us /= sim->ndone;
+    }
+}
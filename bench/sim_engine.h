@@ -0,0 +1,100 @@
+/**
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Discrete event engine for simulating SCON collectives over many
+ * virtual members inside a single process. Members exchange messages
+ * over an in-memory loopback whose cost follows a simple model:
+ *
+ *  - every send and every receive costs the member overhead_us of CPU
+ *  - a member's outgoing and incoming links each carry one message at
+ *    a time at mbytes_per_sec, so fan-in and fan-out serialize
+ *  - a message then takes latency_us on the wire
+ *
+ * Each message records the length of the chain of messages that led
+ * to it, which gives the number of communication rounds.
+ */
+#ifndef SIM_ENGINE_H
+#define SIM_ENGINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef struct {
+    double latency_us;
+    double mbytes_per_sec;
+    double overhead_us;
+    /* envelope added to every message */
+    size_t header_bytes;
+} sim_model_t;
+
+typedef struct {
+    double time;
+    uint64_t seq;
+    uint32_t src;
+    uint32_t dst;
+    size_t bytes;
+    uint32_t round;
+    /* algorithm specific, e.g. the step the message belongs to */
+    uint32_t step;
+} sim_msg_t;
+
+typedef struct sim sim_t;
+
+/* called when msg is delivered to msg->dst */
+typedef void (*sim_recv_fn_t)(sim_t *sim, const sim_msg_t *msg);
+
+struct sim {
+    sim_model_t model;
+    uint32_t nmembers;
+    sim_recv_fn_t recv;
+    /* per member: CPU and link availability, the deepest round seen
+     * and the completion time, negative until the member is done */
+    double *clock;
+    double *tx_free;
+    double *rx_free;
+    uint32_t *round;
+    double *done;
+    uint32_t *handled;
+    uint32_t ndone;
+    /* pending deliveries, a binary heap on (time, seq) */
+    sim_msg_t *heap;
+    size_t nheap;
+    size_t heap_size;
+    uint64_t seq;
+    /* totals for the current run */
+    uint64_t msgs;
+    uint64_t bytes;
+};
+
+/* result of one collective */
+typedef struct {
+    uint64_t msgs;
+    uint64_t bytes;
+    uint32_t rounds;
+    /* time the last member completed */
+    double critical_path_us;
+    double avg_completion_us;
+    /* most messages sent plus received by any one member */
+    uint32_t max_member_msgs;
+    /* members that never completed - nonzero means a broken schedule */
+    uint32_t incomplete;
+} sim_result_t;
+
+int sim_init(sim_t *sim, const sim_model_t *model, uint32_t nmembers);
+void sim_fini(sim_t *sim);
+/* clear all state ahead of a new collective */
+void sim_reset(sim_t *sim, sim_recv_fn_t recv);
+/* send bytes of payload from src to dst, tagged with step */
+void sim_send(sim_t *sim, uint32_t src, uint32_t dst, size_t bytes, uint32_t step);
+/* mark member as having completed the collective */
+void sim_complete(sim_t *sim, uint32_t member);
+/* deliver messages until none are left */
+void sim_run(sim_t *sim, sim_result_t *res);
+
+#endif
@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Merge the traces written by the members of a job with
+ * scon_trace_enable=1 into a single Chrome trace:
+ *
+ *   trace_merge [-o out.json] scon-trace.<job>.*.json
+ *
+ * Each member is a process in the merged trace. The members stamp
+ * their events with the wall clock, so the result is only as well
+ * aligned as the clocks of the nodes.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-o output] trace.json...\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    char *output = NULL, *line = NULL, *ev;
+    size_t linesz = 0, len;
+    unsigned long nevents = 0;
+    FILE *in, *out = stdout;
+    int opt, i, rc = 0;
+
+    while (-1 != (opt = getopt(argc, argv, "o:h"))) {
+        switch (opt) {
+            case 'o':
+                output = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (NULL != output && NULL == (out = fopen(output, "w"))) {
+        perror(output);
+        return 1;
+    }
+
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    for (i = optind; i < argc; i++) {
+        if (NULL == (in = fopen(argv[i], "r"))) {
+            perror(argv[i]);
+            rc = 1;
+            continue;
+        }
+        /* the library writes the header on the first line, then
+         * one event per line and the closing brackets */
+        if (0 >= getline(&line, &linesz, in) ||
+            NULL == strstr(line, "\"traceEvents\":[")) {
+            fprintf(stderr, "%s: %s is not a SCON trace\n", argv[0], argv[i]);
+            fclose(in);
+            rc = 1;
+            continue;
+        }
+        while (0 < getline(&line, &linesz, in)) {
+            len = strlen(line);
+            while (0 < len && ('\n' == line[len-1] || '\r' == line[len-1] ||
+                               ',' == line[len-1])) {
+                line[--len] = '\0';
+            }
+            ev = line;
+            if (',' == *ev) {
+                ev++;
+            }
+            if ('{' != *ev) {
+                continue;
+            }
+            fprintf(out, "%s\n%s", (0 == nevents) ? "" : ",", ev);
+            nevents++;
+        }
+        fclose(in);
+    }
+    fprintf(out, "\n]}\n");
+    free(line);
+    if (stdout != out) {
+        fclose(out);
+    }
+    fprintf(stderr, "%s: merged %lu events from %d files\n", argv[0], nevents, argc - optind);
+    return rc;
+}
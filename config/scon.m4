@@ -859,6 +859,24 @@ fi
 
 AC_DEFINE_UNQUOTED([SCON_ENABLE_IPV6], [$WANT_IPV6],
                    [Whether or not we want IPv6 support])
+
+#
+# Hash function for binary hash table keys
+#
+AC_MSG_CHECKING([if the word-at-a-time hash should be used for binary keys])
+AC_ARG_ENABLE(fast-hash,
+              AC_HELP_STRING([--disable-fast-hash],
+                             [hash binary hash table keys a byte at a time, as older releases did (default: enabled)]))
+if test "$enable_fast_hash" = "no"; then
+    AC_MSG_RESULT([no])
+    WANT_FAST_HASH=0
+else
+    AC_MSG_RESULT([yes])
+    WANT_FAST_HASH=1
+fi
+
+AC_DEFINE_UNQUOTED([SCON_ENABLE_FAST_HASH], [$WANT_FAST_HASH],
+                   [Whether to hash binary hash table keys a word at a time])
 ])dnl
 
 # This must be a standalone routine so that it can be called both by
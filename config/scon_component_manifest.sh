@@ -0,0 +1,51 @@
+#!/bin/sh
+#
+# Copyright (c) 2017 Intel, Inc. All rights reserved.
+# $COPYRIGHT$
+#
+# Additional copyrights may follow
+#
+# $HEADER$
+#
+# Write the list of the MCA components installed in a directory to
+# <dir>/scon-components.manifest, so that the library can find them
+# at startup without reading the directory and stat'ing every file
+# in it. Run at install time:
+#
+#   scon_component_manifest.sh <component dir> <scon version>
+#
+# Each line is "<framework> <component> <file name without extension>",
+# the same split of mca_<framework>_<component> the repository makes.
+# The library ignores a manifest whose version isn't its own.
+
+dir=$1
+version=$2
+manifest=$dir/scon-components.manifest
+
+if test -z "$dir" || test -z "$version"; then
+    echo "usage: $0 <component dir> <scon version>" >&2
+    exit 1
+fi
+if test ! -d "$dir"; then
+    # no components were installed - nothing to list
+    exit 0
+fi
+
+tmp=$manifest.tmp.$$
+{
+    echo "# SCON component manifest - generated at install, do not edit"
+    echo "# version $version"
+    for file in "$dir"/mca_*.la "$dir"/mca_*.so; do
+        test -f "$file" || continue
+        base=`basename "$file"`
+        echo "${base%.*}"
+    done | sort -u | while read base; do
+        # framework names may not include an _, component names may
+        framework=`echo "$base" | sed -e 's/^mca_\([^_]*\)_.*$/\1/'`
+        component=`echo "$base" | sed -e 's/^mca_[^_]*_\(.*\)$/\1/'`
+        if test -n "$framework" && test -n "$component" && \
+           test "$framework" != "$base" && test "$component" != "$base"; then
+            echo "$framework $component $base"
+        fi
+    done
+} > "$tmp" && mv -f "$tmp" "$manifest"
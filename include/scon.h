@@ -71,6 +71,29 @@ typedef void (*scon_allgather_cbfunc_t) (scon_status_t status,
                                        scon_info_t info[],
                                        size_t ninfo,
                                        void *cbdata);
+/* scon allgatherv callback function. result indexes the contributions
+ * by participant, it is NULL if the allgather failed */
+typedef void (*scon_allgatherv_cbfunc_t) (scon_status_t status,
+                                          scon_handle_t scon_handle,
+                                          scon_proc_t procs[],
+                                          size_t nprocs,
+                                          scon_allgather_result_t *result,
+                                          scon_info_t info[],
+                                          size_t ninfo,
+                                          void *cbdata);
+/* scon allreduce/reduce callback function. recvbuf holds the count
+ * reduced elements of the given type, or is NULL on members that
+ * are not the root of a rooted reduce */
+typedef void (*scon_reduce_cbfunc_t) (scon_status_t status,
+                                      scon_handle_t scon_handle,
+                                      scon_proc_t procs[],
+                                      size_t nprocs,
+                                      void *recvbuf,
+                                      size_t count,
+                                      scon_data_type_t type,
+                                      scon_info_t info[],
+                                      size_t ninfo,
+                                      void *cbdata);
 /**
  * @func scon_init initializes the scon library.
  * @param info   - array of info keys specifying the requested SCON library capabilities.
@@ -113,10 +136,49 @@ scon_handle_t scon_create(scon_proc_t procs[],
                           scon_create_cbfunc_t cbfunc,
                           void *cbdata);
 
+/**
+ * @func scon_split derives child scons from an existing (parent) scon. Every member
+ *                  of the parent must call it. Members passing the same color end up in
+ *                  the same child, ordered by key and then by their order in the parent,
+ *                  the first of them being the master. The child reuses the parent's
+ *                  modules and connections, so it costs one allgather over the parent
+ *                  instead of a full create, and no collective at all with SCON_SPLIT_BLOCK.
+ * @param parent    - handle of the parent scon, it must be operational.
+ * @param color     - the child to join, SCON_SPLIT_UNDEFINED to join none, in which
+ *                    case cbfunc is called with SCON_HANDLE_INVALID.
+ * @param key       - rank of the caller within its child.
+ * @param info      - array of info keys, SCON_SPLIT_BLOCK is the one supported.
+ * @param ninfo     - size of info array.
+ * @param cbfunc    - called with the handle of the child once it is operational.
+ * @param cbdata    - user's cbdata.
+ * @return          - SCON_HANDLE_NEW if the split was started, SCON_HANDLE_INVALID otherwise.
+ *                    As with scon_create, the members of the parent must create, split
+ *                    and delete scons in the same order.
+ */
+scon_handle_t scon_split(scon_handle_t parent,
+                         int color,
+                         int key,
+                         scon_info_t info[],
+                         size_t ninfo,
+                         scon_create_cbfunc_t cbfunc,
+                         void *cbdata);
+
 scon_status_t scon_get_info (scon_handle_t scon_handle,
                              scon_info_t **info,
                              size_t *ninfo);
 
+/**
+ * Send a message to a member of a scon.
+ *
+ * The buffer belongs to the library until cbfunc is called, so the
+ * same buffer mustn't be handed to two sends at once. Messages of
+ * more than the pt2pt_base_eager_limit MCA param are held until the
+ * receiver has a matching recv posted, so cbfunc may only be called
+ * once the receiver calls scon_recv_nb. If the queue to the next hop
+ * is over the pt2pt_tcp_max_queued_bytes MCA param the send isn't
+ * queued, and cbfunc is called with SCON_ERR_QUEUE_FULL. The
+ * SCON_MSG_PRIORITY info key picks the class the message is sent in.
+ */
 scon_status_t scon_send_nb (scon_handle_t scon_handle,
                             scon_proc_t *peer,
                             scon_buffer_t *buf,
@@ -173,6 +235,69 @@ scon_status_t scon_allgather(scon_handle_t scon_handle,
                            scon_info_t info[],
                            size_t ninfo);
 
+/**
+ * @func scon_allgatherv same as scon_allgather, except that the result
+ *                       is indexed by participant. Participant i is
+ *                       procs[i], or the i-th member of the scon when
+ *                       procs = null, and its contribution is loaded
+ *                       into a buffer with SCON_ALLGATHER_RESULT_VIEW.
+ *                       The result is released when cbfunc returns.
+ */
+scon_status_t scon_allgatherv(scon_handle_t scon_handle,
+                              scon_proc_t procs[],
+                              size_t nprocs,
+                              scon_buffer_t *buf,
+                              scon_allgatherv_cbfunc_t cbfunc,
+                              void *cbdata,
+                              scon_info_t info[],
+                              size_t ninfo);
+
+/**
+ * @func scon_allreduce combines an array contributed by every participant
+ *                      element-wise and returns the result to all of them.
+ * @param procs    - participating procs, NULL for all members of the scon
+ * @param nprocs   - size of procs[], 0 when procs = null
+ * @param sendbuf  - local contribution of count elements of type
+ * @param recvbuf  - where the result is stored before cbfunc is called,
+ *                   may be the same as sendbuf
+ * @param count    - number of elements, must be the same on all participants
+ * @param type     - one of the integer or floating point scon data types
+ * @param op       - one of the SCON_OP_xxx built-in operators
+ * @return         - SCON_ERR_NOT_SUPPORTED if the type/op combination
+ *                   is not supported, otherwise the post status.
+ */
+scon_status_t scon_allreduce(scon_handle_t scon_handle,
+                             scon_proc_t procs[],
+                             size_t nprocs,
+                             const void *sendbuf,
+                             void *recvbuf,
+                             size_t count,
+                             scon_data_type_t type,
+                             scon_reduce_op_t op,
+                             scon_reduce_cbfunc_t cbfunc,
+                             void *cbdata,
+                             scon_info_t info[],
+                             size_t ninfo);
+
+/**
+ * @func scon_reduce same as scon_allreduce, except that the result is
+ *                   only delivered to root. recvbuf is ignored on all
+ *                   other participants.
+ */
+scon_status_t scon_reduce(scon_handle_t scon_handle,
+                          scon_proc_t procs[],
+                          size_t nprocs,
+                          const void *sendbuf,
+                          void *recvbuf,
+                          size_t count,
+                          scon_data_type_t type,
+                          scon_reduce_op_t op,
+                          scon_proc_t *root,
+                          scon_reduce_cbfunc_t cbfunc,
+                          void *cbdata,
+                          scon_info_t info[],
+                          size_t ninfo);
+
 scon_status_t scon_finalize(void);
 
 
@@ -146,6 +146,8 @@ typedef int scon_status_t;
 /* used by the query system */
 #define SCON_QUERY_PARTIAL_SUCCESS              (SCON_ERR_BASE - 27)
 #define SCON_ERR_QUERY_NOT_SUPPORTED            (SCON_ERR_BASE - 28)
+/* flow control - the send queue to the next hop is full */
+#define SCON_ERR_QUEUE_FULL                     (SCON_ERR_BASE - 29)
 
 /* define a starting point for SCON internal error codes
  * that are never exposed outside the library */
@@ -265,6 +267,18 @@ typedef uint8_t  scon_data_type_t;  /** data type indicators */
 /* SCON Dynamic */
 #define    SCON_DSS_ID_DYNAMIC      (scon_data_type_t)  100
 
+/****    SCON REDUCTION OPERATORS    ****/
+/* built-in operators for scon_allreduce/scon_reduce. They apply
+ * element-wise to arrays of the integer and floating point data
+ * types above - the bitwise operators are only defined on the
+ * integer types */
+typedef uint8_t scon_reduce_op_t;
+#define    SCON_OP_SUM              (scon_reduce_op_t)    1
+#define    SCON_OP_MIN              (scon_reduce_op_t)    2
+#define    SCON_OP_MAX              (scon_reduce_op_t)    3
+#define    SCON_OP_BAND             (scon_reduce_op_t)    4
+#define    SCON_OP_BOR              (scon_reduce_op_t)    5
+
 typedef uint32_t scon_rank_t;
 
 /* define a range for data "published" by SCON
@@ -577,6 +591,39 @@ typedef struct {
     size_t bytes_used;
 } scon_buffer_t;
 
+/**
+ * Result of scon_allgatherv - the contributions of all participants
+ * back to back in participant order, with the offset and size of
+ * each one, so that a participant's data can be found without
+ * unpacking the others. It belongs to the library and is only
+ * valid in the callback */
+typedef struct {
+    /** type of the contributed buffers */
+    scon_bfrop_buffer_type_t type;
+    /** number of participants */
+    size_t nprocs;
+    /** start of the contributions */
+    char *bytes;
+    /** offset from bytes and size of the contribution of
+        participant i, a participant may contribute 0 bytes */
+    size_t *offsets;
+    size_t *sizes;
+} scon_allgather_result_t;
+
+/* load buffer b with the contribution of participant idx of
+ * allgather result r, ready to be unpacked. The buffer shares the
+ * result's memory - it must not be destructed and is only valid
+ * in the callback */
+#define SCON_ALLGATHER_RESULT_VIEW(b, r, idx)                                   \
+    do {                                                                        \
+        (b)->type = (r)->type;                                                  \
+        (b)->base_ptr = (r)->bytes + (r)->offsets[(idx)];                       \
+        (b)->unpack_ptr = (b)->base_ptr;                                        \
+        (b)->pack_ptr = (b)->base_ptr + (r)->sizes[(idx)];                      \
+        (b)->bytes_allocated = (r)->sizes[(idx)];                               \
+        (b)->bytes_used = (r)->sizes[(idx)];                                    \
+    } while (0)
+
 
 
 /* SCON INFO KEYS */
@@ -611,8 +658,12 @@ typedef struct {
                                                                  that are allowed to exchange msgs */
 #define SCON_MASTER_PROC           "scon.master"        /* master process for the scon - topology root
                                                                value is scon_proc_t */
-#define SCON_RECV_QUEUE_LENGTH     "scon.recv.queue.length"  /* unsigned int length of the queue for unmatched received messages
+#define SCON_RECV_QUEUE_LENGTH     "scon.recv.queue.length"  /* uint16 length of the queue for unmatched received messages
                                                               */
+#define SCON_RECV_QUEUE_BYTES      "scon.recv.queue.bytes"   /* size_t bytes of eager payload the queue for unmatched
+                                                                received messages may hold - past this or the length,
+                                                                senders are asked to hold their data until it is
+                                                                received (default: pt2pt_base_unexpected_bytes MCA param) */
 #define SCON_CREATE_TIMEOUT        "scon.create.timeout"    /* Time out in secs for the create operation
                                                                value is unsigned int   master process must specify this value.*/
 #define SCON_OPERATIONAL_QUORUM    "scon.operational.quorum"  /* minimum number of members that must be up
@@ -628,6 +679,52 @@ typedef struct {
 #define SCON_TOPO_MOD_LIST         "scon.topo.mod.list"       /* list of topology modules requested at SCON lib init.
                                                               value is a comma separated list of topology modules
                                                                (refer to module MCA names) */
+#define SCON_SPLIT_BLOCK           "scon.split.block"         /* uint32 - scon_split puts each run of this many members
+                                                                 of the parent, in parent order, in a child of its own.
+                                                                 The color and key are ignored and no messages are
+                                                                 exchanged. All members must pass the same value */
+#define SCON_COLL_ALGORITHM        "scon.coll.algorithm"      /* string - collectives component (default, brucks, rcd) whose
+                                                                 allgather runs this call, instead of the one picked from the
+                                                                 tuning rules. All participants must pass the same value */
+#define SCON_COLL_SIZE_HINT        "scon.coll.size.hint"      /* size_t - per participant payload the allgather algorithm is
+                                                                 picked for. Without it the algorithm is picked by member count
+                                                                 alone. All participants must pass the same value */
+#define SCON_MSG_PRIORITY          "scon.msg.priority"        /* uint8 - class of a scon_send_nb or scon_xcast: one of the
+                                                                 SCON_MSG_PRIORITY values below. Each hop sends what it has
+                                                                 queued of a higher class first, and large messages go in
+                                                                 fragments so a higher class can cut in between them. Only
+                                                                 messages of the same class keep their order. Defaults to
+                                                                 SCON_MSG_PRIORITY_NORMAL, barriers always go as HIGH */
+
+/* scon message priority classes, highest first */
+#define SCON_MSG_PRIORITY_HIGH     0
+#define SCON_MSG_PRIORITY_NORMAL   1
+#define SCON_MSG_PRIORITY_BULK     2
+#define SCON_MSG_PRIORITY_CLASSES  3
+
+/* scon_split color of a member that joins none of the children */
+#define SCON_SPLIT_UNDEFINED       (-1)
+
+/* SCON performance keys - read only, query with scon_get_info on any scon.
+   The values are kept for the whole process across all scons. Counters are
+   uint64, histograms are a char * summary "count= avg= p50<= p99<= max=" */
+#define SCON_PERF_MSGS_SENT        "scon.perf.msgs.sent"        /* uint64 messages sent */
+#define SCON_PERF_BYTES_SENT       "scon.perf.bytes.sent"       /* uint64 payload bytes sent */
+#define SCON_PERF_MSGS_RECVD       "scon.perf.msgs.recvd"       /* uint64 messages received */
+#define SCON_PERF_BYTES_RECVD      "scon.perf.bytes.recvd"      /* uint64 payload bytes received */
+#define SCON_PERF_UNMATCHED_MSGS   "scon.perf.unmatched.msgs"   /* uint64 messages currently waiting for a recv */
+#define SCON_PERF_COLL_TRACKERS    "scon.perf.coll.trackers"    /* uint64 collective trackers currently alive */
+#define SCON_PERF_COLL_COMPLETED   "scon.perf.coll.completed"   /* uint64 collectives completed */
+#define SCON_PERF_TCP_SEND_QUEUE   "scon.perf.tcp.sendq"        /* uint64 messages currently queued on tcp peers */
+#define SCON_PERF_TCP_EAGAIN       "scon.perf.tcp.eagain"       /* uint64 tcp writes that would have blocked */
+#define SCON_PERF_TCP_RETRIES      "scon.perf.tcp.retries"      /* uint64 tcp connection attempts retried */
+#define SCON_PERF_COLL_LATENCY     "scon.perf.coll.latency"     /* histogram of usecs from posting a collective
+                                                                   to its callback */
+#define SCON_PERF_MSG_SIZE         "scon.perf.msg.size"         /* histogram of payload bytes per message sent */
+#define SCON_PERF_UNMATCHED_DEPTH  "scon.perf.unmatched.depth"  /* histogram of the unmatched queue length */
+#define SCON_PERF_TCP_QUEUE_DEPTH  "scon.perf.tcp.queue.depth"  /* histogram of the tcp peer send queue length */
+#define SCON_PERF_STARTUP          "scon.perf.startup"          /* (char*) usecs spent in each phase of scon_init
+                                                                   as "phase=usec,...", in the order they started */
 
 /* define a set of bit-mask flags for specifying behavior of
  * command directives via scon_info_t arrays */
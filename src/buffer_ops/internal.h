@@ -454,7 +454,7 @@ int scon_bfrop_print_coll_sig(char **output, char *prefix,
  * Internal helper functions
  */
 
- char* scon_bfrop_buffer_extend(scon_buffer_t *bptr, size_t bytes_to_add);
+ SCON_EXPORT char* scon_bfrop_buffer_extend(scon_buffer_t *bptr, size_t bytes_to_add);
 
  bool scon_bfrop_too_small(scon_buffer_t *buffer, size_t bytes_reqd);
 
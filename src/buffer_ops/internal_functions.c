@@ -34,7 +34,7 @@
  * Internal function that resizes (expands) an inuse buffer if
  * necessary.
  */
-char* scon_bfrop_buffer_extend(scon_buffer_t *buffer, size_t bytes_to_add)
+SCON_EXPORT char* scon_bfrop_buffer_extend(scon_buffer_t *buffer, size_t bytes_to_add)
 {
     size_t required, to_alloc;
     size_t pack_offset, unpack_offset;
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/** @file
+ *
+ *  Hash functions for the arbitrary size binary keys of
+ *  scon_hash_table_t. scon_hash_key() is the one the tables use,
+ *  picked at configure time (--disable-fast-hash selects the byte
+ *  at a time one). Both are here so they can be compared by
+ *  bench/bench_hash.
+ *
+ *  The hashes are of the in-memory bytes, read in host order, so
+ *  they are only meaningful within a process.
+ */
+
+#ifndef SCON_HASH_KEY_H
+#define SCON_HASH_KEY_H
+
+#include <src/include/scon_config.h>
+
+#include <stdint.h>
+#include <string.h>
+
+BEGIN_C_DECLS
+
+/**
+ *  The original hash: hash = 31 * hash + byte over every byte.
+ *  Cheap on short keys, but a serial chain of multiplies on long
+ *  ones, and the high bits of short keys barely change.
+ */
+static inline uint64_t scon_hash_key_mult31(const void *key, size_t key_size)
+{
+    const unsigned char *scanner = (const unsigned char *)key;
+    uint64_t hash = 0;
+    size_t ii;
+
+    for (ii = 0; ii < key_size; ii += 1) {
+        hash = 31*hash + *scanner++;
+    }
+    return hash;
+}
+
+#define SCON_HASH_KEY_PRIME1 0x9E3779B185EBCA87ULL
+#define SCON_HASH_KEY_PRIME2 0xC2B2AE3D27D4EB4FULL
+#define SCON_HASH_KEY_PRIME3 0x165667B19E3779F9ULL
+#define SCON_HASH_KEY_PRIME4 0x85EBCA77C2B2AE63ULL
+#define SCON_HASH_KEY_PRIME5 0x27D4EB2F165667C5ULL
+
+static inline uint64_t scon_hash_key_rotl(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t scon_hash_key_read64(const unsigned char *p)
+{
+    uint64_t v;
+    /* keys need not be aligned - the compiler turns this into a load */
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t scon_hash_key_read32(const unsigned char *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t scon_hash_key_round(uint64_t acc, uint64_t input)
+{
+    acc += input * SCON_HASH_KEY_PRIME2;
+    acc = scon_hash_key_rotl(acc, 31);
+    return acc * SCON_HASH_KEY_PRIME1;
+}
+
+static inline uint64_t scon_hash_key_merge(uint64_t hash, uint64_t lane)
+{
+    hash ^= scon_hash_key_round(0, lane);
+    return hash * SCON_HASH_KEY_PRIME1 + SCON_HASH_KEY_PRIME4;
+}
+
+/**
+ *  A word at a time hash after xxHash64. Keys of 32 bytes and more
+ *  are consumed in 32 byte stripes by four independent lanes, which
+ *  keeps the multipliers busy (or lets the compiler vectorize them)
+ *  instead of waiting on one another. The final mix makes every
+ *  input bit affect every output bit, so the low bits used for the
+ *  bucket index are as good as the high ones.
+ */
+static inline uint64_t scon_hash_key_xx64(const void *key, size_t key_size)
+{
+    const unsigned char *p = (const unsigned char *)key;
+    const unsigned char *end = p + key_size;
+    uint64_t hash, v1, v2, v3, v4;
+
+    if (32 <= key_size) {
+        v1 = SCON_HASH_KEY_PRIME1 + SCON_HASH_KEY_PRIME2;
+        v2 = SCON_HASH_KEY_PRIME2;
+        v3 = 0;
+        v4 = -SCON_HASH_KEY_PRIME1;
+        do {
+            v1 = scon_hash_key_round(v1, scon_hash_key_read64(p));
+            v2 = scon_hash_key_round(v2, scon_hash_key_read64(p + 8));
+            v3 = scon_hash_key_round(v3, scon_hash_key_read64(p + 16));
+            v4 = scon_hash_key_round(v4, scon_hash_key_read64(p + 24));
+            p += 32;
+        } while (p + 32 <= end);
+        hash = scon_hash_key_rotl(v1, 1) + scon_hash_key_rotl(v2, 7) +
+               scon_hash_key_rotl(v3, 12) + scon_hash_key_rotl(v4, 18);
+        hash = scon_hash_key_merge(hash, v1);
+        hash = scon_hash_key_merge(hash, v2);
+        hash = scon_hash_key_merge(hash, v3);
+        hash = scon_hash_key_merge(hash, v4);
+    } else {
+        hash = SCON_HASH_KEY_PRIME5;
+    }
+    hash += key_size;
+
+    /* the tail, 8, 4 and 1 bytes at a time */
+    for (; p + 8 <= end; p += 8) {
+        hash ^= scon_hash_key_round(0, scon_hash_key_read64(p));
+        hash = scon_hash_key_rotl(hash, 27) * SCON_HASH_KEY_PRIME1 + SCON_HASH_KEY_PRIME4;
+    }
+    if (p + 4 <= end) {
+        hash ^= (uint64_t)scon_hash_key_read32(p) * SCON_HASH_KEY_PRIME1;
+        hash = scon_hash_key_rotl(hash, 23) * SCON_HASH_KEY_PRIME2 + SCON_HASH_KEY_PRIME3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        hash ^= (uint64_t)(*p) * SCON_HASH_KEY_PRIME5;
+        hash = scon_hash_key_rotl(hash, 11) * SCON_HASH_KEY_PRIME1;
+    }
+
+    /* avalanche */
+    hash ^= hash >> 33;
+    hash *= SCON_HASH_KEY_PRIME2;
+    hash ^= hash >> 29;
+    hash *= SCON_HASH_KEY_PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+#if SCON_ENABLE_FAST_HASH
+#define scon_hash_key(k, s) scon_hash_key_xx64((k), (s))
+#else
+#define scon_hash_key(k, s) scon_hash_key_mult31((k), (s))
+#endif
+
+END_C_DECLS
+
+#endif /* SCON_HASH_KEY_H */
@@ -28,6 +28,7 @@
 #include "src/util/crc.h"
 #include "src/class/scon_list.h"
 #include "src/class/scon_hash_table.h"
+#include "src/class/scon_hash_key.h"
 
 #include "include/scon.h"
 #include "src/util/name_fns.h"
@@ -35,12 +36,17 @@
  * scon_hash_table_t
  */
 
-#define HASH_MULTIPLIER 31
-
 /*
  * Define the structs that are opaque in the .h
  */
 
+/* values of the valid field. Only the old table of an incremental
+ * grow holds MOVED elements - they were migrated or removed, but keep
+ * the probe sequences of the old table intact */
+#define SCON_HASH_ELT_EMPTY 0
+#define SCON_HASH_ELT_VALID 1
+#define SCON_HASH_ELT_MOVED 2
+
 struct scon_hash_element_t {
     int         valid;          /* whether this element is valid */
     union {                     /* the key, in its various forms */
@@ -63,6 +69,8 @@ struct scon_hash_type_methods_t {
     void        (*elt_destructor)(scon_hash_element_t * elt);
     /* Hash the key of the element -- for growing and adjusting-after-removal */
     uint64_t    (*hash_elt)(scon_hash_element_t * elt);
+    /* Whether the key of the element is the key of the other */
+    bool        (*elt_match)(scon_hash_element_t * elt, scon_hash_element_t * key);
 };
 
 /* interact with the class-like mechanism */
@@ -85,6 +93,8 @@ scon_hash_table_construct(scon_hash_table_t* ht)
   ht->ht_density_numer = ht->ht_density_denom = 0;
   ht->ht_growth_numer = ht->ht_growth_denom = 0;
   ht->ht_type_methods = NULL;
+  ht->ht_old_table = NULL;
+  ht->ht_old_capacity = ht->ht_migrate_pos = ht->ht_migrate_step = 0;
 }
 
 static void
@@ -147,6 +157,17 @@ scon_hash_table_remove_all(scon_hash_table_t* ht)
         elt->valid = 0;
         elt->value = NULL;
     }
+    /* drop whatever is left of an incremental grow */
+    for (ii = 0; ii < ht->ht_old_capacity; ii += 1) {
+        scon_hash_element_t * elt = &ht->ht_old_table[ii];
+        if (SCON_HASH_ELT_VALID == elt->valid &&
+            ht->ht_type_methods && ht->ht_type_methods->elt_destructor) {
+            ht->ht_type_methods->elt_destructor(elt);
+        }
+    }
+    free(ht->ht_old_table);
+    ht->ht_old_table = NULL;
+    ht->ht_old_capacity = ht->ht_migrate_pos = 0;
     ht->ht_size = 0;
     /* the tests reuse the hash table for different types after removing all */
     /* so we should allow that by forgetting what type it used to be */
@@ -154,57 +175,139 @@ scon_hash_table_remove_all(scon_hash_table_t* ht)
     return SCON_SUCCESS;
 }
 
+/* move up to nslots slots of the old table of an incremental grow
+   into the new one, using the hash_elt method to generically hash an
+   element and struct-assignment to copy it.  The hash table never
+   owns the value, and in the case of ptr keys we still own the ptr
+   key storage, just in the new table now - the old slot is marked as
+   moved so it is neither found nor freed again.  Once all slots are
+   moved the old table is released */
+static void
+scon_hash_migrate(scon_hash_table_t * ht, size_t nslots)
+{
+    size_t ii, capacity = ht->ht_capacity;
+    scon_hash_element_t * old_elt;
+    scon_hash_element_t * new_elt;
+
+    if (NULL == ht->ht_old_table) {
+        return;
+    }
+    for (; 0 < nslots && ht->ht_migrate_pos < ht->ht_old_capacity; nslots -= 1) {
+        old_elt = &ht->ht_old_table[ht->ht_migrate_pos++];
+        if (SCON_HASH_ELT_VALID != old_elt->valid) {
+            continue;
+        }
+        for (ii = (ht->ht_type_methods->hash_elt(old_elt)%capacity); ; ii += 1) {
+            if (ii == capacity) { ii = 0; }
+            new_elt = &ht->ht_table[ii];
+            if (! new_elt->valid) {
+                *new_elt = *old_elt;
+                break;
+            }
+        }
+        old_elt->valid = SCON_HASH_ELT_MOVED;
+    }
+    if (ht->ht_migrate_pos == ht->ht_old_capacity) {
+        free(ht->ht_old_table);
+        ht->ht_old_table = NULL;
+        ht->ht_old_capacity = ht->ht_migrate_pos = 0;
+    }
+}
+
+/* look a key up in the old table of an incremental grow. Elements
+   that were moved out of it still occupy their slot, so the probe
+   only stops at a slot that was never used */
+static scon_hash_element_t *
+scon_hash_old_find(scon_hash_table_t * ht, uint64_t hash, scon_hash_element_t * key)
+{
+    size_t ii, capacity = ht->ht_old_capacity;
+    scon_hash_element_t * elt;
+
+    for (ii = hash%capacity; ; ii += 1) {
+        if (ii == capacity) { ii = 0; }
+        elt = &ht->ht_old_table[ii];
+        if (SCON_HASH_ELT_EMPTY == elt->valid) {
+            return NULL;
+        } else if (SCON_HASH_ELT_VALID == elt->valid &&
+                   ht->ht_type_methods->elt_match(elt, key)) {
+            return elt;
+        } else {
+            /* keep looking */
+        }
+    }
+}
+
+/* remove an element found in the old table of an incremental grow */
 static int                      /* SCON_ return code */
-scon_hash_grow(scon_hash_table_t * ht)
+scon_hash_old_remove(scon_hash_table_t * ht, scon_hash_element_t * elt)
 {
-    size_t jj, ii;
-    scon_hash_element_t* old_table;
-    scon_hash_element_t* new_table;
-    size_t old_capacity;
-    size_t new_capacity;
+    if (ht->ht_type_methods->elt_destructor) {
+        ht->ht_type_methods->elt_destructor(elt);
+    }
+    elt->valid = SCON_HASH_ELT_MOVED;
+    ht->ht_size -= 1;
+    return SCON_SUCCESS;
+}
 
-    old_table    = ht->ht_table;
-    old_capacity = ht->ht_capacity;
+static int                      /* SCON_ return code */
+scon_hash_grow_to(scon_hash_table_t * ht, size_t new_capacity, bool incremental)
+{
+    scon_hash_element_t* new_table;
 
-    new_capacity = old_capacity * ht->ht_growth_numer / ht->ht_growth_denom;
-    new_capacity = scon_hash_round_capacity_up(new_capacity);
+    /* a previous grow must be done before we start another */
+    scon_hash_migrate(ht, ht->ht_old_capacity);
 
     new_table    = (scon_hash_element_t*) calloc(new_capacity, sizeof(new_table[0]));
     if (NULL == new_table) {
         return SCON_ERR_OUT_OF_RESOURCE;
     }
-
-    /* for each element of the old table (indexed by jj), insert it
-       into the new table (indexed by ii), using the hash_elt method
-       to generically hash an element, then modulo the new capacity,
-       and using struct-assignment to copy an old element into its
-       place int he new table.  The hash table never owns the value,
-       and in the case of ptr keys the old dlements will be blindly
-       deleted, so we still own the ptr key storage, just in the new
-       table now */
-    for (jj = 0; jj < old_capacity; jj += 1) {
-        scon_hash_element_t * old_elt;
-        scon_hash_element_t * new_elt;
-        old_elt =  &old_table[jj];
-        if (old_elt->valid) {
-            for (ii = (ht->ht_type_methods->hash_elt(old_elt)%new_capacity); ; ii += 1) {
-                if (ii == new_capacity) { ii = 0; }
-                new_elt = &new_table[ii];
-                if (! new_elt->valid) {
-                    *new_elt = *old_elt;
-                    break;
-                }
-            }
-        }
-    }
-    /* update with the new, free the old, return */
+    ht->ht_old_table = ht->ht_table;
+    ht->ht_old_capacity = ht->ht_capacity;
+    ht->ht_migrate_pos = 0;
     ht->ht_table = new_table;
     ht->ht_capacity = new_capacity;
     ht->ht_growth_trigger = new_capacity * ht->ht_density_numer / ht->ht_density_denom;
-    free(old_table);
+    if (!incremental) {
+        scon_hash_migrate(ht, ht->ht_old_capacity);
+    }
+    return SCON_SUCCESS;
+}
+
+static int                      /* SCON_ return code */
+scon_hash_grow(scon_hash_table_t * ht)
+{
+    size_t new_capacity;
+
+    new_capacity = ht->ht_capacity * ht->ht_growth_numer / ht->ht_growth_denom;
+    new_capacity = scon_hash_round_capacity_up(new_capacity);
+    return scon_hash_grow_to(ht, new_capacity, 0 < ht->ht_migrate_step);
+}
+
+int                             /* SCON_ return code */
+scon_hash_table_set_incremental(scon_hash_table_t * ht, size_t step)
+{
+    ht->ht_migrate_step = step;
+    if (0 == step) {
+        scon_hash_migrate(ht, ht->ht_old_capacity);
+    }
     return SCON_SUCCESS;
 }
 
+int                             /* SCON_ return code */
+scon_hash_table_reserve(scon_hash_table_t * ht, size_t nelts)
+{
+    size_t capacity;
+
+    scon_hash_migrate(ht, ht->ht_old_capacity);
+    /* leave room for one more so the last insert doesn't trigger a grow */
+    capacity = (nelts + 1) * ht->ht_density_denom / ht->ht_density_numer;
+    capacity = scon_hash_round_capacity_up(capacity);
+    if (capacity <= ht->ht_capacity) {
+        return SCON_SUCCESS;
+    }
+    return scon_hash_grow_to(ht, capacity, false);
+}
+
 /* one of the removal functions has determined which element should be
    removed.  With the help of the type methods this can be generic.
    The important thing is to rehash any valid elements immediately
@@ -273,10 +376,17 @@ scon_hash_hash_elt_uint32(scon_hash_element_t * elt)
   return elt->key.u32;
 }
 
+static bool
+scon_hash_match_elt_uint32(scon_hash_element_t * elt, scon_hash_element_t * key)
+{
+  return elt->key.u32 == key->key.u32;
+}
+
 static const struct scon_hash_type_methods_t
 scon_hash_type_methods_uint32 = {
     NULL,
-    scon_hash_hash_elt_uint32
+    scon_hash_hash_elt_uint32,
+    scon_hash_match_elt_uint32
 };
 
 int                             /* SCON_ return code */
@@ -300,6 +410,14 @@ scon_hash_table_get_value_uint32(scon_hash_table_t* ht, uint32_t key, void * *va
 #endif
 
     ht->ht_type_methods = &scon_hash_type_methods_uint32;
+    if (NULL != ht->ht_old_table) {
+        scon_hash_element_t tmp;
+        tmp.key.u32 = key;
+        if (NULL != (elt = scon_hash_old_find(ht, key, &tmp))) {
+            *value = elt->value;
+            return SCON_SUCCESS;
+        }
+    }
     for (ii = key%capacity; ; ii += 1) {
         if (ii == capacity) { ii = 0; }
         elt = &ht->ht_table[ii];
@@ -337,6 +455,16 @@ scon_hash_table_set_value_uint32(scon_hash_table_t * ht, uint32_t key, void * va
 #endif
 
     ht->ht_type_methods = &scon_hash_type_methods_uint32;
+    if (NULL != ht->ht_old_table) {
+        scon_hash_element_t tmp;
+        tmp.key.u32 = key;
+        if (NULL != (elt = scon_hash_old_find(ht, key, &tmp))) {
+            /* replace existing element */
+            elt->value = value;
+            return SCON_SUCCESS;
+        }
+        scon_hash_migrate(ht, ht->ht_migrate_step);
+    }
     for (ii = key%capacity; ; ii += 1) {
         if (ii == capacity) { ii = 0; }
         elt = &ht->ht_table[ii];
@@ -382,6 +510,14 @@ scon_hash_table_remove_value_uint32(scon_hash_table_t * ht, uint32_t key)
 #endif
 
     ht->ht_type_methods = &scon_hash_type_methods_uint32;
+    if (NULL != ht->ht_old_table) {
+        scon_hash_element_t tmp, *elt;
+        tmp.key.u32 = key;
+        if (NULL != (elt = scon_hash_old_find(ht, key, &tmp))) {
+            return scon_hash_old_remove(ht, elt);
+        }
+        scon_hash_migrate(ht, ht->ht_migrate_step);
+    }
     for (ii = key%capacity; ; ii += 1) {
         scon_hash_element_t * elt;
         if (ii == capacity) ii = 0;
@@ -406,10 +542,17 @@ scon_hash_hash_elt_uint64(scon_hash_element_t * elt)
   return elt->key.u64;
 }
 
+static bool
+scon_hash_match_elt_uint64(scon_hash_element_t * elt, scon_hash_element_t * key)
+{
+  return elt->key.u64 == key->key.u64;
+}
+
 static const struct scon_hash_type_methods_t
 scon_hash_type_methods_uint64 = {
     NULL,
-    scon_hash_hash_elt_uint64
+    scon_hash_hash_elt_uint64,
+    scon_hash_match_elt_uint64
 };
 
 int                             /* SCON_ return code */
@@ -433,6 +576,14 @@ scon_hash_table_get_value_uint64(scon_hash_table_t * ht, uint64_t key, void * *v
     }
 #endif
     ht->ht_type_methods = &scon_hash_type_methods_uint64;
+    if (NULL != ht->ht_old_table) {
+        scon_hash_element_t tmp;
+        tmp.key.u64 = key;
+        if (NULL != (elt = scon_hash_old_find(ht, key, &tmp))) {
+            *value = elt->value;
+            return SCON_SUCCESS;
+        }
+    }
     for (ii = key%capacity; ; ii += 1) {
         if (ii == capacity) { ii = 0; }
         elt = &ht->ht_table[ii];
@@ -469,6 +620,16 @@ scon_hash_table_set_value_uint64(scon_hash_table_t * ht, uint64_t key, void * va
 #endif
 
     ht->ht_type_methods = &scon_hash_type_methods_uint64;
+    if (NULL != ht->ht_old_table) {
+        scon_hash_element_t tmp;
+        tmp.key.u64 = key;
+        if (NULL != (elt = scon_hash_old_find(ht, key, &tmp))) {
+            /* replace existing element */
+            elt->value = value;
+            return SCON_SUCCESS;
+        }
+        scon_hash_migrate(ht, ht->ht_migrate_step);
+    }
     for (ii = key%capacity; ; ii += 1) {
         if (ii == capacity) { ii = 0; }
         elt = &ht->ht_table[ii];
@@ -514,6 +675,14 @@ scon_hash_table_remove_value_uint64(scon_hash_table_t * ht, uint64_t key)
 #endif
 
     ht->ht_type_methods = &scon_hash_type_methods_uint64;
+    if (NULL != ht->ht_old_table) {
+        scon_hash_element_t tmp, *elt;
+        tmp.key.u64 = key;
+        if (NULL != (elt = scon_hash_old_find(ht, key, &tmp))) {
+            return scon_hash_old_remove(ht, elt);
+        }
+        scon_hash_migrate(ht, ht->ht_migrate_step);
+    }
     for (ii = key%capacity; ; ii += 1) {
         scon_hash_element_t * elt;
         if (ii == capacity) { ii = 0; }
@@ -532,19 +701,10 @@ scon_hash_table_remove_value_uint64(scon_hash_table_t * ht, uint64_t key)
 /***************************************************************************/
 
 /* helper function used in several places */
-static uint64_t
+static inline uint64_t
 scon_hash_hash_key_ptr(const void * key, size_t key_size)
 {
-    uint64_t hash;
-    const unsigned char *scanner;
-    size_t ii;
-
-    hash = 0;
-    scanner = (const unsigned char *)key;
-    for (ii = 0; ii < key_size; ii += 1) {
-        hash = HASH_MULTIPLIER*hash + *scanner++;
-    }
-    return hash;
+    return scon_hash_key(key, key_size);
 }
 
 /* ptr methods */
@@ -566,10 +726,18 @@ scon_hash_hash_elt_ptr(scon_hash_element_t * elt)
     return scon_hash_hash_key_ptr(elt->key.ptr.key, elt->key.ptr.key_size);
 }
 
+static bool
+scon_hash_match_elt_ptr(scon_hash_element_t * elt, scon_hash_element_t * key)
+{
+    return elt->key.ptr.key_size == key->key.ptr.key_size &&
+           0 == memcmp(elt->key.ptr.key, key->key.ptr.key, key->key.ptr.key_size);
+}
+
 static const struct scon_hash_type_methods_t
 scon_hash_type_methods_ptr = {
     scon_hash_destruct_elt_ptr,
-    scon_hash_hash_elt_ptr
+    scon_hash_hash_elt_ptr,
+    scon_hash_match_elt_ptr
 };
 
 int                             /* SCON_ return code */
@@ -578,6 +746,7 @@ scon_hash_table_get_value_ptr(scon_hash_table_t * ht,
                               void * *value)
 {
     size_t ii, capacity = ht->ht_capacity;
+    uint64_t hash;
     scon_hash_element_t * elt;
 
 #if SCON_ENABLE_DEBUG
@@ -595,7 +764,17 @@ scon_hash_table_get_value_ptr(scon_hash_table_t * ht,
 #endif
 
     ht->ht_type_methods = &scon_hash_type_methods_ptr;
-    for (ii = scon_hash_hash_key_ptr(key, key_size)%capacity; ; ii += 1) {
+    hash = scon_hash_hash_key_ptr(key, key_size);
+    if (NULL != ht->ht_old_table) {
+        scon_hash_element_t tmp;
+        tmp.key.ptr.key = key;
+        tmp.key.ptr.key_size = key_size;
+        if (NULL != (elt = scon_hash_old_find(ht, hash, &tmp))) {
+            *value = elt->value;
+            return SCON_SUCCESS;
+        }
+    }
+    for (ii = hash%capacity; ; ii += 1) {
         if (ii == capacity) { ii = 0; }
         elt = &ht->ht_table[ii];
         if (! elt->valid) {
@@ -617,6 +796,7 @@ scon_hash_table_set_value_ptr(scon_hash_table_t * ht,
 {
     int rc;
     size_t ii, capacity = ht->ht_capacity;
+    uint64_t hash;
     scon_hash_element_t * elt;
 
 #if SCON_ENABLE_DEBUG
@@ -634,7 +814,19 @@ scon_hash_table_set_value_ptr(scon_hash_table_t * ht,
 #endif
 
     ht->ht_type_methods = &scon_hash_type_methods_ptr;
-    for (ii = scon_hash_hash_key_ptr(key, key_size)%capacity; ; ii += 1) {
+    hash = scon_hash_hash_key_ptr(key, key_size);
+    if (NULL != ht->ht_old_table) {
+        scon_hash_element_t tmp;
+        tmp.key.ptr.key = key;
+        tmp.key.ptr.key_size = key_size;
+        if (NULL != (elt = scon_hash_old_find(ht, hash, &tmp))) {
+            /* replace existing value */
+            elt->value = value;
+            return SCON_SUCCESS;
+        }
+        scon_hash_migrate(ht, ht->ht_migrate_step);
+    }
+    for (ii = hash%capacity; ; ii += 1) {
         if (ii == capacity) { ii = 0; }
         elt = &ht->ht_table[ii];
         if (! elt->valid) {
@@ -668,6 +860,7 @@ scon_hash_table_remove_value_ptr(scon_hash_table_t * ht,
                                  const void * key, size_t key_size)
 {
     size_t ii, capacity = ht->ht_capacity;
+    uint64_t hash;
 
 #if SCON_ENABLE_DEBUG
     if(capacity == 0) {
@@ -684,7 +877,17 @@ scon_hash_table_remove_value_ptr(scon_hash_table_t * ht,
 #endif
 
     ht->ht_type_methods = &scon_hash_type_methods_ptr;
-    for (ii = scon_hash_hash_key_ptr(key, key_size)%capacity; ; ii += 1) {
+    hash = scon_hash_hash_key_ptr(key, key_size);
+    if (NULL != ht->ht_old_table) {
+        scon_hash_element_t tmp, *elt;
+        tmp.key.ptr.key = key;
+        tmp.key.ptr.key_size = key_size;
+        if (NULL != (elt = scon_hash_old_find(ht, hash, &tmp))) {
+            return scon_hash_old_remove(ht, elt);
+        }
+        scon_hash_migrate(ht, ht->ht_migrate_step);
+    }
+    for (ii = hash%capacity; ; ii += 1) {
         scon_hash_element_t * elt;
         if (ii == capacity) { ii = 0; }
         elt = &ht->ht_table[ii];
@@ -710,9 +913,23 @@ scon_hash_table_get_next_elt(scon_hash_table_t *ht,
   scon_hash_element_t* elts = ht->ht_table;
   size_t ii, capacity = ht->ht_capacity;
 
+  /* while growing incrementally walk the new table, then whatever
+     is left in the old one */
+  if (NULL == prev_elt || (prev_elt >= elts && prev_elt < elts + capacity)) {
+    for (ii = (NULL == prev_elt ? 0 : (prev_elt-elts)+1); ii < capacity; ii += 1) {
+      scon_hash_element_t * elt = &elts[ii];
+      if (elt->valid) {
+        *next_elt = elt;
+        return SCON_SUCCESS;
+      }
+    }
+    prev_elt = NULL;
+  }
+  elts = ht->ht_old_table;
+  capacity = ht->ht_old_capacity;
   for (ii = (NULL == prev_elt ? 0 : (prev_elt-elts)+1); ii < capacity; ii += 1) {
     scon_hash_element_t * elt = &elts[ii];
-    if (elt->valid) {
+    if (SCON_HASH_ELT_VALID == elt->valid) {
       *next_elt = elt;
       return SCON_SUCCESS;
     }
@@ -59,6 +59,10 @@ struct scon_hash_table_t
     int                  ht_density_numer, ht_density_denom; /**< max allowed density of table */
     int                  ht_growth_numer, ht_growth_denom;   /**< growth factor when grown  */
     const struct scon_hash_type_methods_t * ht_type_methods;
+    struct scon_hash_element_t * ht_old_table;   /**< table being migrated from, if any */
+    size_t               ht_old_capacity; /**< capacity of the old table */
+    size_t               ht_migrate_pos; /**< next old slot to migrate */
+    size_t               ht_migrate_step; /**< old slots migrated per set/remove, 0 grows at once */
 };
 typedef struct scon_hash_table_t scon_hash_table_t;
 
@@ -82,6 +86,38 @@ SCON_EXPORT int scon_hash_table_init2(scon_hash_table_t* ht, size_t estimated_ma
                                         int density_numer, int density_denom,
                                         int growth_numer, int growth_denom);
 
+/**
+ *  Grow the table incrementally. When the table has to grow, the
+ *  elements are moved to the new table a few at a time by the
+ *  following set and remove calls instead of all at once, so no
+ *  single call pays for rehashing the whole table. Lookups search
+ *  both tables until the move is done.
+ *
+ *  @param   table   The input hash table (IN).
+ *  @param   step    Number of old slots moved per set/remove, 0 to
+ *                   grow all at once (the default) (IN).
+ *  @return  SCON return code.
+ *
+ *  With the default density and growth a step of 2 or more finishes
+ *  the move before the table has to grow again - if it has not
+ *  finished by then, the rest is moved at once.
+ */
+
+SCON_EXPORT int scon_hash_table_set_incremental(scon_hash_table_t *ht, size_t step);
+
+/**
+ *  Make room for at least nelts elements without growing again. Any
+ *  growth this requires is done right away, so call it before the
+ *  table sits on a latency sensitive path.
+ *
+ *  @param   table   The input hash table (IN).
+ *  @param   nelts   Number of elements expected (IN).
+ *  @return  SCON return code.
+ *
+ */
+
+SCON_EXPORT int scon_hash_table_reserve(scon_hash_table_t *ht, size_t nelts);
+
 /**
  *  Returns the number of elements currently stored in the table.
  *
@@ -492,7 +492,9 @@ static inline scon_object_t *scon_obj_new(scon_class_t * cls)
 static inline int scon_obj_update(scon_object_t *object, int inc) __scon_attribute_always_inline__;
 static inline int scon_obj_update(scon_object_t *object, int inc)
 {
-    return object->obj_reference_count += inc;
+    /* objects are handed between the progress threads, so a
+     * retain and a release can race */
+    return __atomic_add_fetch(&object->obj_reference_count, inc, __ATOMIC_ACQ_REL);
 }
 
 END_C_DECLS
@@ -68,10 +68,18 @@ SCON_CLASS_DECLARATION(scon_mca_base_component_priority_list_item_t);
  */
 extern char *scon_mca_base_component_path;
 extern bool scon_mca_base_component_show_load_errors;
+extern bool scon_mca_base_component_use_manifest;
 extern bool scon_mca_base_component_disable_dlopen;
 extern char *scon_mca_base_system_default_path;
 extern char *scon_mca_base_user_default_path;
 
+/*
+ * Name of the list of components written into each component
+ * directory at install. The repository reads it instead of scanning
+ * the directory when its version matches the library's.
+ */
+#define SCON_MCA_BASE_COMPONENT_MANIFEST "scon-components.manifest"
+
 /*
  * Standard verbosity levels
  */
@@ -43,6 +43,7 @@
 #include "scon_common.h"
 #include "src/class/scon_hash_table.h"
 #include "src/util/basename.h"
+#include "src/util/perf.h"
 
 #if SCON_HAVE_SDL_SUPPORT
 
@@ -175,6 +176,58 @@ static int file_exists(const char *filename, const char *ext)
     return (0 == ret);
 }
 
+/*
+ * Add the components listed in the manifest of a directory. The
+ * manifest is written at install time (see
+ * config/scon_component_manifest.sh):
+ *
+ *   # version <SCON_VERSION>
+ *   <framework> <component> <file name without extension>
+ *
+ * Returns false if there is no usable manifest, in which case the
+ * directory has to be scanned. A manifest from another version is
+ * ignored as the directory may have been reinstalled over.
+ */
+static bool read_manifest(const char *dir)
+{
+    char *path = NULL, line[256], type[64], name[64], base[128];
+    bool version_ok = false;
+    FILE *fp;
+
+    if (0 > asprintf(&path, "%s/%s", dir, SCON_MCA_BASE_COMPONENT_MANIFEST)) {
+        return false;
+    }
+    fp = fopen(path, "r");
+    free(path);
+    if (NULL == fp) {
+        return false;
+    }
+    while (NULL != fgets(line, sizeof(line), fp)) {
+        if ('#' == line[0]) {
+            if (1 == sscanf(line, "# version %63s", name)) {
+                version_ok = (0 == strcmp(name, SCON_VERSION));
+                if (!version_ok) {
+                    break;
+                }
+            }
+            continue;
+        }
+        if (!version_ok) {
+            break;
+        }
+        if (3 != sscanf(line, "%63s %63s %127s", type, name, base)) {
+            continue;
+        }
+        if (0 > asprintf(&path, "%s/%s", dir, base)) {
+            break;
+        }
+        (void) process_repository_item(path, NULL);
+        free(path);
+    }
+    fclose(fp);
+    return version_ok;
+}
+
 #endif /* SCON_HAVE_SDL_SUPPORT */
 
 int scon_mca_base_component_repository_add (const char *path)
@@ -200,6 +253,9 @@ int scon_mca_base_component_repository_add (const char *path)
             dir = scon_mca_base_system_default_path;
         }
 
+        if (scon_mca_base_component_use_manifest && read_manifest(dir)) {
+            continue;
+        }
         if (0 != scon_sdl_foreachfile(dir, process_repository_item, NULL)) {
             break;
         }
@@ -239,12 +295,14 @@ int scon_mca_base_component_repository_init(void)
         return ret;
     }
 
+    uint64_t start = scon_perf_now_usec();
     ret = scon_mca_base_component_repository_add(scon_mca_base_component_path);
     if (SCON_SUCCESS != ret) {
         SCON_DESTRUCT(&scon_mca_base_component_repository);
         (void) scon_mca_base_framework_close(&scon_sdl_base_framework);
         return ret;
     }
+    scon_perf_startup_phase("find components", start);
 #endif
 
     initialized = true;
@@ -390,6 +448,8 @@ int scon_mca_base_component_repository_open(scon_mca_base_framework_t *framework
     /* Now try to load the component */
 
     char *err_msg = NULL;
+    char phase[SCON_MCA_BASE_MAX_TYPE_NAME_LEN + SCON_MCA_BASE_MAX_COMPONENT_NAME_LEN + 16];
+    uint64_t start = scon_perf_now_usec();
     if (SCON_SUCCESS != scon_sdl_open(ri->ri_path, true, false, &ri->ri_dlhandle, &err_msg)) {
         if (NULL == err_msg) {
             err_msg = "scon_dl_open() error message was NULL!";
@@ -477,6 +537,9 @@ int scon_mca_base_component_repository_open(scon_mca_base_framework_t *framework
         ri->ri_refcnt = 1;
         scon_list_append(&framework->framework_components, &mitem->super);
 
+        snprintf(phase, sizeof(phase), "dlopen %s %s", ri->ri_type, ri->ri_name);
+        scon_perf_startup_phase(phase, start);
+
         scon_output_verbose (SCON_MCA_BASE_VERBOSE_INFO, 0, "scon_mca_base_component_repository_open: opened dynamic %s MCA "
                              "component \"%s\"", ri->ri_type, ri->ri_name);
 
@@ -15,6 +15,7 @@
 
 #include "scon_common.h"
 #include "src/util/output.h"
+#include "src/util/perf.h"
 
 #include "scon_mca_base_framework.h"
 #include "scon_mca_base_var.h"
@@ -139,6 +140,8 @@ int scon_mca_base_framework_register (struct scon_mca_base_framework_t *framewor
 
 SCON_EXPORT int scon_mca_base_framework_open (struct scon_mca_base_framework_t *framework,
                              scon_mca_base_open_flag_t flags) {
+    char phase[SCON_MCA_BASE_MAX_TYPE_NAME_LEN + 8];
+    uint64_t start = scon_perf_now_usec();
     int ret;
 
     assert (NULL != framework);
@@ -181,6 +184,8 @@ SCON_EXPORT int scon_mca_base_framework_open (struct scon_mca_base_framework_t *
         framework->framework_refcnt--;
     } else {
         framework->framework_flags |= SCON_MCA_BASE_FRAMEWORK_FLAG_OPEN;
+        snprintf(phase, sizeof(phase), "open %s", framework->framework_name);
+        scon_perf_startup_phase(phase, start);
     }
 
     return ret;
@@ -49,6 +49,7 @@ int scon_mca_base_opened = 0;
 char *scon_mca_base_system_default_path = NULL;
 char *scon_mca_base_user_default_path = NULL;
 bool scon_mca_base_component_show_load_errors = true;
+bool scon_mca_base_component_use_manifest = true;
 bool scon_mca_base_component_disable_dlopen = false;
 
 static char *scon_mca_base_verbose = NULL;
@@ -111,6 +112,16 @@ int scon_mca_base_open(void)
     (void) scon_mca_base_var_register_synonym(var_id, "scon", "mca", NULL, "component_show_load_errors",
                                               SCON_MCA_BASE_VAR_SYN_FLAG_DEPRECATED);
 
+    scon_mca_base_component_use_manifest = true;
+    (void) scon_mca_base_var_register("scon", "mca", "base", "component_use_manifest",
+                                      "Whether to find the components of a directory in the "
+                                      SCON_MCA_BASE_COMPONENT_MANIFEST " written there at install "
+                                      "instead of scanning the directory (default: true)",
+                                      SCON_MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                      SCON_INFO_LVL_9,
+                                      SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                      &scon_mca_base_component_use_manifest);
+
 /*    scon_mca_base_component_disable_dlopen = false;
     var_id = scon_mca_base_var_register("scon", "mca", "base", "component_disable_dlopen",
                                    "Whether to attempt to disable opening dynamic components or not",
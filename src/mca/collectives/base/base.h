@@ -24,16 +24,85 @@
 #include "src/mca/base/base.h"
 #include "src/class/scon_hash_table.h"
 #include "src/mca/collectives/collectives.h"
+#include "src/mca/comm/base/base.h"
 /* select a component */
 int scon_collectives_base_select(void);
 
+/* barrier tokens that arrived before the matching barrier
+ * was started locally */
+typedef struct {
+    scon_list_item_t super;
+    scon_handle_t scon_handle;
+    uint32_t seq_num;
+    uint32_t nprocs;
+    uint32_t hash;
+    /* rounds received, one bit per round */
+    uint64_t rounds;
+} scon_collectives_early_token_t;
+SCON_EXPORT SCON_CLASS_DECLARATION(scon_collectives_early_token_t);
+
+/* a recv handler of the modules - the recvs are delivered on the
+ * pt2pt thread, which on the master and the interim nodes isn't
+ * the collectives thread, so a handler that works on the trackers
+ * is run from here on the collectives thread */
+typedef struct {
+    scon_list_item_t super;
+    scon_recv_cbfunc_t cbfunc;
+} scon_collectives_handler_t;
+SCON_EXPORT SCON_CLASS_DECLARATION(scon_collectives_handler_t);
+
+/* per scon state of the non-blocking collectives. Every member
+ * must issue the collectives on a given participant list in the
+ * same order, which is what keeps the seq nums in step */
+typedef struct {
+    scon_list_item_t super;
+    scon_handle_t scon_handle;
+    /* next seq num, keyed by participant list */
+    scon_hash_table_t seqs;
+    /* issue position given to the next request */
+    uint32_t next_issue;
+    /* issue position of the next request to deliver */
+    uint32_t next_deliver;
+    /* requests handed to the module and not yet completed */
+    int active;
+    /* requests waiting for room in the window */
+    scon_list_t pending;
+    /* completed requests waiting for an earlier one, by issue order */
+    scon_list_t deferred;
+} scon_collectives_window_t;
+SCON_EXPORT SCON_CLASS_DECLARATION(scon_collectives_window_t);
+
+/* tuning rule - allgathers over min_members to max_members members
+ * contributing min_size to max_size bytes each run the allgather of
+ * the named component */
+typedef struct {
+    scon_list_item_t super;
+    size_t min_members;
+    size_t max_members;
+    size_t min_size;
+    size_t max_size;
+    char component[SCON_MCA_BASE_MAX_COMPONENT_NAME_LEN + 1];
+} scon_collectives_rule_t;
+SCON_EXPORT SCON_CLASS_DECLARATION(scon_collectives_rule_t);
+
 /*
  * globals that might be needed
  */
 typedef struct {
     scon_list_t actives;
     scon_list_t ongoing;
-    scon_hash_table_t coll_table;
+    scon_list_t windows;
+    scon_list_t early_tokens;
+    scon_list_t handlers;
+    /* max collectives in progress per scon, 0 for no limit */
+    int max_outstanding;
+    /* allgather algorithm selection - the rules read from the
+     * tuning file, and the link model used where none applies */
+    char *tuning_file;
+    scon_list_t rules;
+    int link_latency;
+    int link_bandwidth;
+    int tree_fanout;
 } scon_collectives_base_t;
 
 /** Collectives framework stub APIs **/
@@ -64,10 +133,49 @@ int collectives_base_api_allgather(scon_handle_t scon_handle,
                                    scon_info_t info[],
                                    size_t ninfo);
 
+int collectives_base_api_allgatherv(scon_handle_t scon_handle,
+                                    scon_proc_t procs[],
+                                    size_t nprocs,
+                                    scon_buffer_t *buf,
+                                    scon_allgatherv_cbfunc_t cbfunc,
+                                    void *cbdata,
+                                    scon_info_t info[],
+                                    size_t ninfo);
+
+int collectives_base_api_reduce(scon_handle_t scon_handle,
+                                scon_proc_t procs[],
+                                size_t nprocs,
+                                const void *sendbuf,
+                                void *recvbuf,
+                                size_t count,
+                                scon_data_type_t type,
+                                scon_reduce_op_t op,
+                                scon_proc_t *root,
+                                scon_reduce_cbfunc_t cbfunc,
+                                void *cbdata,
+                                scon_info_t info[],
+                                size_t ninfo);
+
+/* assign the seq num and start the request, or queue it if the
+ * scon already has max_outstanding collectives in progress */
+void scon_collectives_base_post(scon_coll_req_t *req);
+
+/* allgather algorithm selection, see collectives_base_tuning.c */
+int scon_collectives_base_load_tuning(const char *path);
+int scon_collectives_base_scon_init(scon_comm_scon_t *scon);
+scon_collectives_module_t* scon_collectives_base_allgather_module(scon_comm_scon_t *scon,
+                                                                  scon_coll_req_t *req,
+                                                                  size_t nprocs);
+
 /* helper functions */
 scon_collectives_tracker_t* scon_collectives_base_get_tracker(scon_collectives_signature_t *sig, bool create);
 void scon_collectives_base_mark_distance_recv(scon_collectives_tracker_t *coll, uint32_t distance);
 unsigned int scon_collectives_base_check_distance_recv(scon_collectives_tracker_t *coll, uint32_t distance);
+int scon_collectives_base_member_index(scon_collectives_signature_t *sig, scon_proc_t *proc);
+/* post a persistent recv whose handler runs on the collectives thread */
+int scon_collectives_base_recv_nb(scon_handle_t scon_handle,
+                                  scon_msg_tag_t tag,
+                                  scon_recv_cbfunc_t cbfunc);
 
 void scon_collectives_base_allgather_send_complete_callback (
                                   int status, scon_handle_t scon_handle,
@@ -75,6 +183,68 @@ void scon_collectives_base_allgather_send_complete_callback (
                                   scon_buffer_t* buffer,
                                   scon_msg_tag_t tag,
                                   void* cbdata);
+/* allgather helpers shared by the collectives modules. The
+ * contributions are stored in the tracker's slots by member index
+ * as they arrive, whatever route they took, and the result is
+ * assembled in member order once at the end */
+int scon_collectives_base_allgather_setup(scon_collectives_tracker_t *coll);
+int scon_collectives_base_allgather_contribute(scon_collectives_tracker_t *coll,
+                                               scon_buffer_t *buf);
+bool scon_collectives_base_allgather_store(scon_collectives_tracker_t *coll,
+                                           uint32_t idx, char *bytes, size_t size);
+int scon_collectives_base_allgather_pack(scon_collectives_tracker_t *coll,
+                                         scon_buffer_t *buf,
+                                         uint32_t first, uint32_t nblocks);
+int scon_collectives_base_allgather_unpack(scon_collectives_tracker_t *coll,
+                                           scon_buffer_t *buf, size_t *nstored);
+int scon_collectives_base_allgather_assemble(scon_collectives_tracker_t *coll);
+int scon_collectives_base_allgather_set_layout(scon_collectives_tracker_t *coll,
+                                               const size_t *sizes);
+int scon_collectives_base_allgather_pack_result(scon_collectives_tracker_t *coll,
+                                                scon_buffer_t *buf);
+int scon_collectives_base_allgather_unpack_result(scon_collectives_tracker_t *coll,
+                                                  scon_buffer_t *buf);
+void scon_collectives_base_allgather_complete(scon_collectives_tracker_t *coll,
+                                              int status);
+
+/* reduction operators */
+int scon_collectives_base_reduce_type_size(scon_data_type_t type, size_t *size);
+int scon_collectives_base_reduce_check(scon_reduce_op_t op, scon_data_type_t type);
+void scon_collectives_base_reduce_apply(scon_reduce_op_t op, scon_data_type_t type,
+                                        void *inout, const void *in, size_t count);
+
+/* reduction helpers shared by the collectives modules */
+int scon_collectives_base_reduce_contribute(scon_collectives_tracker_t *coll);
+int scon_collectives_base_reduce_store(scon_collectives_tracker_t *coll,
+                                       scon_proc_t *peer,
+                                       scon_buffer_t *buf);
+int scon_collectives_base_reduce_fold(scon_collectives_tracker_t *coll, int idx);
+int scon_collectives_base_reduce_send(scon_collectives_tracker_t *coll,
+                                      scon_proc_t *peer,
+                                      scon_msg_tag_t tag);
+void scon_collectives_base_reduce_complete(scon_collectives_tracker_t *coll,
+                                           int status, bool deliver);
+
+/* peer to peer reduction engine - recursive doubling for allreduce,
+ * binomial tree for a rooted reduce */
+int scon_collectives_base_allreduce_rd(scon_collectives_tracker_t *coll);
+int scon_collectives_base_reduce_binomial(scon_collectives_tracker_t *coll);
+void scon_collectives_base_reduce_recv(scon_status_t status,
+                                       scon_handle_t scon_handle,
+                                       scon_proc_t *peer,
+                                       scon_buffer_t *buf,
+                                       scon_msg_tag_t tag,
+                                       void *cbdata);
+
+/* token based barrier engine */
+int scon_collectives_base_barrier_dissemination(scon_collectives_tracker_t *coll);
+void scon_collectives_base_barrier_recv(scon_status_t status,
+                                        scon_handle_t scon_handle,
+                                        scon_proc_t *peer,
+                                        scon_buffer_t *buf,
+                                        scon_msg_tag_t tag,
+                                        void *cbdata);
+
 /* extern declarations */
 SCON_EXPORT extern scon_collectives_base_t scon_collectives_base;
 SCON_EXPORT extern scon_mca_base_framework_t scon_collectives_base_framework;
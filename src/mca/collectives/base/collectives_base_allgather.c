@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2017      Intel, Inc.  All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Allgather support shared by the collectives modules.
+ *
+ * Each contribution is stored once, in the tracker's slot of the
+ * member it came from, so it doesn't matter in which order or by
+ * which route the contributions arrive. On the wire a set of
+ * contributions is a uint32 count followed by (member index, byte
+ * object) pairs.
+ *
+ * When the collective completes the slots are concatenated in member
+ * order into coll->bucket, which is what scon_allgather delivers.
+ * For scon_allgatherv the offset and size of every contribution in
+ * the bucket is also recorded in the request's layout, so the user
+ * can go straight to any member's data.
+ */
+#include "scon_config.h"
+#include <scon_common.h>
+#include <scon.h>
+
+#include "src/buffer_ops/buffer_ops.h"
+#include "src/buffer_ops/types.h"
+#include "src/buffer_ops/internal.h"
+#include "src/util/output.h"
+#include "src/util/error.h"
+#include "src/util/name_fns.h"
+#include "src/include/scon_globals.h"
+
+#include "src/mca/mca.h"
+#include "src/mca/base/base.h"
+#include "src/mca/collectives/base/base.h"
+#include "src/mca/collectives/collectives.h"
+
+/* record where each contribution is in the bucket - sizes is in
+ * member order, or NULL to take them from the slots */
+SCON_EXPORT int scon_collectives_base_allgather_set_layout(scon_collectives_tracker_t *coll,
+                                                           const size_t *sizes)
+{
+    scon_coll_req_t *req = coll->req;
+    size_t n, offset = 0;
+
+    if (NULL == req || !req->indexed) {
+        return SCON_SUCCESS;
+    }
+    if (NULL == req->layout.offsets) {
+        req->layout.offsets = (size_t*)malloc(coll->sig->nprocs * sizeof(size_t));
+        req->layout.sizes = (size_t*)malloc(coll->sig->nprocs * sizeof(size_t));
+        if (NULL == req->layout.offsets || NULL == req->layout.sizes) {
+            return SCON_ERR_OUT_OF_RESOURCE;
+        }
+    }
+    for (n = 0; n < coll->sig->nprocs; n++) {
+        req->layout.offsets[n] = offset;
+        req->layout.sizes[n] = (NULL == sizes) ? coll->slots[n].size : sizes[n];
+        offset += req->layout.sizes[n];
+    }
+    req->layout.nprocs = coll->sig->nprocs;
+    req->layout.type = coll->bucket.type;
+    return SCON_SUCCESS;
+}
+
+/* setup the slots - this may happen on receipt of a contribution
+ * from a peer, before we have been called locally */
+SCON_EXPORT int scon_collectives_base_allgather_setup(scon_collectives_tracker_t *coll)
+{
+    int idx;
+
+    if (NULL != coll->slots) {
+        return SCON_SUCCESS;
+    }
+    if (0 > (idx = scon_collectives_base_member_index(coll->sig, SCON_PROC_MY_NAME))) {
+        return SCON_ERR_NOT_FOUND;
+    }
+    coll->my_rank = idx;
+    coll->slots = (scon_collectives_slot_t*)calloc(coll->sig->nprocs,
+                                                   sizeof(scon_collectives_slot_t));
+    if (NULL == coll->slots) {
+        return SCON_ERR_OUT_OF_RESOURCE;
+    }
+    return SCON_SUCCESS;
+}
+
+/* seed my own slot with the unread part of buf */
+SCON_EXPORT int scon_collectives_base_allgather_contribute(scon_collectives_tracker_t *coll,
+                                                           scon_buffer_t *buf)
+{
+    size_t size;
+    char *bytes = NULL;
+    int rc;
+
+    if (SCON_SUCCESS != (rc = scon_collectives_base_allgather_setup(coll))) {
+        return rc;
+    }
+    /* the result carries the same buffer type as the contributions */
+    coll->bucket.type = buf->type;
+    size = buf->pack_ptr - buf->unpack_ptr;
+    if (0 < size) {
+        if (NULL == (bytes = (char*)malloc(size))) {
+            return SCON_ERR_OUT_OF_RESOURCE;
+        }
+        memcpy(bytes, buf->unpack_ptr, size);
+    }
+    scon_collectives_base_allgather_store(coll, coll->my_rank, bytes, size);
+    return SCON_SUCCESS;
+}
+
+/* store a contribution, taking ownership of the bytes. Returns
+ * false if we already had it */
+SCON_EXPORT bool scon_collectives_base_allgather_store(scon_collectives_tracker_t *coll,
+                                                       uint32_t idx, char *bytes, size_t size)
+{
+    if (idx >= coll->sig->nprocs || coll->slots[idx].filled) {
+        /* duplicate or bogus - ignore it */
+        if (NULL != bytes) {
+            free(bytes);
+        }
+        return false;
+    }
+    coll->slots[idx].bytes = bytes;
+    coll->slots[idx].size = size;
+    coll->slots[idx].filled = true;
+    return true;
+}
+
+/* pack the contributions we have among the nblocks members
+ * starting at first, wrapping around the member list */
+SCON_EXPORT int scon_collectives_base_allgather_pack(scon_collectives_tracker_t *coll,
+                                                     scon_buffer_t *buf,
+                                                     uint32_t first, uint32_t nblocks)
+{
+    scon_byte_object_t bo;
+    uint32_t n, idx, count = 0;
+    int rc;
+
+    for (n = 0; n < nblocks; n++) {
+        if (coll->slots[(first + n) % coll->sig->nprocs].filled) {
+            ++count;
+        }
+    }
+    if (SCON_SUCCESS != (rc = scon_bfrop.pack(buf, &count, 1, SCON_UINT32))) {
+        return rc;
+    }
+    for (n = 0; n < nblocks; n++) {
+        idx = (first + n) % coll->sig->nprocs;
+        if (!coll->slots[idx].filled) {
+            continue;
+        }
+        bo.bytes = coll->slots[idx].bytes;
+        bo.size = coll->slots[idx].size;
+        if (SCON_SUCCESS != (rc = scon_bfrop.pack(buf, &idx, 1, SCON_UINT32))) {
+            return rc;
+        }
+        if (SCON_SUCCESS != (rc = scon_bfrop.pack(buf, &bo, 1, SCON_BYTE_OBJECT))) {
+            return rc;
+        }
+    }
+    return SCON_SUCCESS;
+}
+
+/* unpack contributions packed by scon_collectives_base_allgather_pack
+ * into the slots, nstored is set to the number we didn't have yet */
+SCON_EXPORT int scon_collectives_base_allgather_unpack(scon_collectives_tracker_t *coll,
+                                                       scon_buffer_t *buf, size_t *nstored)
+{
+    scon_byte_object_t bo;
+    uint32_t n, count, idx;
+    int32_t cnt;
+    int rc;
+
+    *nstored = 0;
+    if (SCON_SUCCESS != (rc = scon_collectives_base_allgather_setup(coll))) {
+        return rc;
+    }
+    cnt = 1;
+    if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buf, &count, &cnt, SCON_UINT32))) {
+        return rc;
+    }
+    for (n = 0; n < count; n++) {
+        cnt = 1;
+        if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buf, &idx, &cnt, SCON_UINT32))) {
+            return rc;
+        }
+        cnt = 1;
+        if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buf, &bo, &cnt, SCON_BYTE_OBJECT))) {
+            return rc;
+        }
+        if (scon_collectives_base_allgather_store(coll, idx, bo.bytes, bo.size)) {
+            ++(*nstored);
+        }
+    }
+    return SCON_SUCCESS;
+}
+
+/* concatenate the slots in member order into the bucket */
+SCON_EXPORT int scon_collectives_base_allgather_assemble(scon_collectives_tracker_t *coll)
+{
+    size_t n, total = 0;
+    char *ptr;
+
+    for (n = 0; n < coll->sig->nprocs; n++) {
+        total += coll->slots[n].size;
+    }
+    if (0 < total) {
+        if (NULL == (ptr = (char*)malloc(total))) {
+            return SCON_ERR_OUT_OF_RESOURCE;
+        }
+        total = 0;
+        for (n = 0; n < coll->sig->nprocs; n++) {
+            if (0 < coll->slots[n].size) {
+                memcpy(ptr + total, coll->slots[n].bytes, coll->slots[n].size);
+                total += coll->slots[n].size;
+            }
+        }
+        scon_buffer_load(&coll->bucket, ptr, total);
+    }
+    return scon_collectives_base_allgather_set_layout(coll, NULL);
+}
+
+/* pack the complete result for members that will take it as is -
+ * the size of every contribution, then the contributions back to
+ * back in member order */
+SCON_EXPORT int scon_collectives_base_allgather_pack_result(scon_collectives_tracker_t *coll,
+                                                            scon_buffer_t *buf)
+{
+    size_t n, total = 0, *sizes;
+    char *ptr;
+    int rc;
+
+    if (NULL == (sizes = (size_t*)malloc(coll->sig->nprocs * sizeof(size_t)))) {
+        return SCON_ERR_OUT_OF_RESOURCE;
+    }
+    for (n = 0; n < coll->sig->nprocs; n++) {
+        sizes[n] = coll->slots[n].size;
+        total += sizes[n];
+    }
+    rc = scon_bfrop.pack(buf, sizes, coll->sig->nprocs, SCON_SIZE);
+    free(sizes);
+    if (SCON_SUCCESS != rc) {
+        return rc;
+    }
+    if (0 == total) {
+        return SCON_SUCCESS;
+    }
+    if (NULL == (ptr = scon_bfrop_buffer_extend(buf, total))) {
+        return SCON_ERR_OUT_OF_RESOURCE;
+    }
+    for (n = 0; n < coll->sig->nprocs; n++) {
+        if (0 < coll->slots[n].size) {
+            memcpy(ptr, coll->slots[n].bytes, coll->slots[n].size);
+            ptr += coll->slots[n].size;
+        }
+    }
+    buf->pack_ptr += total;
+    buf->bytes_used += total;
+    return SCON_SUCCESS;
+}
+
+/* load the bucket with a result packed by
+ * scon_collectives_base_allgather_pack_result */
+SCON_EXPORT int scon_collectives_base_allgather_unpack_result(scon_collectives_tracker_t *coll,
+                                                              scon_buffer_t *buf)
+{
+    size_t n, total = 0, *sizes;
+    int32_t cnt;
+    int rc;
+
+    if (NULL == (sizes = (size_t*)malloc(coll->sig->nprocs * sizeof(size_t)))) {
+        return SCON_ERR_OUT_OF_RESOURCE;
+    }
+    cnt = coll->sig->nprocs;
+    if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buf, sizes, &cnt, SCON_SIZE))) {
+        free(sizes);
+        return rc;
+    }
+    for (n = 0; n < coll->sig->nprocs; n++) {
+        total += sizes[n];
+    }
+    if (total != (size_t)(buf->pack_ptr - buf->unpack_ptr)) {
+        free(sizes);
+        return SCON_ERR_UNPACK_FAILURE;
+    }
+    /* the result replaces anything we collected ourselves */
+    scon_buffer_destruct(&coll->bucket);
+    scon_buffer_construct(&coll->bucket);
+    if (0 < total && SCON_SUCCESS != (rc = scon_bfrop.copy_payload(&coll->bucket, buf))) {
+        free(sizes);
+        return rc;
+    }
+    rc = scon_collectives_base_allgather_set_layout(coll, sizes);
+    free(sizes);
+    return rc;
+}
+
+/* hand the bucket to the caller and release the tracker */
+SCON_EXPORT void scon_collectives_base_allgather_complete(scon_collectives_tracker_t *coll,
+                                                          int status)
+{
+    scon_coll_req_t *req = coll->req;
+
+    scon_output_verbose(2, scon_collectives_base_framework.framework_output,
+                        "%s allgather complete with status %d on scon %d",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), status,
+                        coll->sig->scon_handle);
+    if (NULL != req && NULL != req->post.allgather.cbfunc) {
+        req->post.allgather.cbfunc(status, coll->sig->scon_handle,
+                                   req->post.allgather.procs,
+                                   req->post.allgather.nprocs, &coll->bucket,
+                                   req->post.allgather.info,
+                                   req->post.allgather.ninfo,
+                                   req->post.allgather.cbdata);
+    }
+    scon_list_remove_item(&scon_collectives_base.ongoing, &coll->super);
+    if (NULL != req) {
+        SCON_RELEASE(req);
+    }
+    SCON_RELEASE(coll);
+}
@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) 2017      Intel, Inc.  All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Dissemination barrier shared by the collectives modules.
+ *
+ * In round k every member signals the member 2^k positions to its
+ * right and waits for the signal from the member 2^k positions to its
+ * left, so after ceil(log2(N)) rounds everyone has (transitively)
+ * heard from everyone else.
+ *
+ * A signal is a fixed size token of SCON_COLLECTIVES_TOKEN_WORDS
+ * words - nothing is packed. The barrier is identified by the
+ * participant list hash and seq num instead of the signature, and
+ * all tokens and the buffers carrying them are set up in a single
+ * pass when the barrier starts. The tracker must outlive the token
+ * sends, so completion waits for them as well as for the last round.
+ *
+ * The tokens still go through the regular pt2pt send path, which
+ * builds a send request and a TCP header for each one. They travel
+ * in the barrier's priority class, which is never coalesced.
+ *
+ * Tokens for a barrier we haven't started yet are recorded on
+ * scon_collectives_base.early_tokens and picked up at start.
+ */
+#include "scon_config.h"
+#include <scon_common.h>
+#include <scon.h>
+
+#ifdef HAVE_ARPA_INET_H
+#include <arpa/inet.h>
+#endif
+#ifdef HAVE_NETINET_IN_H
+#include <netinet/in.h>
+#endif
+
+#include "src/buffer_ops/buffer_ops.h"
+#include "src/buffer_ops/types.h"
+#include "src/util/output.h"
+#include "src/util/error.h"
+#include "src/util/name_fns.h"
+#include "src/util/trace.h"
+#include "src/include/scon_globals.h"
+
+#include "src/mca/mca.h"
+#include "src/mca/base/base.h"
+#include "src/mca/collectives/base/base.h"
+#include "src/mca/collectives/collectives.h"
+#include "src/mca/comm/base/base.h"
+#include "src/mca/pt2pt/base/base.h"
+
+/* FNV-1a over the participant names */
+static uint32_t procs_hash(scon_proc_t *procs, size_t nprocs)
+{
+    uint32_t h = 2166136261u;
+    const unsigned char *p;
+    size_t n, i;
+
+    for (n = 0; n < nprocs; n++) {
+        p = (const unsigned char*)procs[n].job_name;
+        for (i = 0; i < SCON_MAX_JOBLEN && '\0' != p[i]; i++) {
+            h = (h ^ p[i]) * 16777619u;
+        }
+        p = (const unsigned char*)&procs[n].rank;
+        for (i = 0; i < sizeof(procs[n].rank); i++) {
+            h = (h ^ p[i]) * 16777619u;
+        }
+    }
+    return h;
+}
+
+static void barrier_complete(scon_collectives_tracker_t *coll, int status)
+{
+    scon_coll_req_t *req = coll->req;
+
+    scon_output_verbose(2, scon_collectives_base_framework.framework_output,
+                        "%s barrier: complete with status %d on scon %d",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), status,
+                        coll->sig->scon_handle);
+    if (NULL != req && NULL != req->post.barrier.cbfunc) {
+        req->post.barrier.cbfunc(status, coll->sig->scon_handle,
+                                 req->post.barrier.procs,
+                                 req->post.barrier.nprocs,
+                                 req->post.barrier.info,
+                                 req->post.barrier.ninfo,
+                                 req->post.barrier.cbdata);
+    }
+    scon_list_remove_item(&scon_collectives_base.ongoing, &coll->super);
+    SCON_RELEASE(req);
+    SCON_RELEASE(coll);
+}
+
+/* stop the barrier, completing it with rc once no token send
+ * is outstanding */
+static void barrier_fail(scon_collectives_tracker_t *coll, int rc)
+{
+    coll->barrier.status = rc;
+    coll->barrier.done = true;
+    if (0 == coll->barrier.nsends) {
+        barrier_complete(coll, rc);
+    }
+}
+
+/* a token send's completion - it is reported on the pt2pt
+ * thread, and is counted off on the collectives thread that
+ * owns the tracker */
+typedef struct {
+    scon_object_t super;
+    scon_event_t ev;
+    int status;
+    scon_proc_t peer;
+    scon_collectives_tracker_t *coll;
+} token_sent_t;
+static SCON_CLASS_INSTANCE(token_sent_t, scon_object_t, NULL, NULL);
+
+static void token_sent(int fd, short flags, void *cbdata)
+{
+    token_sent_t *sent = (token_sent_t*)cbdata;
+    scon_collectives_tracker_t *coll = sent->coll;
+
+    if (SCON_SUCCESS != sent->status) {
+        scon_output_verbose(0, scon_collectives_base_framework.framework_output,
+                            "%s barrier: token send to %s failed with %d",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                            SCON_PRINT_PROC(&sent->peer), sent->status);
+        coll->barrier.status = sent->status;
+    }
+    if (0 == --coll->barrier.nsends && coll->barrier.done) {
+        barrier_complete(coll, coll->barrier.status);
+    }
+    SCON_RELEASE(sent);
+}
+
+static void token_send_complete(int status, scon_handle_t scon_handle,
+                                scon_proc_t* peer,
+                                scon_buffer_t* buffer,
+                                scon_msg_tag_t tag,
+                                void* cbdata)
+{
+    token_sent_t *sent;
+
+    sent = SCON_NEW(token_sent_t);
+    sent->status = status;
+    memcpy(&sent->peer, peer, sizeof(scon_proc_t));
+    sent->coll = (scon_collectives_tracker_t*)cbdata;
+    scon_event_set(scon_globals.evbase, &sent->ev, -1, SCON_EV_WRITE, token_sent, sent);
+    scon_event_set_priority(&sent->ev, SCON_MSG_PRI);
+    scon_event_active(&sent->ev, SCON_EV_WRITE, 1);
+}
+
+static int send_token(scon_collectives_tracker_t *coll, uint32_t round)
+{
+    size_t n = coll->sig->nprocs;
+    size_t peer = (coll->my_rank + ((size_t)1 << round)) % n;
+    int rc;
+
+    SCON_TRACE(SCON_TRACE_COLL_ROUND, round, coll->sig->seq_num);
+    coll->barrier.nsends++;
+    if (SCON_SUCCESS != (rc = pt2pt_base_api_send_nb(coll->sig->scon_handle,
+                              &coll->sig->procs[peer],
+                              &coll->barrier.bufs[round],
+                              SCON_MSG_TAG_BARRIER_TOKEN,
+                              token_send_complete, coll,
+                              NULL, 0))) {
+        coll->barrier.nsends--;
+        return rc;
+    }
+    return SCON_SUCCESS;
+}
+
+/* move through the rounds whose token has arrived */
+static int barrier_progress(scon_collectives_tracker_t *coll)
+{
+    int rc;
+
+    while (coll->round < coll->barrier.nrounds &&
+           scon_collectives_base_check_distance_recv(coll, coll->round)) {
+        ++coll->round;
+        if (coll->round < coll->barrier.nrounds &&
+            SCON_SUCCESS != (rc = send_token(coll, coll->round))) {
+            return rc;
+        }
+    }
+    if (coll->round == coll->barrier.nrounds) {
+        coll->barrier.done = true;
+        if (0 == coll->barrier.nsends) {
+            barrier_complete(coll, coll->barrier.status);
+        }
+    }
+    return SCON_SUCCESS;
+}
+
+static int barrier_setup(scon_collectives_tracker_t *coll)
+{
+    scon_collectives_early_token_t *early;
+    size_t n = coll->sig->nprocs;
+    uint32_t *token;
+    uint32_t k;
+    int idx, rc;
+
+    if (0 > (idx = scon_collectives_base_member_index(coll->sig, SCON_PROC_MY_NAME))) {
+        return SCON_ERR_NOT_FOUND;
+    }
+    coll->my_rank = idx;
+    coll->round = 0;
+    coll->barrier.status = SCON_SUCCESS;
+    coll->barrier.nrounds = 0;
+    while (((size_t)1 << coll->barrier.nrounds) < n) {
+        coll->barrier.nrounds++;
+    }
+    coll->barrier.hash = procs_hash(coll->sig->procs, n);
+    if (0 == coll->barrier.nrounds) {
+        return SCON_SUCCESS;
+    }
+    if (SCON_SUCCESS != (rc = scon_bitmap_init(&coll->distance_mask_recv, coll->barrier.nrounds))) {
+        return rc;
+    }
+    coll->barrier.tokens = (uint32_t*)malloc(coll->barrier.nrounds * SCON_COLLECTIVES_TOKEN_WORDS *
+                                             sizeof(uint32_t));
+    coll->barrier.bufs = (scon_buffer_t*)calloc(coll->barrier.nrounds, sizeof(scon_buffer_t));
+    if (NULL == coll->barrier.tokens || NULL == coll->barrier.bufs) {
+        return SCON_ERR_OUT_OF_RESOURCE;
+    }
+    for (k = 0; k < coll->barrier.nrounds; k++) {
+        token = &coll->barrier.tokens[k * SCON_COLLECTIVES_TOKEN_WORDS];
+        token[0] = htonl(coll->sig->seq_num);
+        token[1] = htonl((uint32_t)n);
+        token[2] = htonl(coll->barrier.hash);
+        token[3] = htonl(k);
+        scon_buffer_construct(&coll->barrier.bufs[k]);
+        coll->barrier.bufs[k].type = SCON_BFROP_BUFFER_NON_DESC;
+        coll->barrier.bufs[k].base_ptr = (char*)token;
+        coll->barrier.bufs[k].unpack_ptr = (char*)token;
+        coll->barrier.bufs[k].bytes_allocated = SCON_COLLECTIVES_TOKEN_WORDS * sizeof(uint32_t);
+        coll->barrier.bufs[k].bytes_used = SCON_COLLECTIVES_TOKEN_WORDS * sizeof(uint32_t);
+        coll->barrier.bufs[k].pack_ptr = (char*)token + coll->barrier.bufs[k].bytes_used;
+    }
+    /* pick up any tokens that beat us here */
+    SCON_LIST_FOREACH(early, &scon_collectives_base.early_tokens, scon_collectives_early_token_t) {
+        if (early->scon_handle == coll->sig->scon_handle &&
+            early->seq_num == coll->sig->seq_num &&
+            early->nprocs == n && early->hash == coll->barrier.hash) {
+            for (k = 0; k < coll->barrier.nrounds; k++) {
+                if (early->rounds & ((uint64_t)1 << k)) {
+                    scon_collectives_base_mark_distance_recv(coll, k);
+                }
+            }
+            scon_list_remove_item(&scon_collectives_base.early_tokens, &early->super);
+            SCON_RELEASE(early);
+            break;
+        }
+    }
+    return SCON_SUCCESS;
+}
+
+SCON_EXPORT int scon_collectives_base_barrier_dissemination(scon_collectives_tracker_t *coll)
+{
+    int rc;
+
+    scon_output_verbose(2, scon_collectives_base_framework.framework_output,
+                        "%s barrier: dissemination nprocs = %d, on scon=%d",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                        (int)coll->sig->nprocs, coll->sig->scon_handle);
+    if (SCON_SUCCESS != (rc = barrier_setup(coll))) {
+        goto error;
+    }
+    if (0 < coll->barrier.nrounds &&
+        SCON_SUCCESS != (rc = send_token(coll, 0))) {
+        goto error;
+    }
+    if (SCON_SUCCESS != (rc = barrier_progress(coll))) {
+        goto error;
+    }
+    return SCON_SUCCESS;
+
+error:
+    SCON_ERROR_LOG(rc);
+    barrier_fail(coll, rc);
+    return rc;
+}
+
+/* record a token for a barrier we haven't started */
+static void record_early(scon_handle_t scon_handle, uint32_t seq_num,
+                         uint32_t nprocs, uint32_t hash, uint32_t round)
+{
+    scon_collectives_early_token_t *early;
+
+    SCON_LIST_FOREACH(early, &scon_collectives_base.early_tokens, scon_collectives_early_token_t) {
+        if (early->scon_handle == scon_handle && early->seq_num == seq_num &&
+            early->nprocs == nprocs && early->hash == hash &&
+            0 == (early->rounds & ((uint64_t)1 << round))) {
+            early->rounds |= (uint64_t)1 << round;
+            return;
+        }
+    }
+    early = SCON_NEW(scon_collectives_early_token_t);
+    early->scon_handle = scon_handle;
+    early->seq_num = seq_num;
+    early->nprocs = nprocs;
+    early->hash = hash;
+    early->rounds = (uint64_t)1 << round;
+    scon_list_append(&scon_collectives_base.early_tokens, &early->super);
+}
+
+/* a received token - the recv is delivered on the pt2pt thread,
+ * and the token is matched on the collectives thread that owns
+ * the trackers and the early tokens */
+typedef struct {
+    scon_object_t super;
+    scon_event_t ev;
+    scon_handle_t scon_handle;
+    scon_proc_t peer;
+    uint32_t token[SCON_COLLECTIVES_TOKEN_WORDS];
+} token_recvd_t;
+static SCON_CLASS_INSTANCE(token_recvd_t, scon_object_t, NULL, NULL);
+
+static void process_token(int fd, short flags, void *cbdata)
+{
+    token_recvd_t *recvd = (token_recvd_t*)cbdata;
+    scon_collectives_tracker_t *coll;
+    uint32_t seq_num, nprocs, hash, round;
+    int rc;
+
+    seq_num = ntohl(recvd->token[0]);
+    nprocs = ntohl(recvd->token[1]);
+    hash = ntohl(recvd->token[2]);
+    round = ntohl(recvd->token[3]);
+    scon_output_verbose(5, scon_collectives_base_framework.framework_output,
+                        "%s barrier: token for round %u seq %u from %s on scon=%d",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), round, seq_num,
+                        SCON_PRINT_PROC(&recvd->peer), recvd->scon_handle);
+    if (64 <= round) {
+        SCON_ERROR_LOG(SCON_ERR_BAD_PARAM);
+        goto done;
+    }
+    SCON_LIST_FOREACH(coll, &scon_collectives_base.ongoing, scon_collectives_tracker_t) {
+        if (NULL != coll->barrier.tokens && !coll->barrier.done &&
+            coll->sig->scon_handle == recvd->scon_handle &&
+            coll->sig->seq_num == seq_num &&
+            coll->sig->nprocs == nprocs &&
+            coll->barrier.hash == hash &&
+            !scon_collectives_base_check_distance_recv(coll, round)) {
+            scon_collectives_base_mark_distance_recv(coll, round);
+            if (SCON_SUCCESS != (rc = barrier_progress(coll))) {
+                SCON_ERROR_LOG(rc);
+                barrier_fail(coll, rc);
+            }
+            goto done;
+        }
+    }
+    /* either we haven't got there yet, or this is for the next
+     * barrier on the same participants */
+    record_early(recvd->scon_handle, seq_num, nprocs, hash, round);
+
+done:
+    SCON_RELEASE(recvd);
+}
+
+SCON_EXPORT void scon_collectives_base_barrier_recv(scon_status_t status,
+                                                    scon_handle_t scon_handle,
+                                                    scon_proc_t *peer,
+                                                    scon_buffer_t *buf,
+                                                    scon_msg_tag_t tag,
+                                                    void *cbdata)
+{
+    token_recvd_t *recvd;
+
+    if ((size_t)(buf->pack_ptr - buf->unpack_ptr) < sizeof(recvd->token)) {
+        SCON_ERROR_LOG(SCON_ERR_UNPACK_INADEQUATE_SPACE);
+        return;
+    }
+    recvd = SCON_NEW(token_recvd_t);
+    recvd->scon_handle = scon_handle;
+    memcpy(&recvd->peer, peer, sizeof(scon_proc_t));
+    memcpy(recvd->token, buf->unpack_ptr, sizeof(recvd->token));
+    scon_event_set(scon_globals.evbase, &recvd->ev, -1, SCON_EV_WRITE, process_token, recvd);
+    scon_event_set_priority(&recvd->ev, SCON_MSG_PRI);
+    scon_event_active(&recvd->ev, SCON_EV_WRITE, 1);
+}
@@ -13,6 +13,7 @@
 #include <scon_globals.h>
 #include "scon_common.h"
 #include "src/buffer_ops/types.h"
+#include "src/util/perf.h"
 #include "src/mca/collectives/base/base.h"
 #include "src/mca/collectives/base/static-components.h"
 
@@ -22,6 +23,7 @@
 scon_collectives_base_t scon_collectives_base;
 int scon_collectives_base_open(scon_mca_base_open_flag_t flags);
 int scon_collectives_base_close(void);
+static int scon_collectives_base_register(scon_mca_base_register_flag_t flags);
 /*
  * Function for finding and opening either all MCA components,
  * or the one that was specifically requested via a MCA parameter.
@@ -36,8 +38,14 @@ int scon_collectives_base_open(scon_mca_base_open_flag_t flags)
 {
     SCON_CONSTRUCT(&scon_collectives_base.actives, scon_list_t);
     SCON_CONSTRUCT(&scon_collectives_base.ongoing, scon_list_t);
-    SCON_CONSTRUCT(&scon_collectives_base.coll_table, scon_hash_table_t);
-    scon_hash_table_init(&scon_collectives_base.coll_table, 128);
+    SCON_CONSTRUCT(&scon_collectives_base.windows, scon_list_t);
+    SCON_CONSTRUCT(&scon_collectives_base.early_tokens, scon_list_t);
+    SCON_CONSTRUCT(&scon_collectives_base.handlers, scon_list_t);
+    SCON_CONSTRUCT(&scon_collectives_base.rules, scon_list_t);
+    if (NULL != scon_collectives_base.tuning_file &&
+        '\0' != scon_collectives_base.tuning_file[0]) {
+        (void) scon_collectives_base_load_tuning(scon_collectives_base.tuning_file);
+    }
     /* Open up all available components */
     return scon_mca_base_framework_components_open(&scon_collectives_base_framework, flags);
 }
@@ -46,22 +54,81 @@ int scon_collectives_base_close(void)
 {
     SCON_DESTRUCT(&scon_collectives_base.actives);
     SCON_DESTRUCT(&scon_collectives_base.ongoing);
-    SCON_DESTRUCT(&scon_collectives_base.coll_table);
+    SCON_LIST_DESTRUCT(&scon_collectives_base.windows);
+    SCON_LIST_DESTRUCT(&scon_collectives_base.early_tokens);
+    SCON_LIST_DESTRUCT(&scon_collectives_base.handlers);
+    SCON_LIST_DESTRUCT(&scon_collectives_base.rules);
     return scon_mca_base_framework_components_close(&scon_collectives_base_framework, NULL);
 }
 
 
 /* Framework Declaration */
 SCON_MCA_BASE_FRAMEWORK_DECLARE(scon, collectives, "Collectives framework",
-                                NULL /* register */,
+                                scon_collectives_base_register /* register */,
                                 scon_collectives_base_open /* open */,
                                 scon_collectives_base_close /* close */,
                                 mca_collectives_base_static_components,
                                 0);
 
+static int scon_collectives_base_register(scon_mca_base_register_flag_t flags)
+{
+    scon_collectives_base.max_outstanding = 16;
+    (void) scon_mca_base_framework_var_register(&scon_collectives_base_framework, "max_outstanding",
+                                                "Max number of collectives in progress on a scon, "
+                                                "later ones are queued until an earlier one "
+                                                "completes (0 = no limit)",
+                                                SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0,
+                                                SCON_MCA_BASE_VAR_FLAG_SETTABLE,
+                                                SCON_INFO_LVL_5,
+                                                SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                                &scon_collectives_base.max_outstanding);
+    scon_collectives_base.tuning_file = NULL;
+    (void) scon_mca_base_framework_var_register(&scon_collectives_base_framework, "tuning_file",
+                                                "File of rules picking the allgather algorithm by "
+                                                "member count and payload size, as written by "
+                                                "coll_tune",
+                                                SCON_MCA_BASE_VAR_TYPE_STRING, NULL, 0,
+                                                SCON_MCA_BASE_VAR_FLAG_SETTABLE,
+                                                SCON_INFO_LVL_5,
+                                                SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                                &scon_collectives_base.tuning_file);
+    scon_collectives_base.link_latency = 10;
+    (void) scon_mca_base_framework_var_register(&scon_collectives_base_framework, "link_latency",
+                                                "Latency of a message between two members in usecs, "
+                                                "used to pick the allgather algorithm where no "
+                                                "tuning rule applies",
+                                                SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0,
+                                                SCON_MCA_BASE_VAR_FLAG_SETTABLE,
+                                                SCON_INFO_LVL_5,
+                                                SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                                &scon_collectives_base.link_latency);
+    scon_collectives_base.link_bandwidth = 1000;
+    (void) scon_mca_base_framework_var_register(&scon_collectives_base_framework, "link_bandwidth",
+                                                "Bandwidth between two members in MB/s, used to "
+                                                "pick the allgather algorithm where no tuning rule "
+                                                "applies",
+                                                SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0,
+                                                SCON_MCA_BASE_VAR_FLAG_SETTABLE,
+                                                SCON_INFO_LVL_5,
+                                                SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                                &scon_collectives_base.link_bandwidth);
+    scon_collectives_base.tree_fanout = 4;
+    (void) scon_mca_base_framework_var_register(&scon_collectives_base_framework, "tree_fanout",
+                                                "Fanout of the topology tree assumed when costing "
+                                                "the tree allgather",
+                                                SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0,
+                                                SCON_MCA_BASE_VAR_FLAG_SETTABLE,
+                                                SCON_INFO_LVL_5,
+                                                SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                                &scon_collectives_base.tree_fanout);
+    return SCON_SUCCESS;
+}
+
 /* object instances */
 static void xcon (scon_xcast_t *p)
 {
+    p->info = NULL;
+    p->ninfo = 0;
 }
 SCON_CLASS_INSTANCE (scon_xcast_t,
                      scon_list_item_t,
@@ -81,17 +148,65 @@ static void acon (scon_allgather_t *p)
     p->nprocs = 0;
     p->info = NULL;
     p->ninfo =0 ;
+    p->algorithm[0] = '\0';
+    p->has_size_hint = false;
+    p->size_hint = 0;
 }
 SCON_CLASS_INSTANCE (scon_allgather_t,
                      scon_list_item_t,
                      acon, NULL);
 
+static void rcon (scon_reduce_t *p)
+{
+    p->sendbuf = NULL;
+    p->recvbuf = NULL;
+    p->count = 0;
+    p->type = SCON_UNDEF;
+    p->op = 0;
+    p->rooted = false;
+    p->cbfunc = NULL;
+    p->procs = NULL;
+    p->nprocs = 0;
+    p->info = NULL;
+    p->ninfo = 0;
+}
+SCON_CLASS_INSTANCE (scon_reduce_t,
+                     scon_list_item_t,
+                     rcon, NULL);
+
 static void ccon(scon_coll_req_t *p)
 {
+    p->type = SCON_COLL_REQ_XCAST;
+    p->order = 0;
+    p->posted = scon_perf_enabled ? scon_perf_now_usec() : 0;
+    p->sig = NULL;
+    memset(&p->cbfunc, 0, sizeof(p->cbfunc));
+    p->cbdata = NULL;
+    p->indexed = false;
+    memset(&p->layout, 0, sizeof(p->layout));
+    p->status = SCON_SUCCESS;
+    p->result = NULL;
+    p->rresult = NULL;
+}
+static void cdes(scon_coll_req_t *p)
+{
+    if (NULL != p->sig) {
+        SCON_RELEASE(p->sig);
+    }
+    if (NULL != p->result) {
+        scon_buffer_destruct(p->result);
+        free(p->result);
+    }
+    if (NULL != p->layout.offsets) {
+        free(p->layout.offsets);
+    }
+    if (NULL != p->layout.sizes) {
+        free(p->layout.sizes);
+    }
 }
 SCON_CLASS_INSTANCE (scon_coll_req_t,
-                     scon_object_t,
-                     ccon, NULL);
+                     scon_list_item_t,
+                     ccon, cdes);
 
 static void sigcon(scon_collectives_signature_t *s)
 {
@@ -119,15 +234,115 @@ static void tcon(scon_collectives_tracker_t *p)
     p->nreported = 0;
     p->req = NULL;
     p->buffers = NULL;
+    p->round = 0;
+    p->slots = NULL;
+    p->region = NULL;
+    memset(&p->reduction, 0, sizeof(p->reduction));
+    memset(&p->barrier, 0, sizeof(p->barrier));
+    SCON_PERF_INC(SCON_PERF_CTR_COLL_TRACKERS);
 }
 static void tdes(scon_collectives_tracker_t *p)
 {
+    size_t n;
+    if (NULL != p->slots) {
+        for (n = 0; n < p->sig->nprocs; n++) {
+            if (NULL != p->slots[n].bytes) {
+                free(p->slots[n].bytes);
+            }
+        }
+        free(p->slots);
+    }
+    if (NULL != p->region) {
+        SCON_RELEASE(p->region);
+    }
+    if (NULL != p->reduction.data) {
+        free(p->reduction.data);
+    }
+    /* the token buffers wrap the tokens array, so they
+     * are not destructed */
+    if (NULL != p->barrier.bufs) {
+        free(p->barrier.bufs);
+    }
+    if (NULL != p->barrier.tokens) {
+        free(p->barrier.tokens);
+    }
     if (NULL != p->sig) {
         SCON_RELEASE(p->sig);
     }
     SCON_DESTRUCT(&p->distance_mask_recv);
     free(p->buffers);
+    SCON_PERF_DEC(SCON_PERF_CTR_COLL_TRACKERS);
 }
 SCON_CLASS_INSTANCE(scon_collectives_tracker_t,
                    scon_list_item_t,
                    tcon, tdes);
+
+static void rgcon(scon_collectives_region_t *p)
+{
+    scon_buffer_construct(&p->data);
+    p->nblocks = 0;
+    p->ends = NULL;
+    p->sizes = NULL;
+}
+static void rgdes(scon_collectives_region_t *p)
+{
+    scon_buffer_destruct(&p->data);
+    if (NULL != p->ends) {
+        free(p->ends);
+    }
+    if (NULL != p->sizes) {
+        free(p->sizes);
+    }
+}
+SCON_CLASS_INSTANCE(scon_collectives_region_t,
+                   scon_object_t,
+                   rgcon, rgdes);
+
+static void rulecon(scon_collectives_rule_t *p)
+{
+    p->min_members = 0;
+    p->max_members = SIZE_MAX;
+    p->min_size = 0;
+    p->max_size = SIZE_MAX;
+    p->component[0] = '\0';
+}
+SCON_CLASS_INSTANCE(scon_collectives_rule_t,
+                   scon_list_item_t,
+                   rulecon, NULL);
+
+static void etcon(scon_collectives_early_token_t *p)
+{
+    p->scon_handle = SCON_HANDLE_INVALID;
+    p->seq_num = 0;
+    p->nprocs = 0;
+    p->hash = 0;
+    p->rounds = 0;
+}
+SCON_CLASS_INSTANCE(scon_collectives_early_token_t,
+                   scon_list_item_t,
+                   etcon, NULL);
+
+SCON_CLASS_INSTANCE(scon_collectives_handler_t,
+                   scon_list_item_t,
+                   NULL, NULL);
+
+static void wcon(scon_collectives_window_t *p)
+{
+    p->scon_handle = SCON_HANDLE_INVALID;
+    SCON_CONSTRUCT(&p->seqs, scon_hash_table_t);
+    scon_hash_table_init(&p->seqs, 16);
+    p->next_issue = 0;
+    p->next_deliver = 0;
+    p->active = 0;
+    SCON_CONSTRUCT(&p->pending, scon_list_t);
+    SCON_CONSTRUCT(&p->deferred, scon_list_t);
+}
+static void wdes(scon_collectives_window_t *p)
+{
+    SCON_DESTRUCT(&p->seqs);
+    SCON_LIST_DESTRUCT(&p->pending);
+    SCON_LIST_DESTRUCT(&p->deferred);
+}
+SCON_CLASS_INSTANCE(scon_collectives_window_t,
+                   scon_list_item_t,
+                   wcon, wdes);
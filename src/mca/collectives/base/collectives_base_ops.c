@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2017      Intel, Inc.  All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Built-in reduction operators. Each operator/type pair is a
+ * plain loop over two non-aliased arrays so the compiler can
+ * vectorize it - keep the loop bodies branch free.
+ */
+#include "scon_config.h"
+#include <scon_common.h>
+
+#include "src/mca/collectives/base/base.h"
+
+#define SCON_REDUCE_LOOP(t, expr)                                   \
+    do {                                                            \
+        t * __scon_restrict a = (t*)inout;                          \
+        const t * __scon_restrict b = (const t*)in;                 \
+        size_t n;                                                   \
+        for (n = 0; n < count; n++) {                               \
+            a[n] = (expr);                                          \
+        }                                                           \
+    } while (0)
+
+#define SCON_REDUCE_ARITH(t)                                        \
+    do {                                                            \
+        switch (op) {                                               \
+            case SCON_OP_SUM:                                       \
+                SCON_REDUCE_LOOP(t, a[n] + b[n]);                   \
+                break;                                              \
+            case SCON_OP_MIN:                                       \
+                SCON_REDUCE_LOOP(t, (b[n] < a[n]) ? b[n] : a[n]);   \
+                break;                                              \
+            case SCON_OP_MAX:                                       \
+                SCON_REDUCE_LOOP(t, (b[n] > a[n]) ? b[n] : a[n]);   \
+                break;                                              \
+            default:                                                \
+                break;                                              \
+        }                                                           \
+    } while (0)
+
+#define SCON_REDUCE_INTEGER(t)                                      \
+    do {                                                            \
+        switch (op) {                                               \
+            case SCON_OP_BAND:                                      \
+                SCON_REDUCE_LOOP(t, a[n] & b[n]);                   \
+                break;                                              \
+            case SCON_OP_BOR:                                       \
+                SCON_REDUCE_LOOP(t, a[n] | b[n]);                   \
+                break;                                              \
+            default:                                                \
+                SCON_REDUCE_ARITH(t);                               \
+                break;                                              \
+        }                                                           \
+    } while (0)
+
+int scon_collectives_base_reduce_type_size(scon_data_type_t type, size_t *size)
+{
+    switch (type) {
+        case SCON_INT8:
+        case SCON_UINT8:
+            *size = 1;
+            break;
+        case SCON_INT16:
+        case SCON_UINT16:
+            *size = 2;
+            break;
+        case SCON_INT32:
+        case SCON_UINT32:
+            *size = 4;
+            break;
+        case SCON_INT64:
+        case SCON_UINT64:
+            *size = 8;
+            break;
+        case SCON_INT:
+        case SCON_UINT:
+            *size = sizeof(int);
+            break;
+        case SCON_SIZE:
+            *size = sizeof(size_t);
+            break;
+        case SCON_FLOAT:
+            *size = sizeof(float);
+            break;
+        case SCON_DOUBLE:
+            *size = sizeof(double);
+            break;
+        default:
+            return SCON_ERR_NOT_SUPPORTED;
+    }
+    return SCON_SUCCESS;
+}
+
+/* check that op can be applied to type */
+int scon_collectives_base_reduce_check(scon_reduce_op_t op, scon_data_type_t type)
+{
+    size_t size;
+
+    if (SCON_SUCCESS != scon_collectives_base_reduce_type_size(type, &size)) {
+        return SCON_ERR_NOT_SUPPORTED;
+    }
+    switch (op) {
+        case SCON_OP_SUM:
+        case SCON_OP_MIN:
+        case SCON_OP_MAX:
+            return SCON_SUCCESS;
+        case SCON_OP_BAND:
+        case SCON_OP_BOR:
+            if (SCON_FLOAT == type || SCON_DOUBLE == type) {
+                return SCON_ERR_NOT_SUPPORTED;
+            }
+            return SCON_SUCCESS;
+        default:
+            return SCON_ERR_NOT_SUPPORTED;
+    }
+}
+
+/* inout[n] = inout[n] op in[n] for n < count - the combination
+ * must have been validated with scon_collectives_base_reduce_check */
+void scon_collectives_base_reduce_apply(scon_reduce_op_t op, scon_data_type_t type,
+                                        void *inout, const void *in, size_t count)
+{
+    switch (type) {
+        case SCON_INT8:
+            SCON_REDUCE_INTEGER(int8_t);
+            break;
+        case SCON_UINT8:
+            SCON_REDUCE_INTEGER(uint8_t);
+            break;
+        case SCON_INT16:
+            SCON_REDUCE_INTEGER(int16_t);
+            break;
+        case SCON_UINT16:
+            SCON_REDUCE_INTEGER(uint16_t);
+            break;
+        case SCON_INT32:
+            SCON_REDUCE_INTEGER(int32_t);
+            break;
+        case SCON_UINT32:
+            SCON_REDUCE_INTEGER(uint32_t);
+            break;
+        case SCON_INT64:
+            SCON_REDUCE_INTEGER(int64_t);
+            break;
+        case SCON_UINT64:
+            SCON_REDUCE_INTEGER(uint64_t);
+            break;
+        case SCON_INT:
+            SCON_REDUCE_INTEGER(int);
+            break;
+        case SCON_UINT:
+            SCON_REDUCE_INTEGER(unsigned int);
+            break;
+        case SCON_SIZE:
+            SCON_REDUCE_INTEGER(size_t);
+            break;
+        case SCON_FLOAT:
+            SCON_REDUCE_ARITH(float);
+            break;
+        case SCON_DOUBLE:
+            SCON_REDUCE_ARITH(double);
+            break;
+        default:
+            break;
+    }
+}
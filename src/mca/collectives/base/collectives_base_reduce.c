@@ -0,0 +1,448 @@
+/*
+ * Copyright (c) 2017      Intel, Inc.  All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Reduction support shared by the collectives modules.
+ *
+ * The local contribution is copied into coll->reduction and
+ * contributions from peers are parked in the tracker's slot of the
+ * sending member until they can be folded in, so a contribution that
+ * arrives before the local call (or before the round it belongs to)
+ * is simply held. Contributions travel as raw bytes in the native
+ * representation of the element type.
+ *
+ * The peer to peer engine implements:
+ *
+ *  - allreduce by recursive doubling. With p the largest power of two
+ *    not above N and r = N - p, the first 2r members pair up and the
+ *    even ones hand their data to their odd neighbor (step 0). The
+ *    remaining p members exchange and combine with the member whose
+ *    virtual rank differs in bit k in step k+1, and finally the odd
+ *    members of the first 2r pass the result back (step log2(p)+1).
+ *    Every member receives at most once from any given peer, which
+ *    is what lets the slots be indexed by sender.
+ *  - rooted reduce over a binomial tree rooted at the root member.
+ */
+#include "scon_config.h"
+#include <scon_common.h>
+#include <scon.h>
+
+#include "src/buffer_ops/buffer_ops.h"
+#include "src/buffer_ops/types.h"
+#include "src/buffer_ops/internal.h"
+#include "src/util/output.h"
+#include "src/util/error.h"
+#include "src/util/name_fns.h"
+#include "src/util/trace.h"
+#include "src/include/scon_globals.h"
+
+#include "src/mca/mca.h"
+#include "src/mca/base/base.h"
+#include "src/mca/collectives/base/base.h"
+#include "src/mca/collectives/collectives.h"
+#include "src/mca/comm/base/base.h"
+#include "src/mca/pt2pt/base/base.h"
+
+static uint32_t ilog2(size_t n)
+{
+    uint32_t l = 0;
+    while (n >>= 1) {
+        ++l;
+    }
+    return l;
+}
+
+static int setup_slots(scon_collectives_tracker_t *coll)
+{
+    int idx;
+
+    if (NULL != coll->slots) {
+        return SCON_SUCCESS;
+    }
+    if (0 > (idx = scon_collectives_base_member_index(coll->sig, SCON_PROC_MY_NAME))) {
+        return SCON_ERR_NOT_FOUND;
+    }
+    coll->my_rank = idx;
+    coll->slots = (scon_collectives_slot_t*)calloc(coll->sig->nprocs,
+                                                   sizeof(scon_collectives_slot_t));
+    if (NULL == coll->slots) {
+        return SCON_ERR_OUT_OF_RESOURCE;
+    }
+    return SCON_SUCCESS;
+}
+
+/* seed the result with the local contribution */
+SCON_EXPORT int scon_collectives_base_reduce_contribute(scon_collectives_tracker_t *coll)
+{
+    scon_reduce_t *reduce = &coll->req->post.reduce;
+    int rc;
+
+    if (SCON_SUCCESS != (rc = setup_slots(coll))) {
+        return rc;
+    }
+    if (SCON_SUCCESS != (rc = scon_collectives_base_reduce_type_size(reduce->type,
+                                                                     &coll->reduction.size))) {
+        return rc;
+    }
+    coll->reduction.count = reduce->count;
+    coll->reduction.type = reduce->type;
+    coll->reduction.op = reduce->op;
+    coll->reduction.data = malloc(reduce->count * coll->reduction.size);
+    if (NULL == coll->reduction.data) {
+        return SCON_ERR_OUT_OF_RESOURCE;
+    }
+    memcpy(coll->reduction.data, reduce->sendbuf, reduce->count * coll->reduction.size);
+    coll->nreported = 1;
+    coll->round = 0;
+    return SCON_SUCCESS;
+}
+
+/* park a peer's contribution in its slot. Returns the slot index or
+ * a negative error code */
+SCON_EXPORT int scon_collectives_base_reduce_store(scon_collectives_tracker_t *coll,
+                                                   scon_proc_t *peer,
+                                                   scon_buffer_t *buf)
+{
+    scon_byte_object_t bo;
+    int32_t cnt = 1;
+    int idx, rc;
+
+    if (SCON_SUCCESS != (rc = setup_slots(coll))) {
+        return rc;
+    }
+    if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buf, &bo, &cnt, SCON_BYTE_OBJECT))) {
+        return rc;
+    }
+    idx = scon_collectives_base_member_index(coll->sig, peer);
+    if (0 > idx || coll->slots[idx].filled) {
+        /* not a participant, or a duplicate */
+        free(bo.bytes);
+        return SCON_ERR_BAD_PARAM;
+    }
+    coll->slots[idx].bytes = bo.bytes;
+    coll->slots[idx].size = bo.size;
+    coll->slots[idx].filled = true;
+    return idx;
+}
+
+/* combine the contribution parked in slot idx into the result */
+SCON_EXPORT int scon_collectives_base_reduce_fold(scon_collectives_tracker_t *coll, int idx)
+{
+    scon_collectives_slot_t *slot = &coll->slots[idx];
+
+    if (NULL == slot->bytes) {
+        /* already folded */
+        return SCON_SUCCESS;
+    }
+    if (slot->size != coll->reduction.count * coll->reduction.size) {
+        /* members disagree on count or type */
+        return SCON_ERR_BAD_PARAM;
+    }
+    scon_collectives_base_reduce_apply(coll->reduction.op, coll->reduction.type,
+                                       coll->reduction.data, slot->bytes,
+                                       coll->reduction.count);
+    free(slot->bytes);
+    slot->bytes = NULL;
+    coll->nreported++;
+    return SCON_SUCCESS;
+}
+
+/* send the current result to peer */
+SCON_EXPORT int scon_collectives_base_reduce_send(scon_collectives_tracker_t *coll,
+                                                  scon_proc_t *peer,
+                                                  scon_msg_tag_t tag)
+{
+    scon_buffer_t *send_buf;
+    scon_byte_object_t bo;
+    int rc;
+
+    send_buf = (scon_buffer_t*) malloc(sizeof(scon_buffer_t));
+    scon_buffer_construct(send_buf);
+    if (SCON_SUCCESS != (rc = scon_bfrop.pack(send_buf, &coll->sig, 1, SCON_COLLECTIVES_SIGNATURE))) {
+        goto error;
+    }
+    bo.bytes = (char*)coll->reduction.data;
+    bo.size = coll->reduction.count * coll->reduction.size;
+    if (SCON_SUCCESS != (rc = scon_bfrop.pack(send_buf, &bo, 1, SCON_BYTE_OBJECT))) {
+        goto error;
+    }
+    scon_output_verbose(5, scon_collectives_base_framework.framework_output,
+                        "%s reduce: sending %lu bytes at round %u to %s",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), (unsigned long)bo.size,
+                        coll->round, SCON_PRINT_PROC(peer));
+    SCON_TRACE(SCON_TRACE_COLL_ROUND, coll->round, coll->sig->seq_num);
+    SCON_RETAIN(coll);
+    if (SCON_SUCCESS != (rc = pt2pt_base_api_send_nb(coll->sig->scon_handle,
+                              peer, send_buf, tag,
+                              scon_collectives_base_allgather_send_complete_callback, coll,
+                              NULL, 0))) {
+        SCON_RELEASE(coll);
+        goto error;
+    }
+    return SCON_SUCCESS;
+
+error:
+    SCON_ERROR_LOG(rc);
+    scon_buffer_destruct(send_buf);
+    free(send_buf);
+    return rc;
+}
+
+/* hand the result to the caller if deliver is set, and retire the
+ * tracker */
+SCON_EXPORT void scon_collectives_base_reduce_complete(scon_collectives_tracker_t *coll,
+                                                       int status, bool deliver)
+{
+    scon_coll_req_t *req = coll->req;
+    scon_reduce_t *reduce;
+    void *result = NULL;
+
+    scon_output_verbose(2, scon_collectives_base_framework.framework_output,
+                        "%s reduce: complete with status %d on scon %d",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), status,
+                        coll->sig->scon_handle);
+    if (NULL != req) {
+        reduce = &req->post.reduce;
+        if (SCON_SUCCESS == status && deliver && NULL != reduce->recvbuf) {
+            memcpy(reduce->recvbuf, coll->reduction.data,
+                   coll->reduction.count * coll->reduction.size);
+            result = reduce->recvbuf;
+        }
+        if (NULL != reduce->cbfunc) {
+            reduce->cbfunc(status, coll->sig->scon_handle,
+                           reduce->procs, reduce->nprocs,
+                           result, reduce->count, reduce->type,
+                           reduce->info, reduce->ninfo,
+                           reduce->cbdata);
+        }
+    }
+    scon_list_remove_item(&scon_collectives_base.ongoing, &coll->super);
+    SCON_RELEASE(req);
+    SCON_RELEASE(coll);
+}
+
+/* work out who we send to and receive from in a recursive
+ * doubling step, -1 if nobody */
+static void rd_step(scon_collectives_tracker_t *coll, uint32_t step,
+                    int *to, int *from)
+{
+    size_t n = coll->sig->nprocs;
+    size_t p = (size_t)1 << ilog2(n);
+    size_t r = n - p;
+    size_t me = coll->my_rank;
+    size_t v;
+
+    *to = -1;
+    *from = -1;
+    if (0 == step) {
+        if (me < 2 * r) {
+            if (me & 1) {
+                *from = me - 1;
+            } else {
+                *to = me + 1;
+            }
+        }
+    } else if (step <= ilog2(p)) {
+        if (me < 2 * r && 0 == (me & 1)) {
+            /* folded into our neighbor */
+            return;
+        }
+        v = (me < 2 * r) ? me / 2 : me - r;
+        v ^= (size_t)1 << (step - 1);
+        *to = *from = (v < r) ? (int)(2 * v + 1) : (int)(v + r);
+    } else {
+        if (me < 2 * r) {
+            if (me & 1) {
+                *to = me - 1;
+            } else {
+                *from = me + 1;
+            }
+        }
+    }
+}
+
+static int rd_progress(scon_collectives_tracker_t *coll)
+{
+    uint32_t last = ilog2(coll->sig->nprocs) + 1;
+    scon_collectives_slot_t *slot;
+    int to, from, rc;
+
+    while (coll->round <= last) {
+        rd_step(coll, coll->round, &to, &from);
+        if (0 <= from) {
+            slot = &coll->slots[from];
+            if (!slot->filled) {
+                /* wait for it */
+                return SCON_SUCCESS;
+            }
+            if (coll->round < last) {
+                rc = scon_collectives_base_reduce_fold(coll, from);
+            } else if (slot->size != coll->reduction.count * coll->reduction.size) {
+                rc = SCON_ERR_BAD_PARAM;
+            } else {
+                /* the final result from our neighbor */
+                free(coll->reduction.data);
+                coll->reduction.data = slot->bytes;
+                slot->bytes = NULL;
+                rc = SCON_SUCCESS;
+            }
+            if (SCON_SUCCESS != rc) {
+                return rc;
+            }
+        }
+        coll->round++;
+        if (coll->round <= last) {
+            rd_step(coll, coll->round, &to, &from);
+            if (0 <= to &&
+                SCON_SUCCESS != (rc = scon_collectives_base_reduce_send(coll, &coll->sig->procs[to],
+                                                                        SCON_MSG_TAG_REDUCE_RD))) {
+                return rc;
+            }
+        }
+    }
+    scon_collectives_base_reduce_complete(coll, SCON_SUCCESS, true);
+    return SCON_SUCCESS;
+}
+
+static int binomial_progress(scon_collectives_tracker_t *coll)
+{
+    size_t n = coll->sig->nprocs;
+    size_t mask, v, root;
+    int idx, rc;
+
+    if (0 > (idx = scon_collectives_base_member_index(coll->sig, &coll->req->post.reduce.root))) {
+        return SCON_ERR_BAD_PARAM;
+    }
+    root = idx;
+    /* our rank relative to the root */
+    v = (coll->my_rank + n - root) % n;
+    while ((mask = (size_t)1 << coll->round) < n) {
+        if (v & mask) {
+            /* our subtree is done - pass it to our parent */
+            if (SCON_SUCCESS != (rc = scon_collectives_base_reduce_send(coll,
+                                        &coll->sig->procs[(v - mask + root) % n],
+                                        SCON_MSG_TAG_REDUCE_RD))) {
+                return rc;
+            }
+            scon_collectives_base_reduce_complete(coll, SCON_SUCCESS, false);
+            return SCON_SUCCESS;
+        }
+        if (v + mask < n) {
+            idx = (v + mask + root) % n;
+            if (!coll->slots[idx].filled) {
+                return SCON_SUCCESS;
+            }
+            if (SCON_SUCCESS != (rc = scon_collectives_base_reduce_fold(coll, idx))) {
+                return rc;
+            }
+        }
+        coll->round++;
+    }
+    /* only the root gets here */
+    scon_collectives_base_reduce_complete(coll, SCON_SUCCESS, true);
+    return SCON_SUCCESS;
+}
+
+SCON_EXPORT int scon_collectives_base_allreduce_rd(scon_collectives_tracker_t *coll)
+{
+    int to, from, rc;
+
+    scon_output_verbose(2, scon_collectives_base_framework.framework_output,
+                        "%s allreduce: recursive doubling nprocs = %d, on scon=%d",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                        (int)coll->sig->nprocs, coll->sig->scon_handle);
+    if (SCON_SUCCESS != (rc = scon_collectives_base_reduce_contribute(coll))) {
+        goto error;
+    }
+    rd_step(coll, 0, &to, &from);
+    if (0 <= to &&
+        SCON_SUCCESS != (rc = scon_collectives_base_reduce_send(coll, &coll->sig->procs[to],
+                                                                SCON_MSG_TAG_REDUCE_RD))) {
+        goto error;
+    }
+    if (SCON_SUCCESS != (rc = rd_progress(coll))) {
+        goto error;
+    }
+    return SCON_SUCCESS;
+
+error:
+    SCON_ERROR_LOG(rc);
+    scon_collectives_base_reduce_complete(coll, rc, false);
+    return rc;
+}
+
+SCON_EXPORT int scon_collectives_base_reduce_binomial(scon_collectives_tracker_t *coll)
+{
+    int rc;
+
+    scon_output_verbose(2, scon_collectives_base_framework.framework_output,
+                        "%s reduce: binomial tree to %s nprocs = %d, on scon=%d",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                        SCON_PRINT_PROC(&coll->req->post.reduce.root),
+                        (int)coll->sig->nprocs, coll->sig->scon_handle);
+    if (SCON_SUCCESS != (rc = scon_collectives_base_reduce_contribute(coll))) {
+        goto error;
+    }
+    if (SCON_SUCCESS != (rc = binomial_progress(coll))) {
+        goto error;
+    }
+    return SCON_SUCCESS;
+
+error:
+    SCON_ERROR_LOG(rc);
+    scon_collectives_base_reduce_complete(coll, rc, false);
+    return rc;
+}
+
+SCON_EXPORT void scon_collectives_base_reduce_recv(scon_status_t status,
+                                                   scon_handle_t scon_handle,
+                                                   scon_proc_t *peer,
+                                                   scon_buffer_t *buf,
+                                                   scon_msg_tag_t tag,
+                                                   void *cbdata)
+{
+    scon_collectives_signature_t *sig;
+    scon_collectives_tracker_t *coll;
+    int32_t cnt = 1;
+    int rc;
+
+    scon_output_verbose(5, scon_collectives_base_framework.framework_output,
+                        "%s reduce: received contribution from %s on scon=%d",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                        SCON_PRINT_PROC(peer), scon_handle);
+    if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buf, &sig, &cnt, SCON_COLLECTIVES_SIGNATURE))) {
+        SCON_ERROR_LOG(rc);
+        return;
+    }
+    sig->scon_handle = scon_handle;
+    /* check for the tracker and create it if not found */
+    if (NULL == (coll = scon_collectives_base_get_tracker(sig, true))) {
+        SCON_ERROR_LOG(SCON_ERR_NOT_FOUND);
+        SCON_RELEASE(sig);
+        return;
+    }
+    if (coll->sig != sig) {
+        SCON_RELEASE(sig);
+    }
+    if (0 > (rc = scon_collectives_base_reduce_store(coll, peer, buf))) {
+        SCON_ERROR_LOG(rc);
+        return;
+    }
+    /* nothing more to do until we have been called locally */
+    if (NULL == coll->req) {
+        return;
+    }
+    if (coll->req->post.reduce.rooted) {
+        rc = binomial_progress(coll);
+    } else {
+        rc = rd_progress(coll);
+    }
+    if (SCON_SUCCESS != rc) {
+        SCON_ERROR_LOG(rc);
+        scon_collectives_base_reduce_complete(coll, rc, false);
+    }
+}
@@ -12,10 +12,13 @@
 
 #include "src/mca/mca.h"
 #include "src/mca/base/base.h"
+#include "src/buffer_ops/buffer_ops.h"
+#include "src/buffer_ops/types.h"
 #include "src/mca/collectives/base/base.h"
 #include "src/mca/collectives/collectives.h"
 #include "src/mca/comm/base/base.h"
 #include "src/mca/pt2pt/pt2pt.h"
+#include "src/mca/pt2pt/base/base.h"
 #include "src/mca/topology/topology.h"
 #include "src/util/name_fns.h"
 
@@ -55,6 +58,8 @@ static void collectives_base_process_xcast (int fd, short flags, void *cbdata)
     xcast->buf = req->post.xcast.buf ;
     xcast->cbfunc = req->post.xcast.cbfunc;
     xcast->cbdata = req->post.xcast.cbdata;
+    xcast->info = req->post.xcast.info;
+    xcast->ninfo = req->post.xcast.ninfo;
     scon_output_verbose(5, scon_collectives_base_framework.framework_output,
                         " %s calling collectives xcast for tag %d, nprocs =%d, on scon=%d",
                         SCON_PRINT_PROC(SCON_PROC_MY_NAME),
@@ -73,149 +78,13 @@ static void collectives_base_process_xcast (int fd, short flags, void *cbdata)
     SCON_RELEASE(req);
 }
 
-static void collectives_base_process_allgather (int fd, short flags, void *cbdata)
+/* barrier, allgather and reduce requests all go through the
+ * scon's collectives window */
+static void collectives_base_process_coll (int fd, short flags, void *cbdata)
 {
     scon_coll_req_t *req = (scon_coll_req_t*) cbdata;
-    scon_collectives_tracker_t * coll;
-    scon_collectives_signature_t *sig;
-    scon_comm_scon_t *scon;
-    scon_member_t * sm;
-    void *seq_number;
-    int ret;
-    size_t i = 0;
-    scon = scon_comm_base_get_scon(req->post.allgather.scon_handle);
-    sig = SCON_NEW(scon_collectives_signature_t);
-    sig->scon_handle = scon->handle;
-    if(req->post.allgather.nprocs == 0) {
-        sig->nprocs = scon_list_get_size(&scon->members);
-        sig->procs = (scon_proc_t*)malloc(sig->nprocs *
-                                          sizeof(scon_proc_t));
-        SCON_LIST_FOREACH(sm, &scon->members, scon_member_t) {
-            strncpy(sig->procs[i].job_name, sm->name.job_name,  SCON_MAX_JOBLEN);
-            sig->procs[i].rank = sm->name.rank;
-            ++i;
-        }
-
-    }
-    else {
-        sig->nprocs = req->post.allgather.nprocs;
-        sig->procs = (scon_proc_t*)malloc(sig->nprocs *
-                                          sizeof(scon_proc_t));
-        for(i = 0; i < sig->nprocs; i++) {
-            strncpy(sig->procs[i].job_name, req->post.allgather.procs[i].job_name, SCON_MAX_JOBLEN);
-            sig->procs[i].rank = req->post.allgather.procs[i].rank;
-        }
-    }
-
-    ret = scon_hash_table_get_value_ptr(&scon_collectives_base.coll_table,
-                                        (void *)sig->procs,
-                                        sig->nprocs * sizeof(scon_proc_t),
-                                        &seq_number);
-    if (SCON_ERR_NOT_FOUND == ret) {
-        sig->seq_num = 0;
-    } else if (SCON_SUCCESS == ret) {
-        sig->seq_num = *((uint32_t *)(seq_number)) + 1;
-    } else {
-        scon_output(0, " %s SCON collectives base: fatal error sig hash table not initialized",
-                    SCON_PRINT_PROC(SCON_PROC_MY_NAME));
-        scon_output_verbose(0, scon_collectives_base_framework.framework_output,
-                            " %s SCON collectives base: fatal error sig hash table not initialized",
-                            SCON_PRINT_PROC(SCON_PROC_MY_NAME));
-        SCON_ERROR_LOG(ret);
-        SCON_RELEASE(req);
-        return;
-    }
-    ret = scon_hash_table_set_value_ptr(&scon_collectives_base.coll_table,
-                                        (void *)sig->procs, sig->nprocs * sizeof(scon_proc_t), (void *)&sig->seq_num);
-    if (SCON_SUCCESS != ret) {
-        scon_output_verbose(0, scon_collectives_base_framework.framework_output,
-                            " %s SCON collectives base: fatal error sig hash table set failed",
-                            SCON_PRINT_PROC(SCON_PROC_MY_NAME));
-        SCON_ERROR_LOG(ret);
-        SCON_RELEASE(req);
-        return;
-    }
-    /* retrieve an existing tracker, create it if not
-    * already found. The allgather module is responsible
-    * for releasing it upon completion of the collective */
-    coll = scon_collectives_base_get_tracker(sig, true);
-    coll->req = req;
-    scon_output_verbose(5, scon_collectives_base_framework.framework_output,
-                        " %s calling allgather with  nprocs =%lu, on scon=%d buf =%p",
-                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
-                        req->post.allgather.nprocs, req->post.allgather.scon_handle,
-                        (void*)req->post.allgather.buf);
-    scon->collective_module->allgather(coll, req->post.allgather.buf);
-}
 
-static void collectives_base_process_barrier (int fd, short flags, void *cbdata)
-{
-    scon_coll_req_t *req = (scon_coll_req_t*) cbdata;
-    scon_comm_scon_t *scon;
-    scon_collectives_tracker_t * coll;
-    scon_collectives_signature_t *sig;
-    scon_member_t * sm;
-    void *seq_number;
-    int ret;
-    size_t i = 0;
-    scon = scon_comm_base_get_scon(req->post.barrier.scon_handle);
-    sig = SCON_NEW(scon_collectives_signature_t);
-    sig->scon_handle = scon->handle;
-    if(req->post.barrier.nprocs == 0) {
-        sig->nprocs = scon_list_get_size(&scon->members);
-        sig->procs = (scon_proc_t*)malloc(sig->nprocs *
-                                                sizeof(scon_proc_t));
-        SCON_LIST_FOREACH(sm, &scon->members, scon_member_t) {
-            strncpy( sig->procs[i].job_name, sm->name.job_name, SCON_MAX_JOBLEN);
-            sig->procs[i].rank = sm->name.rank;
-            ++i;
-        }
-    }
-    else {
-        sig->nprocs = req->post.barrier.nprocs;
-        sig->procs = (scon_proc_t*)malloc(sig->nprocs *
-                                                sizeof(scon_proc_t));
-        for(i = 0; i < sig->nprocs; i++) {
-            strncpy(sig->procs[i].job_name, req->post.barrier.procs[i].job_name,  SCON_MAX_JOBLEN);
-            sig->procs[i].rank = req->post.barrier.procs[i].rank;
-        }
-    }
-    ret = scon_hash_table_get_value_ptr(&scon_collectives_base.coll_table,
-                                        (void *)sig->procs,
-                                        sig->nprocs * sizeof(scon_proc_t),
-                                        &seq_number);
-    if (SCON_ERR_NOT_FOUND == ret) {
-       sig->seq_num = 0;
-    } else if (SCON_SUCCESS == ret) {
-        sig->seq_num = *((uint32_t *)(seq_number)) + 1;
-    } else {
-        scon_output_verbose(0, scon_collectives_base_framework.framework_output,
-                            " %s SCON collectives base: fatal error sig hash table not initialized",
-                            SCON_PRINT_PROC(SCON_PROC_MY_NAME));
-        SCON_ERROR_LOG(ret);
-        SCON_RELEASE(req);
-        return;
-    }
-    ret = scon_hash_table_set_value_ptr(&scon_collectives_base.coll_table,
-                                        (void *)sig->procs, sig->nprocs * sizeof(scon_proc_t), (void *)&sig->seq_num);
-    if (SCON_SUCCESS != ret) {
-        scon_output_verbose(0, scon_collectives_base_framework.framework_output,
-                            " %s SCON collectives base: fatal error sig hash table set failed",
-                            SCON_PRINT_PROC(SCON_PROC_MY_NAME));
-        SCON_ERROR_LOG(ret);
-        SCON_RELEASE(req);
-        return;
-    }
-    /* retrieve an existing tracker, create it if not
-    * already found. The allgather module is responsible
-    * for releasing it upon completion of the collective */
-    coll = scon_collectives_base_get_tracker(sig, true);
-    coll->req = req;
-    scon_output_verbose(5, scon_collectives_base_framework.framework_output,
-                        " %s calling barrier with  nprocs =%lu, on scon=%d",
-                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
-                         coll->sig->nprocs, req->post.barrier.scon_handle);
-    scon->collective_module->barrier(coll);
+    scon_collectives_base_post(req);
 }
 /* helper functions */
 SCON_EXPORT scon_collectives_tracker_t* scon_collectives_base_get_tracker(
@@ -305,6 +174,22 @@ SCON_EXPORT unsigned int scon_collectives_base_check_distance_recv(scon_collecti
     return scon_bitmap_is_set_bit (&coll->distance_mask_recv, distance);
 }
 
+/* return the position of the given proc in the participant
+ * list of the collective, or -1 if it isn't a participant */
+SCON_EXPORT int scon_collectives_base_member_index(scon_collectives_signature_t *sig,
+                                                   scon_proc_t *proc)
+{
+    size_t n;
+
+    for (n = 0; n < sig->nprocs; n++) {
+        if (SCON_EQUAL == scon_util_compare_name_fields(SCON_NS_CMP_ALL,
+                                                        &sig->procs[n], proc)) {
+            return (int)n;
+        }
+    }
+    return -1;
+}
+
 /* stub functions */
 SCON_EXPORT int collectives_base_api_xcast(scon_handle_t scon_handle,
                                scon_proc_t procs[],
@@ -327,6 +212,7 @@ SCON_EXPORT int collectives_base_api_xcast(scon_handle_t scon_handle,
         /* create a collectives req and do the rest of the processing in
           an event */
         req = SCON_NEW(scon_coll_req_t);
+        req->type = SCON_COLL_REQ_XCAST;
         req->post.xcast.scon_handle = scon_handle ;
         req->post.xcast.buf = buf;
         req->post.xcast.tag = tag;
@@ -370,6 +256,7 @@ SCON_EXPORT int collectives_base_api_barrier(scon_handle_t scon_handle,
         /* create a collectives req and do the rest of the processing in
           an event */
         req = SCON_NEW(scon_coll_req_t);
+        req->type = SCON_COLL_REQ_BARRIER;
         req->post.barrier.scon_handle = scon_handle ;
         req->post.barrier.procs = procs;
         req->post.barrier.nprocs = nprocs;
@@ -382,7 +269,7 @@ SCON_EXPORT int collectives_base_api_barrier(scon_handle_t scon_handle,
                             SCON_PRINT_PROC(SCON_PROC_MY_NAME),
                             scon->handle);
         /* setup the event for rest of the processing  */
-        scon_event_set(scon_globals.evbase, &req->ev, -1, SCON_EV_WRITE, collectives_base_process_barrier, req);
+        scon_event_set(scon_globals.evbase, &req->ev, -1, SCON_EV_WRITE, collectives_base_process_coll, req);
         scon_event_set_priority(&req->ev, SCON_MSG_PRI);
         scon_event_active(&req->ev, SCON_EV_WRITE, 1);
         scon_output_verbose(5, scon_collectives_base_framework.framework_output,
@@ -392,6 +279,30 @@ SCON_EXPORT int collectives_base_api_barrier(scon_handle_t scon_handle,
     }
 }
 
+/* pick up the allgather algorithm keys - the info array is the
+ * user's and may be gone by the time the request is started */
+static void allgather_info(scon_allgather_t *allgather, scon_info_t info[], size_t ninfo)
+{
+    size_t i;
+
+    allgather->algorithm[0] = '\0';
+    allgather->has_size_hint = false;
+    allgather->size_hint = 0;
+    for (i = 0; i < ninfo; i++) {
+        if (0 == strncmp(info[i].key, SCON_COLL_ALGORITHM, SCON_MAX_KEYLEN)) {
+            strncpy(allgather->algorithm, info[i].value.data.string,
+                    SCON_MCA_BASE_MAX_COMPONENT_NAME_LEN);
+            allgather->algorithm[SCON_MCA_BASE_MAX_COMPONENT_NAME_LEN] = '\0';
+            continue;
+        }
+        if (0 == strncmp(info[i].key, SCON_COLL_SIZE_HINT, SCON_MAX_KEYLEN)) {
+            allgather->has_size_hint = true;
+            allgather->size_hint = info[i].value.data.size;
+            continue;
+        }
+    }
+}
+
 SCON_EXPORT int collectives_base_api_allgather(scon_handle_t scon_handle,
                                    scon_proc_t procs[],
                                    size_t nprocs,
@@ -413,6 +324,7 @@ SCON_EXPORT int collectives_base_api_allgather(scon_handle_t scon_handle,
         /* create a collectives req and do the rest of the processing in
           an event */
         req = SCON_NEW(scon_coll_req_t);
+        req->type = SCON_COLL_REQ_ALLGATHER;
         req->post.allgather.scon_handle = scon_handle ;
         req->post.allgather.procs = procs;
         req->post.allgather.nprocs = nprocs;
@@ -421,12 +333,13 @@ SCON_EXPORT int collectives_base_api_allgather(scon_handle_t scon_handle,
         req->post.allgather.cbdata = cbdata;
         req->post.allgather.info = info;
         req->post.allgather.ninfo = ninfo;
+        allgather_info(&req->post.allgather, info, ninfo);
         scon_output_verbose(1, scon_collectives_base_framework.framework_output,
                             "%s collectives_base_api_barrier scon %d ",
                             SCON_PRINT_PROC(SCON_PROC_MY_NAME),
                             scon->handle);
         /* setup the event for rest of the processing  */
-        scon_event_set(scon_globals.evbase, &req->ev, -1, SCON_EV_WRITE, collectives_base_process_allgather, req);
+        scon_event_set(scon_globals.evbase, &req->ev, -1, SCON_EV_WRITE, collectives_base_process_coll, req);
         scon_event_set_priority(&req->ev, SCON_MSG_PRI);
         scon_event_active(&req->ev, SCON_EV_WRITE, 1);
         scon_output_verbose(5, scon_collectives_base_framework.framework_output,
@@ -437,6 +350,130 @@ SCON_EXPORT int collectives_base_api_allgather(scon_handle_t scon_handle,
     return 0;
 }
 
+SCON_EXPORT int collectives_base_api_allgatherv(scon_handle_t scon_handle,
+                                    scon_proc_t procs[],
+                                    size_t nprocs,
+                                    scon_buffer_t *buf,
+                                    scon_allgatherv_cbfunc_t cbfunc,
+                                    void *cbdata,
+                                    scon_info_t info[],
+                                    size_t ninfo)
+{
+    scon_comm_scon_t *scon;
+    scon_coll_req_t *req;
+    /* get the scon object*/
+    if (NULL == (scon = scon_comm_base_get_scon(scon_handle))) {
+        scon_output(0, "collectives_base_api_allgatherv: cannot find the scon with handle %d", scon_handle);
+        return SCON_ERR_NOT_FOUND;
+    }
+    /* same as an allgather, the window delivers the result to the
+     * user's callback with the layout recorded by the module */
+    req = SCON_NEW(scon_coll_req_t);
+    req->type = SCON_COLL_REQ_ALLGATHER;
+    req->indexed = true;
+    req->cbfunc.allgatherv = cbfunc;
+    req->cbdata = cbdata;
+    req->post.allgather.scon_handle = scon_handle;
+    req->post.allgather.procs = procs;
+    req->post.allgather.nprocs = nprocs;
+    req->post.allgather.buf = buf;
+    req->post.allgather.info = info;
+    req->post.allgather.ninfo = ninfo;
+    allgather_info(&req->post.allgather, info, ninfo);
+    scon_output_verbose(1, scon_collectives_base_framework.framework_output,
+                        "%s collectives_base_api_allgatherv scon %d ",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                        scon->handle);
+    /* setup the event for rest of the processing  */
+    scon_event_set(scon_globals.evbase, &req->ev, -1, SCON_EV_WRITE, collectives_base_process_coll, req);
+    scon_event_set_priority(&req->ev, SCON_MSG_PRI);
+    scon_event_active(&req->ev, SCON_EV_WRITE, 1);
+    return SCON_SUCCESS;
+}
+
+SCON_EXPORT int collectives_base_api_reduce(scon_handle_t scon_handle,
+                                scon_proc_t procs[],
+                                size_t nprocs,
+                                const void *sendbuf,
+                                void *recvbuf,
+                                size_t count,
+                                scon_data_type_t type,
+                                scon_reduce_op_t op,
+                                scon_proc_t *root,
+                                scon_reduce_cbfunc_t cbfunc,
+                                void *cbdata,
+                                scon_info_t info[],
+                                size_t ninfo)
+{
+    scon_comm_scon_t *scon;
+    scon_coll_req_t *req;
+    int rc;
+    /* get the scon object*/
+    if( NULL == (scon = scon_comm_base_get_scon(scon_handle)))
+    {
+        scon_output(0, "collectives_base_api_reduce: cannot find the scon with handle %d", scon_handle);
+        return SCON_ERR_NOT_FOUND;
+    }
+    /* reject what we cannot reduce up front so that the error
+     * is reported to the caller rather than in the callback */
+    if (SCON_SUCCESS != (rc = scon_collectives_base_reduce_check(op, type))) {
+        return rc;
+    }
+    if (0 == count || NULL == sendbuf) {
+        return SCON_ERR_BAD_PARAM;
+    }
+    /* create a collectives req and do the rest of the processing in
+      an event */
+    req = SCON_NEW(scon_coll_req_t);
+    req->type = SCON_COLL_REQ_REDUCE;
+    req->post.reduce.scon_handle = scon_handle;
+    req->post.reduce.procs = procs;
+    req->post.reduce.nprocs = nprocs;
+    req->post.reduce.sendbuf = sendbuf;
+    req->post.reduce.recvbuf = recvbuf;
+    req->post.reduce.count = count;
+    req->post.reduce.type = type;
+    req->post.reduce.op = op;
+    req->post.reduce.rooted = false;
+    if (NULL != root) {
+        req->post.reduce.rooted = true;
+        strncpy(req->post.reduce.root.job_name, root->job_name, SCON_MAX_JOBLEN);
+        req->post.reduce.root.rank = root->rank;
+    }
+    req->post.reduce.cbfunc = cbfunc;
+    req->post.reduce.cbdata = cbdata;
+    req->post.reduce.info = info;
+    req->post.reduce.ninfo = ninfo;
+    scon_output_verbose(1, scon_collectives_base_framework.framework_output,
+                        "%s collectives_base_api_reduce scon %d ",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                        scon->handle);
+    /* setup the event for rest of the processing  */
+    scon_event_set(scon_globals.evbase, &req->ev, -1, SCON_EV_WRITE, collectives_base_process_coll, req);
+    scon_event_set_priority(&req->ev, SCON_MSG_PRI);
+    scon_event_active(&req->ev, SCON_EV_WRITE, 1);
+    return SCON_SUCCESS;
+}
+
+/* a send's hold on its tracker - the send completes on the pt2pt
+ * thread, so the hold is dropped from the collectives thread */
+typedef struct {
+    scon_object_t super;
+    scon_event_t ev;
+    scon_collectives_tracker_t *coll;
+} send_hold_t;
+static SCON_CLASS_INSTANCE(send_hold_t, scon_object_t, NULL, NULL);
+
+static void release_send_hold(int fd, short flags, void *cbdata)
+{
+    send_hold_t *hold = (send_hold_t*)cbdata;
+
+    SCON_RELEASE(hold->coll);
+    SCON_RELEASE(hold);
+}
+
+/* the modules send with the tracker as cbdata, retained for the
+ * send, and hand the buffer over to us */
 SCON_EXPORT void scon_collectives_base_allgather_send_complete_callback(
     int status, scon_handle_t scon_handle,
     scon_proc_t* peer,
@@ -444,5 +481,107 @@ SCON_EXPORT void scon_collectives_base_allgather_send_complete_callback(
     scon_msg_tag_t tag,
     void* cbdata)
 {
-    /** TO DO **/
+    send_hold_t *hold;
+
+    if (SCON_SUCCESS != status) {
+        scon_output_verbose(2, scon_collectives_base_framework.framework_output,
+                            "%s collectives: send to %s at tag %d failed with status %d",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                            SCON_PRINT_PROC(peer), tag, status);
+    }
+    if (NULL != buffer) {
+        scon_buffer_destruct(buffer);
+        free(buffer);
+    }
+    if (NULL == cbdata) {
+        return;
+    }
+    hold = SCON_NEW(send_hold_t);
+    hold->coll = (scon_collectives_tracker_t*)cbdata;
+    scon_event_set(scon_globals.evbase, &hold->ev, -1, SCON_EV_WRITE, release_send_hold, hold);
+    scon_event_set_priority(&hold->ev, SCON_MSG_PRI);
+    scon_event_active(&hold->ev, SCON_EV_WRITE, 1);
+}
+
+/* a recv moved to the collectives thread, with the buffer taken
+ * over from the pt2pt layer */
+typedef struct {
+    scon_object_t super;
+    scon_event_t ev;
+    scon_recv_cbfunc_t cbfunc;
+    scon_status_t status;
+    scon_handle_t scon_handle;
+    scon_proc_t peer;
+    scon_buffer_t buf;
+    scon_msg_tag_t tag;
+} recv_shift_t;
+
+static void recv_shift_cons(recv_shift_t *p)
+{
+    scon_buffer_construct(&p->buf);
+}
+static void recv_shift_des(recv_shift_t *p)
+{
+    scon_buffer_destruct(&p->buf);
+}
+static SCON_CLASS_INSTANCE(recv_shift_t, scon_object_t,
+                           recv_shift_cons, recv_shift_des);
+
+static void process_shifted_recv(int fd, short flags, void *cbdata)
+{
+    recv_shift_t *shift = (recv_shift_t*)cbdata;
+
+    shift->cbfunc(shift->status, shift->scon_handle, &shift->peer,
+                  &shift->buf, shift->tag, NULL);
+    SCON_RELEASE(shift);
+}
+
+static void shift_recv(scon_status_t status,
+                       scon_handle_t scon_handle,
+                       scon_proc_t *peer,
+                       scon_buffer_t *buf,
+                       scon_msg_tag_t tag,
+                       void *cbdata)
+{
+    scon_collectives_handler_t *handler = (scon_collectives_handler_t*)cbdata;
+    recv_shift_t *shift;
+
+    shift = SCON_NEW(recv_shift_t);
+    shift->cbfunc = handler->cbfunc;
+    shift->status = status;
+    shift->scon_handle = scon_handle;
+    memcpy(&shift->peer, peer, sizeof(scon_proc_t));
+    shift->buf = *buf;
+    scon_buffer_construct(buf);
+    shift->tag = tag;
+    scon_event_set(scon_globals.evbase, &shift->ev, -1, SCON_EV_WRITE, process_shifted_recv, shift);
+    scon_event_set_priority(&shift->ev, SCON_MSG_PRI);
+    scon_event_active(&shift->ev, SCON_EV_WRITE, 1);
+}
+
+SCON_EXPORT int scon_collectives_base_recv_nb(scon_handle_t scon_handle,
+                                              scon_msg_tag_t tag,
+                                              scon_recv_cbfunc_t cbfunc)
+{
+    scon_collectives_handler_t *handler;
+
+    /* nothing to move if the recvs are delivered on our thread */
+    if (scon_pt2pt_base.pt2pt_evbase == scon_globals.evbase) {
+        return pt2pt_base_api_recv_nb(scon_handle, SCON_PROC_WILDCARD, tag,
+                                      SCON_MSG_PERSISTENT, cbfunc, NULL,
+                                      NULL, 0);
+    }
+    SCON_LIST_FOREACH(handler, &scon_collectives_base.handlers, scon_collectives_handler_t) {
+        if (handler->cbfunc == cbfunc) {
+            break;
+        }
+    }
+    if (&handler->super == scon_list_get_end(&scon_collectives_base.handlers)) {
+        handler = SCON_NEW(scon_collectives_handler_t);
+        handler->cbfunc = cbfunc;
+        scon_list_append(&scon_collectives_base.handlers, &handler->super);
+    }
+    return pt2pt_base_api_recv_nb(scon_handle, SCON_PROC_WILDCARD, tag,
+                                  SCON_MSG_PERSISTENT, shift_recv, handler,
+                                  NULL, 0);
 }
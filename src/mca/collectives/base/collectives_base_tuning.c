@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2017      Intel, Inc.  All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Per call selection of the allgather algorithm.
+ *
+ * The scon's collectives module runs its barriers, reductions and
+ * xcasts, but any module with an allgather_init can run its
+ * allgathers: the receives of their allgather engines are posted on
+ * every scon next to those of the scon's own module. Each allgather
+ * then goes to, in order of precedence:
+ *
+ *  - the component named by the SCON_COLL_ALGORITHM info key
+ *  - the first rule of the tuning file matching the member count and
+ *    the per member payload given with SCON_COLL_SIZE_HINT
+ *  - the cheaper of the tree (default) and Brucks (brucks) allgathers
+ *    under a latency/bandwidth model of the links, for that payload
+ *  - the scon's own module
+ *
+ * Every member has to come to the same decision, so only inputs that
+ * are the same everywhere are used: the member count and the size
+ * hint. The size of our own contribution may differ from the others',
+ * so without a hint only the rules that cover all sizes apply. The
+ * tuning file is written by bench/coll_tune from runs of bench_coll:
+ *
+ *   # comment
+ *   latency <usecs>
+ *   bandwidth <MB/s>
+ *   allgather <min members> <max members> <min bytes> <max bytes> <component>
+ *
+ * where a max of "max" is unbounded. latency and bandwidth override
+ * the link_latency and link_bandwidth MCA params.
+ */
+#include "scon_config.h"
+#include <scon_common.h>
+#include <scon.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/util/output.h"
+#include "src/util/error.h"
+#include "src/util/name_fns.h"
+#include "src/util/bit_ops.h"
+#include "src/include/scon_globals.h"
+
+#include "src/mca/mca.h"
+#include "src/mca/base/base.h"
+#include "src/mca/collectives/base/base.h"
+#include "src/mca/collectives/collectives.h"
+
+static bool parse_bound(const char *str, size_t *bound)
+{
+    char *end;
+
+    if (0 == strcmp(str, "max")) {
+        *bound = SIZE_MAX;
+        return true;
+    }
+    *bound = (size_t)strtoull(str, &end, 10);
+    return ('\0' == *end);
+}
+
+SCON_EXPORT int scon_collectives_base_load_tuning(const char *path)
+{
+    scon_collectives_rule_t *rule;
+    char line[256], op[32], bounds[4][32], comp[SCON_MCA_BASE_MAX_COMPONENT_NAME_LEN + 1];
+    unsigned int lineno = 0;
+    int value;
+    FILE *fp;
+
+    if (NULL == (fp = fopen(path, "r"))) {
+        scon_output(0, "%s collectives: cannot open tuning file %s, "
+                    "the allgather algorithm is picked by the link model",
+                    SCON_PRINT_PROC(SCON_PROC_MY_NAME), path);
+        return SCON_ERR_NOT_FOUND;
+    }
+    while (NULL != fgets(line, sizeof(line), fp)) {
+        ++lineno;
+        if ('#' == line[0] || 1 != sscanf(line, "%31s", op)) {
+            continue;
+        }
+        if (0 == strcmp(op, "latency") && 1 == sscanf(line, "%*s %d", &value) && 0 < value) {
+            scon_collectives_base.link_latency = value;
+            continue;
+        }
+        if (0 == strcmp(op, "bandwidth") && 1 == sscanf(line, "%*s %d", &value) && 0 < value) {
+            scon_collectives_base.link_bandwidth = value;
+            continue;
+        }
+        rule = SCON_NEW(scon_collectives_rule_t);
+        if (0 != strcmp(op, "allgather") ||
+            5 != sscanf(line, "%*s %31s %31s %31s %31s %63s", bounds[0], bounds[1],
+                        bounds[2], bounds[3], comp) ||
+            !parse_bound(bounds[0], &rule->min_members) ||
+            !parse_bound(bounds[1], &rule->max_members) ||
+            !parse_bound(bounds[2], &rule->min_size) ||
+            !parse_bound(bounds[3], &rule->max_size)) {
+            scon_output(0, "%s collectives: ignoring line %u of tuning file %s",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), lineno, path);
+            SCON_RELEASE(rule);
+            continue;
+        }
+        strncpy(rule->component, comp, SCON_MCA_BASE_MAX_COMPONENT_NAME_LEN);
+        scon_list_append(&scon_collectives_base.rules, &rule->super);
+    }
+    fclose(fp);
+    scon_output_verbose(2, scon_collectives_base_framework.framework_output,
+                        "%s collectives: %lu allgather rules read from %s",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                        (unsigned long)scon_list_get_size(&scon_collectives_base.rules), path);
+    return SCON_SUCCESS;
+}
+
+/* init the scon's collectives module, and the allgather engines of
+ * all the others */
+SCON_EXPORT int scon_collectives_base_scon_init(scon_comm_scon_t *scon)
+{
+    scon_collectives_base_component_t *comp;
+    scon_mca_base_component_list_item_t *cli;
+    scon_collectives_module_t *module;
+    int rc;
+
+    if (SCON_SUCCESS != (rc = scon->collective_module->init(scon->handle))) {
+        return rc;
+    }
+    SCON_LIST_FOREACH(cli, &scon_collectives_base_framework.framework_components,
+                      scon_mca_base_component_list_item_t) {
+        comp = (scon_collectives_base_component_t*)cli->cli_component;
+        module = comp->get_module();
+        if (NULL != module && module != scon->collective_module &&
+            NULL != module->allgather_init) {
+            module->allgather_init(scon->handle);
+        }
+    }
+    return SCON_SUCCESS;
+}
+
+/* the module of the named component, if it can run allgathers on
+ * this scon */
+static scon_collectives_module_t* engine(scon_comm_scon_t *scon, char *name)
+{
+    scon_collectives_module_t *module;
+
+    if (NULL == (module = scon_collectives_base_get_module(name)) ||
+        NULL == module->allgather) {
+        return NULL;
+    }
+    if (module != scon->collective_module && NULL == module->allgather_init) {
+        return NULL;
+    }
+    return module;
+}
+
+/* usecs for a tree allgather: the contributions go up to the root and
+ * the result comes back down, so twice the depth in latency, and the
+ * root takes in everything and sends it to each of its children */
+static double tree_cost(size_t nprocs, size_t size)
+{
+    size_t depth = 0, total = 1, width = 1;
+    size_t fanout = (1 < scon_collectives_base.tree_fanout) ?
+                    (size_t)scon_collectives_base.tree_fanout : 2;
+
+    while (total < nprocs) {
+        width *= fanout;
+        total += width;
+        ++depth;
+    }
+    return 2.0 * depth * scon_collectives_base.link_latency +
+           (double)(fanout + 1) * nprocs * size / scon_collectives_base.link_bandwidth;
+}
+
+/* usecs for a Brucks allgather: ceil(log2(n)) rounds, each member
+ * taking in everyone else's contribution once */
+static double brucks_cost(size_t nprocs, size_t size)
+{
+    return (double)scon_cube_dim((int)nprocs) * scon_collectives_base.link_latency +
+           (double)(nprocs - 1) * size / scon_collectives_base.link_bandwidth;
+}
+
+SCON_EXPORT scon_collectives_module_t* scon_collectives_base_allgather_module(scon_comm_scon_t *scon,
+                                                                            scon_coll_req_t *req,
+                                                                            size_t nprocs)
+{
+    scon_allgather_t *allgather = &req->post.allgather;
+    scon_collectives_rule_t *rule;
+    scon_collectives_module_t *module, *tree, *brucks;
+    size_t size;
+
+    if ('\0' != allgather->algorithm[0]) {
+        if (NULL != (module = engine(scon, allgather->algorithm))) {
+            return module;
+        }
+        scon_output_verbose(1, scon_collectives_base_framework.framework_output,
+                            "%s collectives: allgather algorithm %s not available on scon %d",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME), allgather->algorithm,
+                            scon->handle);
+    }
+    /* without a hint the size isn't known alike on all members */
+    size = allgather->has_size_hint ? allgather->size_hint : 0;
+
+    SCON_LIST_FOREACH(rule, &scon_collectives_base.rules, scon_collectives_rule_t) {
+        if (nprocs < rule->min_members || nprocs > rule->max_members) {
+            continue;
+        }
+        if (allgather->has_size_hint ?
+            (size < rule->min_size || size > rule->max_size) :
+            (0 != rule->min_size || SIZE_MAX != rule->max_size)) {
+            continue;
+        }
+        if (NULL != (module = engine(scon, rule->component))) {
+            scon_output_verbose(2, scon_collectives_base_framework.framework_output,
+                                "%s collectives: allgather of %lu members, %lu bytes by rule: %s",
+                                SCON_PRINT_PROC(SCON_PROC_MY_NAME), (unsigned long)nprocs,
+                                (unsigned long)size, rule->component);
+            return module;
+        }
+    }
+    if (!allgather->has_size_hint) {
+        return scon->collective_module;
+    }
+
+    /* no rule - let the model choose between the tree and Brucks */
+    module = scon->collective_module;
+    tree = engine(scon, "default");
+    brucks = engine(scon, "brucks");
+    if (NULL != tree && NULL != brucks) {
+        module = (brucks_cost(nprocs, size) < tree_cost(nprocs, size)) ? brucks : tree;
+    }
+    scon_output_verbose(2, scon_collectives_base_framework.framework_output,
+                        "%s collectives: allgather of %lu members, %lu bytes by model: %s",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), (unsigned long)nprocs,
+                        (unsigned long)size, (module == brucks) ? "brucks" :
+                        (module == tree) ? "default" : "scon module");
+    return module;
+}
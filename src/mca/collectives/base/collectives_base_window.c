@@ -0,0 +1,477 @@
+/*
+ * Copyright (c) 2017      Intel, Inc.  All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Overlapping non-blocking collectives.
+ *
+ * Each scon keeps a window of the collectives issued on it. A
+ * request gets the next seq num for its participant list and its
+ * position in the issue order when it is posted. Up to
+ * max_outstanding requests are handed to the module at a time, the
+ * rest are queued and started as earlier ones complete. Messages
+ * for a seq num we haven't started yet are held by the tracker
+ * created on arrival, so members may run ahead of each other.
+ *
+ * The modules complete into a base callback which delivers to the
+ * user in issue order, holding a completion (and the payload of an
+ * allgather result) until everything issued before it has been
+ * delivered. The window is only touched on the collectives thread -
+ * completions are shifted there from whichever thread the module
+ * finished on. Xcasts are not part of the window.
+ */
+
+#include "scon_config.h"
+#include "scon_common.h"
+
+#include <stddef.h>
+
+#include "src/buffer_ops/buffer_ops.h"
+#include "src/buffer_ops/types.h"
+#include "src/util/output.h"
+#include "src/util/error.h"
+#include "src/util/name_fns.h"
+#include "src/util/perf.h"
+#include "src/util/trace.h"
+#include "src/include/scon_globals.h"
+
+#include "src/mca/comm/base/base.h"
+#include "src/mca/collectives/base/base.h"
+#include "src/mca/collectives/collectives.h"
+
+static void start_coll(int fd, short flags, void *cbdata);
+
+static scon_collectives_window_t* get_window(scon_handle_t scon_handle, bool create)
+{
+    scon_collectives_window_t *w;
+
+    SCON_LIST_FOREACH(w, &scon_collectives_base.windows, scon_collectives_window_t) {
+        if (w->scon_handle == scon_handle) {
+            return w;
+        }
+    }
+    if (!create) {
+        return NULL;
+    }
+    w = SCON_NEW(scon_collectives_window_t);
+    w->scon_handle = scon_handle;
+    scon_list_append(&scon_collectives_base.windows, &w->super);
+    return w;
+}
+
+/* seq nums are never reset, so collectives on the same participants
+ * that overlap can't be confused with each other */
+static int next_seq(scon_collectives_window_t *w, scon_collectives_signature_t *sig)
+{
+    size_t len = sig->nprocs * sizeof(scon_proc_t);
+    uint32_t seq = 0;
+    void *val;
+
+    if (SCON_SUCCESS == scon_hash_table_get_value_ptr(&w->seqs, sig->procs, len, &val)) {
+        seq = (uint32_t)(uintptr_t)val;
+    }
+    sig->seq_num = seq;
+    return scon_hash_table_set_value_ptr(&w->seqs, sig->procs, len,
+                                         (void*)(uintptr_t)(seq + 1));
+}
+
+static scon_collectives_signature_t* build_sig(scon_comm_scon_t *scon,
+                                               scon_proc_t *procs, size_t nprocs)
+{
+    scon_collectives_signature_t *sig;
+    scon_member_t *sm;
+    size_t i = 0;
+
+    sig = SCON_NEW(scon_collectives_signature_t);
+    sig->scon_handle = scon->handle;
+    sig->nprocs = (0 == nprocs) ? scon_list_get_size(&scon->members) : nprocs;
+    /* zero the whole array as the participant list is hashed */
+    if (0 == sig->nprocs ||
+        NULL == (sig->procs = (scon_proc_t*)calloc(sig->nprocs, sizeof(scon_proc_t)))) {
+        SCON_RELEASE(sig);
+        return NULL;
+    }
+    if (0 == nprocs) {
+        SCON_LIST_FOREACH(sm, &scon->members, scon_member_t) {
+            strncpy(sig->procs[i].job_name, sm->name.job_name, SCON_MAX_JOBLEN);
+            sig->procs[i].rank = sm->name.rank;
+            ++i;
+        }
+    } else {
+        for (i = 0; i < nprocs; i++) {
+            strncpy(sig->procs[i].job_name, procs[i].job_name, SCON_MAX_JOBLEN);
+            sig->procs[i].rank = procs[i].rank;
+        }
+    }
+    return sig;
+}
+
+static scon_handle_t req_handle(scon_coll_req_t *req)
+{
+    switch (req->type) {
+        case SCON_COLL_REQ_BARRIER:
+            return req->post.barrier.scon_handle;
+        case SCON_COLL_REQ_ALLGATHER:
+            return req->post.allgather.scon_handle;
+        case SCON_COLL_REQ_REDUCE:
+            return req->post.reduce.scon_handle;
+        default:
+            return SCON_HANDLE_INVALID;
+    }
+}
+
+static void deliver(scon_coll_req_t *req, int status,
+                    scon_buffer_t *buf, void *rresult)
+{
+    scon_allgather_result_t *result;
+
+    if (scon_perf_enabled && 0 != req->posted) {
+        scon_perf_hist_add(SCON_PERF_HIST_COLL_LATENCY,
+                           scon_perf_now_usec() - req->posted);
+        scon_perf_add(SCON_PERF_CTR_COLL_COMPLETED, 1);
+    }
+    SCON_TRACE_ASYNC_END(SCON_TRACE_COLL, (uintptr_t)req, req->type, status);
+    SCON_TRACE_BEGIN(SCON_TRACE_COLL_CB, req->type, status);
+    switch (req->type) {
+        case SCON_COLL_REQ_BARRIER:
+            if (NULL != req->cbfunc.barrier) {
+                req->cbfunc.barrier(status, req->post.barrier.scon_handle,
+                                    req->post.barrier.procs,
+                                    req->post.barrier.nprocs,
+                                    req->post.barrier.info,
+                                    req->post.barrier.ninfo,
+                                    req->cbdata);
+            }
+            break;
+        case SCON_COLL_REQ_ALLGATHER:
+            if (req->indexed) {
+                /* the result stays ours, the user only sees it
+                 * through the layout */
+                result = NULL;
+                if (SCON_SUCCESS == status && NULL != buf) {
+                    if (NULL == req->layout.offsets) {
+                        /* the module didn't record the layout */
+                        status = SCON_ERR_NOT_SUPPORTED;
+                    } else {
+                        req->layout.bytes = buf->unpack_ptr;
+                        result = &req->layout;
+                    }
+                }
+                if (NULL != req->cbfunc.allgatherv) {
+                    req->cbfunc.allgatherv(status, req->post.allgather.scon_handle,
+                                           req->post.allgather.procs,
+                                           req->post.allgather.nprocs, result,
+                                           req->post.allgather.info,
+                                           req->post.allgather.ninfo,
+                                           req->cbdata);
+                }
+                if (NULL != req->result) {
+                    scon_buffer_destruct(req->result);
+                    free(req->result);
+                    req->result = NULL;
+                }
+            } else {
+                if (NULL != req->cbfunc.allgather) {
+                    req->cbfunc.allgather(status, req->post.allgather.scon_handle,
+                                          req->post.allgather.procs,
+                                          req->post.allgather.nprocs, buf,
+                                          req->post.allgather.info,
+                                          req->post.allgather.ninfo,
+                                          req->cbdata);
+                }
+                /* the payload of the result now belongs to the user */
+                if (NULL != req->result) {
+                    free(req->result);
+                    req->result = NULL;
+                }
+            }
+            break;
+        case SCON_COLL_REQ_REDUCE:
+            if (NULL != req->cbfunc.reduce) {
+                req->cbfunc.reduce(status, req->post.reduce.scon_handle,
+                                   req->post.reduce.procs,
+                                   req->post.reduce.nprocs, rresult,
+                                   req->post.reduce.count,
+                                   req->post.reduce.type,
+                                   req->post.reduce.info,
+                                   req->post.reduce.ninfo,
+                                   req->cbdata);
+            }
+            break;
+        default:
+            break;
+    }
+    SCON_TRACE_END(SCON_TRACE_COLL_CB, req->type, status);
+}
+
+/* hand queued requests to the module while there is room */
+static void release_pending(scon_collectives_window_t *w)
+{
+    scon_coll_req_t *req;
+
+    while ((0 >= scon_collectives_base.max_outstanding ||
+            w->active < scon_collectives_base.max_outstanding) &&
+           NULL != (req = (scon_coll_req_t*)scon_list_remove_first(&w->pending))) {
+        w->active++;
+        /* we may be inside a module's completion path, so
+         * start it from the event library */
+        scon_event_set(scon_globals.evbase, &req->ev, -1, SCON_EV_WRITE, start_coll, req);
+        scon_event_set_priority(&req->ev, SCON_MSG_PRI);
+        scon_event_active(&req->ev, SCON_EV_WRITE, 1);
+    }
+}
+
+/* runs on the collectives thread, which owns the windows */
+static void finish_req(int fd, short flags, void *cbdata)
+{
+    scon_coll_req_t *req = (scon_coll_req_t*)cbdata;
+    scon_collectives_window_t *w;
+    scon_coll_req_t *next;
+
+    if (NULL == (w = get_window(req_handle(req), false))) {
+        deliver(req, req->status, req->result, req->rresult);
+        SCON_RELEASE(req);
+        return;
+    }
+    w->active--;
+    if (req->order != w->next_deliver) {
+        scon_output_verbose(5, scon_collectives_base_framework.framework_output,
+                            "%s collectives: request %u complete, holding for %u on scon %d",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME), req->order,
+                            w->next_deliver, w->scon_handle);
+        /* the list takes over our reference */
+        SCON_LIST_FOREACH(next, &w->deferred, scon_coll_req_t) {
+            if ((int32_t)(req->order - next->order) < 0) {
+                break;
+            }
+        }
+        if (next == (scon_coll_req_t*)scon_list_get_end(&w->deferred)) {
+            scon_list_append(&w->deferred, &req->super);
+        } else {
+            scon_list_insert_pos(&w->deferred, &next->super, &req->super);
+        }
+    } else {
+        deliver(req, req->status, req->result, req->rresult);
+        w->next_deliver++;
+        SCON_RELEASE(req);
+        while (NULL != (next = (scon_coll_req_t*)scon_list_get_first(&w->deferred)) &&
+               next != (scon_coll_req_t*)scon_list_get_end(&w->deferred) &&
+               next->order == w->next_deliver) {
+            scon_list_remove_item(&w->deferred, &next->super);
+            deliver(next, next->status, next->result, next->rresult);
+            w->next_deliver++;
+            SCON_RELEASE(next);
+        }
+    }
+    release_pending(w);
+    /* drop the window once the scon is gone and nothing is left on it */
+    if (0 == w->active && 0 == scon_list_get_size(&w->pending) &&
+        0 == scon_list_get_size(&w->deferred) &&
+        NULL == scon_comm_base_get_scon(w->scon_handle)) {
+        scon_list_remove_item(&scon_collectives_base.windows, &w->super);
+        SCON_RELEASE(w);
+    }
+}
+
+/* the modules complete on whichever thread brought in the last
+ * message, so take what they hand us and finish the request
+ * from the collectives thread */
+static void complete_req(scon_coll_req_t *req, int status,
+                         scon_buffer_t *buf, void *rresult)
+{
+    req->status = status;
+    req->rresult = rresult;
+    /* the module's buffer goes away when we return, take
+     * over its payload rather than copying it */
+    if (NULL != buf && SCON_SUCCESS == status) {
+        if (NULL == (req->result = (scon_buffer_t*)malloc(sizeof(scon_buffer_t)))) {
+            req->status = SCON_ERR_OUT_OF_RESOURCE;
+        } else {
+            *req->result = *buf;
+            scon_buffer_construct(buf);
+        }
+    }
+    /* the module releases the request when we return */
+    SCON_RETAIN(req);
+    scon_event_set(scon_globals.evbase, &req->ev, -1, SCON_EV_WRITE, finish_req, req);
+    scon_event_set_priority(&req->ev, SCON_MSG_PRI);
+    scon_event_active(&req->ev, SCON_EV_WRITE, 1);
+}
+
+/* callbacks handed to the modules in place of the user's */
+static void barrier_done(scon_status_t status, scon_handle_t scon_handle,
+                         scon_proc_t procs[], size_t nprocs,
+                         scon_info_t info[], size_t ninfo,
+                         void *cbdata)
+{
+    complete_req((scon_coll_req_t*)cbdata, status, NULL, NULL);
+}
+
+static void allgather_done(scon_status_t status, scon_handle_t scon_handle,
+                           scon_proc_t procs[], size_t nprocs,
+                           scon_buffer_t *buf,
+                           scon_info_t info[], size_t ninfo,
+                           void *cbdata)
+{
+    complete_req((scon_coll_req_t*)cbdata, status, buf, NULL);
+}
+
+static void reduce_done(scon_status_t status, scon_handle_t scon_handle,
+                        scon_proc_t procs[], size_t nprocs,
+                        void *recvbuf, size_t count, scon_data_type_t type,
+                        scon_info_t info[], size_t ninfo,
+                        void *cbdata)
+{
+    complete_req((scon_coll_req_t*)cbdata, status, NULL, recvbuf);
+}
+
+static void install_callback(scon_coll_req_t *req)
+{
+    switch (req->type) {
+        case SCON_COLL_REQ_BARRIER:
+            req->cbfunc.barrier = req->post.barrier.cbfunc;
+            req->cbdata = req->post.barrier.cbdata;
+            req->post.barrier.cbfunc = barrier_done;
+            req->post.barrier.cbdata = req;
+            break;
+        case SCON_COLL_REQ_ALLGATHER:
+            /* an allgatherv came with its callback already set */
+            if (!req->indexed) {
+                req->cbfunc.allgather = req->post.allgather.cbfunc;
+                req->cbdata = req->post.allgather.cbdata;
+            }
+            req->post.allgather.cbfunc = allgather_done;
+            req->post.allgather.cbdata = req;
+            break;
+        case SCON_COLL_REQ_REDUCE:
+            req->cbfunc.reduce = req->post.reduce.cbfunc;
+            req->cbdata = req->post.reduce.cbdata;
+            req->post.reduce.cbfunc = reduce_done;
+            req->post.reduce.cbdata = req;
+            break;
+        default:
+            break;
+    }
+}
+
+/* fail a request that never made it into the window */
+static void reject_req(scon_coll_req_t *req, int rc)
+{
+    deliver(req, rc, NULL, NULL);
+    SCON_RELEASE(req);
+}
+
+static void start_coll(int fd, short flags, void *cbdata)
+{
+    scon_coll_req_t *req = (scon_coll_req_t*)cbdata;
+    scon_collectives_signature_t *sig = req->sig;
+    scon_collectives_tracker_t *coll;
+    scon_comm_scon_t *scon;
+    scon_collectives_module_t *module;
+    scon_reduce_t *reduce;
+
+    if (NULL == (scon = scon_comm_base_get_scon(sig->scon_handle))) {
+        complete_req(req, SCON_ERR_NOT_FOUND, NULL, NULL);
+        SCON_RELEASE(req);
+        return;
+    }
+    /* retrieve an existing tracker, create it if not already
+     * found. The module is responsible for releasing it upon
+     * completion of the collective */
+    req->sig = NULL;
+    coll = scon_collectives_base_get_tracker(sig, true);
+    if (coll->sig != sig) {
+        SCON_RELEASE(sig);
+    }
+    coll->req = req;
+    scon_output_verbose(5, scon_collectives_base_framework.framework_output,
+                        "%s collectives: starting request %u seq %u nprocs = %lu on scon=%d",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), req->order,
+                        coll->sig->seq_num, coll->sig->nprocs, scon->handle);
+    switch (req->type) {
+        case SCON_COLL_REQ_BARRIER:
+            scon->collective_module->barrier(coll);
+            break;
+        case SCON_COLL_REQ_ALLGATHER:
+            /* the algorithm is picked per call - if the one picked
+             * can't do this one, the scon's own module does */
+            module = scon_collectives_base_allgather_module(scon, req, coll->sig->nprocs);
+            if (SCON_ERR_TAKE_NEXT_OPTION == module->allgather(coll, req->post.allgather.buf) &&
+                module != scon->collective_module) {
+                scon->collective_module->allgather(coll, req->post.allgather.buf);
+            }
+            break;
+        case SCON_COLL_REQ_REDUCE:
+            reduce = &req->post.reduce;
+            if (reduce->rooted && NULL != scon->collective_module->reduce) {
+                scon->collective_module->reduce(coll);
+            } else if (!reduce->rooted && NULL != scon->collective_module->allreduce) {
+                scon->collective_module->allreduce(coll);
+            } else {
+                scon_collectives_base_reduce_complete(coll, SCON_ERR_NOT_SUPPORTED, false);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+SCON_EXPORT void scon_collectives_base_post(scon_coll_req_t *req)
+{
+    scon_collectives_window_t *w;
+    scon_comm_scon_t *scon;
+    scon_handle_t scon_handle = req_handle(req);
+    scon_proc_t *procs;
+    size_t nprocs;
+    int rc;
+
+    switch (req->type) {
+        case SCON_COLL_REQ_BARRIER:
+            procs = req->post.barrier.procs;
+            nprocs = req->post.barrier.nprocs;
+            break;
+        case SCON_COLL_REQ_ALLGATHER:
+            procs = req->post.allgather.procs;
+            nprocs = req->post.allgather.nprocs;
+            break;
+        case SCON_COLL_REQ_REDUCE:
+            procs = req->post.reduce.procs;
+            nprocs = req->post.reduce.nprocs;
+            break;
+        default:
+            SCON_ERROR_LOG(SCON_ERR_BAD_PARAM);
+            SCON_RELEASE(req);
+            return;
+    }
+    SCON_TRACE_ASYNC_BEGIN(SCON_TRACE_COLL, (uintptr_t)req, req->type, 0);
+    install_callback(req);
+    if (NULL == (scon = scon_comm_base_get_scon(scon_handle))) {
+        reject_req(req, SCON_ERR_NOT_FOUND);
+        return;
+    }
+    if (NULL == (req->sig = build_sig(scon, procs, nprocs))) {
+        reject_req(req, SCON_ERR_BAD_PARAM);
+        return;
+    }
+    w = get_window(scon_handle, true);
+    if (SCON_SUCCESS != (rc = next_seq(w, req->sig))) {
+        SCON_ERROR_LOG(rc);
+        reject_req(req, rc);
+        return;
+    }
+    req->order = w->next_issue++;
+    if (0 < scon_collectives_base.max_outstanding &&
+        (w->active >= scon_collectives_base.max_outstanding ||
+         0 < scon_list_get_size(&w->pending))) {
+        scon_output_verbose(5, scon_collectives_base_framework.framework_output,
+                            "%s collectives: window full, queueing request %u on scon %d",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME), req->order, scon_handle);
+        scon_list_append(&w->pending, &req->super);
+        return;
+    }
+    w->active++;
+    start_coll(-1, 0, req);
+}
@@ -17,15 +17,14 @@
 #include "scon_common.h"
 
 #include <stddef.h>
-#include <math.h>
 #include "src/buffer_ops/buffer_ops.h"
 #include "src/buffer_ops/types.h"
 #include "src/buffer_ops/internal.h"
-#include "src/class/scon_bitmap.h"
 #include "src/util/bit_ops.h"
 #include "src/util/output.h"
 #include "util/error.h"
 #include "src/util/name_fns.h"
+#include "src/util/trace.h"
 #include "src/include/scon_globals.h"
 #include "src/mca/collectives/base/base.h"
 #include "src/mca/collectives/collectives.h"
@@ -38,6 +37,7 @@ static void finalize(scon_handle_t scon_handle);
 static int allgather(scon_collectives_tracker_t *coll,
                      scon_buffer_t *buf);
 static int barrier(scon_collectives_tracker_t *coll);
+static int allgather_init(scon_handle_t scon_handle);
 
 /* Module def */
 scon_collectives_module_t scon_collectives_brucks_module = {
@@ -45,29 +45,82 @@ scon_collectives_module_t scon_collectives_brucks_module = {
     NULL,
     barrier,
     allgather,
-    finalize
+    scon_collectives_base_allreduce_rd,
+    scon_collectives_base_reduce_binomial,
+    finalize,
+    allgather_init
 };
 
 /* internal functions */
-static void brucks_allgather_process_data(scon_collectives_tracker_t *coll,
-                                          uint32_t distance);
-static int brucks_allgather_send_dist(scon_collectives_tracker_t *coll,
-                                      scon_proc_t *peer,
-                                      uint32_t distance);
+static int brucks_allgather_send_round(scon_collectives_tracker_t *coll,
+                                       uint32_t round);
 static void brucks_allgather_recv_dist(int status,
                                        scon_handle_t handle,
                                        scon_proc_t* sender,
                                        scon_buffer_t* buffer,
                                        scon_msg_tag_t tag,
                                        void* cbdata);
-static void brucks_barrier_recv_dist(int status,
-                                       scon_handle_t handle,
-                                       scon_proc_t* sender,
-                                       scon_buffer_t* buffer,
-                                       scon_msg_tag_t tag,
-                                       void* cbdata);
+static void brucks_allgather_process_recv(int fd, short flags, void *cbdata);
+static void brucks_allgather_progress(scon_collectives_tracker_t *coll);
 static int brucks_finalize_coll(scon_collectives_tracker_t *coll,
                                 int ret);
+
+/* Brucks allgather over the member indices of the collective:
+ * in round k, with d = 2^k, member i sends the first min(d, n - d)
+ * blocks it holds to member i - d and appends the ones it gets from
+ * member i + d. Block j of member i's region is the contribution of
+ * member i + j, so after ceil(log2(n)) rounds everyone holds all n
+ * blocks, rotated by their own index, and puts them in member order
+ * once at the end.
+ *
+ * The region is sent as is - a round's message is the packed
+ * signature followed by the blocks, each a packed size and the raw
+ * bytes - so a send only references a prefix of it and nothing is
+ * copied on the way out. The round is implied by who sent it.
+ *
+ * Messages arrive and sends complete on the pt2pt thread, so both
+ * are handed to the collectives thread the allgather was started
+ * on, and the tracker and region are only ever touched there */
+
+/* caddy for moving a received round or a completed send
+ * to the collectives thread */
+typedef struct {
+    scon_object_t super;
+    scon_event_t ev;
+    scon_proc_t sender;
+    scon_buffer_t buf;
+    scon_collectives_region_t *region;
+} brucks_caddy_t;
+
+static void brucks_caddy_cons(brucks_caddy_t *p)
+{
+    scon_buffer_construct(&p->buf);
+    p->region = NULL;
+}
+static void brucks_caddy_des(brucks_caddy_t *p)
+{
+    scon_buffer_destruct(&p->buf);
+    if (NULL != p->region) {
+        SCON_RELEASE(p->region);
+    }
+}
+static SCON_CLASS_INSTANCE(brucks_caddy_t, scon_object_t,
+                           brucks_caddy_cons, brucks_caddy_des);
+
+static void brucks_caddy_release(int fd, short flags, void *cbdata)
+{
+    brucks_caddy_t *caddy = (brucks_caddy_t*)cbdata;
+
+    SCON_RELEASE(caddy);
+}
+
+/* number of blocks sent in the given round */
+static inline uint32_t brucks_round_blocks(size_t nprocs, uint32_t round)
+{
+    size_t d = (size_t)1 << round;
+
+    return (uint32_t)((d < nprocs - d) ? d : nprocs - d);
+}
 /**
  * Initialize the module
  */
@@ -82,10 +135,12 @@ static int init(scon_handle_t scon_handle)
                            NULL, 0);
     pt2pt_base_api_recv_nb(scon_handle,
                            SCON_PROC_WILDCARD,
-                           SCON_MSG_TAG_BARRIER_BRUCKS,
+                           SCON_MSG_TAG_BARRIER_TOKEN,
                            SCON_MSG_PERSISTENT,
-                           brucks_barrier_recv_dist, NULL,
+                           scon_collectives_base_barrier_recv, NULL,
                            NULL, 0);
+    /* reductions are handled by the base peer to peer engine */
+    scon_collectives_base_recv_nb(scon_handle, SCON_MSG_TAG_REDUCE_RD, scon_collectives_base_reduce_recv);
     return SCON_SUCCESS;
 }
 
@@ -95,191 +150,270 @@ static int init(scon_handle_t scon_handle)
 static void finalize(scon_handle_t scon_handle)
 {
     /* cancel the recv */
-    pt2pt_base_api_recv_cancel(scon_handle, SCON_PROC_WILDCARD, SCON_MSG_TAG_BARRIER_BRUCKS);
+    pt2pt_base_api_recv_cancel(scon_handle, SCON_PROC_WILDCARD, SCON_MSG_TAG_BARRIER_TOKEN);
     pt2pt_base_api_recv_cancel(scon_handle, SCON_PROC_WILDCARD, SCON_MSG_TAG_ALLGATHER_BRUCKS);
+    pt2pt_base_api_recv_cancel(scon_handle, SCON_PROC_WILDCARD, SCON_MSG_TAG_REDUCE_RD);
+}
+
+/**
+ * Post the receive of the allgather alone
+ */
+static int allgather_init(scon_handle_t scon_handle)
+{
+    pt2pt_base_api_recv_nb(scon_handle,
+                           SCON_PROC_WILDCARD,
+                           SCON_MSG_TAG_ALLGATHER_BRUCKS,
+                           SCON_MSG_PERSISTENT,
+                           brucks_allgather_recv_dist, NULL,
+                           NULL, 0);
+    return SCON_SUCCESS;
 }
 
 static int allgather(scon_collectives_tracker_t *coll,
                      scon_buffer_t *buf)
 {
+    scon_collectives_region_t *region;
+    size_t size;
+    char *ptr;
+    int idx, rc;
+
     scon_output_verbose(2,  scon_collectives_base_framework.framework_output,
                         "%s brucks: allgather nprocs =%d, on scon=%d",
                         SCON_PRINT_PROC(SCON_PROC_MY_NAME),
                         (int)coll->sig->nprocs, coll->sig->scon_handle);
-    /* TO DO : set my own rank */
-    coll->my_rank = SCON_PROC_MY_NAME->rank;
-
-    /* record that we contributed */
+    if (0 > (idx = scon_collectives_base_member_index(coll->sig, SCON_PROC_MY_NAME))) {
+        rc = SCON_ERR_NOT_FOUND;
+        goto error;
+    }
+    coll->my_rank = idx;
+    /* the result carries the same buffer type as the contributions */
+    coll->bucket.type = buf->type;
+
+    /* start the region with the header of our messages and our own
+     * data, leaving room for as much again from everyone else so it
+     * doesn't have to grow when the contributions are all alike */
+    region = SCON_NEW(scon_collectives_region_t);
+    coll->region = region;
+    region->ends = (size_t*)malloc(coll->sig->nprocs * sizeof(size_t));
+    region->sizes = (size_t*)malloc(coll->sig->nprocs * sizeof(size_t));
+    if (NULL == region->ends || NULL == region->sizes) {
+        rc = SCON_ERR_OUT_OF_RESOURCE;
+        goto error;
+    }
+    if (SCON_SUCCESS != (rc = scon_bfrop.pack(&region->data, &coll->sig, 1,
+                                              SCON_COLLECTIVES_SIGNATURE))) {
+        goto error;
+    }
+    size = buf->pack_ptr - buf->unpack_ptr;
+    if (SCON_SUCCESS != (rc = scon_bfrop.pack(&region->data, &size, 1, SCON_SIZE))) {
+        goto error;
+    }
+    if (NULL == (ptr = scon_bfrop_buffer_extend(&region->data,
+                      coll->sig->nprocs * (region->data.bytes_used + size)))) {
+        rc = SCON_ERR_OUT_OF_RESOURCE;
+        goto error;
+    }
+    if (0 < size) {
+        memcpy(ptr, buf->unpack_ptr, size);
+        region->data.pack_ptr += size;
+        region->data.bytes_used += size;
+    }
+    region->ends[0] = region->data.bytes_used;
+    region->sizes[0] = size;
+    region->nblocks = 1;
     coll->nreported = 1;
+    coll->round = 0;
 
-    /* mark local data received */
-
-    scon_bitmap_init (&coll->distance_mask_recv, ((uint32_t)log2 (coll->sig->nprocs)) + 1);
-
-    /* start by seeding the collection with our own data */
-    scon_bfrop.copy_payload(&coll->bucket, buf);
+    /* send our block, then take whatever already arrived */
+    if (1 < coll->sig->nprocs &&
+        SCON_SUCCESS != (rc = brucks_allgather_send_round(coll, 0))) {
+        goto error;
+    }
+    brucks_allgather_progress(coll);
+    return SCON_SUCCESS;
 
-    /* process data */
-    brucks_allgather_process_data (coll, 0);
+error:
+    SCON_ERROR_LOG(rc);
+    brucks_finalize_coll(coll, rc);
+    return rc;
+}
 
-    return SCON_SUCCESS;
+static void brucks_allgather_send_complete(int status,
+                                           scon_handle_t scon_handle,
+                                           scon_proc_t* peer,
+                                           scon_buffer_t* buffer,
+                                           scon_msg_tag_t tag,
+                                           void* cbdata)
+{
+    brucks_caddy_t *caddy;
+
+    /* the buffer only borrowed the region's bytes */
+    buffer->base_ptr = NULL;
+    scon_buffer_destruct(buffer);
+    free(buffer);
+    /* let go of the region where it is being grown */
+    caddy = SCON_NEW(brucks_caddy_t);
+    caddy->region = (scon_collectives_region_t*)cbdata;
+    scon_event_set(scon_globals.evbase, &caddy->ev, -1, SCON_EV_WRITE, brucks_caddy_release, caddy);
+    scon_event_set_priority(&caddy->ev, SCON_MSG_PRI);
+    scon_event_active(&caddy->ev, SCON_EV_WRITE, 1);
 }
 
-static int brucks_allgather_send_dist(scon_collectives_tracker_t *coll,
-                                      scon_proc_t *peer,
-                                      uint32_t distance)
+static int brucks_allgather_send_round(scon_collectives_tracker_t *coll,
+                                       uint32_t round)
 {
+    scon_collectives_region_t *region = coll->region;
     scon_buffer_t *send_buf;
+    scon_proc_t *peer;
+    size_t nprocs = coll->sig->nprocs;
+    size_t bytes;
     int rc;
 
+    peer = &coll->sig->procs[(coll->my_rank + nprocs - ((size_t)1 << round)) % nprocs];
+    bytes = region->ends[brucks_round_blocks(nprocs, round) - 1];
+
+    /* point the message at the prefix of the region */
     send_buf = (scon_buffer_t*) malloc(sizeof(scon_buffer_t));
     scon_buffer_construct(send_buf);
-    /* pack the signature */
-    if (SCON_SUCCESS != (rc = scon_bfrop.pack(send_buf, &coll->sig, 1, SCON_COLLECTIVES_SIGNATURE))) {
-        SCON_ERROR_LOG(rc);
-        SCON_RELEASE(send_buf);
-        return rc;
-    }
-    /* pack the current distance */
-    if (SCON_SUCCESS != (rc = scon_bfrop.pack(send_buf, &distance, 1, SCON_INT32))) {
-        SCON_ERROR_LOG(rc);
-        SCON_RELEASE(send_buf);
-        return rc;
-    }
-    /* pack the number of daemons included in the payload */
-    if (SCON_SUCCESS != (rc = scon_bfrop.pack(send_buf, &coll->nreported, 1, SCON_SIZE))) {
-        SCON_ERROR_LOG(rc);
-        SCON_RELEASE(send_buf);
-        return rc;
-    }
-    /* pack the data */
-    if (SCON_SUCCESS != (rc = scon_bfrop.copy_payload(send_buf, &coll->bucket))) {
-        SCON_ERROR_LOG(rc);
-        SCON_RELEASE(send_buf);
-        return rc;
-    }
-
+    send_buf->type = region->data.type;
+    send_buf->base_ptr = region->data.base_ptr;
+    send_buf->pack_ptr = send_buf->base_ptr + bytes;
+    send_buf->unpack_ptr = send_buf->base_ptr;
+    send_buf->bytes_allocated = bytes;
+    send_buf->bytes_used = bytes;
+    SCON_RETAIN(region);
 
+    scon_output_verbose(2,  scon_collectives_base_framework.framework_output,
+                        "%s brucks: allgather sending round %u to %s",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), round,
+                        SCON_PRINT_PROC(peer));
+    SCON_TRACE(SCON_TRACE_COLL_ROUND, round, coll->sig->seq_num);
     if (SCON_SUCCESS != (rc = pt2pt_base_api_send_nb(coll->sig->scon_handle,
                               peer, send_buf,
                               SCON_MSG_TAG_ALLGATHER_BRUCKS,
-                              scon_collectives_base_allgather_send_complete_callback, coll,
+                              brucks_allgather_send_complete, region,
                               NULL, 0))) {
         SCON_ERROR_LOG(rc);
-        SCON_RELEASE(send_buf);
+        send_buf->base_ptr = NULL;
+        scon_buffer_destruct(send_buf);
+        free(send_buf);
+        SCON_RELEASE(region);
         return rc;
-    };
-
+    }
     return SCON_SUCCESS;
 }
 
-static int brucks_allgather_process_buffered (scon_collectives_tracker_t *coll, uint32_t distance) {
-    scon_buffer_t *buffer;
-    size_t nreceived;
-    int32_t cnt = 1;
+/* append the blocks received in the current round to the region */
+static int brucks_allgather_append(scon_collectives_tracker_t *coll,
+                                   scon_buffer_t *buf)
+{
+    scon_collectives_region_t *region = coll->region, *grown;
+    uint32_t n, nblocks;
+    size_t len, base;
+    char *start, *ptr;
+    int32_t cnt;
     int rc;
 
-    /* check whether data for next distance is available*/
-    if (NULL == coll->buffers || NULL == coll->buffers[distance]) {
-        return 0;
+    /* walk the blocks to find where each one ends */
+    nblocks = brucks_round_blocks(coll->sig->nprocs, coll->round);
+    start = buf->unpack_ptr;
+    for (n = region->nblocks; n < region->nblocks + nblocks; n++) {
+        cnt = 1;
+        if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buf, &region->sizes[n], &cnt, SCON_SIZE))) {
+            return rc;
+        }
+        if (region->sizes[n] > (size_t)(buf->pack_ptr - buf->unpack_ptr)) {
+            return SCON_ERR_UNPACK_FAILURE;
+        }
+        buf->unpack_ptr += region->sizes[n];
+        region->ends[n] = buf->unpack_ptr - start;
+    }
+    len = buf->unpack_ptr - start;
+
+    /* grow in place unless a send still points into the region,
+     * in which case we move to a bigger one and leave the old
+     * one to the sends */
+    if (region->data.bytes_allocated - region->data.bytes_used < len &&
+        1 < ((scon_object_t*)region)->obj_reference_count) {
+        grown = SCON_NEW(scon_collectives_region_t);
+        grown->ends = (size_t*)malloc(coll->sig->nprocs * sizeof(size_t));
+        grown->sizes = (size_t*)malloc(coll->sig->nprocs * sizeof(size_t));
+        if (NULL == grown->ends || NULL == grown->sizes ||
+            NULL == (ptr = scon_bfrop_buffer_extend(&grown->data,
+                                                    2 * (region->data.bytes_used + len)))) {
+            SCON_RELEASE(grown);
+            return SCON_ERR_OUT_OF_RESOURCE;
+        }
+        memcpy(ptr, region->data.base_ptr, region->data.bytes_used);
+        grown->data.type = region->data.type;
+        grown->data.pack_ptr += region->data.bytes_used;
+        grown->data.bytes_used = region->data.bytes_used;
+        memcpy(grown->ends, region->ends, coll->sig->nprocs * sizeof(size_t));
+        memcpy(grown->sizes, region->sizes, coll->sig->nprocs * sizeof(size_t));
+        grown->nblocks = region->nblocks;
+        SCON_RELEASE(region);
+        coll->region = region = grown;
+    }
+    if (NULL == (ptr = scon_bfrop_buffer_extend(&region->data, len))) {
+        return SCON_ERR_OUT_OF_RESOURCE;
+    }
+    memcpy(ptr, start, len);
+    base = region->data.bytes_used;
+    region->data.pack_ptr += len;
+    region->data.bytes_used += len;
+    for (n = region->nblocks; n < region->nblocks + nblocks; n++) {
+        region->ends[n] += base;
     }
+    region->nblocks += nblocks;
+    coll->nreported = region->nblocks;
+    return SCON_SUCCESS;
+}
 
-    buffer = coll->buffers[distance];
-    coll->buffers[distance] = NULL;
+/* complete the current round with buf, and start the next one */
+static int brucks_allgather_round(scon_collectives_tracker_t *coll,
+                                  scon_buffer_t *buf)
+{
+    int rc;
 
     scon_output_verbose(2,  scon_collectives_base_framework.framework_output,
-                         "%s brucks: allgather found data for distance =%d",
-                         SCON_PRINT_PROC(SCON_PROC_MY_NAME),
-                        distance);
-    rc = scon_bfrop.unpack (buffer, &nreceived, &cnt, SCON_SIZE);
-    if (SCON_SUCCESS != rc) {
-        SCON_ERROR_LOG(rc);
-        brucks_finalize_coll(coll, rc);
+                        "%s brucks: allgather completing round %u",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), coll->round);
+    if (SCON_SUCCESS != (rc = brucks_allgather_append(coll, buf))) {
         return rc;
     }
-
-    if (SCON_SUCCESS != (rc = scon_bfrop.copy_payload(&coll->bucket, buffer))) {
-        SCON_ERROR_LOG(rc);
-        brucks_finalize_coll(coll, rc);
-        return rc;
+    ++coll->round;
+    if (coll->region->nblocks < coll->sig->nprocs) {
+        return brucks_allgather_send_round(coll, coll->round);
     }
-
-    coll->nreported += nreceived;
-    scon_collectives_base_mark_distance_recv (coll, distance);
-    SCON_RELEASE(buffer);
-    return 1;
+    return SCON_SUCCESS;
 }
 
-static void brucks_allgather_process_data(scon_collectives_tracker_t *coll, uint32_t distance) {
-    /* Communication step:
-     At every step i, rank r:
-     - doubles the distance
-     - sends message containing all data collected so far to rank r - distance
-     - receives message containing all data collected so far from rank (r + distance)
-     */
-    uint32_t log2nprocs = (uint32_t) log2 (coll->sig->nprocs);
-    uint32_t last_round;
-    scon_proc_t peer;
-    int rc, peer_index;
-
-    /* NTH: calculate in which round we should send the final data. this is the first
-     * round in which we have data from at least (coll->sig->nprocs - (1 << log2nprocs))
-     * procs. alternatively we could just send when distance reaches log2nprocs but
-     * that could end up sending more data than needed */
-    last_round = (uint32_t) ceil (log2 ((double) (coll->sig->nprocs - (1 << log2nprocs))));
-
-    while (distance < log2nprocs) {
-        scon_output_verbose(2,  scon_collectives_base_framework.framework_output,
-                             "%s brucks: allgather process distance =%d",
-                             SCON_PRINT_PROC(SCON_PROC_MY_NAME),
-                             distance);
-
-        /* first send my current contents */
-        peer_index = (coll->sig->nprocs + coll->my_rank - (1 << distance)) % coll->sig->nprocs;
-        peer = coll->sig->procs[peer_index];
-
-        brucks_allgather_send_dist(coll, &peer, distance);
-
-        if (distance == last_round) {
-            /* have enough data to send the final round now */
-            peer_index = (coll->sig->nprocs + coll->my_rank - (1 << log2nprocs)) % coll->sig->nprocs;
-            peer = coll->sig->procs[peer_index];
-            brucks_allgather_send_dist(coll, &peer, log2nprocs);
-        }
-
-        rc = brucks_allgather_process_buffered (coll, distance);
-        if (!rc) {
-            break;
-        } else if (rc < 0) {
-            return;
-        }
-
-        ++distance;
-    }
-
-    if (distance == log2nprocs) {
-        if (distance == last_round) {
-            /* need to send the final round now */
-            peer_index = (coll->sig->nprocs + coll->my_rank - (1 << log2nprocs)) % coll->sig->nprocs;
-            peer = coll->sig->procs[peer_index];
-            brucks_allgather_send_dist(coll, &peer, log2nprocs);
-        }
+/* take the rounds that arrived early, and finish if that was all */
+static void brucks_allgather_progress(scon_collectives_tracker_t *coll)
+{
+    scon_buffer_t *buffer;
+    int rc;
 
-        /* check if the final message is already queued */
-        rc = brucks_allgather_process_buffered (coll, distance);
-        if (rc < 0) {
+    while (coll->region->nblocks < coll->sig->nprocs &&
+           NULL != coll->buffers && NULL != coll->buffers[coll->round]) {
+        buffer = coll->buffers[coll->round];
+        coll->buffers[coll->round] = NULL;
+        rc = brucks_allgather_round(coll, buffer);
+        scon_buffer_destruct(buffer);
+        free(buffer);
+        if (SCON_SUCCESS != rc) {
+            SCON_ERROR_LOG(rc);
+            brucks_finalize_coll(coll, rc);
             return;
         }
     }
 
     scon_output_verbose(2,  scon_collectives_base_framework.framework_output,
-                        "%s brucks: allgather nreported =%lu out of nexpected = %lu",
+                        "%s brucks: allgather nreported =%lu out of nprocs = %lu",
                         SCON_PRINT_PROC(SCON_PROC_MY_NAME),
-                        coll->nreported,
-                        coll->nexpected);
-
-    /* if we are done, then complete things. we may get data from more daemons than expected */
-    if (coll->nreported >= coll->sig->nprocs){
+                        (unsigned long)coll->nreported,
+                        (unsigned long)coll->sig->nprocs);
+    if (coll->region->nblocks == coll->sig->nprocs) {
         brucks_finalize_coll(coll, SCON_SUCCESS);
     }
 }
@@ -291,137 +425,163 @@ static void brucks_allgather_recv_dist(int status,
                                        scon_msg_tag_t tag,
                                        void* cbdata)
 {
-    int32_t cnt;
-    int rc;
-    scon_collectives_signature_t *sig;
-    scon_collectives_tracker_t *coll;
-    uint32_t distance;
+    brucks_caddy_t *caddy;
 
     scon_output_verbose(2,  scon_collectives_base_framework.framework_output,
                         "%s brucks: allgather receiving from %s",
                         SCON_PRINT_PROC(SCON_PROC_MY_NAME),
                         SCON_PRINT_PROC(sender));
 
+    /* the payload is ours, take it over rather than copying it */
+    caddy = SCON_NEW(brucks_caddy_t);
+    memcpy(&caddy->sender, sender, sizeof(scon_proc_t));
+    caddy->buf = *buffer;
+    scon_buffer_construct(buffer);
+    scon_event_set(scon_globals.evbase, &caddy->ev, -1, SCON_EV_WRITE, brucks_allgather_process_recv, caddy);
+    scon_event_set_priority(&caddy->ev, SCON_MSG_PRI);
+    scon_event_active(&caddy->ev, SCON_EV_WRITE, 1);
+}
+
+static void brucks_allgather_process_recv(int fd, short flags, void *cbdata)
+{
+    brucks_caddy_t *caddy = (brucks_caddy_t*)cbdata;
+    scon_buffer_t *buffer = &caddy->buf;
+    int32_t cnt;
+    int idx, me, rc;
+    scon_collectives_signature_t *sig;
+    scon_collectives_tracker_t *coll;
+    size_t nprocs, d;
+    uint32_t round;
+
     /* unpack the signature */
     cnt = 1;
     if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buffer, &sig, &cnt, SCON_COLLECTIVES_SIGNATURE))) {
         SCON_ERROR_LOG(rc);
-        return;
+        goto done;
     }
 
     /* check for the tracker and create it if not found */
     if (NULL == (coll = scon_collectives_base_get_tracker (sig, true))) {
         SCON_ERROR_LOG(SCON_ERR_NOT_FOUND);
         SCON_RELEASE(sig);
-        return;
+        goto done;
     }
-    /* unpack the distance */
-    distance = 1;
-    if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buffer, &distance, &cnt, SCON_INT32))) {
+    if (coll->sig != sig) {
         SCON_RELEASE(sig);
-        SCON_ERROR_LOG(rc);
-        brucks_finalize_coll(coll, rc);
-        return;
     }
-    assert(0 == scon_collectives_base_check_distance_recv(coll, distance));
 
-    /* Check whether we can process next distance */
-    if (coll->nreported && (!distance || scon_collectives_base_check_distance_recv(coll, distance - 1))) {
-        size_t nreceived;
+    /* the sender is d = 2^round members ahead of us */
+    nprocs = coll->sig->nprocs;
+    if (0 > (idx = scon_collectives_base_member_index(coll->sig, &caddy->sender))) {
+        SCON_ERROR_LOG(SCON_ERR_NOT_FOUND);
+        goto done;
+    }
+    if (0 > (me = scon_collectives_base_member_index(coll->sig, SCON_PROC_MY_NAME))) {
+        SCON_ERROR_LOG(SCON_ERR_NOT_FOUND);
+        goto done;
+    }
+    d = (idx + nprocs - me) % nprocs;
+    if (0 == d || 0 != (d & (d - 1))) {
+        SCON_ERROR_LOG(SCON_ERR_BAD_PARAM);
+        goto done;
+    }
+    round = scon_cube_dim((int)d);
+
+    if (NULL != coll->region && round == coll->round) {
         scon_output_verbose(2,  scon_collectives_base_framework.framework_output,
-                             "%s grpcomm:coll:brucks data from %d distance received, "
-                             "Process the next distance.",
-                             SCON_PRINT_PROC(SCON_PROC_MY_NAME), distance);
-        /* capture any provided content */
-        rc = scon_bfrop.unpack (buffer, &nreceived, &cnt, SCON_SIZE);
-        if (SCON_SUCCESS != rc) {
-            SCON_RELEASE(sig);
+                             "%s brucks: allgather data for round %u received, "
+                             "processing it.",
+                             SCON_PRINT_PROC(SCON_PROC_MY_NAME), round);
+        if (SCON_SUCCESS != (rc = brucks_allgather_round(coll, buffer))) {
             SCON_ERROR_LOG(rc);
             brucks_finalize_coll(coll, rc);
-            return;
+            goto done;
         }
-        if (SCON_SUCCESS != (rc = scon_bfrop.copy_payload(&coll->bucket, buffer))) {
-            SCON_RELEASE(sig);
-            SCON_ERROR_LOG(rc);
-            brucks_finalize_coll(coll, rc);
-            return;
-        }
-        coll->nreported += nreceived;
-        scon_collectives_base_mark_distance_recv(coll, distance);
-        brucks_allgather_process_data(coll, distance + 1);
-    } else {
-        scon_output_verbose(2,  scon_collectives_base_framework.framework_output,
-                             "%s grpcomm:coll:brucks data from %d distance received, "
-                             "still waiting for data.",
-                             SCON_PRINT_PROC(SCON_PROC_MY_NAME), distance);
-        if (NULL == coll->buffers) {
-            if (NULL == (coll->buffers = (scon_buffer_t **) calloc ((uint32_t) log2 (coll->sig->nprocs) + 1, sizeof(scon_buffer_t *)))) {
-                rc = SCON_ERR_OUT_OF_RESOURCE;
-                SCON_RELEASE(sig);
-                SCON_ERROR_LOG(rc);
-                brucks_finalize_coll(coll, rc);
-                return;
-            }
-        }
-        if (NULL == (coll->buffers[distance] = (scon_buffer_t *) malloc (sizeof(scon_buffer_t)))) {
+        brucks_allgather_progress(coll);
+        goto done;
+    }
+
+    /* either we haven't started yet or it's ahead of the current
+     * round - hold on to it until we get there */
+    scon_output_verbose(2,  scon_collectives_base_framework.framework_output,
+                         "%s brucks: allgather data for round %u received, "
+                         "still waiting for data.",
+                         SCON_PRINT_PROC(SCON_PROC_MY_NAME), round);
+    if (NULL == coll->buffers) {
+        if (NULL == (coll->buffers = (scon_buffer_t **) calloc (scon_cube_dim((int)nprocs),
+                                                                 sizeof(scon_buffer_t *)))) {
             rc = SCON_ERR_OUT_OF_RESOURCE;
-            SCON_RELEASE(sig);
             SCON_ERROR_LOG(rc);
             brucks_finalize_coll(coll, rc);
-            return;
-        }
-        scon_buffer_construct(coll->buffers[distance]);
-        if (SCON_SUCCESS != (rc = scon_bfrop.copy_payload(coll->buffers[distance], buffer))) {
-            SCON_RELEASE(sig);
-            SCON_ERROR_LOG(rc);
-            brucks_finalize_coll(coll, rc);
-            return;
+            goto done;
         }
     }
+    if ((NULL != coll->region && round < coll->round) || NULL != coll->buffers[round]) {
+        /* duplicate - ignore it */
+        goto done;
+    }
+    if (NULL == (coll->buffers[round] = (scon_buffer_t *) malloc (sizeof(scon_buffer_t)))) {
+        rc = SCON_ERR_OUT_OF_RESOURCE;
+        SCON_ERROR_LOG(rc);
+        brucks_finalize_coll(coll, rc);
+        goto done;
+    }
+    *coll->buffers[round] = *buffer;
+    scon_buffer_construct(buffer);
 
-    SCON_RELEASE(sig);
+done:
+    SCON_RELEASE(caddy);
 }
 
 static int brucks_finalize_coll(scon_collectives_tracker_t *coll, int ret)
 {
-    scon_coll_req_t *req = coll->req;
-    scon_output(0, "%s brucks_finalize_coll:brucks allgather/barrier collective complete on scon %d",
-                SCON_PRINT_PROC(SCON_PROC_MY_NAME),
-                coll->sig->scon_handle);
+    scon_collectives_region_t *region = coll->region;
+    size_t n, k, nprocs = coll->sig->nprocs;
+    size_t total = 0, *sizes = NULL;
+    char *ptr;
+
     scon_output_verbose(5,  scon_collectives_base_framework.framework_output,
-                        "%s brucks allgather/barrier collective complete on scon %d",
+                        "%s brucks allgather collective complete on scon %d",
                         SCON_PRINT_PROC(SCON_PROC_MY_NAME),
                         coll->sig->scon_handle);
-    /** TO DO : handle barrier also here **/
-    /* execute the callback */
-    if ((NULL != req) && (NULL != req->post.allgather.cbfunc)) {
-        req->post.allgather.cbfunc(ret, coll->sig->scon_handle, req->post.allgather.procs,
-                               req->post.allgather.nprocs,  &coll->bucket,
-                               req->post.allgather.info,
-                               req->post.allgather.ninfo,
-                               req->post.allgather.cbdata);
+    /* block k of the region came from member my_rank + k, rotate
+     * them into member order and execute the callback */
+    if (SCON_SUCCESS == ret) {
+        if (NULL == (sizes = (size_t*)malloc(nprocs * sizeof(size_t)))) {
+            ret = SCON_ERR_OUT_OF_RESOURCE;
+            goto done;
+        }
+        for (k = 0; k < nprocs; k++) {
+            sizes[(coll->my_rank + k) % nprocs] = region->sizes[k];
+            total += region->sizes[k];
+        }
+        if (0 < total) {
+            if (NULL == (ptr = (char*)malloc(total))) {
+                ret = SCON_ERR_OUT_OF_RESOURCE;
+                goto done;
+            }
+            total = 0;
+            for (n = 0; n < nprocs; n++) {
+                k = (n + nprocs - coll->my_rank) % nprocs;
+                memcpy(ptr + total, region->data.base_ptr + region->ends[k] - region->sizes[k],
+                       region->sizes[k]);
+                total += region->sizes[k];
+            }
+            scon_buffer_load(&coll->bucket, ptr, total);
+        }
+        ret = scon_collectives_base_allgather_set_layout(coll, sizes);
     }
-    else {
-        scon_output(0, "%s brucks_finalize_coll: allgather cbfunc is null",
-                    SCON_PRINT_PROC(SCON_PROC_MY_NAME));
+
+done:
+    if (NULL != sizes) {
+        free(sizes);
     }
-    scon_list_remove_item(&scon_collectives_base.ongoing, &coll->super);
-    SCON_RELEASE(req);
-    SCON_RELEASE(coll);
+    scon_collectives_base_allgather_complete(coll, ret);
     return SCON_SUCCESS;
 }
 
 static int barrier(scon_collectives_tracker_t *coll)
 {
-    return SCON_ERR_NOT_IMPLEMENTED;
+    return scon_collectives_base_barrier_dissemination(coll);
 }
 
-static void brucks_barrier_recv_dist(int status,
-                                     scon_handle_t handle,
-                                     scon_proc_t* sender,
-                                     scon_buffer_t* buffer,
-                                     scon_msg_tag_t tag,
-                                     void* cbdata)
-{
-
-}
@@ -99,31 +99,164 @@ typedef struct {
     scon_info_t *info;
     /* number of info */
     size_t ninfo;
+    /* component whose algorithm was asked for with SCON_COLL_ALGORITHM */
+    char algorithm[SCON_MCA_BASE_MAX_COMPONENT_NAME_LEN + 1];
+    /* payload size given with SCON_COLL_SIZE_HINT */
+    bool has_size_hint;
+    size_t size_hint;
 } scon_allgather_t;
 SCON_EXPORT SCON_CLASS_DECLARATION(scon_allgather_t);
 
-/* collectives request obj */
+/* scon allreduce/reduce req */
+typedef struct {
+    scon_list_item_t super;
+    /*status */
+    int status;
+    /*  scon object */
+    scon_handle_t scon_handle;
+    /* partcipants */
+    scon_proc_t *procs;
+    /* num participants */
+    size_t nprocs;
+    /* my contribution */
+    const void *sendbuf;
+    /* where the result goes */
+    void *recvbuf;
+    /* number of elements */
+    size_t count;
+    /* element type */
+    scon_data_type_t type;
+    /* reduction operator */
+    scon_reduce_op_t op;
+    /* true for a rooted reduce, false for allreduce */
+    bool rooted;
+    /* root of a rooted reduce */
+    scon_proc_t root;
+    /* user's callback function */
+    scon_reduce_cbfunc_t cbfunc;
+    /* user's cbdata */
+    void *cbdata;
+    /* info struct */
+    scon_info_t *info;
+    /* number of info */
+    size_t ninfo;
+} scon_reduce_t;
+SCON_EXPORT SCON_CLASS_DECLARATION(scon_reduce_t);
+
+/* Define a collective signature so we don't need to
+ * track global collective id's */
 typedef struct {
     scon_object_t super;
+    scon_handle_t scon_handle;
+    scon_proc_t *procs;
+    size_t nprocs;
+    uint32_t seq_num;
+} scon_collectives_signature_t;
+SCON_EXPORT SCON_CLASS_DECLARATION(scon_collectives_signature_t);
+
+/* collective carried by a request */
+typedef enum {
+    SCON_COLL_REQ_XCAST,
+    SCON_COLL_REQ_BARRIER,
+    SCON_COLL_REQ_ALLGATHER,
+    SCON_COLL_REQ_REDUCE
+} scon_coll_req_type_t;
+
+/* collectives request obj */
+typedef struct {
+    scon_list_item_t super;
     scon_event_t ev;
+    scon_coll_req_type_t type;
+    /* position in the issue order of the collectives on the scon */
+    uint32_t order;
+    /* usecs when the user posted it, for the latency counters */
+    uint64_t posted;
+    /* signature, held by the request until the collective is started */
+    scon_collectives_signature_t *sig;
+    /* user's callback - the modules are handed a base callback in
+     * post so that completions can be delivered in issue order */
+    union {
+        scon_barrier_cbfunc_t barrier;
+        scon_allgather_cbfunc_t allgather;
+        scon_allgatherv_cbfunc_t allgatherv;
+        scon_reduce_cbfunc_t reduce;
+    } cbfunc;
+    void *cbdata;
+    /* an allgatherv - the result is delivered with the offset and
+     * size of each participant's contribution, set by the module
+     * when it assembles the result */
+    bool indexed;
+    scon_allgather_result_t layout;
+    /* completion held back until the earlier collectives complete */
+    int status;
+    scon_buffer_t *result;
+    void *rresult;
     union {
         scon_xcast_t xcast;
         scon_barrier_t barrier;
         scon_allgather_t allgather;
+        scon_reduce_t reduce;
     }post;
 } scon_coll_req_t;
 SCON_EXPORT SCON_CLASS_DECLARATION(scon_coll_req_t);
 
-/* Define a collective signature so we don't need to
- * track global collective id's */
+/* Slot holding one member's contribution to a collective
+ * whose result is laid out by member index */
+typedef struct {
+    char *bytes;
+    size_t size;
+    bool filled;
+} scon_collectives_slot_t;
+
+/* Reference counted region a collective accumulates what it has
+ * collected so far in, for algorithms that forward it as they go.
+ * A send of a prefix of the region points straight into it and holds
+ * a reference until it completes, so while any are in flight the
+ * region is only appended to, never moved */
 typedef struct {
     scon_object_t super;
-    scon_handle_t scon_handle;
-    scon_proc_t *procs;
-    size_t nprocs;
-    uint32_t seq_num;
-} scon_collectives_signature_t;
-SCON_EXPORT SCON_CLASS_DECLARATION(scon_collectives_signature_t);
+    /* packed signature, followed by the blocks */
+    scon_buffer_t data;
+    /* number of blocks in the region */
+    uint32_t nblocks;
+    /* end of each block in data, and the size of its payload */
+    size_t *ends;
+    size_t *sizes;
+} scon_collectives_region_t;
+SCON_EXPORT SCON_CLASS_DECLARATION(scon_collectives_region_t);
+
+/* Running result of a reduction - count elements of type,
+ * combined with op */
+typedef struct {
+    void *data;
+    size_t count;
+    size_t size;
+    scon_data_type_t type;
+    scon_reduce_op_t op;
+} scon_collectives_reduction_t;
+
+/* Number of 32-bit words in a barrier token - seq num, nprocs,
+ * participant hash and round, in network byte order */
+#define SCON_COLLECTIVES_TOKEN_WORDS 4
+
+/* State of a token based barrier. The tokens and the buffers
+ * wrapping them are allocated once for all rounds when the barrier
+ * starts, the rounds received are tracked in the tracker's
+ * distance_mask_recv bitmap */
+typedef struct {
+    uint32_t nrounds;
+    /* hash of the participant list, identifies the barrier
+     * together with the seq num */
+    uint32_t hash;
+    /* token sends not yet completed */
+    int nsends;
+    /* all rounds received */
+    bool done;
+    /* first error seen */
+    int status;
+    uint32_t *tokens;
+    scon_buffer_t *bufs;
+} scon_collectives_barrier_state_t;
 
 /* Internal component object for tracking ongoing
  * allgather  operations */
@@ -143,6 +276,16 @@ typedef struct {
     scon_bitmap_t distance_mask_recv;
     /* received buckets */
     scon_buffer_t ** buffers;
+    /* current round of a multi-round algorithm */
+    uint32_t round;
+    /* per-member result layout, indexed by position in sig->procs */
+    scon_collectives_slot_t *slots;
+    /* accumulated blocks of a forwarding allgather */
+    scon_collectives_region_t *region;
+    /* result of an allreduce/reduce */
+    scon_collectives_reduction_t reduction;
+    /* token barrier state */
+    scon_collectives_barrier_state_t barrier;
     /* all gather or barrier req */
     scon_coll_req_t *req;
 } scon_collectives_tracker_t;
@@ -172,6 +315,17 @@ typedef int (*scon_collectives_base_module_barrier_fn_t) (scon_collectives_track
  */
 typedef int (*scon_collectives_base_module_allgather_fn_t) (scon_collectives_tracker_t * coll,
                                                            scon_buffer_t *buf);
+/**
+ * scon allreduce - performing a non blocking reduction on all or specific
+ *                  set of scon members, the result is returned to all of them.
+ *                  The operands are described by coll->req->post.reduce
+ */
+typedef int (*scon_collectives_base_module_allreduce_fn_t) (scon_collectives_tracker_t * coll);
+/**
+ * scon reduce - same as allreduce, but the result is only returned
+ *               to the root
+ */
+typedef int (*scon_collectives_base_module_reduce_fn_t) (scon_collectives_tracker_t * coll);
 
 /**
  * Collectives module definition
@@ -181,7 +335,12 @@ struct scon_collectives_module_1_0_0_t  {
     scon_collectives_base_module_xcast_fn_t              xcast;
     scon_collectives_base_module_barrier_fn_t            barrier;
     scon_collectives_base_module_allgather_fn_t          allgather;
+    scon_collectives_base_module_allreduce_fn_t          allreduce;
+    scon_collectives_base_module_reduce_fn_t             reduce;
     scon_collectives_base_module_finalize_fn_t           finalize;
+    /* post the receives of the allgather alone, so that the allgather
+     * of the module can be picked per call on a scon run by another one */
+    scon_collectives_base_module_init_fn_t               allgather_init;
 };
 
 typedef struct scon_collectives_module_1_0_0_t scon_collectives_module_1_0_0_t;
@@ -41,6 +41,7 @@ static int xcast(scon_xcast_t *xcast);
 static int allgather(scon_collectives_tracker_t *coll,
                      scon_buffer_t *buf);
 static int barrier(scon_collectives_tracker_t *coll);
+static int allgather_init(scon_handle_t scon_handle);
 
 /* Module def */
 scon_collectives_module_t scon_collectives_default_module = {
@@ -48,7 +49,10 @@ scon_collectives_module_t scon_collectives_default_module = {
     xcast,
     barrier,
     allgather,
-    finalize
+    scon_collectives_default_allreduce,
+    scon_collectives_default_reduce,
+    finalize,
+    allgather_init
 };
 
 /* internal functions */
@@ -95,31 +99,23 @@ static int init(scon_handle_t scon_handle)
                            SCON_MSG_PERSISTENT,
                            xcast_recv, NULL,
                            NULL, 0);
-    pt2pt_base_api_recv_nb(scon_handle,
-                           SCON_PROC_WILDCARD,
-                           SCON_MSG_TAG_ALLGATHER_DIRECT,
-                           SCON_MSG_PERSISTENT,
-                           allgather_recv, NULL,
-                           NULL, 0);
-    pt2pt_base_api_recv_nb(scon_handle,
-                           SCON_PROC_WILDCARD,
-                           SCON_MSG_TAG_BARRIER_DIRECT,
-                           SCON_MSG_PERSISTENT,
-                           barrier_recv, NULL,
-                           NULL, 0);
+    scon_collectives_base_recv_nb(scon_handle, SCON_MSG_TAG_ALLGATHER_DIRECT, allgather_recv);
+    scon_collectives_base_recv_nb(scon_handle, SCON_MSG_TAG_BARRIER_DIRECT, barrier_recv);
     /* setup recv for  collective (allgather/barrier) release */
+    scon_collectives_base_recv_nb(scon_handle, SCON_MSG_TAG_BARRIER_RELEASE, barrier_release);
+    scon_collectives_base_recv_nb(scon_handle, SCON_MSG_TAG_ALLGATHER_RELEASE, allgather_release);
+    /* setup recv for the pipelined allgather blocks */
+    scon_collectives_base_recv_nb(scon_handle, SCON_MSG_TAG_ALLGATHER_PIPELINE, scon_collectives_default_allgather_pipeline_recv);
+    /* setup recv for the barrier tokens */
     pt2pt_base_api_recv_nb(scon_handle,
                            SCON_PROC_WILDCARD,
-                           SCON_MSG_TAG_BARRIER_RELEASE,
+                           SCON_MSG_TAG_BARRIER_TOKEN,
                            SCON_MSG_PERSISTENT,
-                           barrier_release, NULL,
-                           NULL, 0);
-    pt2pt_base_api_recv_nb(scon_handle,
-                           SCON_PROC_WILDCARD,
-                           SCON_MSG_TAG_ALLGATHER_RELEASE,
-                           SCON_MSG_PERSISTENT,
-                           allgather_release, NULL,
+                           scon_collectives_base_barrier_recv, NULL,
                            NULL, 0);
+    /* setup recvs for the reduction partials and release */
+    scon_collectives_base_recv_nb(scon_handle, SCON_MSG_TAG_REDUCE_DIRECT, scon_collectives_default_reduce_recv);
+    scon_collectives_base_recv_nb(scon_handle, SCON_MSG_TAG_REDUCE_RELEASE, scon_collectives_default_reduce_release);
     return SCON_SUCCESS;
 }
 
@@ -134,9 +130,31 @@ static void finalize(scon_handle_t scon_handle)
     pt2pt_base_api_recv_cancel(scon_handle, SCON_PROC_WILDCARD, SCON_MSG_TAG_BARRIER_DIRECT);
     pt2pt_base_api_recv_cancel(scon_handle, SCON_PROC_WILDCARD, SCON_MSG_TAG_BARRIER_RELEASE);
     pt2pt_base_api_recv_cancel(scon_handle, SCON_PROC_WILDCARD, SCON_MSG_TAG_ALLGATHER_RELEASE);
+    pt2pt_base_api_recv_cancel(scon_handle, SCON_PROC_WILDCARD, SCON_MSG_TAG_ALLGATHER_PIPELINE);
+    pt2pt_base_api_recv_cancel(scon_handle, SCON_PROC_WILDCARD, SCON_MSG_TAG_BARRIER_TOKEN);
+    pt2pt_base_api_recv_cancel(scon_handle, SCON_PROC_WILDCARD, SCON_MSG_TAG_REDUCE_DIRECT);
+    pt2pt_base_api_recv_cancel(scon_handle, SCON_PROC_WILDCARD, SCON_MSG_TAG_REDUCE_RELEASE);
     return;
 }
 
+/**
+ * Post the receives of the tree allgather, which relays its
+ * release down with our own xcast
+ */
+static int allgather_init(scon_handle_t scon_handle)
+{
+    pt2pt_base_api_recv_nb(scon_handle,
+                           SCON_PROC_WILDCARD,
+                           SCON_MSG_TAG_XCAST,
+                           SCON_MSG_PERSISTENT,
+                           xcast_recv, NULL,
+                           NULL, 0);
+    scon_collectives_base_recv_nb(scon_handle, SCON_MSG_TAG_ALLGATHER_DIRECT, allgather_recv);
+    scon_collectives_base_recv_nb(scon_handle, SCON_MSG_TAG_ALLGATHER_RELEASE, allgather_release);
+    scon_collectives_base_recv_nb(scon_handle, SCON_MSG_TAG_ALLGATHER_PIPELINE, scon_collectives_default_allgather_pipeline_recv);
+    return SCON_SUCCESS;
+}
+
 static void xcast_send_complete_callback (int status,
         scon_handle_t scon_handle,
         scon_proc_t* peer,
@@ -192,6 +210,8 @@ static int xcast(scon_xcast_t *xcast)
     scon_buffer_t *xcast_buf;
     scon_collectives_signature_t *sig;
     scon_comm_scon_t *scon;
+    scon_info_t pinfo;
+    uint8_t priority;
     sig = SCON_NEW(scon_collectives_signature_t);
     sig->scon_handle = xcast->scon_handle;
     sig->nprocs = xcast->nprocs;
@@ -216,6 +236,14 @@ static int xcast(scon_xcast_t *xcast)
         SCON_ERROR_LOG(rc);
         goto CLEANUP;
     }
+    /* and the class every hop sends it in */
+    priority = scon_pt2pt_base_priority(SCON_MSG_TAG_XCAST, xcast->info, xcast->ninfo);
+    if (SCON_SUCCESS != (rc = scon_bfrop.pack(xcast_buf, &priority, 1, SCON_UINT8))) {
+        SCON_ERROR_LOG(rc);
+        goto CLEANUP;
+    }
+    memset(&pinfo, 0, sizeof(pinfo));
+    SCON_INFO_LOAD(&pinfo, SCON_MSG_PRIORITY, &priority, SCON_UINT8);
 
     /* copy the payload into the new buffer - this is non-destructive, so our
      * caller is still responsible for releasing any memory in the buffer they
@@ -231,7 +259,7 @@ static int xcast(scon_xcast_t *xcast)
                                SCON_GET_MASTER(scon), xcast_buf,
                                SCON_MSG_TAG_XCAST,
                                xcast_send_complete_callback, xcast,
-                               NULL, 0))) {
+                               &pinfo, 1))) {
         SCON_ERROR_LOG(rc);
         goto CLEANUP;
     }
@@ -261,8 +289,15 @@ CLEANUP:
 static int allgather(scon_collectives_tracker_t *coll,
                      scon_buffer_t *buf)
 {
-    int rc;
+    int rc, algorithm;
     scon_buffer_t *relay;
+
+    /* large results are exchanged directly between members rather
+     * than being funneled through the master */
+    algorithm = scon_collectives_default_allgather_select(coll, buf);
+    if (SCON_COLLECTIVES_DEFAULT_ALLGATHER_TREE != algorithm) {
+        return scon_collectives_default_allgather_pipelined(coll, buf, algorithm);
+    }
     scon_output_verbose(2,  scon_collectives_base_framework.framework_output,
                         "%s allgather  forwarding to ourserlves nprocs =%d, on scon=%d",
                         SCON_PRINT_PROC(SCON_PROC_MY_NAME),
@@ -282,18 +317,22 @@ static int allgather(scon_collectives_tracker_t *coll,
         goto CLEANUP;
     }
 
-    /* pass along the payload */
-    if (SCON_SUCCESS != (rc = scon_bfrop.copy_payload(relay, buf))) {
+    /* our contribution goes straight into its slot, the message
+     * to ourselves carries no blocks and just counts us in */
+    if (SCON_SUCCESS != (rc = scon_collectives_base_allgather_contribute(coll, buf)) ||
+        SCON_SUCCESS != (rc = scon_collectives_base_allgather_pack(coll, relay, 0, 0))) {
         SCON_ERROR_LOG(rc);
         goto CLEANUP;
     }
     /* send the info to ourselves for tracking */
+    SCON_RETAIN(coll);
     if (SCON_SUCCESS != (rc = pt2pt_base_api_send_nb(coll->sig->scon_handle,
                               SCON_PROC_MY_NAME, relay,
                               SCON_MSG_TAG_ALLGATHER_DIRECT,
                               scon_collectives_base_allgather_send_complete_callback,
                               coll,
                               NULL, 0))) {
+        SCON_RELEASE(coll);
         SCON_ERROR_LOG(rc);
         goto CLEANUP;
     }
@@ -307,21 +346,10 @@ CLEANUP:
                         (int)coll->sig->nprocs, coll->sig->scon_handle);
     /* error occured processing allgather, release the  relay buffer
        and call user's callback */
-    //SCON_RELEASE(relay);
+    scon_buffer_destruct(relay);
     free(relay);
     coll->req->post.allgather.status = rc;
-    if (NULL !=  coll->req->post.allgather.cbfunc) {
-        coll->req->post.allgather.cbfunc( coll->req->post.allgather.status,
-                           coll->req->post.allgather.scon_handle,
-                           coll->req->post.allgather.procs,
-                           coll->req->post.allgather.nprocs,
-                           coll->req->post.allgather.buf,
-                           coll->req->post.allgather.info,
-                           coll->req->post.allgather.ninfo,
-                           coll->req->post.allgather.cbdata);
-    }
-    SCON_RELEASE(coll->req);
-    SCON_RELEASE(coll);
+    scon_collectives_base_allgather_complete(coll, rc);
     return rc;
 }
 static int barrier(scon_collectives_tracker_t *coll)
@@ -329,6 +357,10 @@ static int barrier(scon_collectives_tracker_t *coll)
     int rc;
     scon_buffer_t *relay;
     scon_barrier_t *barrier;
+
+    if (!scon_collectives_default_barrier_tree) {
+        return scon_collectives_base_barrier_dissemination(coll);
+    }
     scon_output_verbose(2,  scon_collectives_base_framework.framework_output,
                         "%s barrier  forwarding to ourserlves nprocs =%d, on scon=%d",
                         SCON_PRINT_PROC(SCON_PROC_MY_NAME),
@@ -348,12 +380,14 @@ static int barrier(scon_collectives_tracker_t *coll)
         goto CLEANUP;
     }
     /* send the info to ourselves for tracking */
+    SCON_RETAIN(coll);
     if (SCON_SUCCESS != (rc = pt2pt_base_api_send_nb(coll->sig->scon_handle,
                               SCON_PROC_MY_NAME, relay,
                               SCON_MSG_TAG_BARRIER_DIRECT,
                               scon_collectives_base_allgather_send_complete_callback,
                               coll,
                               NULL, 0))) {
+        SCON_RELEASE(coll);
         SCON_ERROR_LOG(rc);
         goto CLEANUP;
     }
@@ -369,7 +403,7 @@ CLEANUP:
        and call user's callback */
     //SCON_RELEASE(relay);
     free(relay);
-    barrier = (scon_barrier_t*) coll->req;
+    barrier = &coll->req->post.barrier;
     barrier->status = rc;
     if (NULL != barrier->cbfunc) {
         barrier->cbfunc(barrier->status,
@@ -380,7 +414,8 @@ CLEANUP:
                           barrier->ninfo,
                           barrier->cbdata);
     }
-    SCON_RELEASE(barrier);
+    scon_list_remove_item(&scon_collectives_base.ongoing, &coll->super);
+    SCON_RELEASE(coll->req);
     SCON_RELEASE(coll);
     return rc;
 }
@@ -400,6 +435,7 @@ static void allgather_recv(scon_status_t status,
     scon_comm_scon_t *scon;
     scon_xcast_t *xcast;
     scon_proc_t *parent;
+    size_t nstored;
     /* retrieve the scon on which the msg was received */
     if( NULL == (scon = (scon_comm_base_get_scon(scon_handle))))
     {
@@ -431,8 +467,11 @@ static void allgather_recv(scon_status_t status,
 
     /* increment nprocs reported for collective */
     coll->nreported++;
-    /* capture any provided content */
-    scon_bfrop.copy_payload(&coll->bucket, buf);
+    /* store the contributions of the sender's subtree */
+    if (SCON_SUCCESS != (rc = scon_collectives_base_allgather_unpack(coll, buf, &nstored))) {
+        SCON_ERROR_LOG(rc);
+        return;
+    }
     scon_output_verbose(2,  scon_collectives_base_framework.framework_output,
                         "%s collectives:direct allgather recv nexpected %d nrep %d",
                         SCON_PRINT_PROC(SCON_PROC_MY_NAME),
@@ -466,8 +505,14 @@ static void allgather_recv(scon_status_t status,
                 SCON_RELEASE(sig);
                 return;
             }
-            /* transfer the collected bucket */
-            scon_bfrop.copy_payload(reply, &coll->bucket);
+            /* transfer the result, in member order */
+            if (SCON_SUCCESS != (rc = scon_collectives_base_allgather_pack_result(coll, reply))) {
+                SCON_ERROR_LOG(rc);
+                scon_buffer_destruct(reply);
+                free(reply);
+                SCON_RELEASE(sig);
+                return;
+            }
             /* send the release via xcast */
             xcast = SCON_NEW(scon_xcast_t);
             xcast->scon_handle = scon->handle;
@@ -482,7 +527,8 @@ static void allgather_recv(scon_status_t status,
             scon_output_verbose(2,  scon_collectives_base_framework.framework_output,
                                 "%s allgather complete, sending xcast to release",
                                  SCON_PRINT_PROC(SCON_PROC_MY_NAME));
-            scon->collective_module->xcast(xcast);
+            /* our own xcast - the scon may be run by another module */
+            scon_collectives_default_module.xcast(xcast);
             //SCON_RELEASE(reply);
             //free(reply);
         } else {
@@ -507,16 +553,26 @@ static void allgather_recv(scon_status_t status,
                 SCON_PROC_FREE(parent, 1);
                 return;
             }
-            /* transfer the collected bucket */
-            scon_bfrop.copy_payload(reply, &coll->bucket);
+            /* transfer the contributions of our subtree */
+            if (SCON_SUCCESS != (rc = scon_collectives_base_allgather_pack(coll, reply, 0,
+                                                                          coll->sig->nprocs))) {
+                SCON_ERROR_LOG(rc);
+                scon_buffer_destruct(reply);
+                free(reply);
+                SCON_RELEASE(sig);
+                SCON_PROC_FREE(parent, 1);
+                return;
+            }
 
             /* send the info to our parent */
+            SCON_RETAIN(coll);
             if(SCON_SUCCESS != (rc = pt2pt_base_api_send_nb(scon_handle,
                                      parent, reply,
                                      SCON_MSG_TAG_ALLGATHER_DIRECT,
                                      scon_collectives_base_allgather_send_complete_callback,
                                      coll,
                                      NULL, 0))) {
+                SCON_RELEASE(coll);
                 SCON_ERROR_LOG(rc);
                 //SCON_RELEASE(reply);
                 free(reply);
@@ -653,12 +709,14 @@ static void barrier_recv(scon_status_t status,
                 return;
             }
             /* send the info to our parent */
+            SCON_RETAIN(coll);
             if(SCON_SUCCESS != (rc = pt2pt_base_api_send_nb(scon_handle,
                                      parent, reply,
                                      SCON_MSG_TAG_BARRIER_DIRECT,
                                      scon_collectives_base_allgather_send_complete_callback,
                                      coll,
                                      NULL, 0))) {
+                SCON_RELEASE(coll);
                 SCON_ERROR_LOG(rc);
                 //SCON_RELEASE(reply);
                 free(reply);
@@ -690,6 +748,8 @@ static void xcast_recv(scon_status_t status,
     scon_list_t relay_list;
     scon_list_item_t *item;
     scon_proc_t *relay_proc;
+    scon_info_t pinfo;
+    uint8_t priority;
     /* retrieve the scon on which the msg was received */
     if( NULL == (scon = scon_comm_base_get_scon(scon_handle)))
     {
@@ -733,6 +793,14 @@ static void xcast_recv(scon_status_t status,
                             scon_handle);
         return;
     }
+    /* and the class to relay it in */
+    cnt=1;
+    if (SCON_SUCCESS != (ret = scon_bfrop.unpack(buf, &priority, &cnt, SCON_UINT8))) {
+        SCON_ERROR_LOG(ret);
+        return;
+    }
+    memset(&pinfo, 0, sizeof(pinfo));
+    SCON_INFO_LOAD(&pinfo, SCON_MSG_PRIORITY, &priority, SCON_UINT8);
 
     //SCON_RELEASE(sig);
     /* setup a buffer we can pass to ourselves - this just contains
@@ -766,7 +834,7 @@ static void xcast_recv(scon_status_t status,
                                    relay,
                                    SCON_MSG_TAG_XCAST,
                                    xcast_relay_send_complete_callback, NULL,
-                                   NULL, 0)))  {
+                                   &pinfo, 1)))  {
             scon_output_verbose(0,  scon_collectives_base_framework.framework_output,
                                 "%s xcast recv: unable to relay xcast to %s  error %d scon=%d",
                                 SCON_PRINT_PROC(SCON_PROC_MY_NAME),
@@ -853,25 +921,19 @@ static void allgather_release(scon_status_t status,
         return;
     }
 
-    /* execute the callback : TO DO we need to differentiate between a barrier and
-    * allgather here */
     scon_output_verbose(1,  scon_collectives_base_framework.framework_output,
                         "%s allgather_release: calling allgather coll->nreported = %lu ",
                         SCON_PRINT_PROC(SCON_PROC_MY_NAME), coll->nreported);
-    if (NULL != coll->req && NULL !=  coll->req->post.allgather.cbfunc) {
-        scon_output_verbose(1,  scon_collectives_base_framework.framework_output,
-                            "%s allgather_release: calling allgather cbfunc with status = %d",
-                            SCON_PRINT_PROC(SCON_PROC_MY_NAME),
-                            status);
-         coll->req->post.allgather.cbfunc(status, scon_handle,  coll->req->post.allgather.procs,
-                           coll->req->post.allgather.nprocs,  buf,  coll->req->post.allgather.info,
-                           coll->req->post.allgather.ninfo,  coll->req->post.allgather.cbdata);
+    /* the result is already in member order, take it as is */
+    if (SCON_SUCCESS == status) {
+        status = ret;
     }
-    scon_hash_table_remove_value_ptr(&scon_collectives_base.coll_table,
-                                        (void *)coll->sig->procs, coll->sig->nprocs * sizeof(scon_proc_t));
-    scon_list_remove_item(&scon_collectives_base.ongoing, &coll->super);
-    SCON_RELEASE( coll->req);
-    SCON_RELEASE(coll);
+    if (SCON_SUCCESS == status &&
+        SCON_SUCCESS != (rc = scon_collectives_base_allgather_unpack_result(coll, buf))) {
+        SCON_ERROR_LOG(rc);
+        status = rc;
+    }
+    scon_collectives_base_allgather_complete(coll, status);
 }
 
 static void barrier_release(scon_status_t status,
@@ -935,8 +997,6 @@ static void barrier_release(scon_status_t status,
                           coll->req->post.barrier.nprocs, coll->req->post.barrier.info,
                           coll->req->post.barrier.ninfo, coll->req->post.barrier.cbdata);
     }
-    scon_hash_table_remove_value_ptr(&scon_collectives_base.coll_table,
-                                  (void *)coll->sig->procs, coll->sig->nprocs * sizeof(scon_proc_t));
     scon_list_remove_item(&scon_collectives_base.ongoing, &coll->super);
     SCON_RELEASE(coll->req);
     SCON_RELEASE(coll);
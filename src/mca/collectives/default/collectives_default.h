@@ -24,6 +24,47 @@ BEGIN_C_DECLS
 extern scon_collectives_base_component_t mca_collectives_default_component;
 extern scon_collectives_module_t scon_collectives_default_module;
 
+/* allgather algorithms */
+#define SCON_COLLECTIVES_DEFAULT_ALLGATHER_AUTO    0
+#define SCON_COLLECTIVES_DEFAULT_ALLGATHER_TREE    1
+#define SCON_COLLECTIVES_DEFAULT_ALLGATHER_RD      2
+#define SCON_COLLECTIVES_DEFAULT_ALLGATHER_RING    3
+
+/* MCA params */
+extern int scon_collectives_default_allgather_algorithm;
+extern int scon_collectives_default_allgather_tree_max;
+extern int scon_collectives_default_allgather_ring_min;
+extern bool scon_collectives_default_barrier_tree;
+
+/* pipelined allgather engine */
+int scon_collectives_default_allgather_select(scon_collectives_tracker_t *coll,
+                                              scon_buffer_t *buf);
+int scon_collectives_default_allgather_pipelined(scon_collectives_tracker_t *coll,
+                                                 scon_buffer_t *buf,
+                                                 int algorithm);
+void scon_collectives_default_allgather_pipeline_recv(scon_status_t status,
+                                                      scon_handle_t scon_handle,
+                                                      scon_proc_t *peer,
+                                                      scon_buffer_t *buf,
+                                                      scon_msg_tag_t tag,
+                                                      void *cbdata);
+
+/* tree allreduce/reduce */
+int scon_collectives_default_allreduce(scon_collectives_tracker_t *coll);
+int scon_collectives_default_reduce(scon_collectives_tracker_t *coll);
+void scon_collectives_default_reduce_recv(scon_status_t status,
+                                          scon_handle_t scon_handle,
+                                          scon_proc_t *peer,
+                                          scon_buffer_t *buf,
+                                          scon_msg_tag_t tag,
+                                          void *cbdata);
+void scon_collectives_default_reduce_release(scon_status_t status,
+                                             scon_handle_t scon_handle,
+                                             scon_proc_t *peer,
+                                             scon_buffer_t *buf,
+                                             scon_msg_tag_t tag,
+                                             void *cbdata);
+
 END_C_DECLS
 
 #endif
@@ -0,0 +1,333 @@
+/*
+ * Copyright (c) 2017      Intel, Inc.  All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Pipelined allgather engine for the default collectives module.
+ *
+ * Contributions are kept in a per-member slot array on the tracker
+ * (indexed by the member's position in the signature) rather than
+ * being appended to a bucket, so each block is stored once no matter
+ * which route it took. Two exchange patterns are provided:
+ *
+ *  - recursive doubling: log2(N) rounds, in round k a member exchanges
+ *    the 2^k blocks it holds with the member whose index differs in
+ *    bit k. Only used when N is a power of two.
+ *  - ring: N-1 steps, each member forwards the block it received from
+ *    its left neighbor to its right neighbor as soon as it arrives, so
+ *    the transfers pipeline around the ring.
+ *
+ * The result handed to the caller is the concatenation of all
+ * contributions in member order.
+ */
+
+#include "scon_config.h"
+#include "scon_common.h"
+
+#include <stddef.h>
+
+#include "src/buffer_ops/buffer_ops.h"
+#include "src/buffer_ops/types.h"
+#include "src/buffer_ops/internal.h"
+#include "src/class/scon_bitmap.h"
+#include "src/util/output.h"
+#include "src/util/error.h"
+#include "src/util/name_fns.h"
+#include "src/util/trace.h"
+#include "src/include/scon_globals.h"
+
+#include "src/mca/pt2pt/base/base.h"
+#include "src/mca/comm/base/base.h"
+#include "src/mca/collectives/base/base.h"
+#include "src/mca/collectives/collectives.h"
+#include "collectives_default.h"
+
+static int ilog2(size_t n)
+{
+    int l = 0;
+    while (n >>= 1) {
+        ++l;
+    }
+    return l;
+}
+
+/* pick the algorithm for this allgather - the choice has to be the
+ * same on all members, so it is made only from what they all agree
+ * on: the member count and the caller's SCON_COLL_SIZE_HINT. The
+ * size of our own contribution may differ from the others', so
+ * without a hint the allgather goes through the master */
+int scon_collectives_default_allgather_select(scon_collectives_tracker_t *coll,
+                                              scon_buffer_t *buf)
+{
+    size_t nprocs = coll->sig->nprocs;
+    size_t total;
+
+    if (SCON_COLLECTIVES_DEFAULT_ALLGATHER_AUTO != scon_collectives_default_allgather_algorithm) {
+        if (SCON_COLLECTIVES_DEFAULT_ALLGATHER_RD == scon_collectives_default_allgather_algorithm &&
+            0 != (nprocs & (nprocs - 1))) {
+            /* recursive doubling needs a power of two */
+            return SCON_COLLECTIVES_DEFAULT_ALLGATHER_RING;
+        }
+        return scon_collectives_default_allgather_algorithm;
+    }
+    if (nprocs < 3 || NULL == coll->req || !coll->req->post.allgather.has_size_hint) {
+        return SCON_COLLECTIVES_DEFAULT_ALLGATHER_TREE;
+    }
+    total = coll->req->post.allgather.size_hint * nprocs;
+    if (total <= (size_t)scon_collectives_default_allgather_tree_max) {
+        return SCON_COLLECTIVES_DEFAULT_ALLGATHER_TREE;
+    }
+    if (0 == (nprocs & (nprocs - 1)) &&
+        total < (size_t)scon_collectives_default_allgather_ring_min) {
+        return SCON_COLLECTIVES_DEFAULT_ALLGATHER_RD;
+    }
+    return SCON_COLLECTIVES_DEFAULT_ALLGATHER_RING;
+}
+
+/* setup the slots - this may happen on receipt of a block from
+ * a peer, before we have been called locally */
+static int setup_slots(scon_collectives_tracker_t *coll)
+{
+    int rc;
+
+    if (NULL != coll->slots) {
+        return SCON_SUCCESS;
+    }
+    if (SCON_SUCCESS != (rc = scon_collectives_base_allgather_setup(coll))) {
+        return rc;
+    }
+    coll->nreported = 0;
+    coll->round = 0;
+    if (1 < coll->sig->nprocs) {
+        scon_bitmap_init(&coll->distance_mask_recv, ilog2(coll->sig->nprocs));
+    }
+    return SCON_SUCCESS;
+}
+
+/* store a block, taking ownership of the bytes */
+static void store_block(scon_collectives_tracker_t *coll, uint32_t idx,
+                        char *bytes, size_t size)
+{
+    if (scon_collectives_base_allgather_store(coll, idx, bytes, size)) {
+        coll->nreported++;
+    }
+}
+
+/* send the nblocks blocks starting at first to the member at peer_idx */
+static int send_blocks(scon_collectives_tracker_t *coll, uint8_t algorithm,
+                       uint32_t step, size_t peer_idx,
+                       uint32_t first, uint32_t nblocks)
+{
+    scon_buffer_t *send_buf;
+    int rc;
+
+    send_buf = (scon_buffer_t*) malloc(sizeof(scon_buffer_t));
+    scon_buffer_construct(send_buf);
+    if (SCON_SUCCESS != (rc = scon_bfrop.pack(send_buf, &coll->sig, 1, SCON_COLLECTIVES_SIGNATURE))) {
+        goto error;
+    }
+    if (SCON_SUCCESS != (rc = scon_bfrop.pack(send_buf, &algorithm, 1, SCON_UINT8))) {
+        goto error;
+    }
+    if (SCON_SUCCESS != (rc = scon_bfrop.pack(send_buf, &step, 1, SCON_UINT32))) {
+        goto error;
+    }
+    if (SCON_SUCCESS != (rc = scon_collectives_base_allgather_pack(coll, send_buf,
+                                                                   first, nblocks))) {
+        goto error;
+    }
+    scon_output_verbose(5, scon_collectives_base_framework.framework_output,
+                        "%s allgather pipeline: sending %u blocks from %u at step %u to %s",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), nblocks, first, step,
+                        SCON_PRINT_PROC(&coll->sig->procs[peer_idx]));
+    SCON_TRACE(SCON_TRACE_COLL_ROUND, step, coll->sig->seq_num);
+    SCON_RETAIN(coll);
+    if (SCON_SUCCESS != (rc = pt2pt_base_api_send_nb(coll->sig->scon_handle,
+                              &coll->sig->procs[peer_idx], send_buf,
+                              SCON_MSG_TAG_ALLGATHER_PIPELINE,
+                              scon_collectives_base_allgather_send_complete_callback, coll,
+                              NULL, 0))) {
+        SCON_RELEASE(coll);
+        goto error;
+    }
+    return SCON_SUCCESS;
+
+error:
+    SCON_ERROR_LOG(rc);
+    scon_buffer_destruct(send_buf);
+    free(send_buf);
+    return rc;
+}
+
+/* assemble the result in member order and notify the caller */
+static void pipeline_complete(scon_collectives_tracker_t *coll, int status)
+{
+    scon_output_verbose(2, scon_collectives_base_framework.framework_output,
+                        "%s allgather pipeline: complete with status %d on scon %d",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), status,
+                        coll->sig->scon_handle);
+    if (SCON_SUCCESS == status) {
+        status = scon_collectives_base_allgather_assemble(coll);
+    }
+    scon_collectives_base_allgather_complete(coll, status);
+}
+
+/* advance the recursive doubling exchange as far as the
+ * received rounds allow */
+static int rd_progress(scon_collectives_tracker_t *coll)
+{
+    uint32_t nrounds = ilog2(coll->sig->nprocs);
+    size_t peer;
+    int rc;
+
+    while (coll->round < nrounds &&
+           scon_collectives_base_check_distance_recv(coll, coll->round)) {
+        ++coll->round;
+        if (coll->round < nrounds) {
+            /* send everything in my group of 2^round members */
+            peer = coll->my_rank ^ (1 << coll->round);
+            if (SCON_SUCCESS != (rc = send_blocks(coll, SCON_COLLECTIVES_DEFAULT_ALLGATHER_RD,
+                                                  coll->round, peer,
+                                                  (coll->my_rank >> coll->round) << coll->round,
+                                                  1 << coll->round))) {
+                return rc;
+            }
+        }
+    }
+    return SCON_SUCCESS;
+}
+
+int scon_collectives_default_allgather_pipelined(scon_collectives_tracker_t *coll,
+                                                 scon_buffer_t *buf,
+                                                 int algorithm)
+{
+    int rc;
+
+    scon_output_verbose(2, scon_collectives_base_framework.framework_output,
+                        "%s allgather pipeline: %s nprocs = %d, on scon=%d",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                        (SCON_COLLECTIVES_DEFAULT_ALLGATHER_RD == algorithm) ? "recursive doubling" : "ring",
+                        (int)coll->sig->nprocs, coll->sig->scon_handle);
+
+    /* seed my own slot */
+    if (SCON_SUCCESS != (rc = setup_slots(coll)) ||
+        SCON_SUCCESS != (rc = scon_collectives_base_allgather_contribute(coll, buf))) {
+        SCON_ERROR_LOG(rc);
+        scon_collectives_base_allgather_complete(coll, rc);
+        return rc;
+    }
+    coll->nreported++;
+
+    if (SCON_COLLECTIVES_DEFAULT_ALLGATHER_RD == algorithm) {
+        rc = send_blocks(coll, algorithm, 0, coll->my_rank ^ 1, coll->my_rank, 1);
+        if (SCON_SUCCESS == rc) {
+            rc = rd_progress(coll);
+        }
+    } else {
+        rc = send_blocks(coll, algorithm, 0, (coll->my_rank + 1) % coll->sig->nprocs,
+                         coll->my_rank, 1);
+    }
+    if (SCON_SUCCESS != rc) {
+        pipeline_complete(coll, rc);
+        return rc;
+    }
+    if (coll->nreported == coll->sig->nprocs) {
+        pipeline_complete(coll, SCON_SUCCESS);
+    }
+    return SCON_SUCCESS;
+}
+
+void scon_collectives_default_allgather_pipeline_recv(scon_status_t status,
+                                                      scon_handle_t scon_handle,
+                                                      scon_proc_t *peer,
+                                                      scon_buffer_t *buf,
+                                                      scon_msg_tag_t tag,
+                                                      void *cbdata)
+{
+    scon_collectives_signature_t *sig;
+    scon_collectives_tracker_t *coll;
+    scon_byte_object_t bo;
+    uint32_t step, nblocks, n, idx;
+    uint8_t algorithm;
+    int32_t cnt;
+    int rc;
+
+    scon_output_verbose(5, scon_collectives_base_framework.framework_output,
+                        "%s allgather pipeline: received blocks from %s on scon=%d",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                        SCON_PRINT_PROC(peer), scon_handle);
+    cnt = 1;
+    if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buf, &sig, &cnt, SCON_COLLECTIVES_SIGNATURE))) {
+        SCON_ERROR_LOG(rc);
+        return;
+    }
+    sig->scon_handle = scon_handle;
+    /* check for the tracker and create it if not found */
+    if (NULL == (coll = scon_collectives_base_get_tracker(sig, true))) {
+        SCON_ERROR_LOG(SCON_ERR_NOT_FOUND);
+        SCON_RELEASE(sig);
+        return;
+    }
+    if (coll->sig != sig) {
+        SCON_RELEASE(sig);
+    }
+    if (SCON_SUCCESS != (rc = setup_slots(coll))) {
+        SCON_ERROR_LOG(rc);
+        return;
+    }
+    cnt = 1;
+    if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buf, &algorithm, &cnt, SCON_UINT8))) {
+        goto error;
+    }
+    cnt = 1;
+    if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buf, &step, &cnt, SCON_UINT32))) {
+        goto error;
+    }
+    cnt = 1;
+    if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buf, &nblocks, &cnt, SCON_UINT32))) {
+        goto error;
+    }
+    for (n = 0; n < nblocks; n++) {
+        cnt = 1;
+        if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buf, &idx, &cnt, SCON_UINT32))) {
+            goto error;
+        }
+        cnt = 1;
+        if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buf, &bo, &cnt, SCON_BYTE_OBJECT))) {
+            goto error;
+        }
+        store_block(coll, idx, bo.bytes, bo.size);
+        /* in a ring, pass the block along right away - this doesn't
+         * depend on our own contribution so it is done even if the
+         * local allgather hasn't been called yet */
+        if (SCON_COLLECTIVES_DEFAULT_ALLGATHER_RING == algorithm &&
+            step + 2 < coll->sig->nprocs) {
+            if (SCON_SUCCESS != (rc = send_blocks(coll, algorithm, step + 1,
+                                                  (coll->my_rank + 1) % coll->sig->nprocs,
+                                                  idx, 1))) {
+                goto error;
+            }
+        }
+    }
+    if (SCON_COLLECTIVES_DEFAULT_ALLGATHER_RD == algorithm) {
+        scon_collectives_base_mark_distance_recv(coll, step);
+        /* we can only move on once our own data is in */
+        if (NULL != coll->req &&
+            SCON_SUCCESS != (rc = rd_progress(coll))) {
+            goto error;
+        }
+    }
+    if (NULL != coll->req && coll->nreported == coll->sig->nprocs) {
+        pipeline_complete(coll, SCON_SUCCESS);
+    }
+    return;
+
+error:
+    SCON_ERROR_LOG(rc);
+    if (NULL != coll->req) {
+        pipeline_complete(coll, rc);
+    }
+}
@@ -21,6 +21,12 @@
 #include "collectives_default.h"
 
 static scon_collectives_module_t* default_get_module(void);
+static int default_register(void);
+
+int scon_collectives_default_allgather_algorithm = SCON_COLLECTIVES_DEFAULT_ALLGATHER_AUTO;
+int scon_collectives_default_allgather_tree_max = 8192;
+int scon_collectives_default_allgather_ring_min = 1048576;
+bool scon_collectives_default_barrier_tree = false;
 
 /**
  * component definition
@@ -36,10 +42,49 @@ SCON_EXPORT scon_collectives_base_component_t mca_collectives_default_component
             SCON_MCA_BASE_MAKE_VERSION(component, SCON_MAJOR_VERSION,
             SCON_MINOR_VERSION,
             SCON_RELEASE_VERSION),
+            .scon_mca_register_component_params = default_register,
         },
         .get_module = default_get_module
 };
 
+static int default_register(void)
+{
+    scon_mca_base_component_t *component = &mca_collectives_default_component.base_version;
+
+    (void)scon_mca_base_component_var_register(component, "allgather_algorithm",
+                                          "Allgather algorithm (0: select by member count and the SCON_COLL_SIZE_HINT of the call, 1: gather to master "
+                                          "and release, 2: recursive doubling, 3: ring). All members must use the same value",
+                                          SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &scon_collectives_default_allgather_algorithm);
+
+    (void)scon_mca_base_component_var_register(component, "allgather_tree_max",
+                                          "Largest allgather result (in bytes, estimated as the SCON_COLL_SIZE_HINT of the call times "
+                                          "number of members) handled by gathering to the master - calls without the hint always are",
+                                          SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &scon_collectives_default_allgather_tree_max);
+
+    (void)scon_mca_base_component_var_register(component, "allgather_ring_min",
+                                          "Smallest allgather result (in bytes) for which the ring algorithm is "
+                                          "preferred over recursive doubling",
+                                          SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &scon_collectives_default_allgather_ring_min);
+
+    (void)scon_mca_base_component_var_register(component, "barrier_tree",
+                                          "Gather barrier arrivals at the master and release by xcast instead of "
+                                          "using the dissemination barrier. All members must use the same value",
+                                          SCON_MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &scon_collectives_default_barrier_tree);
+    return SCON_SUCCESS;
+}
+
 static scon_collectives_module_t* default_get_module()
 {
     return &scon_collectives_default_module ;
@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2017      Intel, Inc.  All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Tree reduction for the default collectives module.
+ *
+ * This follows the same routing tree as the default allgather, but
+ * partial results are combined at every hop instead of being
+ * concatenated, so each link carries a single vector. Once the
+ * master holds the full result it either xcasts it to everyone
+ * (allreduce) or sends it to the root (reduce).
+ */
+
+#include "scon_config.h"
+#include "scon_common.h"
+
+#include <stddef.h>
+
+#include "src/buffer_ops/buffer_ops.h"
+#include "src/buffer_ops/types.h"
+#include "src/buffer_ops/internal.h"
+#include "src/util/output.h"
+#include "src/util/error.h"
+#include "src/util/name_fns.h"
+#include "src/include/scon_globals.h"
+
+#include "src/mca/pt2pt/base/base.h"
+#include "src/mca/comm/base/base.h"
+#include "src/mca/collectives/base/base.h"
+#include "src/mca/collectives/collectives.h"
+#include "collectives_default.h"
+
+/* build the release message carrying the final result */
+static scon_buffer_t* pack_release(scon_collectives_tracker_t *coll)
+{
+    scon_buffer_t *reply;
+    scon_byte_object_t bo;
+    int rc, ret = SCON_SUCCESS;
+
+    reply = (scon_buffer_t*) malloc(sizeof(scon_buffer_t));
+    scon_buffer_construct(reply);
+    if (SCON_SUCCESS != (rc = scon_bfrop.pack(reply, &coll->sig, 1, SCON_COLLECTIVES_SIGNATURE))) {
+        goto error;
+    }
+    if (SCON_SUCCESS != (rc = scon_bfrop.pack(reply, &ret, 1, SCON_INT))) {
+        goto error;
+    }
+    bo.bytes = (char*)coll->reduction.data;
+    bo.size = coll->reduction.count * coll->reduction.size;
+    if (SCON_SUCCESS != (rc = scon_bfrop.pack(reply, &bo, 1, SCON_BYTE_OBJECT))) {
+        goto error;
+    }
+    return reply;
+
+error:
+    SCON_ERROR_LOG(rc);
+    scon_buffer_destruct(reply);
+    free(reply);
+    return NULL;
+}
+
+/* move the result along once our whole subtree has reported */
+static int tree_progress(scon_collectives_tracker_t *coll)
+{
+    scon_reduce_t *reduce = &coll->req->post.reduce;
+    scon_comm_scon_t *scon;
+    scon_buffer_t *reply;
+    scon_xcast_t *xcast;
+    scon_proc_t parent;
+    bool am_root;
+    int rc;
+
+    if (coll->nreported < coll->nexpected) {
+        return SCON_SUCCESS;
+    }
+    if (NULL == (scon = scon_comm_base_get_scon(coll->sig->scon_handle))) {
+        return SCON_ERR_NOT_FOUND;
+    }
+    am_root = reduce->rooted &&
+              SCON_EQUAL == scon_util_compare_name_fields(SCON_NS_CMP_ALL,
+                                                          &reduce->root, SCON_PROC_MY_NAME);
+    if (!is_master(scon)) {
+        parent = scon->topology_module->api.get_nexthop(&scon->topology_module->topology,
+                                                        SCON_GET_MASTER(scon));
+        scon_output_verbose(2,  scon_collectives_base_framework.framework_output,
+                            "%s collectives:default reduce rollup complete, "
+                            "sending result to parent %s",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                            SCON_PRINT_PROC(&parent));
+        if (SCON_SUCCESS != (rc = scon_collectives_base_reduce_send(coll, &parent,
+                                                                    SCON_MSG_TAG_REDUCE_DIRECT))) {
+            return rc;
+        }
+        /* in a rooted reduce only the root waits for the result */
+        if (reduce->rooted && !am_root) {
+            scon_collectives_base_reduce_complete(coll, SCON_SUCCESS, false);
+        }
+        return SCON_SUCCESS;
+    }
+    if (am_root) {
+        scon_collectives_base_reduce_complete(coll, SCON_SUCCESS, true);
+        return SCON_SUCCESS;
+    }
+    if (NULL == (reply = pack_release(coll))) {
+        return SCON_ERR_PACK_FAILURE;
+    }
+    if (reduce->rooted) {
+        scon_output_verbose(2,  scon_collectives_base_framework.framework_output,
+                            "%s reduce complete, sending result to root %s",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                            SCON_PRINT_PROC(&reduce->root));
+        SCON_RETAIN(coll);
+        if (SCON_SUCCESS != (rc = pt2pt_base_api_send_nb(coll->sig->scon_handle,
+                                  &reduce->root, reply,
+                                  SCON_MSG_TAG_REDUCE_RELEASE,
+                                  scon_collectives_base_allgather_send_complete_callback, coll,
+                                  NULL, 0))) {
+            SCON_RELEASE(coll);
+            scon_buffer_destruct(reply);
+            free(reply);
+            return rc;
+        }
+        scon_collectives_base_reduce_complete(coll, SCON_SUCCESS, false);
+        return SCON_SUCCESS;
+    }
+    /* send the release via xcast - we get it back ourselves too */
+    xcast = SCON_NEW(scon_xcast_t);
+    xcast->scon_handle = scon->handle;
+    xcast->procs = coll->sig->procs;
+    xcast->nprocs = coll->sig->nprocs;
+    xcast->buf = reply;
+    xcast->tag = SCON_MSG_TAG_REDUCE_RELEASE;
+    xcast->cbfunc = NULL;
+    xcast->cbdata = NULL;
+    xcast->info = NULL;
+    xcast->ninfo = 0;
+    scon_output_verbose(2,  scon_collectives_base_framework.framework_output,
+                        "%s allreduce complete, sending xcast to release",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME));
+    scon->collective_module->xcast(xcast);
+    return SCON_SUCCESS;
+}
+
+static int tree_start(scon_collectives_tracker_t *coll)
+{
+    size_t n;
+    int rc;
+
+    scon_output_verbose(2,  scon_collectives_base_framework.framework_output,
+                        "%s %s tree nprocs =%d, on scon=%d",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                        coll->req->post.reduce.rooted ? "reduce" : "allreduce",
+                        (int)coll->sig->nprocs, coll->sig->scon_handle);
+    if (SCON_SUCCESS != (rc = scon_collectives_base_reduce_contribute(coll))) {
+        goto error;
+    }
+    /* fold in whatever our children sent ahead of us */
+    for (n = 0; n < coll->sig->nprocs; n++) {
+        if (coll->slots[n].filled &&
+            SCON_SUCCESS != (rc = scon_collectives_base_reduce_fold(coll, n))) {
+            goto error;
+        }
+    }
+    if (SCON_SUCCESS != (rc = tree_progress(coll))) {
+        goto error;
+    }
+    return SCON_SUCCESS;
+
+error:
+    SCON_ERROR_LOG(rc);
+    scon_collectives_base_reduce_complete(coll, rc, false);
+    return rc;
+}
+
+int scon_collectives_default_allreduce(scon_collectives_tracker_t *coll)
+{
+    return tree_start(coll);
+}
+
+int scon_collectives_default_reduce(scon_collectives_tracker_t *coll)
+{
+    return tree_start(coll);
+}
+
+void scon_collectives_default_reduce_recv(scon_status_t status,
+                                          scon_handle_t scon_handle,
+                                          scon_proc_t *peer,
+                                          scon_buffer_t *buf,
+                                          scon_msg_tag_t tag,
+                                          void *cbdata)
+{
+    scon_collectives_signature_t *sig;
+    scon_collectives_tracker_t *coll;
+    int32_t cnt = 1;
+    int rc, idx;
+
+    scon_output_verbose(5, scon_collectives_base_framework.framework_output,
+                        "%s reduce direct: received partial result from %s on scon=%d",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                        SCON_PRINT_PROC(peer), scon_handle);
+    if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buf, &sig, &cnt, SCON_COLLECTIVES_SIGNATURE))) {
+        SCON_ERROR_LOG(rc);
+        return;
+    }
+    sig->scon_handle = scon_handle;
+    /* check for the tracker and create it if not found */
+    if (NULL == (coll = scon_collectives_base_get_tracker(sig, true))) {
+        SCON_ERROR_LOG(SCON_ERR_NOT_FOUND);
+        SCON_RELEASE(sig);
+        return;
+    }
+    if (coll->sig != sig) {
+        SCON_RELEASE(sig);
+    }
+    if (0 > (idx = scon_collectives_base_reduce_store(coll, peer, buf))) {
+        SCON_ERROR_LOG(idx);
+        return;
+    }
+    /* we fold it in when we are called locally */
+    if (NULL == coll->req) {
+        return;
+    }
+    if (SCON_SUCCESS != (rc = scon_collectives_base_reduce_fold(coll, idx)) ||
+        SCON_SUCCESS != (rc = tree_progress(coll))) {
+        SCON_ERROR_LOG(rc);
+        scon_collectives_base_reduce_complete(coll, rc, false);
+    }
+}
+
+void scon_collectives_default_reduce_release(scon_status_t status,
+                                             scon_handle_t scon_handle,
+                                             scon_proc_t *peer,
+                                             scon_buffer_t *buf,
+                                             scon_msg_tag_t tag,
+                                             void *cbdata)
+{
+    scon_collectives_signature_t *sig;
+    scon_collectives_tracker_t *coll;
+    scon_byte_object_t bo;
+    int32_t cnt;
+    int rc, ret;
+
+    scon_output_verbose(2,  scon_collectives_base_framework.framework_output,
+                        "%s reduce_release: called with %d bytes on scon %d",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                        (int)buf->bytes_used, scon_handle);
+    cnt = 1;
+    if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buf, &sig, &cnt, SCON_COLLECTIVES_SIGNATURE))) {
+        SCON_ERROR_LOG(rc);
+        return;
+    }
+    sig->scon_handle = scon_handle;
+    /* check for the tracker - it is not an error if not
+     * found as that just means we were not involved
+     * in the collective */
+    coll = scon_collectives_base_get_tracker(sig, false);
+    SCON_RELEASE(sig);
+    if (NULL == coll || NULL == coll->req) {
+        return;
+    }
+    cnt = 1;
+    if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buf, &ret, &cnt, SCON_INT))) {
+        SCON_ERROR_LOG(rc);
+        scon_collectives_base_reduce_complete(coll, rc, false);
+        return;
+    }
+    if (SCON_SUCCESS != ret) {
+        scon_collectives_base_reduce_complete(coll, ret, false);
+        return;
+    }
+    cnt = 1;
+    if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buf, &bo, &cnt, SCON_BYTE_OBJECT))) {
+        SCON_ERROR_LOG(rc);
+        scon_collectives_base_reduce_complete(coll, rc, false);
+        return;
+    }
+    if (bo.size != coll->reduction.count * coll->reduction.size) {
+        free(bo.bytes);
+        scon_collectives_base_reduce_complete(coll, SCON_ERR_BAD_PARAM, false);
+        return;
+    }
+    memcpy(coll->reduction.data, bo.bytes, bo.size);
+    free(bo.bytes);
+    scon_collectives_base_reduce_complete(coll, SCON_SUCCESS, true);
+}
@@ -27,6 +27,7 @@
 #include "src/util/output.h"
 #include "util/error.h"
 #include "src/util/name_fns.h"
+#include "src/util/trace.h"
 #include "src/include/scon_globals.h"
 
 #include "src/mca/pt2pt/base/base.h"
@@ -40,6 +41,7 @@ static void finalize(scon_handle_t scon_handle);
 static int allgather(scon_collectives_tracker_t *coll,
                      scon_buffer_t *buf);
 static int barrier(scon_collectives_tracker_t *coll);
+static int allgather_init(scon_handle_t scon_handle);
 
 /* Module def */
 scon_collectives_module_t scon_collectives_rcd_module = {
@@ -47,7 +49,10 @@ scon_collectives_module_t scon_collectives_rcd_module = {
     NULL,
     barrier,
     allgather,
-    finalize
+    scon_collectives_base_allreduce_rd,
+    scon_collectives_base_reduce_binomial,
+    finalize,
+    allgather_init
 };
 
 /* internal functions */
@@ -62,12 +67,6 @@ static void rcd_allgather_recv_dist(int status,
                                        scon_buffer_t* buffer,
                                        scon_msg_tag_t tag,
                                        void* cbdata);
-static void rcd_barrier_recv_dist(int status,
-                                       scon_handle_t handle,
-                                       scon_proc_t* sender,
-                                       scon_buffer_t* buffer,
-                                       scon_msg_tag_t tag,
-                                       void* cbdata);
 static int rcd_finalize_coll(scon_collectives_tracker_t *coll,
                                 int ret);
 
@@ -77,18 +76,15 @@ static int rcd_finalize_coll(scon_collectives_tracker_t *coll,
 static int init(scon_handle_t scon_handle)
 {
     /* post the receives */
+    scon_collectives_base_recv_nb(scon_handle, SCON_MSG_TAG_ALLGATHER_RCD, rcd_allgather_recv_dist);
     pt2pt_base_api_recv_nb(scon_handle,
                            SCON_PROC_WILDCARD,
-                           SCON_MSG_TAG_ALLGATHER_RCD,
+                           SCON_MSG_TAG_BARRIER_TOKEN,
                            SCON_MSG_PERSISTENT,
-                           rcd_allgather_recv_dist, NULL,
-                           NULL, 0);
-    pt2pt_base_api_recv_nb(scon_handle,
-                           SCON_PROC_WILDCARD,
-                           SCON_MSG_TAG_BARRIER_RCD,
-                           SCON_MSG_PERSISTENT,
-                           rcd_barrier_recv_dist, NULL,
+                           scon_collectives_base_barrier_recv, NULL,
                            NULL, 0);
+    /* reductions are handled by the base peer to peer engine */
+    scon_collectives_base_recv_nb(scon_handle, SCON_MSG_TAG_REDUCE_RD, scon_collectives_base_reduce_recv);
     return SCON_SUCCESS;
 }
 
@@ -98,8 +94,18 @@ static int init(scon_handle_t scon_handle)
 static void finalize(scon_handle_t scon_handle)
 {
     /* cancel the recv */
-    pt2pt_base_api_recv_cancel(scon_handle, SCON_PROC_WILDCARD, SCON_MSG_TAG_BARRIER_RCD);
+    pt2pt_base_api_recv_cancel(scon_handle, SCON_PROC_WILDCARD, SCON_MSG_TAG_BARRIER_TOKEN);
     pt2pt_base_api_recv_cancel(scon_handle, SCON_PROC_WILDCARD, SCON_MSG_TAG_ALLGATHER_RCD);
+    pt2pt_base_api_recv_cancel(scon_handle, SCON_PROC_WILDCARD, SCON_MSG_TAG_REDUCE_RD);
+}
+
+/**
+ * Post the receive of the allgather alone
+ */
+static int allgather_init(scon_handle_t scon_handle)
+{
+    scon_collectives_base_recv_nb(scon_handle, SCON_MSG_TAG_ALLGATHER_RCD, rcd_allgather_recv_dist);
+    return SCON_SUCCESS;
 }
 
 static int allgather(scon_collectives_tracker_t *coll,
@@ -107,6 +113,7 @@ static int allgather(scon_collectives_tracker_t *coll,
 {
 
     uint32_t log2nprocs;
+    int rc;
 
     /* check the number of involved daemons - if it is not a power of two,
      * then we cannot do it */
@@ -125,15 +132,17 @@ static int allgather(scon_collectives_tracker_t *coll,
     if (log2nprocs) {
         scon_bitmap_init (&coll->distance_mask_recv, log2nprocs);
     }
-    /* TO DO : set my own rank */
-    coll->my_rank = SCON_PROC_MY_NAME->rank;
+    /* start by seeding the collection with our own data - this
+     * also sets my index in the participant list */
+    if (SCON_SUCCESS != (rc = scon_collectives_base_allgather_contribute(coll, buf))) {
+        SCON_ERROR_LOG(rc);
+        rcd_finalize_coll(coll, rc);
+        return rc;
+    }
 
     /* record that we contributed */
     coll->nreported = 1;
 
-    /* start by seeding the collection with our own data */
-    scon_bfrop.copy_payload(&coll->bucket, buf);
-
     /* process data */
     rcd_allgather_process_data (coll, 0);
 
@@ -147,51 +156,39 @@ static int rcd_allgather_send_dist(scon_collectives_tracker_t *coll,
     scon_buffer_t *send_buf;
     int rc;
 
-    //send_buf = SCON_NEW(scon_buffer_t);
     send_buf = (scon_buffer_t*) malloc (sizeof(scon_buffer_t));
+    scon_buffer_construct(send_buf);
     /* pack the signature */
     if (SCON_SUCCESS != (rc = scon_bfrop.pack(send_buf, &coll->sig, 1, SCON_COLLECTIVES_SIGNATURE))) {
-        SCON_ERROR_LOG(rc);
-        //SCON_RELEASE(send_buf);
-        free(send_buf);
-        return rc;
+        goto error;
     }
     /* pack the current distance */
     if (SCON_SUCCESS != (rc = scon_bfrop.pack(send_buf, &distance, 1, SCON_INT32))) {
-        SCON_ERROR_LOG(rc);
-        //SCON_RELEASE(send_buf);
-        free(send_buf);
-        return rc;
+        goto error;
     }
-    /* pack the number of daemons included in the payload */
-    if (SCON_SUCCESS != (rc = scon_bfrop.pack(send_buf, &coll->nreported, 1, SCON_SIZE))) {
-        SCON_ERROR_LOG(rc);
-        //SCON_RELEASE(send_buf);
-        free(send_buf);
-        return rc;
-    }
-    /* pack the data */
-    if (SCON_SUCCESS != (rc = scon_bfrop.copy_payload(send_buf, &coll->bucket))) {
-        SCON_ERROR_LOG(rc);
-        //SCON_RELEASE(send_buf);
-        free(send_buf);
-        return rc;
+    /* pack all the data we have, tagged with the member it came from */
+    if (SCON_SUCCESS != (rc = scon_collectives_base_allgather_pack(coll, send_buf, 0,
+                                                                   coll->sig->nprocs))) {
+        goto error;
     }
 
-
+    SCON_TRACE(SCON_TRACE_COLL_ROUND, distance, coll->sig->seq_num);
+    SCON_RETAIN(coll);
     if (SCON_SUCCESS != (rc = pt2pt_base_api_send_nb(coll->sig->scon_handle,
                               peer, send_buf,
                               SCON_MSG_TAG_ALLGATHER_RCD,
                               scon_collectives_base_allgather_send_complete_callback, coll,
                               NULL, 0))) {
-        SCON_ERROR_LOG(rc);
-        //SCON_RELEASE(send_buf);
-        free(send_buf);
-        free(send_buf);
-        return rc;
-    };
-
+        SCON_RELEASE(coll);
+        goto error;
+    }
     return SCON_SUCCESS;
+
+error:
+    SCON_ERROR_LOG(rc);
+    scon_buffer_destruct(send_buf);
+    free(send_buf);
+    return rc;
 }
 
 static void rcd_allgather_process_data(scon_collectives_tracker_t *coll,
@@ -203,6 +200,7 @@ static void rcd_allgather_process_data(scon_collectives_tracker_t *coll,
      */
     uint32_t log2nprocs = (uint32_t) log2(coll->sig->nprocs);
     scon_proc_t peer;
+    size_t nstored;
     int rc, peer_index;
     while (distance < log2nprocs) {
         scon_output_verbose(2,  scon_collectives_base_framework.framework_output,
@@ -226,15 +224,17 @@ static void rcd_allgather_process_data(scon_collectives_tracker_t *coll,
                             "%s rcd: allgather DATA found for distance =%d",
                             SCON_PRINT_PROC(SCON_PROC_MY_NAME),
                             distance);
-        if (SCON_SUCCESS != (rc = scon_bfrop.copy_payload(&coll->bucket, coll->buffers[distance]))) {
+        rc = scon_collectives_base_allgather_unpack(coll, coll->buffers[distance], &nstored);
+        scon_buffer_destruct(coll->buffers[distance]);
+        free(coll->buffers[distance]);
+        coll->buffers[distance] = NULL;
+        if (SCON_SUCCESS != rc) {
             SCON_ERROR_LOG(rc);
             rcd_finalize_coll(coll, rc);
             return;
         }
-        coll->nreported += 1 << distance;
+        coll->nreported += nstored;
         scon_collectives_base_mark_distance_recv(coll, distance);
-        SCON_RELEASE(coll->buffers[distance]);
-        coll->buffers[distance] = NULL;
         ++distance;
     }
 
@@ -261,6 +261,7 @@ static void rcd_allgather_recv_dist(int status,
     scon_collectives_signature_t *sig;
     scon_collectives_tracker_t *coll;
     uint32_t distance;
+    size_t nstored;
     scon_output_verbose(2,  scon_collectives_base_framework.framework_output,
                         "%s rcd: allgather receiving from %s",
                         SCON_PRINT_PROC(SCON_PROC_MY_NAME),
@@ -296,13 +297,13 @@ static void rcd_allgather_recv_dist(int status,
                              "Process the next distance.",
                              SCON_PRINT_PROC(SCON_PROC_MY_NAME), distance);
         /* capture any provided content */
-        if (SCON_SUCCESS != (rc = scon_bfrop.copy_payload(&coll->bucket, buffer))) {
+        if (SCON_SUCCESS != (rc = scon_collectives_base_allgather_unpack(coll, buffer, &nstored))) {
             SCON_RELEASE(sig);
             SCON_ERROR_LOG(rc);
             rcd_finalize_coll(coll, rc);
             return;
         }
-        coll->nreported += (1 << distance);
+        coll->nreported += nstored;
         scon_collectives_base_mark_distance_recv(coll, distance);
         rcd_allgather_process_data(coll, distance + 1);
     } else {
@@ -319,7 +320,6 @@ static void rcd_allgather_recv_dist(int status,
                 return;
             }
         }
-        //if (NULL == (coll->buffers[distance] = SCON_NEW(scon_buffer_t))) {
         if (NULL == (coll->buffers[distance] = (scon_buffer_t*) malloc (sizeof(scon_buffer_t)))) {
             rc = SCON_ERR_OUT_OF_RESOURCE;
             SCON_RELEASE(sig);
@@ -327,6 +327,7 @@ static void rcd_allgather_recv_dist(int status,
             rcd_finalize_coll(coll, rc);
             return;
         }
+        scon_buffer_construct(coll->buffers[distance]);
         if (SCON_SUCCESS != (rc = scon_bfrop.copy_payload(coll->buffers[distance], buffer))) {
             SCON_RELEASE(sig);
             SCON_ERROR_LOG(rc);
@@ -343,32 +344,16 @@ static int rcd_finalize_coll(scon_collectives_tracker_t *coll, int ret)
                         "%s rcd allgather/barrier collective complete on scon %d",
                         SCON_PRINT_PROC(SCON_PROC_MY_NAME),
                         coll->sig->scon_handle);
-    /** TO DO : handle barrier also here **/
-    /* execute the callback */
-    if ((NULL !=  coll->req) && (NULL !=  coll->req->post.allgather.cbfunc)) {
-         coll->req->post.allgather.cbfunc(ret, coll->sig->scon_handle,  coll->req->post.allgather.procs,
-                                 coll->req->post.allgather.nprocs,  &coll->bucket,
-                                 coll->req->post.allgather.info,
-                                 coll->req->post.allgather.ninfo,
-                                 coll->req->post.allgather.cbdata);
+    /* the contributions are in their slots, lay them out in
+     * member order and execute the callback */
+    if (SCON_SUCCESS == ret) {
+        ret = scon_collectives_base_allgather_assemble(coll);
     }
-    scon_list_remove_item(&scon_collectives_base.ongoing, &coll->super);
-    SCON_RELEASE(coll->req);
-    SCON_RELEASE(coll);
+    scon_collectives_base_allgather_complete(coll, ret);
     return SCON_SUCCESS;
 }
 
-static void rcd_barrier_recv_dist(int status,
-                                  scon_handle_t handle,
-                                  scon_proc_t* sender,
-                                  scon_buffer_t* buffer,
-                                  scon_msg_tag_t tag,
-                                  void* cbdata)
-{
-
-}
-
 static int barrier(scon_collectives_tracker_t *coll)
 {
-    return SCON_ERR_NOT_IMPLEMENTED;
+    return scon_collectives_base_barrier_dissemination(coll);
 }
@@ -45,6 +45,9 @@ int scon_comm_base_select(void);
 /* a global struct tracking framework level objects */
 typedef struct {
     scon_pointer_array_t scons;
+    /* index of the next scon - handles aren't reused, so the members
+     * of a scon number the scons derived from it alike */
+    int next_index;
     scon_list_t actives;
 } comm_base_t;
 
@@ -86,14 +89,22 @@ typedef struct  {
     scon_list_t posted_recvs;
     /* recv buffer msg queue size */
     uint16_t recv_queue_len;
+    /* bytes of eager payload the recv queue may hold */
+    size_t recv_queue_bytes;
     /* unmmatched messages received on this scon */
     scon_list_t unmatched_msgs;
+    /* eager messages among them and their payload */
+    size_t unmatched_eager;
+    size_t unmatched_bytes;
     /* reference to the active pt2pt module for this scon */
     scon_pt2pt_module_t *pt2pt_module;
     /* reference to the active collective module this scon */
     scon_collectives_module_t *collective_module;
     /* reference to the pt2pt module this scon is using */
     scon_topology_module_t *topology_module;
+    /* the topology module is a copy laid out over our members
+     * (scons derived by scon_split), released with the scon */
+    bool own_topology;
 } scon_comm_scon_t;
 SCON_EXPORT SCON_CLASS_DECLARATION(scon_comm_scon_t);
 
@@ -147,6 +158,27 @@ typedef struct {
 } scon_teardown_t;
 SCON_EXPORT SCON_CLASS_DECLARATION(scon_teardown_t);
 
+/* scon split request */
+typedef struct {
+    scon_list_item_t super;
+    /* the scon being split */
+    scon_handle_t parent;
+    /* the caller's color and key */
+    int color;
+    int key;
+    /* size of the groups when split by SCON_SPLIT_BLOCK, 0 otherwise */
+    uint32_t block;
+    /* user's callback function */
+    scon_create_cbfunc_t cbfunc;
+    /* user's cbdata */
+    void *cbdata;
+    /* the req's infos */
+    scon_info_t *info;
+    /* number of req infos */
+    size_t ninfo;
+} scon_split_t;
+SCON_EXPORT SCON_CLASS_DECLARATION(scon_split_t);
+
 
 /* Request object for transfering requests to the event lib */
 typedef struct {
@@ -155,6 +187,7 @@ typedef struct {
     union {
         scon_create_t create;
         scon_teardown_t teardown;
+        scon_split_t split;
     }post;
 } scon_req_t;
 SCON_CLASS_DECLARATION(scon_req_t);
@@ -200,6 +233,9 @@ scon_status_t comm_base_set_scon_config(scon_comm_scon_t *scon,
 scon_comm_scon_t * scon_comm_base_get_scon (scon_handle_t handle);
 void scon_comm_base_add_scon(scon_comm_scon_t *scon);
 void scon_comm_base_remove_scon(scon_comm_scon_t *scon);
+/* use up the handle the next scon would get, for a member
+ * left out of a scon its peers add */
+void scon_comm_base_skip_handle(void);
 
 END_C_DECLS
 #endif /* SCON_COMM_BASE_H */
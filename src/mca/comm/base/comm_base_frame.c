@@ -15,7 +15,10 @@
 
 #include "src/mca/mca.h"
 #include "src/util/output.h"
+#include "src/util/perf.h"
 #include "src/mca/base/base.h"
+#include "src/mca/pt2pt/base/base.h"
+#include "src/mca/topology/base/base.h"
 
 /*
  * The following file was created by configure.  It contains extern
@@ -57,6 +60,7 @@ static int scon_comm_base_open(scon_mca_base_open_flag_t flags)
                                                  INT_MAX, 1)) {
         return SCON_ERR_OUT_OF_RESOURCE;
     }
+    comm_base.next_index = 0;
    /* Open up all available components */
     return scon_mca_base_framework_components_open(&scon_comm_base_framework, flags);
 }
@@ -76,9 +80,11 @@ SCON_EXPORT scon_comm_scon_t * scon_comm_base_get_scon (scon_handle_t handle)
 
 SCON_EXPORT void scon_comm_base_add_scon(scon_comm_scon_t *scon)
 {
-    int add_index;
-    add_index = scon_pointer_array_add (&comm_base.scons, scon);
+    int add_index = comm_base.next_index++;
+    scon_pointer_array_set_item (&comm_base.scons, add_index, scon);
     scon->handle = add_index + 1;
+    /* deliver whatever our peers sent before we got here */
+    scon_pt2pt_base_release_early_msgs(scon->handle);
 }
 
 SCON_EXPORT void scon_comm_base_remove_scon(scon_comm_scon_t *scon)
@@ -90,6 +96,15 @@ SCON_EXPORT void scon_comm_base_remove_scon(scon_comm_scon_t *scon)
 
 }
 
+SCON_EXPORT void scon_comm_base_skip_handle(void)
+{
+    scon_handle_t handle = ++comm_base.next_index;
+    scon_output_verbose(1, scon_comm_base_framework.framework_output,
+                        "skipping scon %d", handle);
+    /* nothing we were sent for it will ever be delivered */
+    scon_pt2pt_base_drop_early_msgs(handle);
+}
+
 
 SCON_MCA_BASE_FRAMEWORK_DECLARE(scon, comm, "comm",
                            scon_comm_base_register, scon_comm_base_open, scon_comm_base_close,
@@ -100,11 +115,19 @@ SCON_MCA_BASE_FRAMEWORK_DECLARE(scon, comm, "comm",
 static void scon_cons (scon_comm_scon_t *ptr)
 {
     ptr->nmembers = 0;
+    ptr->num_replied = 0;
+    ptr->state = SCON_STATE_CREATING;
     ptr->handle = SCON_HANDLE_INVALID;
+    ptr->topology_module = NULL;
+    ptr->own_topology = false;
     SCON_CONSTRUCT(&ptr->members, scon_list_t);
     SCON_CONSTRUCT(&ptr->posted_recvs, scon_list_t);
     SCON_CONSTRUCT(&ptr->queued_msgs, scon_list_t);
     SCON_CONSTRUCT(&ptr->unmatched_msgs, scon_list_t);
+    ptr->recv_queue_len = 0;
+    ptr->recv_queue_bytes = 0;
+    ptr->unmatched_eager = 0;
+    ptr->unmatched_bytes = 0;
 }
 
 static void scon_des (scon_comm_scon_t *ptr)
@@ -112,7 +135,12 @@ static void scon_des (scon_comm_scon_t *ptr)
     SCON_LIST_DESTRUCT(&ptr->members);
     SCON_LIST_DESTRUCT(&ptr->posted_recvs);
     SCON_LIST_DESTRUCT(&ptr->queued_msgs);
+    SCON_PERF_ADD(SCON_PERF_CTR_UNMATCHED_MSGS,
+                  -(int64_t)scon_list_get_size(&ptr->unmatched_msgs));
     SCON_LIST_DESTRUCT(&ptr->unmatched_msgs);
+    if (ptr->own_topology) {
+        scon_topology_base_release_module(ptr->topology_module);
+    }
 }
 
 SCON_CLASS_INSTANCE (scon_comm_scon_t,
@@ -131,10 +159,15 @@ SCON_CLASS_INSTANCE (scon_teardown_t,
                     scon_list_item_t,
                     NULL, NULL);
 
+SCON_CLASS_INSTANCE (scon_split_t,
+                    scon_list_item_t,
+                    NULL, NULL);
+
 static void scon_req_cons(scon_req_t *ptr)
 {
     SCON_CONSTRUCT(&ptr->post.create,  scon_create_t);
     SCON_CONSTRUCT(&ptr->post.teardown,  scon_teardown_t);
+    SCON_CONSTRUCT(&ptr->post.split,  scon_split_t);
 }
 
 SCON_CLASS_INSTANCE(scon_req_t,
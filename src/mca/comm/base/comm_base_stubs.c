@@ -33,6 +33,7 @@ SCON_EXPORT scon_comm_scon_t * comm_base_create (scon_proc_t procs[],
     char coll_comp[SCON_MCA_BASE_MAX_COMPONENT_NAME_LEN+1];
     uint16_t *temp;
     uint32_t *temp1;
+    size_t *temp2;
     /* create the local scon object and set its attributes*/
     scon_comm_scon_t *scon = SCON_NEW(scon_comm_scon_t);
     /* process the info array and error if any of the required keys
@@ -60,6 +61,12 @@ SCON_EXPORT scon_comm_scon_t * comm_base_create (scon_proc_t procs[],
                 scon->recv_queue_len = *temp;
                 continue;
             }
+            if (0 == strncmp(info[i].key, SCON_RECV_QUEUE_BYTES, SCON_MAX_KEYLEN)) {
+                /* unloaded straight into the scon */
+                temp2 = &scon->recv_queue_bytes;
+                scon_value_unload(&info[i].value, (void**)&temp2, &sz, SCON_SIZE);
+                continue;
+            }
             if (0 == strncmp(info[i].key, SCON_OPERATIONAL_QUORUM, SCON_MAX_KEYLEN)) {
                 /* copy the value and store it */
                 scon_value_unload(&info[i].value, (void**)&temp1, &sz, SCON_UINT32);
@@ -118,6 +125,11 @@ SCON_EXPORT scon_comm_scon_t * comm_base_create (scon_proc_t procs[],
             }
         }
     }
+    /* size the peer tables for all members now, before the wireup
+     * starts adding them from the progress thread */
+    if (SCON_SUCCESS != scon_pt2pt_base_reserve_peers(scon->nmembers)) {
+        goto error;
+    }
     /* Now assign the requested pt2pt, topology and collectives modules */
     /** user can only select the topology module at this pt in time */
     strcpy(pt2pt_comp, SCON_PT2PT_DEFAULT_COMPONENT);
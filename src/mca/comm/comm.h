@@ -77,6 +77,18 @@ typedef int (*scon_comm_base_module_delete_fn_t) (scon_handle_t scon_handle,
  */
 typedef int (*scon_comm_base_module_finalize_fn_t) (void);
 
+/**
+ * scon split - derive child scons from the members of an existing scon,
+ *              grouped by color and ordered by key.
+ */
+typedef int (*scon_comm_base_module_split_fn_t) (scon_handle_t parent,
+                                                 int color,
+                                                 int key,
+                                                 scon_info_t info[],
+                                                 size_t ninfo,
+                                                 scon_create_cbfunc_t cbfunc,
+                                                 void *cbdata);
+
 
 /**
  * Common module definition
@@ -87,6 +99,7 @@ struct scon_comm_base_module_1_0_0_t  {
     scon_comm_base_module_get_info_fn_t          getinfo;
     scon_comm_base_module_delete_fn_t            del;
     scon_comm_base_module_finalize_fn_t          finalize;
+    scon_comm_base_module_split_fn_t             split;
 };
 typedef struct scon_comm_base_module_1_0_0_t scon_comm_base_module_1_0_0_t;
 typedef struct scon_comm_base_module_1_0_0_t scon_comm_module_t;
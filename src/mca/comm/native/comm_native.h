@@ -22,6 +22,10 @@ BEGIN_C_DECLS
 SCON_EXPORT extern scon_comm_base_component_t mca_comm_native_component;
 SCON_EXPORT extern scon_comm_module_t scon_comm_native_module;
 
+/* run the create handshake as an allgather among all members
+ * instead of rolling it up the topology tree */
+extern bool scon_comm_native_create_allgather;
+
 END_C_DECLS
 
 #endif
@@ -22,11 +22,14 @@
 #include "src/mca/topology/base/base.h"
 #include "src/mca/collectives/base/base.h"
 #include "src/mca/comm/comm.h"
+#include "src/mca/comm/native/comm_native.h"
 #include "src/include/scon_globals.h"
 #include "src/util/scon_pmix.h"
+#include "src/util/perf.h"
 #include "src/buffer_ops/types.h"
 
 
+static int native_register(void);
 static int native_open(void);
 static int native_close(void);
 static int native_query(scon_mca_base_module_t **module, int *priority);
@@ -47,6 +50,13 @@ static int native_delete (scon_handle_t scon_handle,
                         void *cbdata,
                         scon_info_t info[],
                         size_t ninfo);
+static int native_split (scon_handle_t parent,
+                       int color,
+                       int key,
+                       scon_info_t info[],
+                       size_t ninfo,
+                       scon_create_cbfunc_t cbfunc,
+                       void *cbdata);
 
 /**
  * component definition
@@ -66,6 +76,7 @@ SCON_EXPORT scon_comm_base_component_t mca_comm_native_component = {
          .scon_mca_open_component = native_open,
          .scon_mca_close_component = native_close,
          .scon_mca_query_component = native_query,
+         .scon_mca_register_component_params = native_register,
     },
     .priority = 80,
     .get_module = comm_native_get_module
@@ -76,9 +87,24 @@ scon_comm_module_t native_module = {
     native_create,
     native_getinfo,
     native_delete,
-    native_finalize
+    native_finalize,
+    native_split
 };
 
+bool scon_comm_native_create_allgather = false;
+
+static int native_register(void)
+{
+    (void)scon_mca_base_component_var_register(&mca_comm_native_component.base, "create_allgather",
+                                          "Synchronize scon create with an allgather among all members instead of "
+                                          "rolling it up the topology tree. All members must use the same value",
+                                          SCON_MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &scon_comm_native_create_allgather);
+    return SCON_SUCCESS;
+}
+
 static int native_open()
 {
     return SCON_SUCCESS;
@@ -149,6 +175,7 @@ static void native_create_cfg_recv_cbfunc(scon_status_t status,
                              "%s native_create_cfg_recv_cbfunc for scon %d status = %d ",
                              SCON_PRINT_PROC(SCON_PROC_MY_NAME), scon_handle, status);
         //comm_base_set_scon_config (scon_comm_base_get_scon (scon_handle), buf);
+        scon_comm_base_get_scon(scon_handle)->state = SCON_STATE_OPERATIONAL;
         req->post.create.cbfunc(status, scon_handle,req->post.create.cbdata);
         if(NULL != buf) {
             scon_buffer_destruct(buf);
@@ -157,6 +184,128 @@ static void native_create_cfg_recv_cbfunc(scon_status_t status,
     }
     /*** TO DO: implement error behavior ***/
 }
+/* every member has created the scon. The master xcasts the config
+ * down the topology tree, which also releases the members, and every
+ * member (the master too) completes the create when it arrives */
+static void native_create_release(scon_comm_scon_t *scon, scon_req_t *req)
+{
+    scon_buffer_t *buf;
+
+    if(is_master(scon)) {
+        /*  prepare the xcast msg and complete create in xcast send callback */
+        buf = malloc(sizeof(scon_buffer_t));
+        scon_buffer_construct(buf);
+        comm_base_pack_scon_config(scon, buf);
+        collectives_base_api_xcast( scon->handle,
+                                    NULL, 0,
+                                    buf,
+                                    SCON_MSG_TAG_CFG_INFO,
+                                    native_create_xcast_send_complete,
+                                    req, NULL , 0);
+    }
+
+    /* wait for config info xcast msg from master */
+    pt2pt_base_api_recv_nb (scon->handle,
+                            SCON_PROC_WILDCARD,
+                            SCON_MSG_TAG_CFG_INFO,
+                            SCON_MSG_PERSISTENT,
+                            native_create_cfg_recv_cbfunc,
+                            req, NULL, 0);
+}
+
+static void native_create_fail(scon_comm_scon_t *scon, scon_req_t *req, int status)
+{
+    scon_comm_base_remove_scon(scon);
+    SCON_RELEASE(scon);
+    req->post.create.cbfunc(status, SCON_HANDLE_INVALID, req->post.create.cbdata);
+    SCON_RELEASE(req);
+}
+
+static void native_create_ready_send_complete(scon_status_t status,
+                                              scon_handle_t scon_handle,
+                                              scon_proc_t *peer,
+                                              scon_buffer_t *buf,
+                                              scon_msg_tag_t tag,
+                                              void *cbdata)
+{
+    if (SCON_SUCCESS != status) {
+        scon_output(0, "%s native_create: ready on scon %d to %s failed with status=%d",
+                    SCON_PRINT_PROC(SCON_PROC_MY_NAME), scon_handle,
+                    SCON_PRINT_PROC(peer), status);
+    }
+    scon_buffer_destruct(buf);
+    free(buf);
+}
+
+/* the create handshake is rolled up the topology tree: a member
+ * reports ready to its parent once it and every member routed through
+ * it have created the scon. When the master's subtree - everyone - is
+ * ready, the config xcast goes back down and releases the members.
+ * A member only ever talks to its parent and children, whose contact
+ * info is looked up on the first send to them, so neither the
+ * messages nor the contacts of a member grow with the size of the scon */
+static void native_create_check_ready(scon_comm_scon_t *scon)
+{
+    scon_req_t *req = (scon_req_t*)scon->req;
+    scon_topology_module_t *topo = scon->topology_module;
+    scon_buffer_t *buf;
+    scon_proc_t parent;
+    int rc;
+
+    /* ourselves plus each of our children */
+    if (scon->num_replied < 1 + topo->api.num_routes(&topo->topology)) {
+        return;
+    }
+    /* our whole subtree has reported */
+    pt2pt_base_api_recv_cancel(scon->handle, SCON_PROC_WILDCARD, SCON_MSG_TAG_CREATE_READY);
+    if (is_master(scon)) {
+        native_create_release(scon, req);
+        return;
+    }
+    parent = topo->api.get_nexthop(&topo->topology, SCON_GET_MASTER(scon));
+    scon_output_verbose(2, scon_comm_base_framework.framework_output,
+                        "%s native_create: subtree of scon %d ready, reporting to %s",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), scon->handle,
+                        SCON_PRINT_PROC(&parent));
+    buf = (scon_buffer_t*) malloc (sizeof(scon_buffer_t));
+    scon_buffer_construct(buf);
+    if (SCON_SUCCESS != (rc = scon_bfrop.pack(buf, &scon->handle, 1, SCON_UINT32)) ||
+        SCON_SUCCESS != (rc = pt2pt_base_api_send_nb(scon->handle, &parent, buf,
+                                                     SCON_MSG_TAG_CREATE_READY,
+                                                     native_create_ready_send_complete,
+                                                     NULL, NULL, 0))) {
+        SCON_ERROR_LOG(rc);
+        scon_buffer_destruct(buf);
+        free(buf);
+        native_create_fail(scon, req, rc);
+        return;
+    }
+    native_create_release(scon, req);
+}
+
+static void native_create_ready_recv_cbfunc(scon_status_t status,
+                                            scon_handle_t scon_handle,
+                                            scon_proc_t *peer,
+                                            scon_buffer_t *buf,
+                                            scon_msg_tag_t tag,
+                                            void *cbdata)
+{
+    scon_comm_scon_t *scon = scon_comm_base_get_scon(scon_handle);
+
+    if (NULL != buf) {
+        scon_buffer_destruct(buf);
+    }
+    if (NULL == scon || SCON_STATE_CREATING != scon->state) {
+        return;
+    }
+    scon_output_verbose(2, scon_comm_base_framework.framework_output,
+                        "%s native_create: %s ready on scon %d",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), SCON_PRINT_PROC(peer),
+                        scon_handle);
+    scon->num_replied++;
+    native_create_check_ready(scon);
+}
+
 static void native_create_barrier_complete_callback (scon_status_t status,
                                                    scon_handle_t scon_handle,
                                                    scon_proc_t procs[],
@@ -167,39 +316,14 @@ static void native_create_barrier_complete_callback (scon_status_t status,
                                                    void *cbdata)
 {
     scon_req_t *req = (scon_req_t *) cbdata;
-    scon_buffer_t *buf = malloc(sizeof(scon_buffer_t));
-    scon_buffer_construct(buf);
     scon_comm_scon_t *scon = scon_comm_base_get_scon(scon_handle);
     scon_output_verbose (1,  scon_comm_base_framework.framework_output,
                            "%s native_create_barrier_complete_callback on scon %d status = %d ",
                             SCON_PRINT_PROC(SCON_PROC_MY_NAME), scon_handle, status);
     if(SCON_SUCCESS == status) {
-        /** TO DO : The returned buffer will have  the contact information
-           of all the peers, which can then be processed to set the member uris
-           TO DO : process member uris and local SCON IDs from the returned all gather buffer
-         **/
-        /** Master xcasts  config info to all the participants and completes create req */
+        /* the gathered handles aren't used */
         scon_buffer_destruct(buffer);
-
-        if(is_master(scon)) {
-            /*  prepare the xcast msg and complete create in xcast send callback */
-            comm_base_pack_scon_config(scon, buf);
-            collectives_base_api_xcast( scon_handle,
-                                        NULL, 0,
-                                        buf,
-                                        SCON_MSG_TAG_CFG_INFO,
-                                        native_create_xcast_send_complete,
-                                        req, NULL , 0);
-        }
-
-        /* wait for config info xcast msg from master */
-        pt2pt_base_api_recv_nb (scon_handle,
-                                SCON_PROC_WILDCARD,
-                                SCON_MSG_TAG_CFG_INFO,
-                                SCON_MSG_PERSISTENT,
-                                native_create_cfg_recv_cbfunc,
-                                req, NULL, 0);
-
+        native_create_release(scon, req);
     }
     else {
         scon_output(0, "%s native_create_barrier_complete_callback failed with status =%d",
@@ -221,14 +345,14 @@ static void native_create_barrier_complete_callback (scon_status_t status,
  * final configuration.
  * (1) First optimization is to skip config verify operation unless the info key
  * is specified, this eliminates the need for additional xcasts and barrier.
- * (2) Further down the road we can completely eliminate the initial allgather and
- * exchange the scon ids on demand.
+ * (2) Exchange the scon ids on demand.
  ****** End To Do */
 
 /** The create process
-* (1) all members participate in an initial barrier, at this point the end point addresses
-* are exchanged. We can eliminate this step in future, and use PMIx get instead
-* to send msgs to our peers.
+* (1) every member publishes its address via PMIx and reports ready up the topology
+* tree (see native_create_check_ready). The address of a peer is only fetched from
+* PMIx on the first send to it, so a member learns just its tree neighbours. With
+* comm_native_create_allgather set this is an allgather among all members instead.
 * (2) Master sends config verify xcast message
 * (3) All members verify that their local scon configuration matches with that of the master
 *     and send their response - ie config check successful or fail and their local scon id.
@@ -277,6 +401,25 @@ static void native_process_create (int fd, short flags, void *cbdata)
 
     scon->topology_module->api.update_topology (&scon->topology_module->topology,
                                                 scon->nmembers);
+    if (!scon_comm_native_create_allgather) {
+        scon_collectives_base_scon_init(scon);
+        /* count ourselves before the recv goes up - from then on
+         * only our children's reports, on the pt2pt thread, move
+         * the count and check it */
+        scon->num_replied++;
+        if (0 == scon->topology_module->api.num_routes(&scon->topology_module->topology)) {
+            native_create_check_ready(scon);
+            return;
+        }
+        /* our children may already be waiting to report */
+        pt2pt_base_api_recv_nb (scon->handle,
+                                SCON_PROC_WILDCARD,
+                                SCON_MSG_TAG_CREATE_READY,
+                                SCON_MSG_PERSISTENT,
+                                native_create_ready_recv_cbfunc,
+                                NULL, NULL, 0);
+        return;
+    }
     allgather_buf = (scon_buffer_t*) malloc (sizeof(scon_buffer_t));
     scon_buffer_construct(allgather_buf);
     if (SCON_SUCCESS != (ret = scon_bfrop.pack(allgather_buf, &scon->handle,
@@ -284,7 +427,7 @@ static void native_process_create (int fd, short flags, void *cbdata)
         SCON_ERROR_LOG(ret);
         goto error;
     }
-    scon->collective_module->init(scon->handle);
+    scon_collectives_base_scon_init(scon);
     /* now wait for all scon participants to get here */
     /*** TO DO **** - fence or allgather */
     collectives_base_api_allgather( scon->handle,
@@ -303,6 +446,21 @@ error:
 }
 
 
+/* free the scon on the pt2pt thread - its posted recvs and unmatched
+ * messages belong to that thread, which may be delivering into them */
+static void native_process_delete_complete (int fd, short flags, void *cbdata)
+{
+    scon_req_t *req = (scon_req_t*) cbdata;
+    scon_comm_scon_t *scon = scon_comm_base_get_scon(req->post.teardown.scon_handle);
+
+    scon_comm_base_remove_scon(scon);
+    /* TO DO: need to call finalize on all the modules associated
+       with this scon */
+    SCON_RELEASE(scon);
+    req->post.teardown.cbfunc(SCON_SUCCESS, req->post.teardown.cbdata);
+    SCON_RELEASE(req);
+}
+
 /* delete completion fn - after fence release */
 static void native_process_delete_barrier_cbfunc (scon_status_t status,
                                                 scon_handle_t scon_handle,
@@ -316,13 +474,10 @@ static void native_process_delete_barrier_cbfunc (scon_status_t status,
                         "%s native_process_delete_barrier_cbfunc on scon %d ",
                         SCON_PRINT_PROC(SCON_PROC_MY_NAME), scon_handle);
     scon_req_t *req = (scon_req_t*) cbdata;
-    scon_comm_scon_t *scon = scon_comm_base_get_scon(req->post.teardown.scon_handle);
-    scon_comm_base_remove_scon(scon);
-    /* TO DO: need to call finalize on all the modules associated
-       with this scon */
-    SCON_RELEASE(scon);
-    req->post.teardown.cbfunc(SCON_SUCCESS, req->post.teardown.cbdata);
-    SCON_RELEASE(req);
+    scon_event_set(scon_pt2pt_base.pt2pt_evbase, &req->ev, -1, SCON_EV_WRITE,
+                   native_process_delete_complete, req);
+    scon_event_set_priority(&req->ev, SCON_MSG_PRI);
+    scon_event_active(&req->ev, SCON_EV_WRITE, 1);
 }
 
 /** Delete is synchronized among members by default
@@ -348,6 +503,234 @@ static void native_process_delete (int fd, short flags, void *cbdata)
     return;
 }
 
+/*** Split Request Processing
+ * A split derives child scons from an operational parent. The members of
+ * a child already know each other and have the pt2pt, collectives modules
+ * and connections of the parent, so unlike create there is no PMIx put,
+ * config xcast or ready handshake - the only collective is one allgather
+ * over the parent that tells everyone the color and key of everyone else,
+ * and with SCON_SPLIT_BLOCK every member computes its group on its own.
+ * Each child gets a topology of its own laid out over its members, the
+ * first of them (in key order) being the master */
+typedef struct {
+    scon_proc_t name;
+    int32_t color;
+    int32_t key;
+    uint32_t index;
+} native_split_entry_t;
+
+static int native_split_cmp(const void *a, const void *b)
+{
+    const native_split_entry_t *ea = (const native_split_entry_t*)a;
+    const native_split_entry_t *eb = (const native_split_entry_t*)b;
+
+    if (ea->key != eb->key) {
+        return (ea->key < eb->key) ? -1 : 1;
+    }
+    return (ea->index < eb->index) ? -1 : (ea->index > eb->index);
+}
+
+static void native_split_complete(scon_req_t *req, int status, scon_handle_t handle)
+{
+    req->post.split.cbfunc(status, handle, req->post.split.cbdata);
+    SCON_RELEASE(req);
+}
+
+/* our index in the members of scon, or -1 */
+static int native_split_my_index(scon_comm_scon_t *scon)
+{
+    scon_member_t *mem;
+    int index = 0;
+
+    SCON_LIST_FOREACH(mem, &scon->members, scon_member_t) {
+        if (SCON_EQUAL == scon_util_compare_name_fields(SCON_NS_CMP_ALL,
+                                                        &mem->name, SCON_PROC_MY_NAME)) {
+            return index;
+        }
+        index++;
+    }
+    return -1;
+}
+
+/* set up the child scon of the given members, in order, locally */
+static void native_split_create(scon_req_t *req, scon_comm_scon_t *parent,
+                                scon_proc_t *procs, size_t nprocs)
+{
+    scon_comm_scon_t *child;
+    scon_member_t *mem;
+    size_t i;
+
+    child = SCON_NEW(scon_comm_scon_t);
+    child->type = SCON_TYPE_MY_JOB_PARTIAL;
+    child->nmembers = nprocs;
+    for (i = 0; i < nprocs; i++) {
+        mem = SCON_NEW(scon_member_t);
+        memcpy(&mem->name, &procs[i], sizeof(scon_proc_t));
+        scon_list_append(&child->members, &mem->super);
+    }
+    memcpy(&child->master, &procs[0], sizeof(scon_proc_t));
+    child->recv_queue_len = parent->recv_queue_len;
+    child->recv_queue_bytes = parent->recv_queue_bytes;
+    child->pt2pt_module = parent->pt2pt_module;
+    child->collective_module = parent->collective_module;
+    if (NULL == (child->topology_module =
+                 scon_topology_base_clone_module(parent->topology_module, procs, nprocs))) {
+        SCON_ERROR_LOG(SCON_ERR_OUT_OF_RESOURCE);
+        SCON_RELEASE(child);
+        scon_comm_base_skip_handle();
+        native_split_complete(req, SCON_ERR_OUT_OF_RESOURCE, SCON_HANDLE_INVALID);
+        return;
+    }
+    child->own_topology = true;
+    scon_comm_base_add_scon(child);
+    scon_collectives_base_scon_init(child);
+    child->state = SCON_STATE_OPERATIONAL;
+    scon_output_verbose(1, scon_comm_base_framework.framework_output,
+                        "%s native_split: scon %d split into scon %d of %lu members, master %s",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), parent->handle, child->handle,
+                        (unsigned long)nprocs, SCON_PRINT_PROC(&child->master));
+    native_split_complete(req, SCON_SUCCESS, child->handle);
+}
+
+static void native_split_allgather_cbfunc(scon_status_t status,
+                                          scon_handle_t scon_handle,
+                                          scon_proc_t procs[],
+                                          size_t nprocs,
+                                          scon_buffer_t *buffer,
+                                          scon_info_t info[],
+                                          size_t ninfo,
+                                          void *cbdata)
+{
+    scon_req_t *req = (scon_req_t *) cbdata;
+    scon_comm_scon_t *parent = scon_comm_base_get_scon(scon_handle);
+    native_split_entry_t *entries = NULL, entry;
+    scon_proc_t *members = NULL;
+    size_t i, n = 0;
+    int32_t cnt;
+    int rc = status;
+
+    if (SCON_SUCCESS != status || NULL == parent) {
+        scon_output(0, "%s native_split: allgather on scon %d failed with status =%d",
+                    SCON_PRINT_PROC(SCON_PROC_MY_NAME), scon_handle, status);
+        rc = (SCON_SUCCESS == status) ? SCON_ERR_NOT_FOUND : status;
+        goto done;
+    }
+    if (SCON_SPLIT_UNDEFINED == req->post.split.color) {
+        /* our peers are adding scons, keep our handles in step */
+        scon_comm_base_skip_handle();
+        goto done;
+    }
+    if (NULL == (entries = (native_split_entry_t*)malloc(parent->nmembers *
+                                                         sizeof(native_split_entry_t)))) {
+        rc = SCON_ERR_OUT_OF_RESOURCE;
+        goto done;
+    }
+    /* keep the members of our color */
+    for (i = 0; i < parent->nmembers; i++) {
+        cnt = 1;
+        if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buffer, &entry.name, &cnt, SCON_PROC))) {
+            break;
+        }
+        cnt = 1;
+        if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buffer, &entry.color, &cnt, SCON_INT32))) {
+            break;
+        }
+        cnt = 1;
+        if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buffer, &entry.key, &cnt, SCON_INT32))) {
+            break;
+        }
+        cnt = 1;
+        if (SCON_SUCCESS != (rc = scon_bfrop.unpack(buffer, &entry.index, &cnt, SCON_UINT32))) {
+            break;
+        }
+        if (entry.color == req->post.split.color) {
+            entries[n++] = entry;
+        }
+    }
+    if (SCON_SUCCESS != rc) {
+        SCON_ERROR_LOG(rc);
+        goto done;
+    }
+    if (0 == n) {
+        /* we weren't in the allgather result ourselves */
+        rc = SCON_ERR_NOT_FOUND;
+        goto done;
+    }
+    qsort(entries, n, sizeof(native_split_entry_t), native_split_cmp);
+    SCON_PROC_CREATE(members, n);
+    for (i = 0; i < n; i++) {
+        memcpy(&members[i], &entries[i].name, sizeof(scon_proc_t));
+    }
+    free(entries);
+    scon_buffer_destruct(buffer);
+    native_split_create(req, parent, members, n);
+    SCON_PROC_FREE(members, n);
+    return;
+done:
+    free(entries);
+    if (NULL != buffer) {
+        scon_buffer_destruct(buffer);
+    }
+    native_split_complete(req, rc, SCON_HANDLE_INVALID);
+}
+
+static void native_process_split (int fd, short flags, void *cbdata)
+{
+    scon_req_t *req = (scon_req_t*) cbdata;
+    scon_comm_scon_t *parent = scon_comm_base_get_scon(req->post.split.parent);
+    scon_member_t *mem;
+    scon_buffer_t *buf;
+    scon_proc_t *members;
+    uint32_t index, start, n, i;
+    int32_t color = req->post.split.color, key = req->post.split.key;
+    int my_index, rc;
+
+    if (NULL == parent || SCON_STATE_OPERATIONAL != parent->state ||
+        0 > (my_index = native_split_my_index(parent))) {
+        scon_output(0, "%s native_split: scon %d is not an operational scon of ours",
+                    SCON_PRINT_PROC(SCON_PROC_MY_NAME), req->post.split.parent);
+        native_split_complete(req, SCON_ERR_NOT_FOUND, SCON_HANDLE_INVALID);
+        return;
+    }
+    index = (uint32_t)my_index;
+    if (0 < req->post.split.block) {
+        /* no need to ask anyone, our group is the run of members we are in */
+        start = index - index % req->post.split.block;
+        n = parent->nmembers - start;
+        if (n > req->post.split.block) {
+            n = req->post.split.block;
+        }
+        SCON_PROC_CREATE(members, n);
+        i = 0;
+        SCON_LIST_FOREACH(mem, &parent->members, scon_member_t) {
+            if (i >= start && i < start + n) {
+                memcpy(&members[i - start], &mem->name, sizeof(scon_proc_t));
+            }
+            i++;
+        }
+        native_split_create(req, parent, members, n);
+        SCON_PROC_FREE(members, n);
+        return;
+    }
+    buf = (scon_buffer_t*) malloc (sizeof(scon_buffer_t));
+    scon_buffer_construct(buf);
+    if (SCON_SUCCESS != (rc = scon_bfrop.pack(buf, SCON_PROC_MY_NAME, 1, SCON_PROC)) ||
+        SCON_SUCCESS != (rc = scon_bfrop.pack(buf, &color, 1, SCON_INT32)) ||
+        SCON_SUCCESS != (rc = scon_bfrop.pack(buf, &key, 1, SCON_INT32)) ||
+        SCON_SUCCESS != (rc = scon_bfrop.pack(buf, &index, 1, SCON_UINT32))) {
+        SCON_ERROR_LOG(rc);
+        scon_buffer_destruct(buf);
+        free(buf);
+        native_split_complete(req, rc, SCON_HANDLE_INVALID);
+        return;
+    }
+    collectives_base_api_allgather(parent->handle,
+                                   NULL, 0,
+                                   buf, native_split_allgather_cbfunc,
+                                   req,
+                                   NULL, 0);
+}
+
 /**
  * native init
  */
@@ -480,8 +863,11 @@ static int native_getinfo ( scon_handle_t scon_handle,
     }
     /* only limited infos are supported at this time */
     for(i = 0; i< *ninfo; i++) {
-        if(0 == strncmp(info[i]->key, SCON_NUM_MEMBERS, SCON_MAX_KEYLEN)) {
-            scon_value_load(&info[i]->value, (void *)&scon->nmembers, SCON_UINT32);
+        if(0 == strncmp((*info)[i].key, SCON_NUM_MEMBERS, SCON_MAX_KEYLEN)) {
+            scon_value_load(&(*info)[i].value, (void *)&scon->nmembers, SCON_UINT32);
+            continue;
+        }
+        if (SCON_SUCCESS == scon_perf_get_info((*info)[i].key, &(*info)[i].value)) {
             continue;
         }
         /* to do check & return additional info keys*/
@@ -528,6 +914,49 @@ static int native_delete (scon_handle_t scon_handle,
     return SCON_SUCCESS;
 }
 
+/**
+ * native split
+ */
+static int native_split (scon_handle_t parent,
+                       int color,
+                       int key,
+                       scon_info_t info[],
+                       size_t ninfo,
+                       scon_create_cbfunc_t cbfunc,
+                       void *cbdata)
+{
+    scon_req_t *req;
+    size_t i;
+
+    if (NULL == scon_comm_base_get_scon(parent)) {
+        return SCON_HANDLE_INVALID;
+    }
+    req = SCON_NEW(scon_req_t);
+    req->post.split.parent = parent;
+    req->post.split.color = color;
+    req->post.split.key = key;
+    req->post.split.block = 0;
+    req->post.split.cbfunc = cbfunc;
+    req->post.split.cbdata = cbdata;
+    req->post.split.info = info;
+    req->post.split.ninfo = ninfo;
+    for (i = 0; i < ninfo; i++) {
+        if (0 == strncmp(info[i].key, SCON_SPLIT_BLOCK, SCON_MAX_KEYLEN)) {
+            req->post.split.block = info[i].value.data.uint32;
+            continue;
+        }
+    }
+    scon_output_verbose(2, scon_comm_base_framework.framework_output,
+                        "%s scon_native_split splitting scon %d color %d key %d block %u",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), parent, color, key,
+                        req->post.split.block);
+    /* setup the event for rest of the processing  */
+    scon_event_set(scon_globals.evbase, &req->ev, -1, SCON_EV_WRITE, native_process_split, req);
+    scon_event_set_priority(&req->ev, SCON_MSG_PRI);
+    scon_event_active(&req->ev, SCON_EV_WRITE, 1);
+    return SCON_HANDLE_NEW;
+}
+
 /**
  * native_finalize
  */
@@ -24,7 +24,10 @@
 #include "src/mca/base/base.h"
 #include "src/class/scon_hash_table.h"
 #include "src/class/scon_bitmap.h"
+#include "src/util/perf.h"
+#include "src/util/trace.h"
 #include "src/mca/pt2pt/pt2pt.h"
+#include "src/mca/comm/base/base.h"
 
 SCON_EXPORT extern scon_mca_base_framework_t scon_pt2pt_base_framework;
 
@@ -35,6 +38,23 @@ typedef struct {
     scon_hash_table_t peers;
     bool num_threads;
     scon_event_base_t *pt2pt_evbase;
+    /* messages received for a scon we haven't created yet - a
+     * peer can finish its create or split before we start ours */
+    scon_list_t early_msgs;
+    /* messages larger than this are sent by rendezvous */
+    size_t eager_limit;
+    /* default caps on the eager messages held unmatched by a scon */
+    size_t unexpected_bytes;
+    int unexpected_msgs;
+    /* rendezvous sends waiting for the receiver to pull them */
+    uint32_t rndv_next_id;
+    scon_list_t rndv_sends;
+    /* matched rendezvous receives waiting for their data */
+    scon_list_t rndv_pulls;
+    /* peers that asked us to send everything by rendezvous, by scon */
+    scon_list_t rndv_peers;
+    /* origins we asked to send everything by rendezvous, by scon */
+    scon_list_t throttled;
 } scon_pt2pt_base_t;
 SCON_EXPORT extern scon_pt2pt_base_t scon_pt2pt_base;
 
@@ -45,10 +65,36 @@ typedef struct {
 } scon_pt2pt_base_peer_t;
 SCON_EXPORT SCON_CLASS_DECLARATION(scon_pt2pt_base_peer_t);
 
+/* a message moving by rendezvous - on the sending side the held
+ * send, on the receiving side the recv its data goes to. Also used
+ * to remember the peers we have throttled or been throttled by */
+typedef struct {
+    scon_list_item_t super;
+    uint32_t id;
+    scon_handle_t scon_handle;
+    /* the receiver of a send, the sender of a pull */
+    scon_proc_t peer;
+    /* the user's tag and callback for a held send */
+    scon_msg_tag_t tag;
+    scon_send_req_t *req;
+    scon_send_cbfunc_t cbfunc;
+    void *cbdata;
+    scon_posted_recv_t *post;
+    /* messages from the same sender on the same tag that came in
+     * while we wait for the data of a pull */
+    scon_list_t held;
+} scon_pt2pt_base_rndv_t;
+SCON_EXPORT SCON_CLASS_DECLARATION(scon_pt2pt_base_rndv_t);
+
 /* select a component */
 int scon_pt2pt_base_select(void);
 /* get a module of the selected component */
 scon_pt2pt_module_t * scon_pt2pt_base_get_module(char *comp_name);
+/* size the peer tables of the base and the active components */
+int scon_pt2pt_base_reserve_peers(size_t npeers);
+/* old slots moved per insert/remove when a peer table grows, so
+ * a growing table never stalls progress for a full rehash */
+#define SCON_PT2PT_PEERS_MIGRATE_STEP 16
 #define SCON_PT2PT_NUM_THREADS 8
 
 #define PT2PT_SEND_MESSAGE(m)                                        \
@@ -69,6 +115,7 @@ scon_pt2pt_module_t * scon_pt2pt_base_get_module(char *comp_name);
     cd->post.send.dst.rank = m->dst.rank;                           \
     cd->post.send.cbfunc = m->cbfunc;                               \
     cd->post.send.cbdata = m->cbdata;                               \
+    cd->post.send.priority = m->priority;                           \
     strncpy(cd->post.send.dst.job_name, m->dst.job_name,            \
         SCON_MAX_JOBLEN);                                           \
     scon_event_set(scon_pt2pt_base.pt2pt_evbase, &cd->ev, -1,        \
@@ -95,6 +142,8 @@ scon_pt2pt_module_t * scon_pt2pt_base_get_module(char *comp_name);
     msg->scon_handle = (h);                                                \
     msg->iov.iov_base = (IOVBASE_TYPE*)(b);                                \
     msg->iov.iov_len = (l);                                                \
+    SCON_PERF_MSG(false, (p), (t), (l));                                   \
+    SCON_TRACE(SCON_TRACE_RECV, (p)->rank, (t));                           \
     /* setup the event */                                                  \
     scon_event_set(scon_pt2pt_base.pt2pt_evbase, &msg->ev, -1,             \
                    SCON_EV_WRITE,                                          \
@@ -120,6 +169,12 @@ do {                                                                 \
      }                                                               \
 }while(0);
 
+/* the class a message is sent in - the SCON_MSG_PRIORITY info
+ * key if given, otherwise the default for the tag */
+SCON_EXPORT uint8_t scon_pt2pt_base_priority(scon_msg_tag_t tag,
+                                             scon_info_t info[],
+                                             size_t ninfo);
+
 /* stub function declarations */
 SCON_EXPORT int pt2pt_base_api_send_nb (scon_handle_t scon_handle,
                             scon_proc_t *peer,
@@ -146,7 +201,18 @@ SCON_EXPORT int pt2pt_base_api_recv_cancel (scon_handle_t scon_handle,
 /* internal pt2pt helper functions */
 SCON_EXPORT void pt2pt_base_post_recv(int sd, short args, void *cbdata);
 SCON_EXPORT void pt2pt_base_process_recv_msg(int fd, short flags, void *cbdata);
+SCON_EXPORT void scon_pt2pt_base_release_early_msgs(scon_handle_t scon_handle);
+SCON_EXPORT void scon_pt2pt_base_drop_early_msgs(scon_handle_t scon_handle);
 SCON_EXPORT void scon_pt2pt_base_get_contact_info(char **uri);
 SCON_EXPORT void scon_pt2pt_base_set_contact_info(char *uri);
 SCON_EXPORT void pt2pt_base_process_send (int fd, short flags, void *cbdata);
+SCON_EXPORT void scon_pt2pt_base_deliver(scon_posted_recv_t *post, scon_recv_t *msg);
+/* rendezvous protocol */
+SCON_EXPORT bool scon_pt2pt_base_rndv_send(scon_comm_scon_t *scon, scon_send_req_t *req);
+SCON_EXPORT bool scon_pt2pt_base_rndv_recv(scon_recv_t *msg);
+SCON_EXPORT bool scon_pt2pt_base_rndv_hold(scon_recv_t *msg);
+SCON_EXPORT void scon_pt2pt_base_rndv_pull(scon_comm_scon_t *scon, scon_posted_recv_t *post,
+                                           scon_recv_t *msg);
+SCON_EXPORT void scon_pt2pt_base_unexpected_add(scon_comm_scon_t *scon, scon_recv_t *msg);
+SCON_EXPORT void scon_pt2pt_base_unexpected_remove(scon_comm_scon_t *scon, scon_recv_t *msg);
 #endif /* SCON_PT2PT_BASE_H */
@@ -38,7 +38,14 @@ static int scon_pt2pt_base_open(scon_mca_base_open_flag_t flags)
     scon_pt2pt_base.max_uri_length = -1;
     SCON_CONSTRUCT(&scon_pt2pt_base.peers, scon_hash_table_t);
     scon_hash_table_init(&scon_pt2pt_base.peers, 128);
+    scon_hash_table_set_incremental(&scon_pt2pt_base.peers, SCON_PT2PT_PEERS_MIGRATE_STEP);
     SCON_CONSTRUCT(&scon_pt2pt_base.actives, scon_list_t);
+    SCON_CONSTRUCT(&scon_pt2pt_base.early_msgs, scon_list_t);
+    SCON_CONSTRUCT(&scon_pt2pt_base.rndv_sends, scon_list_t);
+    SCON_CONSTRUCT(&scon_pt2pt_base.rndv_pulls, scon_list_t);
+    SCON_CONSTRUCT(&scon_pt2pt_base.throttled, scon_list_t);
+    SCON_CONSTRUCT(&scon_pt2pt_base.rndv_peers, scon_list_t);
+    scon_pt2pt_base.rndv_next_id = 0;
     if ((SCON_PROC_IS_MASTER) || (SCON_PROC_IS_INTERIM_NODE)) {
         scon_pt2pt_base.pt2pt_evbase = scon_progress_thread_init("PT2PT_BASE");
     } else {
@@ -60,6 +67,32 @@ static int scon_pt2pt_base_register(scon_mca_base_register_flag_t flags)
                                 9,
                                 SCON_MCA_BASE_VAR_SCOPE_READONLY,
                                 &scon_pt2pt_base.num_threads);
+    scon_pt2pt_base.eager_limit = 1024 * 1024;
+    (void)scon_mca_base_var_register("scon", "pt2pt", "base", "eager_limit",
+                                "Messages of more than this many bytes are announced to the "
+                                "receiver and only sent once it has posted a matching recv",
+                                SCON_MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0,
+                                SCON_INFO_LVL_5,
+                                SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                &scon_pt2pt_base.eager_limit);
+    scon_pt2pt_base.unexpected_bytes = 256 * 1024 * 1024;
+    (void)scon_mca_base_var_register("scon", "pt2pt", "base", "unexpected_bytes",
+                                "Bytes of unmatched eager messages a scon holds before asking "
+                                "their senders to send everything by rendezvous, unless set "
+                                "by the SCON_RECV_QUEUE_BYTES key (0 = unlimited)",
+                                SCON_MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0,
+                                SCON_INFO_LVL_5,
+                                SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                &scon_pt2pt_base.unexpected_bytes);
+    scon_pt2pt_base.unexpected_msgs = 4096;
+    (void)scon_mca_base_var_register("scon", "pt2pt", "base", "unexpected_msgs",
+                                "Number of unmatched eager messages a scon holds before asking "
+                                "their senders to send everything by rendezvous, unless set "
+                                "by the SCON_RECV_QUEUE_LENGTH key (0 = unlimited)",
+                                SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                SCON_INFO_LVL_5,
+                                SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                &scon_pt2pt_base.unexpected_msgs);
     return SCON_SUCCESS;
 }
 
@@ -81,6 +114,11 @@ static int scon_pt2pt_base_close(void)
 
     /* destruct our internal lists */
     SCON_DESTRUCT(&scon_pt2pt_base.actives);
+    SCON_LIST_DESTRUCT(&scon_pt2pt_base.early_msgs);
+    SCON_LIST_DESTRUCT(&scon_pt2pt_base.rndv_sends);
+    SCON_LIST_DESTRUCT(&scon_pt2pt_base.rndv_pulls);
+    SCON_LIST_DESTRUCT(&scon_pt2pt_base.throttled);
+    SCON_LIST_DESTRUCT(&scon_pt2pt_base.rndv_peers);
 
     /* release all peers from the hash table */
     SCON_HASH_TABLE_FOREACH(key, uint64, value, &scon_pt2pt_base.peers) {
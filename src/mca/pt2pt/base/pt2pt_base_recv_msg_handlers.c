@@ -30,6 +30,8 @@
 #include "src/util/output.h"
 #include "src/class/scon_list.h"
 #include "src/util/name_fns.h"
+#include "src/util/perf.h"
+#include "src/util/trace.h"
 #include "src/mca/comm/base/base.h"
 #include "src/mca/pt2pt/base/base.h"
 #include "src/buffer_ops/types.h"
@@ -64,6 +66,8 @@ void pt2pt_base_post_recv(int sd, short args, void *cbdata)
         /* something went wrong */
         scon_output(0, "%s dangling SCON RECV request, invalid scon handle %d",
                     SCON_PRINT_PROC(SCON_PROC_MY_NAME), post->scon_handle );
+        SCON_RELEASE(req);
+        return;
     }
     /* if the request is to cancel a recv, then find the recv
      * and remove it from our list
@@ -111,19 +115,70 @@ void pt2pt_base_post_recv(int sd, short args, void *cbdata)
     SCON_RELEASE(req);
 }
 
+/* hand a message to the recv it matched - the message is released */
+void scon_pt2pt_base_deliver(scon_posted_recv_t *post, scon_recv_t *msg)
+{
+    scon_buffer_t buf;
+
+    /* deliver the data in the buffer */
+    //SCON_CONSTRUCT(&buf, scon_buffer_t);
+    scon_buffer_construct(&buf);
+    if(SCON_SUCCESS != scon_buffer_load(&buf, msg->iov.iov_base, msg->iov.iov_len)) {
+        scon_output(0, "%s error loading received buffer on scon %d tag =%d from peer %s",
+                    SCON_PRINT_PROC(SCON_PROC_MY_NAME), msg->scon_handle, msg->tag,
+                    SCON_PRINT_PROC(&msg->sender));
+        SCON_ERROR_LOG(SCON_ERR_SILENT);
+    }
+    /* xfer ownership of the malloc'd data to the buffer */
+    msg->iov.iov_base = NULL;
+    SCON_TRACE(SCON_TRACE_MATCH, msg->sender.rank, msg->tag);
+    SCON_TRACE_BEGIN(SCON_TRACE_RECV_CB, msg->sender.rank, msg->tag);
+    post->cbfunc(SCON_SUCCESS, msg->scon_handle, &msg->sender, &buf, msg->tag, post->cbdata);
+    SCON_TRACE_END(SCON_TRACE_RECV_CB, msg->sender.rank, msg->tag);
+    /* the user must have unloaded the buffer if they wanted
+     * to retain ownership of it, so release whatever remains
+     */
+    scon_output_verbose(5, scon_pt2pt_base_framework.framework_output,
+                             "%s message received  bytes from %s for tag %d called callback",
+                             SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                             SCON_PRINT_PROC(&msg->sender),
+                             msg->tag);
+    /* release the message */
+    SCON_RELEASE(msg);
+    scon_output_verbose(5, scon_pt2pt_base_framework.framework_output,
+                         "%s message tag %d on released",
+                         SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                         post->tag);
+}
+
 static void pt2pt_base_complete_recv_msg (scon_recv_t **recv_msg)
 {
     scon_posted_recv_t *post;
     scon_ns_cmp_bitmask_t mask = SCON_NS_CMP_ALL | SCON_NS_CMP_WILD;
-    scon_buffer_t buf;
     scon_recv_t *msg = *recv_msg;
     scon_comm_scon_t *scon;
+
+    /* rendezvous control messages and data are dealt with
+     * there - an announcement comes back as a stub of the
+     * message it announces, to be matched like any other */
+    if (scon_pt2pt_base_rndv_recv(msg)) {
+        return;
+    }
     scon = scon_comm_base_get_scon(msg->scon_handle);
 
     if (NULL == scon) {
-        SCON_ERROR_LOG(SCON_ERR_NOT_FOUND);
-        scon_output(0, "OOPS received a message on a non existent SCON handle %d, tag %d",
-                   msg->scon_handle, msg->tag);
+        /* the sender may be ahead of us in creating the scon, hold
+         * the message until we add it */
+        scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
+                            "%s message from %s for tag %d on scon %d we don't have yet, holding it",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                            SCON_PRINT_PROC(&msg->sender),
+                            msg->tag, msg->scon_handle);
+        scon_list_append(&scon_pt2pt_base.early_msgs, &msg->super);
+        return;
+    }
+    /* don't let it overtake a message whose data we are pulling */
+    if (scon_pt2pt_base_rndv_hold(msg)) {
         return;
     }
 
@@ -134,32 +189,12 @@ static void pt2pt_base_complete_recv_msg (scon_recv_t **recv_msg)
          */
         if (SCON_EQUAL == scon_util_compare_name_fields(mask, &msg->sender, &post->peer) &&
             msg->tag == post->tag) {
-            /* deliver the data in the buffer */
-            //SCON_CONSTRUCT(&buf, scon_buffer_t);
-            scon_buffer_construct(&buf);
-            if(SCON_SUCCESS != scon_buffer_load(&buf, msg->iov.iov_base, msg->iov.iov_len)) {
-                scon_output(0, "%s error loading received buffer on scon %d tag =%d from peer %s",
-                            SCON_PRINT_PROC(SCON_PROC_MY_NAME), scon->handle, msg->tag,
-                            SCON_PRINT_PROC(&msg->sender));
-                SCON_ERROR_LOG(SCON_ERR_SILENT);
+            if (msg->rndv) {
+                /* have the sender send the data for this recv */
+                scon_pt2pt_base_rndv_pull(scon, post, msg);
+                return;
             }
-            /* xfer ownership of the malloc'd data to the buffer */
-            msg->iov.iov_base = NULL;
-            post->cbfunc(SCON_SUCCESS, msg->scon_handle, &msg->sender, &buf, msg->tag, post->cbdata);
-            /* the user must have unloaded the buffer if they wanted
-             * to retain ownership of it, so release whatever remains
-             */
-            scon_output_verbose(5, scon_pt2pt_base_framework.framework_output,
-                                     "%s message received  bytes from %s for tag %d called callback",
-                                     SCON_PRINT_PROC(SCON_PROC_MY_NAME),
-                                     SCON_PRINT_PROC(&msg->sender),
-                                     msg->tag);
-            /* release the message */
-            SCON_RELEASE(msg);
-            scon_output_verbose(5, scon_pt2pt_base_framework.framework_output,
-                                 "%s message tag %d on released",
-                                 SCON_PRINT_PROC(SCON_PROC_MY_NAME),
-                                 post->tag);
+            scon_pt2pt_base_deliver(post, msg);
 
             /* if the recv is non-persistent, remove it */
             if (!post->persistent) {
@@ -184,6 +219,10 @@ static void pt2pt_base_complete_recv_msg (scon_recv_t **recv_msg)
                             msg->tag,
                             msg->scon_handle);
      scon_list_append(&scon->unmatched_msgs, &msg->super);
+     scon_pt2pt_base_unexpected_add(scon, msg);
+     SCON_PERF_INC(SCON_PERF_CTR_UNMATCHED_MSGS);
+     SCON_PERF_HIST(SCON_PERF_HIST_UNMATCHED_DEPTH,
+                    scon_list_get_size(&scon->unmatched_msgs));
 }
 
 static void match_posted_recv(scon_posted_recv_t *rcv,
@@ -217,12 +256,14 @@ static void match_posted_recv(scon_posted_recv_t *rcv,
             scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
                                 "matched recv message with unmatched msg on scon %d tag %d",
                                  rcv->tag, rcv->scon_handle);
-            scon_event_set(scon_globals.evbase, &msg->ev, -1,
+            scon_event_set(scon_pt2pt_base.pt2pt_evbase, &msg->ev, -1,
                                SCON_EV_WRITE,
                                pt2pt_base_process_recv_msg, msg);
             scon_event_set_priority(&msg->ev, SCON_MSG_PRI);
             scon_event_active(&msg->ev, SCON_EV_WRITE, 1);
             scon_list_remove_item(&scon->unmatched_msgs, item);
+            SCON_PERF_DEC(SCON_PERF_CTR_UNMATCHED_MSGS);
+            scon_pt2pt_base_unexpected_remove(scon, msg);
 
             if (!get_all) {
                 break;
@@ -232,6 +273,73 @@ static void match_posted_recv(scon_posted_recv_t *rcv,
     }
 }
 
+/* the early messages are kept by the pt2pt thread, which queues
+ * them as they come in, so the scon they were waiting for is
+ * released or skipped there too */
+typedef struct {
+    scon_object_t super;
+    scon_event_t ev;
+    scon_handle_t scon_handle;
+    bool drop;
+} early_req_t;
+static SCON_CLASS_INSTANCE(early_req_t, scon_object_t, NULL, NULL);
+
+static void process_early_msgs(int fd, short flags, void *cbdata)
+{
+    early_req_t *req = (early_req_t*)cbdata;
+    scon_recv_t *msg, *next;
+    scon_list_t msgs;
+
+    SCON_CONSTRUCT(&msgs, scon_list_t);
+    SCON_LIST_FOREACH_SAFE(msg, next, &scon_pt2pt_base.early_msgs, scon_recv_t) {
+        if (msg->scon_handle != req->scon_handle) {
+            continue;
+        }
+        scon_list_remove_item(&scon_pt2pt_base.early_msgs, &msg->super);
+        if (req->drop) {
+            scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
+                                "%s dropping message from %s for tag %d on scon %d",
+                                SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                                SCON_PRINT_PROC(&msg->sender),
+                                msg->tag, msg->scon_handle);
+            SCON_RELEASE(msg);
+            continue;
+        }
+        scon_list_append(&msgs, &msg->super);
+    }
+    /* we are on the thread that completes them - do it now,
+     * ahead of anything that came in since the scon was added */
+    while (NULL != (msg = (scon_recv_t*)scon_list_remove_first(&msgs))) {
+        pt2pt_base_complete_recv_msg(&msg);
+    }
+    SCON_DESTRUCT(&msgs);
+    SCON_RELEASE(req);
+}
+
+static void post_early_req(scon_handle_t scon_handle, bool drop)
+{
+    early_req_t *req;
+
+    req = SCON_NEW(early_req_t);
+    req->scon_handle = scon_handle;
+    req->drop = drop;
+    scon_event_set(scon_pt2pt_base.pt2pt_evbase, &req->ev, -1,
+                   SCON_EV_WRITE,
+                   process_early_msgs, req);
+    scon_event_set_priority(&req->ev, SCON_MSG_PRI);
+    scon_event_active(&req->ev, SCON_EV_WRITE, 1);
+}
+
+void scon_pt2pt_base_release_early_msgs(scon_handle_t scon_handle)
+{
+    post_early_req(scon_handle, false);
+}
+
+void scon_pt2pt_base_drop_early_msgs(scon_handle_t scon_handle)
+{
+    post_early_req(scon_handle, true);
+}
+
 void pt2pt_base_process_recv_msg(int fd, short flags, void *cbdata)
 {
     scon_recv_t *msg = (scon_recv_t*)cbdata;
@@ -0,0 +1,558 @@
+/*
+ * Copyright (c) 2017      Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Rendezvous protocol for large messages.
+ *
+ * A message of more than pt2pt_base_eager_limit bytes isn't sent
+ * right away. The sender holds it and sends the receiver an RTS
+ * carrying its id, tag and size. The receiver matches the RTS like
+ * any message, holding it on the unmatched queue if need be, and
+ * once a recv takes it answers with a CTS. Only then does the data
+ * go out, with the id appended so the receiver can hand it to the
+ * recv that asked for it. The recv is taken off the posted list when
+ * the CTS goes out, so a later message can't claim it meanwhile.
+ * Messages from the same sender on the same tag that arrive before
+ * the data are held on the pull and matched once it is delivered,
+ * so they can't overtake it either.
+ *
+ * Every scon also caps the eager messages it holds unmatched, by
+ * count (SCON_RECV_QUEUE_LENGTH) and by bytes (SCON_RECV_QUEUE_BYTES).
+ * When a message takes a scon over either cap, its sender is sent a
+ * THROTTLE and from then on sends it everything by rendezvous on that
+ * scon, so the unmatched queue only grows by announcements. Once the
+ * queue is back under half its caps the throttles of the scon are
+ * lifted. Both sides track a throttle by scon and peer. The library's
+ * own tags always go eager - their recvs are posted for the life of
+ * the scon.
+ */
+#include "scon_config.h"
+#include <scon_common.h>
+#include <scon.h>
+
+#include <arpa/inet.h>
+
+#include "src/buffer_ops/buffer_ops.h"
+#include "src/buffer_ops/types.h"
+#include "src/buffer_ops/internal.h"
+#include "src/util/output.h"
+#include "src/util/error.h"
+#include "src/util/name_fns.h"
+#include "src/include/scon_globals.h"
+
+#include "src/mca/mca.h"
+#include "src/mca/base/base.h"
+#include "src/mca/comm/base/base.h"
+#include "src/mca/pt2pt/base/base.h"
+#include "src/mca/pt2pt/pt2pt.h"
+
+static void ctrl_complete(int status, scon_handle_t scon_handle,
+                          scon_proc_t *peer, scon_buffer_t *buffer,
+                          scon_msg_tag_t tag, void *cbdata);
+
+static scon_pt2pt_base_rndv_t* find(scon_list_t *list, uint32_t id, scon_proc_t *peer)
+{
+    scon_pt2pt_base_rndv_t *rndv;
+
+    SCON_LIST_FOREACH(rndv, list, scon_pt2pt_base_rndv_t) {
+        if (rndv->id == id &&
+            SCON_EQUAL == scon_util_compare_name_fields(SCON_NS_CMP_ALL, &rndv->peer, peer)) {
+            return rndv;
+        }
+    }
+    return NULL;
+}
+
+/* the throttle of the given scon and peer */
+static scon_pt2pt_base_rndv_t* find_throttle(scon_list_t *list, scon_handle_t scon_handle,
+                                             scon_proc_t *peer)
+{
+    scon_pt2pt_base_rndv_t *item;
+
+    SCON_LIST_FOREACH(item, list, scon_pt2pt_base_rndv_t) {
+        if (item->scon_handle == scon_handle &&
+            SCON_EQUAL == scon_util_compare_name_fields(SCON_NS_CMP_ALL, &item->peer, peer)) {
+            return item;
+        }
+    }
+    return NULL;
+}
+
+/* the pull waiting for data from the given sender on the given tag */
+static scon_pt2pt_base_rndv_t* find_pull(scon_handle_t scon_handle, scon_proc_t *peer,
+                                         scon_msg_tag_t tag)
+{
+    scon_pt2pt_base_rndv_t *rndv;
+
+    SCON_LIST_FOREACH(rndv, &scon_pt2pt_base.rndv_pulls, scon_pt2pt_base_rndv_t) {
+        if (rndv->scon_handle == scon_handle && rndv->tag == tag &&
+            SCON_EQUAL == scon_util_compare_name_fields(SCON_NS_CMP_ALL, &rndv->peer, peer)) {
+            return rndv;
+        }
+    }
+    return NULL;
+}
+
+/* send one of our control messages - the buffer is released on completion */
+static int send_ctrl(scon_handle_t scon_handle, scon_proc_t *peer,
+                     scon_buffer_t *buf, scon_msg_tag_t tag, void *cbdata)
+{
+    int rc;
+
+    if (SCON_SUCCESS != (rc = pt2pt_base_api_send_nb(scon_handle, peer, buf, tag,
+                                                     ctrl_complete, cbdata, NULL, 0))) {
+        SCON_ERROR_LOG(rc);
+        scon_buffer_destruct(buf);
+        free(buf);
+    }
+    return rc;
+}
+
+static scon_buffer_t* new_ctrl(void)
+{
+    scon_buffer_t *buf;
+
+    if (NULL != (buf = (scon_buffer_t*)malloc(sizeof(scon_buffer_t)))) {
+        scon_buffer_construct(buf);
+    }
+    return buf;
+}
+
+/* complete a send we were holding back to the user */
+static void complete_send(scon_pt2pt_base_rndv_t *rndv, int status)
+{
+    if (NULL != rndv->cbfunc) {
+        rndv->cbfunc(status, rndv->scon_handle, &rndv->peer,
+                     rndv->req->post.send.buf, rndv->tag, rndv->cbdata);
+    }
+    SCON_RELEASE(rndv);
+}
+
+static void ctrl_complete(int status, scon_handle_t scon_handle,
+                          scon_proc_t *peer, scon_buffer_t *buffer,
+                          scon_msg_tag_t tag, void *cbdata)
+{
+    scon_pt2pt_base_rndv_t *rndv;
+
+    scon_buffer_destruct(buffer);
+    free(buffer);
+    if (SCON_SUCCESS == status || SCON_MSG_TAG_RNDV_RTS != tag) {
+        return;
+    }
+    /* the receiver will never ask for this one */
+    if (NULL != (rndv = find(&scon_pt2pt_base.rndv_sends, (uint32_t)(uintptr_t)cbdata, peer))) {
+        scon_list_remove_item(&scon_pt2pt_base.rndv_sends, &rndv->super);
+        complete_send(rndv, status);
+    }
+}
+
+/* the data of a held send is out - give the user back the buffer
+ * as they gave it to us */
+static void data_complete(int status, scon_handle_t scon_handle,
+                          scon_proc_t *peer, scon_buffer_t *buffer,
+                          scon_msg_tag_t tag, void *cbdata)
+{
+    scon_pt2pt_base_rndv_t *rndv = (scon_pt2pt_base_rndv_t*)cbdata;
+
+    buffer->pack_ptr -= sizeof(uint32_t);
+    buffer->bytes_used -= sizeof(uint32_t);
+    scon_output_verbose(5, scon_pt2pt_base_framework.framework_output,
+                        "%s rendezvous %u to %s on tag %d complete with status %d",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), rndv->id,
+                        SCON_PRINT_PROC(&rndv->peer), rndv->tag, status);
+    complete_send(rndv, status);
+}
+
+SCON_EXPORT bool scon_pt2pt_base_rndv_send(scon_comm_scon_t *scon, scon_send_req_t *req)
+{
+    scon_send_t *snd = &req->post.send;
+    scon_pt2pt_base_rndv_t *rndv;
+    scon_buffer_t *rts;
+    size_t size = snd->buf->bytes_used;
+    int rc;
+
+    /* library traffic, and messages we are only relaying, go as they are */
+    if (snd->tag <= SCON_MSG_TAG_MAX_RESERVED ||
+        SCON_EQUAL != scon_util_compare_name_fields(SCON_NS_CMP_ALL, &snd->origin,
+                                                    SCON_PROC_MY_NAME)) {
+        return false;
+    }
+    if (size <= scon_pt2pt_base.eager_limit &&
+        NULL == find_throttle(&scon_pt2pt_base.rndv_peers, scon->handle, &snd->dst)) {
+        return false;
+    }
+    if (NULL == (rts = new_ctrl())) {
+        return false;
+    }
+    rndv = SCON_NEW(scon_pt2pt_base_rndv_t);
+    rndv->id = ++scon_pt2pt_base.rndv_next_id;
+    rndv->scon_handle = scon->handle;
+    rndv->peer = snd->dst;
+    rndv->tag = snd->tag;
+    rndv->req = req;
+    rndv->cbfunc = snd->cbfunc;
+    rndv->cbdata = snd->cbdata;
+    if (SCON_SUCCESS != (rc = scon_bfrop.pack(rts, &rndv->id, 1, SCON_UINT32)) ||
+        SCON_SUCCESS != (rc = scon_bfrop.pack(rts, &rndv->tag, 1, SCON_UINT32)) ||
+        SCON_SUCCESS != (rc = scon_bfrop.pack(rts, &size, 1, SCON_SIZE))) {
+        /* send it eagerly instead */
+        SCON_ERROR_LOG(rc);
+        scon_buffer_destruct(rts);
+        free(rts);
+        rndv->req = NULL;
+        SCON_RELEASE(rndv);
+        return false;
+    }
+    scon_list_append(&scon_pt2pt_base.rndv_sends, &rndv->super);
+    scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
+                        "%s holding %lu bytes to %s on tag %d as rendezvous %u",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), (unsigned long)size,
+                        SCON_PRINT_PROC(&snd->dst), snd->tag, rndv->id);
+    if (SCON_SUCCESS != (rc = send_ctrl(scon->handle, &snd->dst, rts, SCON_MSG_TAG_RNDV_RTS,
+                                        (void*)(uintptr_t)rndv->id))) {
+        scon_list_remove_item(&scon_pt2pt_base.rndv_sends, &rndv->super);
+        complete_send(rndv, rc);
+    }
+    return true;
+}
+
+/* the receiver has a recv for a send we are holding - send the
+ * data with the id on the end */
+static void cts(scon_recv_t *msg)
+{
+    scon_pt2pt_base_rndv_t *rndv;
+    scon_send_t *snd;
+    scon_buffer_t buf;
+    uint32_t id;
+    int32_t cnt = 1;
+    char *ptr;
+    int rc;
+
+    scon_buffer_construct(&buf);
+    scon_buffer_load(&buf, msg->iov.iov_base, msg->iov.iov_len);
+    msg->iov.iov_base = NULL;
+    rc = scon_bfrop.unpack(&buf, &id, &cnt, SCON_UINT32);
+    scon_buffer_destruct(&buf);
+    if (SCON_SUCCESS != rc) {
+        SCON_ERROR_LOG(rc);
+        return;
+    }
+    if (NULL == (rndv = find(&scon_pt2pt_base.rndv_sends, id, &msg->sender))) {
+        scon_output(0, "%s CTS from %s for unknown rendezvous %u",
+                    SCON_PRINT_PROC(SCON_PROC_MY_NAME), SCON_PRINT_PROC(&msg->sender), id);
+        return;
+    }
+    scon_list_remove_item(&scon_pt2pt_base.rndv_sends, &rndv->super);
+    snd = &rndv->req->post.send;
+    if (NULL == (ptr = scon_bfrop_buffer_extend(snd->buf, sizeof(id)))) {
+        complete_send(rndv, SCON_ERR_OUT_OF_RESOURCE);
+        return;
+    }
+    id = htonl(id);
+    memcpy(ptr, &id, sizeof(id));
+    snd->buf->pack_ptr += sizeof(id);
+    snd->buf->bytes_used += sizeof(id);
+    snd->tag = SCON_MSG_TAG_RNDV_DATA;
+    snd->cbfunc = data_complete;
+    snd->cbdata = rndv;
+    scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
+                        "%s sending rendezvous %u to %s",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), rndv->id,
+                        SCON_PRINT_PROC(&rndv->peer));
+    scon_event_set(scon_globals.evbase, &rndv->req->ev, -1, SCON_EV_WRITE,
+                   pt2pt_base_process_send, rndv->req);
+    scon_event_set_priority(&rndv->req->ev, SCON_MSG_PRI);
+    scon_event_active(&rndv->req->ev, SCON_EV_WRITE, 1);
+}
+
+/* the data for a recv we asked for */
+static void data(scon_recv_t *msg)
+{
+    scon_pt2pt_base_rndv_t *rndv, *next;
+    scon_recv_t *held;
+    uint32_t id;
+
+    if (msg->iov.iov_len < sizeof(id)) {
+        SCON_ERROR_LOG(SCON_ERR_UNPACK_FAILURE);
+        SCON_RELEASE(msg);
+        return;
+    }
+    msg->iov.iov_len -= sizeof(id);
+    memcpy(&id, (char*)msg->iov.iov_base + msg->iov.iov_len, sizeof(id));
+    id = ntohl(id);
+    if (NULL == (rndv = find(&scon_pt2pt_base.rndv_pulls, id, &msg->sender))) {
+        scon_output(0, "%s data from %s for unknown rendezvous %u",
+                    SCON_PRINT_PROC(SCON_PROC_MY_NAME), SCON_PRINT_PROC(&msg->sender), id);
+        SCON_RELEASE(msg);
+        return;
+    }
+    scon_list_remove_item(&scon_pt2pt_base.rndv_pulls, &rndv->super);
+    msg->tag = rndv->tag;
+    scon_pt2pt_base_deliver(rndv->post, msg);
+    /* now match what came in behind it, in order - once another
+     * announcement among them is pulled, the rest wait for that */
+    while (NULL != (held = (scon_recv_t*)scon_list_remove_first(&rndv->held))) {
+        pt2pt_base_process_recv_msg(-1, SCON_EV_WRITE, held);
+        if (NULL != (next = find_pull(rndv->scon_handle, &rndv->peer, rndv->tag))) {
+            scon_list_join(&next->held, scon_list_get_end(&next->held), &rndv->held);
+            break;
+        }
+    }
+    SCON_RELEASE(rndv);
+}
+
+SCON_EXPORT bool scon_pt2pt_base_rndv_hold(scon_recv_t *msg)
+{
+    scon_pt2pt_base_rndv_t *rndv;
+
+    if (NULL == (rndv = find_pull(msg->scon_handle, &msg->sender, msg->tag))) {
+        return false;
+    }
+    scon_output_verbose(5, scon_pt2pt_base_framework.framework_output,
+                        "%s holding message from %s on tag %d behind rendezvous %u",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                        SCON_PRINT_PROC(&msg->sender), msg->tag, rndv->id);
+    scon_list_append(&rndv->held, &msg->super);
+    return true;
+}
+
+/* a receiver wants everything we send it by rendezvous, or no longer */
+static void throttle(scon_recv_t *msg)
+{
+    scon_pt2pt_base_rndv_t *item;
+    scon_buffer_t buf;
+    bool on;
+    int32_t cnt = 1;
+    int rc;
+
+    scon_buffer_construct(&buf);
+    scon_buffer_load(&buf, msg->iov.iov_base, msg->iov.iov_len);
+    msg->iov.iov_base = NULL;
+    rc = scon_bfrop.unpack(&buf, &on, &cnt, SCON_BOOL);
+    scon_buffer_destruct(&buf);
+    if (SCON_SUCCESS != rc) {
+        SCON_ERROR_LOG(rc);
+        return;
+    }
+    scon_output_verbose(1, scon_pt2pt_base_framework.framework_output,
+                        "%s %s asks for %s sends on scon %d",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), SCON_PRINT_PROC(&msg->sender),
+                        on ? "rendezvous" : "eager", msg->scon_handle);
+    item = find_throttle(&scon_pt2pt_base.rndv_peers, msg->scon_handle, &msg->sender);
+    if (on && NULL == item) {
+        item = SCON_NEW(scon_pt2pt_base_rndv_t);
+        item->scon_handle = msg->scon_handle;
+        item->peer = msg->sender;
+        scon_list_append(&scon_pt2pt_base.rndv_peers, &item->super);
+    } else if (!on && NULL != item) {
+        scon_list_remove_item(&scon_pt2pt_base.rndv_peers, &item->super);
+        SCON_RELEASE(item);
+    }
+}
+
+SCON_EXPORT bool scon_pt2pt_base_rndv_recv(scon_recv_t *msg)
+{
+    scon_buffer_t buf;
+    int32_t cnt;
+    int rc;
+
+    switch (msg->tag) {
+        case SCON_MSG_TAG_RNDV_RTS:
+            /* turn it into a stub of the message it announces */
+            scon_buffer_construct(&buf);
+            scon_buffer_load(&buf, msg->iov.iov_base, msg->iov.iov_len);
+            msg->iov.iov_base = NULL;
+            msg->iov.iov_len = 0;
+            cnt = 1;
+            if (SCON_SUCCESS == (rc = scon_bfrop.unpack(&buf, &msg->rndv_id, &cnt, SCON_UINT32))) {
+                cnt = 1;
+                if (SCON_SUCCESS == (rc = scon_bfrop.unpack(&buf, &msg->tag, &cnt, SCON_UINT32))) {
+                    cnt = 1;
+                    rc = scon_bfrop.unpack(&buf, &msg->rndv_size, &cnt, SCON_SIZE);
+                }
+            }
+            scon_buffer_destruct(&buf);
+            if (SCON_SUCCESS != rc) {
+                SCON_ERROR_LOG(rc);
+                SCON_RELEASE(msg);
+                return true;
+            }
+            msg->rndv = true;
+            scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
+                                "%s %s announces %lu bytes on tag %d as rendezvous %u",
+                                SCON_PRINT_PROC(SCON_PROC_MY_NAME), SCON_PRINT_PROC(&msg->sender),
+                                (unsigned long)msg->rndv_size, msg->tag, msg->rndv_id);
+            return false;
+        case SCON_MSG_TAG_RNDV_CTS:
+            cts(msg);
+            SCON_RELEASE(msg);
+            return true;
+        case SCON_MSG_TAG_RNDV_DATA:
+            data(msg);
+            return true;
+        case SCON_MSG_TAG_RNDV_THROTTLE:
+            throttle(msg);
+            SCON_RELEASE(msg);
+            return true;
+        default:
+            return false;
+    }
+}
+
+SCON_EXPORT void scon_pt2pt_base_rndv_pull(scon_comm_scon_t *scon, scon_posted_recv_t *post,
+                                           scon_recv_t *msg)
+{
+    scon_pt2pt_base_rndv_t *rndv;
+    scon_buffer_t *buf;
+    int rc;
+
+    if (NULL == (buf = new_ctrl())) {
+        SCON_ERROR_LOG(SCON_ERR_OUT_OF_RESOURCE);
+        SCON_RELEASE(msg);
+        return;
+    }
+    if (SCON_SUCCESS != (rc = scon_bfrop.pack(buf, &msg->rndv_id, 1, SCON_UINT32))) {
+        SCON_ERROR_LOG(rc);
+        scon_buffer_destruct(buf);
+        free(buf);
+        SCON_RELEASE(msg);
+        return;
+    }
+    rndv = SCON_NEW(scon_pt2pt_base_rndv_t);
+    rndv->id = msg->rndv_id;
+    rndv->scon_handle = msg->scon_handle;
+    rndv->peer = msg->sender;
+    rndv->tag = msg->tag;
+    if (SCON_SUCCESS != send_ctrl(scon->handle, &msg->sender, buf, SCON_MSG_TAG_RNDV_CTS, NULL)) {
+        SCON_RELEASE(rndv);
+        SCON_RELEASE(msg);
+        return;
+    }
+    /* the recv is spoken for until the data arrives */
+    if (post->persistent) {
+        SCON_RETAIN(post);
+    } else {
+        scon_list_remove_item(&scon->posted_recvs, &post->super);
+    }
+    rndv->post = post;
+    scon_list_append(&scon_pt2pt_base.rndv_pulls, &rndv->super);
+    scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
+                        "%s pulling rendezvous %u of %lu bytes from %s",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), rndv->id,
+                        (unsigned long)msg->rndv_size, SCON_PRINT_PROC(&msg->sender));
+    SCON_RELEASE(msg);
+}
+
+static void send_throttle(scon_pt2pt_base_rndv_t *item, bool on)
+{
+    scon_buffer_t *buf;
+    int rc;
+
+    if (NULL == (buf = new_ctrl())) {
+        SCON_ERROR_LOG(SCON_ERR_OUT_OF_RESOURCE);
+        return;
+    }
+    if (SCON_SUCCESS != (rc = scon_bfrop.pack(buf, &on, 1, SCON_BOOL))) {
+        SCON_ERROR_LOG(rc);
+        scon_buffer_destruct(buf);
+        free(buf);
+        return;
+    }
+    send_ctrl(item->scon_handle, &item->peer, buf, SCON_MSG_TAG_RNDV_THROTTLE, NULL);
+}
+
+/* is the unmatched queue over 1/divisor of its caps */
+static bool over_caps(scon_comm_scon_t *scon, size_t divisor)
+{
+    size_t max_msgs, max_bytes;
+
+    max_msgs = (0 < scon->recv_queue_len) ? scon->recv_queue_len :
+               (0 < scon_pt2pt_base.unexpected_msgs) ? (size_t)scon_pt2pt_base.unexpected_msgs : 0;
+    max_bytes = (0 < scon->recv_queue_bytes) ? scon->recv_queue_bytes :
+                scon_pt2pt_base.unexpected_bytes;
+    return ((0 < max_msgs && scon->unmatched_eager > max_msgs / divisor) ||
+            (0 < max_bytes && scon->unmatched_bytes > max_bytes / divisor));
+}
+
+SCON_EXPORT void scon_pt2pt_base_unexpected_add(scon_comm_scon_t *scon, scon_recv_t *msg)
+{
+    scon_pt2pt_base_rndv_t *item;
+
+    /* announcements hold no data */
+    if (msg->rndv) {
+        return;
+    }
+    ++scon->unmatched_eager;
+    scon->unmatched_bytes += msg->iov.iov_len;
+    if (!over_caps(scon, 1) ||
+        SCON_EQUAL == scon_util_compare_name_fields(SCON_NS_CMP_ALL, &msg->sender,
+                                                    SCON_PROC_MY_NAME)) {
+        return;
+    }
+    if (NULL != find_throttle(&scon_pt2pt_base.throttled, scon->handle, &msg->sender)) {
+        return;
+    }
+    scon_output_verbose(1, scon_pt2pt_base_framework.framework_output,
+                        "%s scon %d holds %lu unmatched messages of %lu bytes, "
+                        "asking %s for rendezvous sends",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), scon->handle,
+                        (unsigned long)scon->unmatched_eager,
+                        (unsigned long)scon->unmatched_bytes,
+                        SCON_PRINT_PROC(&msg->sender));
+    item = SCON_NEW(scon_pt2pt_base_rndv_t);
+    item->scon_handle = scon->handle;
+    item->peer = msg->sender;
+    scon_list_append(&scon_pt2pt_base.throttled, &item->super);
+    send_throttle(item, true);
+}
+
+SCON_EXPORT void scon_pt2pt_base_unexpected_remove(scon_comm_scon_t *scon, scon_recv_t *msg)
+{
+    scon_pt2pt_base_rndv_t *item, *next;
+
+    if (msg->rndv) {
+        return;
+    }
+    --scon->unmatched_eager;
+    scon->unmatched_bytes -= msg->iov.iov_len;
+    if (over_caps(scon, 2)) {
+        return;
+    }
+    SCON_LIST_FOREACH_SAFE(item, next, &scon_pt2pt_base.throttled, scon_pt2pt_base_rndv_t) {
+        if (item->scon_handle != (scon_handle_t)scon->handle) {
+            continue;
+        }
+        send_throttle(item, false);
+        scon_list_remove_item(&scon_pt2pt_base.throttled, &item->super);
+        SCON_RELEASE(item);
+    }
+}
+
+static void rndv_cons(scon_pt2pt_base_rndv_t *ptr)
+{
+    ptr->id = 0;
+    ptr->scon_handle = SCON_HANDLE_INVALID;
+    ptr->tag = 0;
+    ptr->req = NULL;
+    ptr->cbfunc = NULL;
+    ptr->cbdata = NULL;
+    ptr->post = NULL;
+    SCON_CONSTRUCT(&ptr->held, scon_list_t);
+}
+static void rndv_des(scon_pt2pt_base_rndv_t *ptr)
+{
+    if (NULL != ptr->req) {
+        SCON_RELEASE(ptr->req);
+    }
+    if (NULL != ptr->post) {
+        SCON_RELEASE(ptr->post);
+    }
+    SCON_LIST_DESTRUCT(&ptr->held);
+}
+SCON_CLASS_INSTANCE(scon_pt2pt_base_rndv_t,
+                    scon_list_item_t,
+                    rndv_cons, rndv_des);
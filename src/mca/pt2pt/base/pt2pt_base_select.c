@@ -148,3 +148,24 @@ scon_pt2pt_module_t * scon_pt2pt_base_get_module(char *comp_name) {
     }
     return NULL;
 }
+
+int scon_pt2pt_base_reserve_peers(size_t npeers)
+{
+    scon_mca_base_component_list_item_t *cli;
+    scon_pt2pt_base_component_t *pt2pt_comp;
+    int rc;
+
+    if (SCON_SUCCESS != (rc = scon_hash_table_reserve(&scon_pt2pt_base.peers, npeers))) {
+        SCON_ERROR_LOG(rc);
+        return rc;
+    }
+    SCON_LIST_FOREACH(cli, &scon_pt2pt_base.actives, scon_mca_base_component_list_item_t) {
+        pt2pt_comp = (scon_pt2pt_base_component_t *) cli->cli_component;
+        if (NULL != pt2pt_comp->reserve_peers &&
+            SCON_SUCCESS != (rc = pt2pt_comp->reserve_peers(npeers))) {
+            SCON_ERROR_LOG(rc);
+            return rc;
+        }
+    }
+    return SCON_SUCCESS;
+}
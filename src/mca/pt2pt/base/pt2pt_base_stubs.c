@@ -61,6 +61,7 @@ void pt2pt_base_process_send (int fd, short flags, void *cbdata)
                         SCON_PRINT_PROC(SCON_PROC_MY_NAME),
                         SCON_PRINT_PROC(&peer),
                         req->post.send.tag);
+    SCON_PERF_MSG(true, &peer, req->post.send.tag, req->post.send.buf->bytes_used);
     if (SCON_EQUAL == scon_util_compare_name_fields(SCON_NS_CMP_ALL, &peer, SCON_PROC_MY_NAME)) {
         /* local delivery */
         scon_output_verbose(1, scon_pt2pt_base_framework.framework_output,
@@ -76,6 +77,8 @@ void pt2pt_base_process_send (int fd, short flags, void *cbdata)
             memcpy(rcv->iov.iov_base, req->post.send.buf->base_ptr, req->post.send.buf->bytes_used);
             rcv->iov.iov_len = req->post.send.buf->bytes_used;
         }
+        SCON_PERF_MSG(false, &peer, rcv->tag, rcv->iov.iov_len);
+        SCON_TRACE(SCON_TRACE_RECV, peer.rank, rcv->tag);
         /* post the message for receipt - then execute the send complete callback
          */
         scon_event_set(scon_pt2pt_base.pt2pt_evbase, &rcv->ev, -1,
@@ -97,6 +100,11 @@ void pt2pt_base_process_send (int fd, short flags, void *cbdata)
         return;
     }
 
+    /* large messages wait here until the receiver has a recv for them */
+    if (scon_pt2pt_base_rndv_send(scon, req)) {
+        return;
+    }
+
     /*** TO DO: The scon has to stick in routing here, ie find the route,
      * post and do the routing here, and also stick in the scon ids correctly.
      * This is currently handled in oob, we to do that up here, so OFI also
@@ -106,10 +114,7 @@ void pt2pt_base_process_send (int fd, short flags, void *cbdata)
     /* before farwording the request to the module lets make sure that we have this
        peer's contact information */
     /* if this a collectives message then we don't want to route */
-    if((SCON_MSG_TAG_ALLGATHER_BRUCKS == req->post.send.tag) ||
-       (SCON_MSG_TAG_BARRIER_BRUCKS == req->post.send.tag) ||
-       (SCON_MSG_TAG_ALLGATHER_RCD == req->post.send.tag) ||
-       (SCON_MSG_TAG_BARRIER_RCD == req->post.send.tag) )
+    if (SCON_MSG_TAG_IS_DIRECT(req->post.send.tag))
     {
         scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
                             "%s pt2pt_base_process_send :  message tag %d sending direct",
@@ -127,7 +132,6 @@ void pt2pt_base_process_send (int fd, short flags, void *cbdata)
                            "%s pt2pt:base:send unknown peer %s",
                             SCON_PRINT_PROC(SCON_PROC_MY_NAME),
                             SCON_PRINT_PROC(&hop));
-        scon_pmix_get(&hop, SCON_PMIX_PROC_URI, NULL, 0, &val);
         if (SCON_SUCCESS ==  scon_pmix_get(&hop, SCON_PMIX_PROC_URI, NULL, 0, &val)) {
             scon_value_unload(val, (void **)&uri,
                               &uri_sz, SCON_STRING);
@@ -172,6 +176,36 @@ void pt2pt_base_process_send (int fd, short flags, void *cbdata)
 }
 
 
+SCON_EXPORT uint8_t scon_pt2pt_base_priority(scon_msg_tag_t tag,
+                                             scon_info_t info[],
+                                             size_t ninfo)
+{
+    size_t n;
+
+    for (n = 0; n < ninfo; n++) {
+        if (0 == strncmp(info[n].key, SCON_MSG_PRIORITY, SCON_MAX_KEYLEN) &&
+            SCON_UINT8 == info[n].value.type &&
+            SCON_MSG_PRIORITY_CLASSES > info[n].value.data.uint8) {
+            return info[n].value.data.uint8;
+        }
+    }
+    /* barriers and the rendezvous handshake are what others
+     * are waiting on */
+    switch (tag) {
+        case SCON_MSG_TAG_BARRIER_DIRECT:
+        case SCON_MSG_TAG_BARRIER_RELEASE:
+        case SCON_MSG_TAG_BARRIER_BRUCKS:
+        case SCON_MSG_TAG_BARRIER_RCD:
+        case SCON_MSG_TAG_BARRIER_TOKEN:
+        case SCON_MSG_TAG_RNDV_RTS:
+        case SCON_MSG_TAG_RNDV_CTS:
+        case SCON_MSG_TAG_RNDV_THROTTLE:
+            return SCON_MSG_PRIORITY_HIGH;
+        default:
+            return SCON_MSG_PRIORITY_NORMAL;
+    }
+}
+
 SCON_EXPORT int pt2pt_base_api_send_nb (scon_handle_t scon_handle,
                          scon_proc_t *peer,
                          scon_buffer_t *buf,
@@ -191,6 +225,7 @@ SCON_EXPORT int pt2pt_base_api_send_nb (scon_handle_t scon_handle,
     else {
         /* create a send req and do the rest of the processing in
           an event */
+        SCON_TRACE(SCON_TRACE_SEND_POST, peer->rank, tag);
         req = SCON_NEW(scon_send_req_t);
         req->post.send.scon_handle = scon->handle;
         req->post.send.origin = *SCON_PROC_MY_NAME;
@@ -199,6 +234,7 @@ SCON_EXPORT int pt2pt_base_api_send_nb (scon_handle_t scon_handle,
         req->post.send.dst = *peer;
         req->post.send.cbfunc = cbfunc;
         req->post.send.cbdata = cbdata;
+        req->post.send.priority = scon_pt2pt_base_priority(tag, info, ninfo);
         /* setup the event for rest of the processing  */
         scon_event_set(scon_globals.evbase, &req->ev, -1, SCON_EV_WRITE, pt2pt_base_process_send, req);
         scon_event_set_priority(&req->ev, SCON_MSG_PRI);
@@ -240,7 +276,7 @@ SCON_EXPORT int pt2pt_base_api_recv_nb (scon_handle_t scon_handle,
         req->post->persistent = persistent;
         req->post->cbfunc = cbfunc;
         req->post->cbdata = cbdata;
-        scon_event_set(scon_globals.evbase, &req->ev, -1,
+        scon_event_set(scon_pt2pt_base.pt2pt_evbase, &req->ev, -1,
                        SCON_EV_WRITE,
                        pt2pt_base_post_recv, req);
         scon_event_set_priority(&req->ev, SCON_MSG_PRI);
@@ -254,7 +290,26 @@ SCON_EXPORT int pt2pt_base_api_recv_cancel (scon_handle_t scon_handle,
                              scon_proc_t *peer,
                              scon_msg_tag_t tag)
 {
-    return SCON_ERROR;
+    scon_recv_req_t *req;
+
+    if (NULL == scon_comm_base_get_scon(scon_handle)) {
+        return SCON_ERR_NOT_FOUND;
+    }
+    /* the recv is taken off the list on the thread that delivers
+     * to it, in order with the requests that posted it - so a recv
+     * cancelled from its own callback goes once that callback is done */
+    req = SCON_NEW(scon_recv_req_t);
+    req->cancel = true;
+    req->post = SCON_NEW(scon_posted_recv_t);
+    req->post->scon_handle = scon_handle;
+    req->post->peer = *peer;
+    req->post->tag = tag;
+    scon_event_set(scon_pt2pt_base.pt2pt_evbase, &req->ev, -1,
+                   SCON_EV_WRITE,
+                   pt2pt_base_post_recv, req);
+    scon_event_set_priority(&req->ev, SCON_MSG_PRI);
+    scon_event_active(&req->ev, SCON_EV_WRITE, 1);
+    return SCON_SUCCESS;
 }
 
 static void send_cons(scon_send_t  *ptr)
@@ -263,6 +318,7 @@ static void send_cons(scon_send_t  *ptr)
     ptr->cbfunc = NULL;
     ptr->cbdata = NULL;
     ptr->info = NULL;
+    ptr->priority = SCON_MSG_PRIORITY_NORMAL;
 }
 SCON_CLASS_INSTANCE (scon_send_t,
                      scon_list_item_t,
@@ -281,6 +337,9 @@ static void recv_cons(scon_recv_t *ptr)
 {
     ptr->iov.iov_base = NULL;
     ptr->iov.iov_len = 0;
+    ptr->rndv = false;
+    ptr->rndv_id = 0;
+    ptr->rndv_size = 0;
 }
 static void recv_des(scon_recv_t *ptr)
 {
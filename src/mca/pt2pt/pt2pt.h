@@ -54,6 +54,8 @@ typedef struct {
     scon_info_t *info;
     /* number of info */
     size_t ninfo;
+    /* class the message is sent in (SCON_MSG_PRIORITY_*) */
+    uint8_t priority;
 } scon_send_t;
 SCON_EXPORT SCON_CLASS_DECLARATION(scon_send_t);
 
@@ -75,6 +77,11 @@ typedef struct {
     scon_proc_t sender;          // sender
     scon_msg_tag_t tag;          // targeted tag
     struct iovec iov;            // the recvd data
+    /* a rendezvous announcement - the rndv_size bytes of
+     * the message are still held by the sender */
+    bool rndv;
+    uint32_t rndv_id;
+    size_t rndv_size;
 } scon_recv_t;
 SCON_EXPORT SCON_CLASS_DECLARATION(scon_recv_t);
 
@@ -127,6 +134,9 @@ typedef char* (*scon_mca_pt2pt_base_component_get_addr_fn_t)(void);
 /* Set contact info */
 typedef int (*scon_mca_pt2pt_base_component_set_addr_fn_t)(scon_proc_t *peer,
                                                              char **uris);
+/* Size the peer tracking for the given number of peers, so it
+ * doesn't have to grow while messages are flowing - optional */
+typedef int (*scon_mca_pt2pt_base_component_reserve_peers_fn_t)(size_t npeers);
 /**
  * topology component specific functions
  */
@@ -146,6 +156,7 @@ struct scon_pt2pt_base_component_1_0_0_t {
     scon_mca_pt2pt_base_component_get_addr_fn_t           get_addr;
     scon_mca_pt2pt_base_component_set_addr_fn_t           set_addr;
     scon_mca_pt2pt_base_component_get_module_fn_t         get_module;
+    scon_mca_pt2pt_base_component_reserve_peers_fn_t      reserve_peers;
 };
 typedef struct scon_pt2pt_base_component_1_0_0_t scon_pt2pt_base_component_1_0_0_t;
 typedef struct scon_pt2pt_base_component_1_0_0_t scon_pt2pt_base_component_t;
@@ -166,6 +177,32 @@ typedef struct scon_pt2pt_base_component_1_0_0_t scon_pt2pt_base_component_t;
 #define SCON_MSG_TAG_ALLGATHER_RCD         11
 #define SCON_MSG_TAG_BARRIER_RCD           12
 #define SCON_MSG_TAG_BARRIER_RELEASE       13
+#define SCON_MSG_TAG_ALLGATHER_PIPELINE    14
+#define SCON_MSG_TAG_REDUCE_DIRECT         15
+#define SCON_MSG_TAG_REDUCE_RELEASE        16
+#define SCON_MSG_TAG_REDUCE_RD             17
+#define SCON_MSG_TAG_BARRIER_TOKEN         18
+/* tags of the collectives that exchange messages directly
+ * between members rather than along the routing tree */
+#define SCON_MSG_TAG_DIRECT_MASK                                    \
+    ((1u << SCON_MSG_TAG_ALLGATHER_BRUCKS) |                        \
+     (1u << SCON_MSG_TAG_BARRIER_BRUCKS) |                          \
+     (1u << SCON_MSG_TAG_ALLGATHER_RCD) |                           \
+     (1u << SCON_MSG_TAG_BARRIER_RCD) |                             \
+     (1u << SCON_MSG_TAG_ALLGATHER_PIPELINE) |                      \
+     (1u << SCON_MSG_TAG_REDUCE_RD) |                               \
+     (1u << SCON_MSG_TAG_BARRIER_TOKEN))
+#define SCON_MSG_TAG_IS_DIRECT(t)                                   \
+    ((t) < 32 && 0 != (SCON_MSG_TAG_DIRECT_MASK & (1u << (t))))
+#define SCON_MSG_TAG_CREATE_READY          19
+/* rendezvous protocol for large messages */
+#define SCON_MSG_TAG_RNDV_RTS              20
+#define SCON_MSG_TAG_RNDV_CTS              21
+#define SCON_MSG_TAG_RNDV_DATA             22
+#define SCON_MSG_TAG_RNDV_THROTTLE         23
+/* the highest tag used by the library itself - messages on
+ * these tags are always sent eagerly */
+#define SCON_MSG_TAG_MAX_RESERVED          SCON_MSG_TAG_RNDV_THROTTLE
 /** RECV MSG FLAGS */
 #define SCON_MSG_PERSISTENT                1
 
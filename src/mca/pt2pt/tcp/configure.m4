@@ -21,5 +21,10 @@ AC_DEFUN([MCA_scon_pt2pt_tcp_CONFIG],[
 #include <netinet/in.h>
 #endif])
 
+    # the io_uring backend and zero-copy sends are built if the
+    # kernel headers have them - whether the running kernel supports
+    # them is checked at startup
+    AC_CHECK_HEADERS([linux/io_uring.h sys/eventfd.h linux/errqueue.h])
+
     AS_IF([test "$pt2pt_tcp_happy" = "yes"], [$1], [$2])
 ])dnl
@@ -67,6 +67,7 @@
 #include "src/mca/pt2pt/tcp/pt2pt_tcp_peer.h"
 #include "src/mca/pt2pt/tcp/pt2pt_tcp_common.h"
 #include "src/mca/pt2pt/tcp/pt2pt_tcp_connection.h"
+#include "src/mca/pt2pt/tcp/pt2pt_tcp_uring.h"
 #include "src/mca/pt2pt/tcp/pt2pt_tcp_ping.h"
 
 
@@ -94,6 +95,7 @@ void scon_pt2pt_tcp_init(void)
     /* setup the module's state variables */
     SCON_CONSTRUCT(&scon_pt2pt_tcp_module.peers, scon_hash_table_t);
     scon_hash_table_init(&scon_pt2pt_tcp_module.peers, 32);
+    scon_hash_table_set_incremental(&scon_pt2pt_tcp_module.peers, SCON_PT2PT_PEERS_MIGRATE_STEP);
     scon_pt2pt_tcp_module.ev_active = false;
 
     if (scon_pt2pt_base.num_threads) {
@@ -108,6 +110,14 @@ void scon_pt2pt_tcp_init(void)
     else {
         scon_pt2pt_tcp_module.ev_base = scon_pt2pt_base.pt2pt_evbase;
     }
+
+    if (NULL != mca_pt2pt_tcp_component.backend &&
+        0 == strcmp(mca_pt2pt_tcp_component.backend, "uring") &&
+        SCON_SUCCESS != scon_pt2pt_tcp_uring_init()) {
+        scon_output_verbose(1, scon_pt2pt_base_framework.framework_output,
+                            "%s io_uring backend not available - using the event backend",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME));
+    }
 }
 
 /*
@@ -129,6 +139,7 @@ void scon_pt2pt_tcp_fini(void)
         }
     }
     SCON_DESTRUCT(&scon_pt2pt_tcp_module.peers);
+    scon_pt2pt_tcp_uring_finalize();
 
     if (scon_pt2pt_tcp_module.ev_active) {
         /* if we used an independent progress thread at
@@ -362,10 +373,7 @@ static void process_send(int fd, short args, void *cbdata)
                         SCON_PRINT_PROC(SCON_PROC_MY_NAME),
                         __FILE__, __LINE__,
                         SCON_PRINT_PROC(&op->msg->dst), op->msg->tag);
-    if((SCON_MSG_TAG_ALLGATHER_BRUCKS == op->msg->tag) ||
-            (SCON_MSG_TAG_BARRIER_BRUCKS == op->msg->tag) ||
-            (SCON_MSG_TAG_ALLGATHER_RCD == op->msg->tag) ||
-            (SCON_MSG_TAG_BARRIER_RCD == op->msg->tag))
+    if (SCON_MSG_TAG_IS_DIRECT(op->msg->tag))
     {
         scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
                             "%s process_send :  message tag %d sending direct",
@@ -376,8 +384,6 @@ static void process_send(int fd, short args, void *cbdata)
     else
         hop = scon->topology_module->api.get_nexthop(&scon->topology_module->topology,
                 &op->msg->dst);
-    /* do we have a route to this peer (could be direct)? */
-    hop = scon->topology_module->api.get_nexthop(&scon->topology_module->topology, &op->msg->dst);
     /* do we know this hop? */
     if (NULL == (peer = scon_pt2pt_tcp_peer_lookup(&hop))) {
         /* push this back to the component so it can try
@@ -394,14 +400,55 @@ static void process_send(int fd, short args, void *cbdata)
         goto cleanup;
     }
 
+    /* a send of our own fails rather than queue without bound
+     * behind a hop that isn't keeping up. Relays are held back
+     * by the credits of the peers feeding us instead, and the
+     * library's own traffic is always let through */
+    if (0 < mca_pt2pt_tcp_component.max_queued_bytes &&
+        mca_pt2pt_tcp_component.max_queued_bytes <= peer->queued_bytes &&
+        SCON_MSG_TAG_MAX_RESERVED < op->msg->tag &&
+        SCON_EQUAL == scon_util_compare_name_fields(SCON_NS_CMP_ALL, &op->msg->origin,
+                                                    SCON_PROC_MY_NAME)) {
+        scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
+                            "%s:[%s:%d] send queue to %s is full (%lu bytes)",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                            __FILE__, __LINE__,
+                            SCON_PRINT_PROC(&hop), (unsigned long)peer->queued_bytes);
+        op->msg->status = SCON_ERR_QUEUE_FULL;
+        PT2PT_SEND_COMPLETE(op->msg);
+        goto cleanup;
+    }
+
+    /* count it towards the hop's socket profile */
+    scon_pt2pt_tcp_peer_observe(peer, (NULL == op->msg->buf) ? 0 : op->msg->buf->bytes_used, false);
+
     /* add the msg to the hop's send queue */
     if (SCON_PT2PT_TCP_CONNECTED == peer->state) {
         scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
                             "%s tcp:send_nb: already connected to %s - queueing for send",
                             SCON_PRINT_PROC(SCON_PROC_MY_NAME),
                             SCON_PRINT_PROC(&peer->name));
+        /* only the normal class is coalesced - high priority
+         * messages shouldn't wait on the batch timer, and bulk
+         * ones aren't worth it */
+        if (SCON_MSG_PRIORITY_NORMAL == op->msg->priority &&
+            mca_pt2pt_tcp_component.coalesce && NULL != op->msg->buf &&
+            (int)op->msg->buf->bytes_used <= mca_pt2pt_tcp_component.coalesce_msg_size) {
+            scon_pt2pt_tcp_coalesce(peer, op->msg);
+            goto cleanup;
+        }
+        /* preserve ordering behind any partially built batch */
+        if (SCON_MSG_PRIORITY_NORMAL == op->msg->priority) {
+            scon_pt2pt_tcp_flush_batch(peer);
+        }
+        /* large messages are split over all our connections to the peer */
+        if (NULL != op->msg->buf &&
+            mca_pt2pt_tcp_component.stripe_min_size <= op->msg->buf->bytes_used &&
+            scon_pt2pt_tcp_stripe(peer, op->msg)) {
+            goto cleanup;
+        }
         SCON_PT2PT_TCP_QUEUE_SEND(op->msg, peer);
-        return;
+        goto cleanup;
     }
 
     /* add the message to the queue for sending after the
@@ -547,6 +594,10 @@ static void recv_handler(int sd, short flg, void *cbdata)
             scon_pt2pt_tcp_peer_close(peer);
             goto cleanup;
         }
+        if (0 < hdr.tag && hdr.tag < SCON_PT2PT_TCP_MAX_RAILS) {
+            /* one of the extra connections to the peer */
+            peer = peer->rails[hdr.tag];
+        }
         /* set socket up to be non-blocking */
         if ((flags = fcntl(sd, F_GETFL, 0)) < 0) {
             scon_output(0, "%s scon_pt2pt_tcp_recv_connect: fcntl(F_GETFL) failed: %s (%d)",
@@ -570,6 +621,10 @@ static void recv_handler(int sd, short flg, void *cbdata)
                             peer->state);
             }
             CLOSE_THE_SOCKET(sd);
+            if (0 < peer->rail) {
+                /* the primary connection is still good */
+                goto cleanup;
+            }
             proc_name_ui64 = scon_util_convert_process_name_to_uint64(&peer->name);
             (void)scon_hash_table_set_value_uint64(&scon_pt2pt_tcp_module.peers, proc_name_ui64, NULL);
             SCON_RELEASE(peer);
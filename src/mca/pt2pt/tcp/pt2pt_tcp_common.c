@@ -57,6 +57,8 @@
 
 #include "src/util/error.h"
 #include "src/util/output.h"
+#include "src/util/name_fns.h"
+#include "src/include/scon_globals.h"
 #include "src/include/scon_socket_errno.h"
 /*#include "scon/util/if.h"
 #include "scon/util/net.h"*/
@@ -187,6 +189,151 @@ void scon_pt2pt_tcp_set_socket_options(int sd)
     }
 }
 
+static void set_option(int sd, int level, int name, const char *str, int value)
+{
+    if (setsockopt(sd, level, name, (char *)&value, sizeof(value)) < 0) {
+        scon_output_verbose(5, scon_pt2pt_base_framework.framework_output,
+                            "[%s:%d] setsockopt(%s) failed: %s (%d)",
+                            __FILE__, __LINE__, str,
+                            strerror(scon_socket_errno),
+                            scon_socket_errno);
+    }
+}
+
+/*
+ * Socket tuning profiles. One setting is wrong either for the
+ * connections that carry relays and large messages or for those
+ * that only carry control traffic, so each connection has a
+ * profile:
+ *
+ *  - bulk: large kernel buffers (bulk_sndbuf/bulk_rcvbuf) so the
+ *    window can cover the bandwidth-delay product
+ *  - leaf: the component-wide sndbuf/rcvbuf, and optionally quick
+ *    acks, busy polling and a low TCP_NOTSENT_LOWAT for latency
+ *
+ * One connection serves every scon routed over it, each with its
+ * own routing tree, so the role of a link is taken from the traffic
+ * it carries rather than from any one tree. Rails only carry pieces
+ * of striped messages and are always bulk
+ */
+void scon_pt2pt_tcp_set_profile(scon_pt2pt_tcp_peer_t *peer, int profile)
+{
+    int sndbuf, rcvbuf, lowat, busy_poll;
+
+    peer->profile = profile;
+    if (SCON_PT2PT_TCP_PROFILE_BULK == profile) {
+        sndbuf = mca_pt2pt_tcp_component.bulk_sndbuf;
+        rcvbuf = mca_pt2pt_tcp_component.bulk_rcvbuf;
+        lowat = mca_pt2pt_tcp_component.bulk_notsent_lowat;
+        busy_poll = 0;
+        peer->quickack = false;
+    } else {
+        sndbuf = mca_pt2pt_tcp_component.tcp_sndbuf;
+        rcvbuf = mca_pt2pt_tcp_component.tcp_rcvbuf;
+        lowat = mca_pt2pt_tcp_component.leaf_notsent_lowat;
+        busy_poll = mca_pt2pt_tcp_component.leaf_busy_poll;
+        peer->quickack = mca_pt2pt_tcp_component.leaf_quickack;
+    }
+    if (peer->sd < 0) {
+        return;
+    }
+    scon_output_verbose(5, scon_pt2pt_base_framework.framework_output,
+                        "%s using the %s socket profile for %s on socket %d",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                        (SCON_PT2PT_TCP_PROFILE_BULK == profile) ? "bulk" : "leaf",
+                        SCON_PRINT_PROC(&peer->name), peer->sd);
+
+    /* a receive buffer set after the handshake may not widen the
+     * window the peer was offered - the profile is kept for the
+     * next connection to the peer, and is set before it connects */
+#if defined(SO_SNDBUF)
+    if (0 < sndbuf) {
+        set_option(peer->sd, SOL_SOCKET, SO_SNDBUF, "SO_SNDBUF", sndbuf);
+    }
+#endif
+#if defined(SO_RCVBUF)
+    if (0 < rcvbuf) {
+        set_option(peer->sd, SOL_SOCKET, SO_RCVBUF, "SO_RCVBUF", rcvbuf);
+    }
+#endif
+    /* the rest are only touched if a profile uses them, and then
+     * set either way so a change of profile takes them back */
+#if defined(TCP_NOTSENT_LOWAT)
+    if (0 < mca_pt2pt_tcp_component.bulk_notsent_lowat ||
+        0 < mca_pt2pt_tcp_component.leaf_notsent_lowat) {
+        set_option(peer->sd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, "TCP_NOTSENT_LOWAT", lowat);
+    }
+#endif
+#if defined(SO_BUSY_POLL)
+    if (0 < mca_pt2pt_tcp_component.leaf_busy_poll) {
+        set_option(peer->sd, SOL_SOCKET, SO_BUSY_POLL, "SO_BUSY_POLL", busy_poll);
+    }
+#endif
+#if defined(TCP_QUICKACK)
+    if (peer->quickack) {
+        set_option(peer->sd, IPPROTO_TCP, TCP_QUICKACK, "TCP_QUICKACK", 1);
+    }
+#endif
+}
+
+/*
+ * Count a message sent or received on a connection, and pick its
+ * profile again once tune_window messages have been counted - bulk
+ * if most of their bytes were in messages of at least bulk_msg_size
+ */
+void scon_pt2pt_tcp_peer_observe(scon_pt2pt_tcp_peer_t *peer, size_t nbytes, bool recvd)
+{
+    char hist[SCON_PT2PT_TCP_SIZE_BINS * 24];
+    uint64_t bulk = 0, total = 0;
+    size_t n, len = 0;
+    int bin, bulk_bin, profile;
+
+#if defined(TCP_QUICKACK)
+    if (recvd && peer->quickack && 0 <= peer->sd) {
+        /* the kernel goes back to delaying acks on its own */
+        set_option(peer->sd, IPPROTO_TCP, TCP_QUICKACK, "TCP_QUICKACK", 1);
+    }
+#endif
+    if (0 >= mca_pt2pt_tcp_component.tune_window || 0 < peer->rail) {
+        return;
+    }
+    /* bin b holds the sizes of b bits */
+    for (bin=0, n=nbytes; 0 < n && bin < SCON_PT2PT_TCP_SIZE_BINS - 1; bin++, n >>= 1);
+    ++peer->size_hist[bin];
+    peer->size_bytes[bin] += nbytes;
+    if (++peer->size_msgs < (uint32_t)mca_pt2pt_tcp_component.tune_window) {
+        return;
+    }
+
+    for (bulk_bin=0, n=mca_pt2pt_tcp_component.bulk_msg_size;
+         0 < n && bulk_bin < SCON_PT2PT_TCP_SIZE_BINS - 1; bulk_bin++, n >>= 1);
+    hist[0] = '\0';
+    for (bin=0; bin < SCON_PT2PT_TCP_SIZE_BINS; bin++) {
+        total += peer->size_bytes[bin];
+        if (bulk_bin <= bin) {
+            bulk += peer->size_bytes[bin];
+        }
+        if (0 < peer->size_hist[bin] && len < sizeof(hist)) {
+            len += snprintf(hist + len, sizeof(hist) - len, " <2^%d:%u", bin,
+                            peer->size_hist[bin]);
+        }
+    }
+    profile = (0 < total && total <= 2 * bulk) ? SCON_PT2PT_TCP_PROFILE_BULK :
+                                                 SCON_PT2PT_TCP_PROFILE_LEAF;
+    scon_output_verbose(5, scon_pt2pt_base_framework.framework_output,
+                        "%s message sizes to/from %s:%s - %lu of %lu bytes bulk",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                        SCON_PRINT_PROC(&peer->name), hist,
+                        (unsigned long)bulk, (unsigned long)total);
+    peer->size_msgs = 0;
+    memset(peer->size_hist, 0, sizeof(peer->size_hist));
+    memset(peer->size_bytes, 0, sizeof(peer->size_bytes));
+
+    if (profile != peer->profile) {
+        scon_pt2pt_tcp_set_profile(peer, profile);
+    }
+}
+
 scon_pt2pt_tcp_peer_t* scon_pt2pt_tcp_peer_lookup(const scon_proc_t *name)
 {
     scon_pt2pt_tcp_peer_t *peer;
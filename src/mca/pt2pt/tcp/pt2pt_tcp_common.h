@@ -29,6 +29,8 @@
 #include "pt2pt_tcp_peer.h"
 
 void scon_pt2pt_tcp_set_socket_options(int sd);
+void scon_pt2pt_tcp_set_profile(scon_pt2pt_tcp_peer_t *peer, int profile);
+void scon_pt2pt_tcp_peer_observe(scon_pt2pt_tcp_peer_t *peer, size_t nbytes, bool recvd);
 char* scon_pt2pt_tcp_state_print(scon_pt2pt_tcp_conn_state_t state);
 scon_pt2pt_tcp_peer_t* scon_pt2pt_tcp_peer_lookup(const scon_proc_t *name);
 #endif /* _MCA_PT2PT_TCP_COMMON_H_ */
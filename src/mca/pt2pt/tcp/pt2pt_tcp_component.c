@@ -80,6 +80,7 @@ static int tcp_component_query(scon_mca_base_module_t **module, int *priority);
 static int tcp_component_startup(void);
 static void tcp_component_shutdown(void);
 static scon_pt2pt_module_t* tcp_component_get_module(void);
+static int tcp_component_reserve_peers(size_t npeers);
 static int component_set_addr(scon_proc_t *peer,
                               char **uris);
 static char* component_get_addr(void);
@@ -114,6 +115,7 @@ scon_pt2pt_tcp_component_t mca_pt2pt_tcp_component = {
     .get_addr = component_get_addr,
     .set_addr = component_set_addr,
     .get_module = tcp_component_get_module,
+    .reserve_peers = tcp_component_reserve_peers,
     },
 };
 
@@ -451,6 +453,210 @@ static int tcp_component_register(void)
                                           SCON_MCA_BASE_VAR_SCOPE_READONLY,
                                           &mca_pt2pt_tcp_component.max_recon_attempts);
 
+    mca_pt2pt_tcp_component.coalesce = false;
+    (void)scon_mca_base_component_var_register(component, "coalesce",
+                                          "Coalesce small messages headed to the same next hop into a single batch",
+                                          SCON_MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.coalesce);
+
+    mca_pt2pt_tcp_component.coalesce_msg_size = 1024;
+    (void)scon_mca_base_component_var_register(component, "coalesce_msg_size",
+                                          "Largest message payload (in bytes) eligible for coalescing",
+                                          SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.coalesce_msg_size);
+
+    mca_pt2pt_tcp_component.coalesce_max_bytes = 16384;
+    (void)scon_mca_base_component_var_register(component, "coalesce_max_bytes",
+                                          "Flush a coalesced batch once it holds this many bytes",
+                                          SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.coalesce_max_bytes);
+
+    mca_pt2pt_tcp_component.coalesce_max_msgs = 32;
+    (void)scon_mca_base_component_var_register(component, "coalesce_max_msgs",
+                                          "Flush a coalesced batch once it holds this many messages",
+                                          SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.coalesce_max_msgs);
+
+    mca_pt2pt_tcp_component.coalesce_flush_usec = 50;
+    (void)scon_mca_base_component_var_register(component, "coalesce_flush_usec",
+                                          "Time (in usec) a partially filled batch may wait before it is flushed",
+                                          SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.coalesce_flush_usec);
+    /* a single eligible message must always fit into a batch */
+    if (mca_pt2pt_tcp_component.coalesce_max_bytes <
+        mca_pt2pt_tcp_component.coalesce_msg_size + (int)sizeof(scon_pt2pt_tcp_hdr_t)) {
+        mca_pt2pt_tcp_component.coalesce_max_bytes =
+            mca_pt2pt_tcp_component.coalesce_msg_size + (int)sizeof(scon_pt2pt_tcp_hdr_t);
+    }
+    if (mca_pt2pt_tcp_component.coalesce_max_msgs < 1) {
+        mca_pt2pt_tcp_component.coalesce_max_msgs = 1;
+    }
+
+    mca_pt2pt_tcp_component.credit_window = 64;
+    (void)scon_mca_base_component_var_register(component, "credit_window",
+                                          "Number of messages a peer may send us before we return credit to it (0 for no flow control)",
+                                          SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.credit_window);
+    if (mca_pt2pt_tcp_component.credit_window < 0) {
+        mca_pt2pt_tcp_component.credit_window = 0;
+    }
+
+    mca_pt2pt_tcp_component.max_queued_bytes = 64 * 1024 * 1024;
+    (void)scon_mca_base_component_var_register(component, "max_queued_bytes",
+                                          "Fail sends originated here with SCON_ERR_QUEUE_FULL once this many bytes are queued for their next hop (0 for no limit)",
+                                          SCON_MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.max_queued_bytes);
+
+    mca_pt2pt_tcp_component.frag_size = 65536;
+    (void)scon_mca_base_component_var_register(component, "frag_size",
+                                          "Send messages larger than this many bytes in pieces, so messages of a higher priority class can go between them (0 to never split)",
+                                          SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.frag_size);
+    if (mca_pt2pt_tcp_component.frag_size < 0) {
+        mca_pt2pt_tcp_component.frag_size = 0;
+    }
+
+    mca_pt2pt_tcp_component.num_links = 1;
+    (void)scon_mca_base_component_var_register(component, "num_links",
+                                          "Number of connections to open to each peer - the extra ones are spread over the peer's interfaces, and only carry pieces of striped messages",
+                                          SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.num_links);
+    if (mca_pt2pt_tcp_component.num_links < 1) {
+        mca_pt2pt_tcp_component.num_links = 1;
+    } else if (SCON_PT2PT_TCP_MAX_RAILS < mca_pt2pt_tcp_component.num_links) {
+        mca_pt2pt_tcp_component.num_links = SCON_PT2PT_TCP_MAX_RAILS;
+    }
+
+    mca_pt2pt_tcp_component.stripe_min_size = 1024 * 1024;
+    (void)scon_mca_base_component_var_register(component, "stripe_min_size",
+                                          "Stripe messages of at least this many bytes across all the connections to their next hop (see num_links)",
+                                          SCON_MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.stripe_min_size);
+
+    mca_pt2pt_tcp_component.backend = "event";
+    (void)scon_mca_base_component_var_register(component, "backend",
+                                          "How connected sockets are driven: event (readiness callbacks from the event library) or uring (io_uring, where the kernel supports it - otherwise event is used)",
+                                          SCON_MCA_BASE_VAR_TYPE_STRING, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.backend);
+
+    mca_pt2pt_tcp_component.uring_entries = 4096;
+    (void)scon_mca_base_component_var_register(component, "uring_entries",
+                                          "Size of the io_uring submission queue",
+                                          SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          SCON_INFO_LVL_9,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.uring_entries);
+
+    mca_pt2pt_tcp_component.uring_recv_buffers = 1024;
+    (void)scon_mca_base_component_var_register(component, "uring_recv_buffers",
+                                          "Number of buffers in the pool io_uring receives into, shared by all sockets (rounded up to a power of 2, at most 32768)",
+                                          SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          SCON_INFO_LVL_9,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.uring_recv_buffers);
+
+    mca_pt2pt_tcp_component.uring_recv_buffer_size = 65536;
+    (void)scon_mca_base_component_var_register(component, "uring_recv_buffer_size",
+                                          "Size of each buffer in the io_uring receive pool",
+                                          SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          SCON_INFO_LVL_9,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.uring_recv_buffer_size);
+
+    mca_pt2pt_tcp_component.zerocopy_min_size = 0;
+    (void)scon_mca_base_component_var_register(component, "zerocopy_min_size",
+                                          "Send payloads of at least this many bytes with MSG_ZEROCOPY, where the kernel supports it - the send completes once the kernel is done with the buffer (0 to disable)",
+                                          SCON_MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.zerocopy_min_size);
+
+    mca_pt2pt_tcp_component.tune_window = 256;
+    (void)scon_mca_base_component_var_register(component, "tune_window",
+                                          "Pick the socket profile of each connection again every this many messages it carries - bulk if most of their bytes are in messages of at least bulk_msg_size, leaf otherwise (0 to keep every connection on the leaf profile)",
+                                          SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.tune_window);
+
+    mca_pt2pt_tcp_component.bulk_msg_size = 64 * 1024;
+    (void)scon_mca_base_component_var_register(component, "bulk_msg_size",
+                                          "Messages of at least this many bytes (rounded down to a power of 2) count as bulk traffic when picking a connection's socket profile",
+                                          SCON_MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.bulk_msg_size);
+
+    mca_pt2pt_tcp_component.bulk_sndbuf = 4 * 1024 * 1024;
+    (void)scon_mca_base_component_var_register(component, "bulk_sndbuf",
+                                          "TCP socket send buffering size (in bytes) of connections with the bulk profile - the leaf profile uses sndbuf",
+                                          SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.bulk_sndbuf);
+
+    mca_pt2pt_tcp_component.bulk_rcvbuf = 4 * 1024 * 1024;
+    (void)scon_mca_base_component_var_register(component, "bulk_rcvbuf",
+                                          "TCP socket receive buffering size (in bytes) of connections with the bulk profile - the leaf profile uses rcvbuf",
+                                          SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          SCON_INFO_LVL_5,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.bulk_rcvbuf);
+
+    mca_pt2pt_tcp_component.bulk_notsent_lowat = 0;
+    (void)scon_mca_base_component_var_register(component, "bulk_notsent_lowat",
+                                          "Most unsent bytes the kernel queues on a connection with the bulk profile (TCP_NOTSENT_LOWAT, 0 for the system default)",
+                                          SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          SCON_INFO_LVL_9,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.bulk_notsent_lowat);
+
+    mca_pt2pt_tcp_component.leaf_notsent_lowat = 0;
+    (void)scon_mca_base_component_var_register(component, "leaf_notsent_lowat",
+                                          "Most unsent bytes the kernel queues on a connection with the leaf profile (TCP_NOTSENT_LOWAT, 0 for the system default) - a small value keeps high priority messages from waiting behind data already handed to the kernel",
+                                          SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          SCON_INFO_LVL_9,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.leaf_notsent_lowat);
+
+    mca_pt2pt_tcp_component.leaf_quickack = false;
+    (void)scon_mca_base_component_var_register(component, "leaf_quickack",
+                                          "Acknowledge every message received on a connection with the leaf profile at once (TCP_QUICKACK) instead of delaying the ack",
+                                          SCON_MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                          SCON_INFO_LVL_9,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.leaf_quickack);
+
+    mca_pt2pt_tcp_component.leaf_busy_poll = 0;
+    (void)scon_mca_base_component_var_register(component, "leaf_busy_poll",
+                                          "Usecs to busy poll the device for data on a connection with the leaf profile before giving up a read (SO_BUSY_POLL, 0 to disable)",
+                                          SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                          SCON_INFO_LVL_9,
+                                          SCON_MCA_BASE_VAR_SCOPE_READONLY,
+                                          &mca_pt2pt_tcp_component.leaf_busy_poll);
+
     return SCON_SUCCESS;
 }
 
@@ -636,6 +842,11 @@ static scon_pt2pt_module_t* tcp_component_get_module(void)
     return &scon_pt2pt_tcp_module.base;
 }
 
+static int tcp_component_reserve_peers(size_t npeers)
+{
+    return scon_hash_table_reserve(&scon_pt2pt_tcp_module.peers, npeers);
+}
+
 static void tcp_component_shutdown(void)
 {
     bool active;
@@ -1210,21 +1421,62 @@ static char **split_and_resolve(char **orig_str, char *name)
 
 static void peer_cons(scon_pt2pt_tcp_peer_t *peer)
 {
+    int i;
+
     peer->auth_method = NULL;
     peer->sd = -1;
     SCON_CONSTRUCT(&peer->addrs, scon_list_t);
     peer->active_addr = NULL;
     peer->state = SCON_PT2PT_TCP_UNCONNECTED;
     peer->num_retries = 0;
-    SCON_CONSTRUCT(&peer->send_queue, scon_list_t);
+    for (i=0; i < SCON_MSG_PRIORITY_CLASSES; i++) {
+        SCON_CONSTRUCT(&peer->send_queues[i], scon_list_t);
+        peer->frag_data[i] = NULL;
+        peer->frag_bytes[i] = 0;
+        peer->frag_size[i] = 0;
+    }
     peer->send_msg = NULL;
     peer->recv_msg = NULL;
     peer->send_ev_active = false;
     peer->recv_ev_active = false;
     peer->timer_ev_active = false;
+    peer->batch = NULL;
+    peer->batch_ev_active = false;
+    peer->queued_bytes = 0;
+    peer->send_window = 0;
+    peer->send_credits = 0;
+    peer->recv_window = 0;
+    peer->credits_owed = 0;
+    peer->rail = 0;
+    peer->primary = NULL;
+    for (i=0; i < SCON_PT2PT_TCP_MAX_RAILS; i++) {
+        peer->rails[i] = NULL;
+    }
+    peer->stripe_next = 0;
+    SCON_CONSTRUCT(&peer->stripes, scon_list_t);
+    SCON_CONSTRUCT(&peer->held, scon_list_t);
+    peer->uring = false;
+    peer->uring_rx = NULL;
+    peer->uring_tx = NULL;
+    peer->uring_tx_done = false;
+    peer->uring_tx_res = 0;
+    peer->uring_rx_ptr = NULL;
+    peer->uring_rx_len = 0;
+    peer->uring_rx_status = 0;
+    peer->zerocopy = false;
+    peer->zc_sent = 0;
+    SCON_CONSTRUCT(&peer->zc_pending, scon_list_t);
+    peer->profile = SCON_PT2PT_TCP_PROFILE_LEAF;
+    peer->quickack = false;
+    peer->size_msgs = 0;
+    memset(peer->size_hist, 0, sizeof(peer->size_hist));
+    memset(peer->size_bytes, 0, sizeof(peer->size_bytes));
 }
 static void peer_des(scon_pt2pt_tcp_peer_t *peer)
 {
+    scon_pt2pt_tcp_recv_t *rcv;
+    int i;
+
     if (NULL != peer->auth_method) {
         free(peer->auth_method);
     }
@@ -1237,6 +1489,7 @@ static void peer_des(scon_pt2pt_tcp_peer_t *peer)
     if (peer->timer_ev_active) {
         scon_event_del(&peer->timer_event);
     }
+    scon_pt2pt_tcp_drop_batch(peer, SCON_ERR_UNREACH);
     if (0 <= peer->sd) {
         scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
                             "%s CLOSING SOCKET %d",
@@ -1245,7 +1498,28 @@ static void peer_des(scon_pt2pt_tcp_peer_t *peer)
         CLOSE_THE_SOCKET(peer->sd);
     }
     SCON_LIST_DESTRUCT(&peer->addrs);
-    SCON_LIST_DESTRUCT(&peer->send_queue);
+    for (i=0; i < SCON_MSG_PRIORITY_CLASSES; i++) {
+        SCON_PERF_ADD(SCON_PERF_CTR_TCP_SEND_QUEUE,
+                      -(int64_t)scon_list_get_size(&peer->send_queues[i]));
+        SCON_LIST_DESTRUCT(&peer->send_queues[i]);
+        if (NULL != peer->frag_data[i]) {
+            free(peer->frag_data[i]);
+        }
+    }
+    for (i=1; i < SCON_PT2PT_TCP_MAX_RAILS; i++) {
+        if (NULL != peer->rails[i]) {
+            SCON_RELEASE(peer->rails[i]);
+        }
+    }
+    SCON_LIST_DESTRUCT(&peer->stripes);
+    while (NULL != (rcv = (scon_pt2pt_tcp_recv_t*)scon_list_remove_first(&peer->held))) {
+        if (NULL != rcv->data) {
+            free(rcv->data);
+        }
+        SCON_RELEASE(rcv);
+    }
+    SCON_DESTRUCT(&peer->held);
+    SCON_LIST_DESTRUCT(&peer->zc_pending);
 }
 SCON_CLASS_INSTANCE(scon_pt2pt_tcp_peer_t,
                    scon_list_item_t,
@@ -42,7 +42,7 @@
 typedef struct {
     scon_pt2pt_base_component_t super;          /**< base pt2pt component */
     uint32_t addr_count;                     /**< total number of addresses */
-    int num_links;                           /**< number of logical links per physical device */
+    int num_links;                           /**< number of connections to each peer */
     int                  max_retries;        /**< max number of retries before declaring peer gone */
     scon_list_t          events;             /**< events for monitoring connections */
     int                  peer_limit;         /**< max size of tcp peer cache */
@@ -82,6 +82,38 @@ typedef struct {
     int                retry_delay;            /**< time to wait before retrying connection */
     int                max_recon_attempts;     /**< maximum number of times to attempt connect before giving up (-1 for never) */
 
+    /* small-message coalescing */
+    bool               coalesce;               /**< batch small messages headed to the same next hop */
+    int                coalesce_msg_size;      /**< largest payload eligible for coalescing */
+    int                coalesce_max_bytes;     /**< flush a batch once it holds this many bytes */
+    int                coalesce_max_msgs;      /**< flush a batch once it holds this many messages */
+    int                coalesce_flush_usec;    /**< flush a partial batch after this many usec */
+
+    /* flow control */
+    int                credit_window;          /**< messages a peer may send us before we return credit */
+    size_t             max_queued_bytes;       /**< fail local sends once this much is queued for a next hop */
+    int                frag_size;              /**< send larger messages in pieces of this many bytes */
+
+    /* multi-rail */
+    size_t             stripe_min_size;        /**< stripe messages of at least this many bytes */
+
+    /* socket I/O */
+    char               *backend;               /**< event or uring */
+    int                uring_entries;          /**< submission queue size */
+    int                uring_recv_buffers;     /**< buffers in the receive pool */
+    int                uring_recv_buffer_size; /**< size of each of them */
+    size_t             zerocopy_min_size;      /**< send payloads of at least this many bytes with MSG_ZEROCOPY */
+
+    /* socket tuning profiles */
+    int                tune_window;            /**< messages between evaluations of a connection's profile */
+    size_t             bulk_msg_size;          /**< smallest message counted as bulk traffic */
+    int                bulk_sndbuf;            /**< send buffer size of bulk connections */
+    int                bulk_rcvbuf;            /**< receive buffer size of bulk connections */
+    int                bulk_notsent_lowat;     /**< TCP_NOTSENT_LOWAT of bulk connections */
+    int                leaf_notsent_lowat;     /**< TCP_NOTSENT_LOWAT of leaf connections */
+    bool               leaf_quickack;          /**< keep TCP_QUICKACK on for leaf connections */
+    int                leaf_busy_poll;         /**< SO_BUSY_POLL usecs of leaf connections */
+
 } scon_pt2pt_tcp_component_t;
 
 SCON_EXPORT extern scon_pt2pt_tcp_component_t mca_pt2pt_tcp_component;
@@ -64,6 +64,7 @@
 #include "pt2pt_tcp.h"
 #include "src/mca/pt2pt/tcp/pt2pt_tcp_component.h"
 #include "src/mca/pt2pt/tcp/pt2pt_tcp_peer.h"
+#include "src/mca/pt2pt/tcp/pt2pt_tcp_uring.h"
 #include "src/mca/pt2pt/tcp/pt2pt_tcp_common.h"
 #include "src/mca/pt2pt/tcp/pt2pt_tcp_connection.h"
 
@@ -98,6 +99,7 @@ static int tcp_peer_create_socket(scon_pt2pt_tcp_peer_t* peer)
     }
    /* setup socket options */
     scon_pt2pt_tcp_set_socket_options(peer->sd);
+    scon_pt2pt_tcp_set_profile(peer, peer->profile);
 
     /* setup event callbacks */
     tcp_peer_event_init(peer);
@@ -139,6 +141,7 @@ void scon_pt2pt_tcp_peer_try_connect(int fd, short args, void *cbdata)
     char *host;
     scon_pt2pt_tcp_send_t *snd;
     bool connected = false;
+    int i;
 
     scon_output_verbose(PT2PT_TCP_DEBUG_CONNECT, scon_pt2pt_base_framework.framework_output,
                         "%s pt2pt_tcp_peer_try_connect: "
@@ -205,10 +208,7 @@ void scon_pt2pt_tcp_peer_try_connect(int fd, short args, void *cbdata)
                                     SCON_PRINT_PROC(SCON_PROC_MY_NAME),
                                     SCON_PRINT_PROC(&peer->name));
                 /* just ensure the send_event is active */
-                if (!peer->send_ev_active) {
-                    scon_event_add(&peer->send_event, 0);
-                    peer->send_ev_active = true;
-                }
+                SCON_PT2PT_TCP_SEND_EV_ADD(peer);
                 SCON_RELEASE(op);
                 return;
             }
@@ -243,6 +243,16 @@ void scon_pt2pt_tcp_peer_try_connect(int fd, short args, void *cbdata)
     }
 
     if (!connected) {
+        if (0 < peer->rail) {
+            /* the messages go over the other connections */
+            scon_output_verbose(PT2PT_TCP_DEBUG_CONNECT, scon_pt2pt_base_framework.framework_output,
+                                "%s pt2pt_tcp_peer_try_connect: unable to open rail %d to %s",
+                                SCON_PRINT_PROC(SCON_PROC_MY_NAME), peer->rail,
+                                SCON_PRINT_PROC(&peer->name));
+            peer->state = SCON_PT2PT_TCP_FAILED;
+            scon_pt2pt_tcp_peer_close(peer);
+            goto cleanup;
+        }
         /* it could be that the intended recipient just hasn't
          * started yet. if requested, wait awhile and try again
          * unless/until we hit the maximum number of retries */
@@ -259,6 +269,7 @@ void scon_pt2pt_tcp_peer_try_connect(int fd, short args, void *cbdata)
                 tv.tv_sec = mca_pt2pt_tcp_component.retry_delay;
                 tv.tv_usec = 0;
                 ++peer->num_retries;
+                SCON_PERF_INC(SCON_PERF_CTR_TCP_CONNECT_RETRIES);
                 SCON_RETRY_TCP_CONN_STATE(peer, scon_pt2pt_tcp_peer_try_connect, &tv);
                 goto cleanup;
             }
@@ -292,8 +303,12 @@ void scon_pt2pt_tcp_peer_try_connect(int fd, short args, void *cbdata)
          */
         if (NULL != peer->send_msg) {
         }
-        while (NULL != (snd = (scon_pt2pt_tcp_send_t*)scon_list_remove_first(&peer->send_queue))) {
+        for (i=0; i < SCON_MSG_PRIORITY_CLASSES; i++) {
+            while (NULL != (snd = (scon_pt2pt_tcp_send_t*)scon_list_remove_first(&peer->send_queues[i]))) {
+                SCON_PERF_DEC(SCON_PERF_CTR_TCP_SEND_QUEUE);
+            }
         }
+        peer->queued_bytes = 0;
         goto cleanup;
     }
 
@@ -304,10 +319,7 @@ void scon_pt2pt_tcp_peer_try_connect(int fd, short args, void *cbdata)
                         SCON_PRINT_PROC(&peer->name));
 
     /* setup our recv to catch the return ack call */
-    if (!peer->recv_ev_active) {
-        scon_event_add(&peer->recv_event, 0);
-        peer->recv_ev_active = true;
-    }
+    SCON_PT2PT_TCP_RECV_EV_ADD(peer);
 
     /* send our globally unique process identifier to the peer */
     if (SCON_SUCCESS == (rc = tcp_peer_send_connect_ack(peer))) {
@@ -362,7 +374,15 @@ static int tcp_peer_send_connect_ack(scon_pt2pt_tcp_peer_t* peer)
     strncpy(hdr.dst.job_name, peer->name.job_name, SCON_MAX_JOBLEN);
     hdr.dst.rank = peer->name.rank;
     hdr.type = SCON_PT2PT_TCP_IDENT;
-    hdr.tag = 0;
+    /* say which of our connections to the peer this is */
+    hdr.tag = peer->rail;
+    /* tell the peer how many messages it may send before it has to
+     * wait for credit - anything we still owed belonged to the
+     * previous connection. A rail only carries pieces of messages
+     * already counted on the primary connection */
+    peer->recv_window = (0 == peer->rail) ? mca_pt2pt_tcp_component.credit_window : 0;
+    peer->credits_owed = 0;
+    hdr.credits = peer->recv_window;
 
     /* get our security credential*/
     /*if (SCON_SUCCESS != (rc = scon_sec.get_my_credential(peer->auth_method,
@@ -509,10 +529,7 @@ void scon_pt2pt_tcp_peer_complete_connect(scon_pt2pt_tcp_peer_t *peer)
                             SCON_PRINT_PROC(SCON_PROC_MY_NAME),
                             SCON_PRINT_PROC(&(peer->name)));
 
-        if (!peer->recv_ev_active) {
-            scon_event_add(&peer->recv_event, 0);
-            peer->recv_ev_active = true;
-        }
+        SCON_PT2PT_TCP_RECV_EV_ADD(peer);
     } else {
         scon_output(0, "%s tcp_peer_complete_connect: unable to send connect ack to %s",
                     SCON_PRINT_PROC(SCON_PROC_MY_NAME),
@@ -707,6 +724,18 @@ int scon_pt2pt_tcp_peer_recv_connect_ack(scon_pt2pt_tcp_peer_t* pr,
         return SCON_ERR_COMM_FAILURE;
     }
 
+    /* an extra connection to a peer we are already connected to */
+    if (NULL == peer && 0 < hdr.tag) {
+        if (NULL == (peer = scon_pt2pt_tcp_peer_rail(&hdr.origin, hdr.tag))) {
+            scon_output_verbose(PT2PT_TCP_DEBUG_CONNECT, scon_pt2pt_base_framework.framework_output,
+                                "%s rejecting rail %d from %s",
+                                SCON_PRINT_PROC(SCON_PROC_MY_NAME), (int)hdr.tag,
+                                SCON_PRINT_PROC(&hdr.origin));
+            CLOSE_THE_SOCKET(sd);
+            return SCON_ERR_UNREACH;
+        }
+    }
+
     /* if we don't already have it, get the peer */
     if (NULL == peer) {
         peer = scon_pt2pt_tcp_peer_lookup(&hdr.origin);
@@ -832,6 +861,15 @@ int scon_pt2pt_tcp_peer_recv_connect_ack(scon_pt2pt_tcp_peer_t* pr,
                         SCON_PRINT_PROC(SCON_PROC_MY_NAME),
                         SCON_PRINT_PROC(&peer->name));
 
+    /* the peer's window - this is what we may send it before
+     * it returns credit */
+    peer->send_window = hdr.credits;
+    peer->send_credits = hdr.credits;
+    scon_output_verbose(PT2PT_TCP_DEBUG_CONNECT, scon_pt2pt_base_framework.framework_output,
+                        "%s credit window of %s is %u",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                        SCON_PRINT_PROC(&peer->name), peer->send_window);
+
     /* if the requestor wanted the header returned, then they
      * will complete their processing
      */
@@ -839,6 +877,12 @@ int scon_pt2pt_tcp_peer_recv_connect_ack(scon_pt2pt_tcp_peer_t* pr,
         return SCON_SUCCESS;
     }
 
+    if (0 < peer->rail) {
+        /* the peer is already known through its primary connection */
+        tcp_peer_connected(peer);
+        return SCON_SUCCESS;
+    }
+
     /* set the peer into the component and OOB-level peer tables to indicate
      * that we know this peer and we will be handling him
      */
@@ -849,6 +893,8 @@ int scon_pt2pt_tcp_peer_recv_connect_ack(scon_pt2pt_tcp_peer_t* pr,
     if (PT2PT_TCP_DEBUG_CONNECT <= scon_output_get_verbosity(scon_pt2pt_base_framework.framework_output)) {
         scon_pt2pt_tcp_peer_dump(peer, "connected");
     }
+    /* we opened the connection, so we open the rails too */
+    scon_pt2pt_tcp_peer_open_rails(peer);
     return SCON_SUCCESS;
 }
 
@@ -871,14 +917,13 @@ static void tcp_peer_connected(scon_pt2pt_tcp_peer_t* peer)
     if (NULL != peer->active_addr) {
         peer->active_addr->retries = 0;
     }
+    /* the io_uring backend, if we have it, takes over from here */
+    scon_pt2pt_tcp_uring_attach(peer);
+    scon_pt2pt_tcp_zerocopy_enable(peer);
     /* initiate send of first message on queue */
-    if (NULL == peer->send_msg) {
-        peer->send_msg = (scon_pt2pt_tcp_send_t*)
-            scon_list_remove_first(&peer->send_queue);
-    }
-    if (NULL != peer->send_msg && !peer->send_ev_active) {
-        scon_event_add(&peer->send_event, 0);
-        peer->send_ev_active = true;
+    scon_pt2pt_tcp_peer_next_send(peer);
+    if (NULL != peer->send_msg) {
+        SCON_PT2PT_TCP_SEND_EV_ADD(peer);
     }
 }
 
@@ -889,13 +934,22 @@ static void tcp_peer_connected(scon_pt2pt_tcp_peer_t* peer)
  */
 void scon_pt2pt_tcp_peer_close(scon_pt2pt_tcp_peer_t *peer)
 {
+    scon_pt2pt_tcp_recv_t *rcv;
+    int i;
+
     scon_output_verbose(PT2PT_TCP_DEBUG_CONNECT, scon_pt2pt_base_framework.framework_output,
                         "%s tcp_peer_close for %s sd %d state %s",
                         SCON_PRINT_PROC(SCON_PROC_MY_NAME),
                         SCON_PRINT_PROC(&(peer->name)),
                         peer->sd, scon_pt2pt_tcp_state_print(peer->state));
 
+    /* the kernel keeps what it has of our zero-copy sends
+     * once the socket is gone - complete them */
+    scon_pt2pt_tcp_zerocopy_reap(peer, true);
+    peer->zerocopy = false;
+
     /* release the socket */
+    scon_pt2pt_tcp_uring_detach(peer);
     close(peer->sd);
     peer->sd = -1;
 
@@ -914,6 +968,24 @@ void scon_pt2pt_tcp_peer_close(scon_pt2pt_tcp_peer_t *peer)
         peer->active_addr->state = SCON_PT2PT_TCP_CLOSED;
     }
 
+    /* the rest of any large message being reassembled is gone */
+    for (i=0; i < SCON_MSG_PRIORITY_CLASSES; i++) {
+        if (NULL != peer->frag_data[i]) {
+            free(peer->frag_data[i]);
+            peer->frag_data[i] = NULL;
+        }
+        peer->frag_bytes[i] = 0;
+        peer->frag_size[i] = 0;
+    }
+    SCON_LIST_DESTRUCT(&peer->stripes);
+    SCON_CONSTRUCT(&peer->stripes, scon_list_t);
+    while (NULL != (rcv = (scon_pt2pt_tcp_recv_t*)scon_list_remove_first(&peer->held))) {
+        if (NULL != rcv->data) {
+            free(rcv->data);
+        }
+        SCON_RELEASE(rcv);
+    }
+
     /* unregister active events */
     if (peer->recv_ev_active) {
         scon_event_del(&peer->recv_event);
@@ -924,6 +996,19 @@ void scon_pt2pt_tcp_peer_close(scon_pt2pt_tcp_peer_t *peer)
         peer->send_ev_active = false;
     }
 
+    if (0 < peer->rail) {
+        /* losing a rail loses no route */
+        return;
+    }
+    /* the rails go with the primary connection - they are opened
+     * again with it */
+    for (i=1; i < SCON_PT2PT_TCP_MAX_RAILS; i++) {
+        if (NULL != peer->rails[i] && 0 <= peer->rails[i]->sd) {
+            peer->rails[i]->state = SCON_PT2PT_TCP_CLOSED;
+            scon_pt2pt_tcp_peer_close(peer->rails[i]);
+        }
+    }
+
     /* inform the component-level that we have lost a connection so
      * it can decide what to do about it.
      */
@@ -937,7 +1022,7 @@ void scon_pt2pt_tcp_peer_close(scon_pt2pt_tcp_peer_t *peer)
      */
  /*   if (NULL != peer->send_msg) {
     }
-    while (NULL != (snd = (scon_pt2pt_tcp_send_t*)scon_list_remove_first(&peer->send_queue))) {
+    while (NULL != (snd = (scon_pt2pt_tcp_send_t*)scon_list_remove_first(&peer->send_queues[i]))) {
     }*/
 }
 
@@ -1132,13 +1217,13 @@ bool scon_pt2pt_tcp_peer_accept(scon_pt2pt_tcp_peer_t* peer)
         /* set the peer into the component and OOB-level peer tables to indicate
          * that we know this peer and we will be handling him
          */
-        SCON_ACTIVATE_TCP_CMP_OP(&peer->name, scon_pt2pt_tcp_component_set_module);
+        if (0 == peer->rail) {
+            SCON_ACTIVATE_TCP_CMP_OP(&peer->name, scon_pt2pt_tcp_component_set_module);
+        }
 
+        scon_pt2pt_tcp_set_profile(peer, peer->profile);
         tcp_peer_connected(peer);
-        if (!peer->recv_ev_active) {
-            scon_event_add(&peer->recv_event, 0);
-            peer->recv_ev_active = true;
-        }
+        SCON_PT2PT_TCP_RECV_EV_ADD(peer);
         if (PT2PT_TCP_DEBUG_CONNECT <= scon_output_get_verbosity(scon_pt2pt_base_framework.framework_output)) {
             scon_pt2pt_tcp_peer_dump(peer, "accepted");
         }
@@ -1153,3 +1238,86 @@ bool scon_pt2pt_tcp_peer_accept(scon_pt2pt_tcp_peer_t* peer)
                         scon_pt2pt_tcp_state_print(peer->state), peer->sd);
     return false;
 }
+
+/*
+ * Open the extra connections to a peer we have just connected to.
+ * The rails go to the peer's addresses in turn, so they land on its
+ * other interfaces when it has more than one, and share the one it
+ * has otherwise. A rail that can't be opened is left out
+ */
+void scon_pt2pt_tcp_peer_open_rails(scon_pt2pt_tcp_peer_t *peer)
+{
+    scon_pt2pt_tcp_peer_t *rail;
+    scon_pt2pt_tcp_addr_t *addr, *raddr;
+    size_t naddrs, n;
+    int i, pass;
+
+    naddrs = scon_list_get_size(&peer->addrs);
+    if (0 < peer->rail || 0 == naddrs) {
+        return;
+    }
+    for (i=1; i < mca_pt2pt_tcp_component.num_links; i++) {
+        if (NULL == (rail = peer->rails[i])) {
+            rail = SCON_NEW(scon_pt2pt_tcp_peer_t);
+            strncpy(rail->name.job_name, peer->name.job_name, SCON_MAX_JOBLEN);
+            rail->name.rank = peer->name.rank;
+            rail->rail = i;
+            rail->primary = peer;
+            rail->profile = SCON_PT2PT_TCP_PROFILE_BULK;
+            peer->rails[i] = rail;
+        } else if (SCON_PT2PT_TCP_UNCONNECTED != rail->state &&
+                   SCON_PT2PT_TCP_CLOSED != rail->state &&
+                   SCON_PT2PT_TCP_FAILED != rail->state) {
+            continue;
+        }
+        /* start with the i'th address, and fall back to the others */
+        SCON_LIST_DESTRUCT(&rail->addrs);
+        SCON_CONSTRUCT(&rail->addrs, scon_list_t);
+        rail->active_addr = NULL;
+        for (pass=0; pass < 2; pass++) {
+            n = 0;
+            SCON_LIST_FOREACH(addr, &peer->addrs, scon_pt2pt_tcp_addr_t) {
+                if ((n++ < (size_t)i % naddrs) == (0 == pass)) {
+                    continue;
+                }
+                raddr = SCON_NEW(scon_pt2pt_tcp_addr_t);
+                memcpy(&raddr->addr, &addr->addr, sizeof(raddr->addr));
+                scon_list_append(&rail->addrs, &raddr->super);
+            }
+        }
+        scon_output_verbose(PT2PT_TCP_DEBUG_CONNECT, scon_pt2pt_base_framework.framework_output,
+                            "%s opening rail %d to %s",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME), i,
+                            SCON_PRINT_PROC(&peer->name));
+        rail->state = SCON_PT2PT_TCP_CONNECTING;
+        SCON_ACTIVATE_TCP_CONN_STATE(rail, scon_pt2pt_tcp_peer_try_connect);
+    }
+}
+
+/*
+ * The rail an accepted connection is for, if the peer is connected
+ * to us on its primary connection
+ */
+scon_pt2pt_tcp_peer_t* scon_pt2pt_tcp_peer_rail(const scon_proc_t *name, int idx)
+{
+    scon_pt2pt_tcp_peer_t *peer, *rail;
+
+    if (SCON_PT2PT_TCP_MAX_RAILS <= idx ||
+        NULL == (peer = scon_pt2pt_tcp_peer_lookup(name)) ||
+        0 < peer->rail || SCON_PT2PT_TCP_CONNECTED != peer->state) {
+        return NULL;
+    }
+    if (NULL == (rail = peer->rails[idx])) {
+        rail = SCON_NEW(scon_pt2pt_tcp_peer_t);
+        strncpy(rail->name.job_name, name->job_name, SCON_MAX_JOBLEN);
+        rail->name.rank = name->rank;
+        rail->rail = idx;
+        rail->primary = peer;
+        rail->profile = SCON_PT2PT_TCP_PROFILE_BULK;
+        peer->rails[idx] = rail;
+    } else if (SCON_PT2PT_TCP_CONNECTED == rail->state) {
+        return NULL;
+    }
+    return rail;
+}
+
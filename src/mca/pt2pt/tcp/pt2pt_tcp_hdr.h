@@ -36,7 +36,23 @@ typedef enum {
     SCON_PT2PT_TCP_IDENT,
     SCON_PT2PT_TCP_PROBE,
     SCON_PT2PT_TCP_PING,
-    SCON_PT2PT_TCP_USER
+    SCON_PT2PT_TCP_USER,
+    /* a batch of coalesced user messages - the payload
+     * is a sequence of (network-order) headers, each
+     * followed by that message's data */
+    SCON_PT2PT_TCP_BATCH,
+    /* a piece of a large message - the rest follows in more
+     * FRAGs of the same priority, the last piece as a USER */
+    SCON_PT2PT_TCP_FRAG,
+    /* returns credits to the peer when there is no
+     * other traffic to carry them */
+    SCON_PT2PT_TCP_CREDIT,
+    /* announces a message striped across the rails - no
+     * payload, the message is delivered in its place once
+     * all of its RAIL pieces are in */
+    SCON_PT2PT_TCP_STRIPE,
+    /* a piece of a striped message, on any rail */
+    SCON_PT2PT_TCP_RAIL
 } scon_pt2pt_tcp_msg_type_t;
 
 /* header for tcp msgs */
@@ -55,12 +71,24 @@ typedef struct {
     scon_proc_t     dst;
     /* type of message */
     scon_pt2pt_tcp_msg_type_t type;
-    /* the msg tag where this message is headed */
+    /* the msg tag where this message is headed - in an IDENT,
+     * the rail the connection is for */
     scon_msg_tag_t tag;
-    /* the seq number of this message */
+    /* the seq number of this message - for a FRAG, STRIPE or
+     * RAIL, the size of the whole message */
     uint32_t seq_num;
     /* number of bytes in message */
     uint32_t nbytes;
+    /* flow control - in an IDENT, the number of messages the
+     * sender will take from us before it returns credit (0 for
+     * no limit). In any other message, the credits it returns */
+    uint32_t credits;
+    /* class the message is sent in (SCON_MSG_PRIORITY_*) */
+    uint32_t priority;
+    /* for a STRIPE or RAIL, the striped message it belongs to
+     * and, for a RAIL, where its payload goes in that message */
+    uint32_t stripe;
+    uint32_t offset;
 } scon_pt2pt_tcp_hdr_t;
 /**
  * Convert the message header to host byte order
@@ -77,7 +105,12 @@ typedef struct {
     (h)->dst.rank = ntohl((h)->dst.rank);        \
     (h)->type = ntohl((h)->type);               \
     (h)->tag = ntohl((h)->tag);                 \
-    (h)->nbytes = ntohl((h)->nbytes);
+    (h)->seq_num = ntohl((h)->seq_num);         \
+    (h)->nbytes = ntohl((h)->nbytes);           \
+    (h)->credits = ntohl((h)->credits);         \
+    (h)->priority = ntohl((h)->priority);       \
+    (h)->stripe = ntohl((h)->stripe);           \
+    (h)->offset = ntohl((h)->offset);
 
 /**
  * Convert the message header to network byte order
@@ -88,6 +121,11 @@ typedef struct {
     (h)->dst.rank = htonl((h)->dst.rank);           \
     (h)->type = htonl((h)->type);               \
     (h)->tag = htonl((h)->tag);                 \
-    (h)->nbytes = htonl((h)->nbytes);
+    (h)->seq_num = htonl((h)->seq_num);         \
+    (h)->nbytes = htonl((h)->nbytes);           \
+    (h)->credits = htonl((h)->credits);         \
+    (h)->priority = htonl((h)->priority);       \
+    (h)->stripe = htonl((h)->stripe);           \
+    (h)->offset = htonl((h)->offset);
 
 #endif /* _SCON_PT2PT_TCP_HDR_H_ */
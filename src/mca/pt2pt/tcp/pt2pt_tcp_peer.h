@@ -36,8 +36,21 @@ typedef struct {
 } scon_pt2pt_tcp_addr_t;
 SCON_CLASS_DECLARATION(scon_pt2pt_tcp_addr_t);
 
+/* most connections we keep to one peer */
+#define SCON_PT2PT_TCP_MAX_RAILS   8
+
+/* socket tuning profiles - bulk for the connections that carry
+ * relays and large messages, leaf for control traffic */
+#define SCON_PT2PT_TCP_PROFILE_LEAF 0
+#define SCON_PT2PT_TCP_PROFILE_BULK 1
+
+/* message sizes are counted by power of 2 */
+#define SCON_PT2PT_TCP_SIZE_BINS   33
+
+struct scon_pt2pt_tcp_uring_op_t;
+
 /* object for tracking peers in the module */
-typedef struct {
+typedef struct scon_pt2pt_tcp_peer_t {
     scon_list_item_t super;
     /* although not required, there is enough debug
      * value that retaining the name makes sense
@@ -55,12 +68,96 @@ typedef struct {
     bool recv_ev_active;
     scon_event_t timer_event;   /**< timer for retrying connection failures */
     bool timer_ev_active;
-    scon_list_t send_queue;      /**< list of messages to send */
+    scon_list_t send_queues[SCON_MSG_PRIORITY_CLASSES]; /**< messages to send, by class */
     scon_pt2pt_tcp_send_t *send_msg; /**< current send in progress */
     scon_pt2pt_tcp_recv_t *recv_msg; /**< current recv in progress */
+    scon_pt2pt_tcp_send_t *batch;    /**< batch of small messages being coalesced */
+    scon_event_t batch_event;   /**< timer for flushing a partial batch */
+    bool batch_ev_active;
+    size_t queued_bytes;        /**< bytes waiting in the send queue */
+    /* flow control */
+    uint32_t send_window;       /**< messages the peer takes before returning credit, 0 for no limit */
+    uint32_t send_credits;      /**< messages we may still send the peer */
+    uint32_t recv_window;       /**< the window we gave the peer */
+    uint32_t credits_owed;      /**< credits we have to return to the peer */
+    /* large messages being reassembled, by class */
+    char *frag_data[SCON_MSG_PRIORITY_CLASSES];
+    size_t frag_bytes[SCON_MSG_PRIORITY_CLASSES];
+    size_t frag_size[SCON_MSG_PRIORITY_CLASSES];
+    /* multi-rail - everything goes over the primary connection
+     * but the pieces of a striped message, which are spread over
+     * it and the extra connections (rails) to the same peer. A
+     * rail is tracked by a peer object of its own */
+    int rail;                   /**< index of this connection, 0 for the primary */
+    struct scon_pt2pt_tcp_peer_t *primary;  /**< for a rail, the primary connection */
+    struct scon_pt2pt_tcp_peer_t *rails[SCON_PT2PT_TCP_MAX_RAILS]; /**< the rails by index, 0 unused */
+    uint32_t stripe_next;       /**< id of the last message we striped */
+    scon_list_t stripes;        /**< striped messages being reassembled */
+    scon_list_t held;           /**< messages received behind an incomplete striped one */
+    /* io_uring backend - a connected socket driven by it isn't
+     * polled. The recv handler runs as data comes in, and the send
+     * handler is scheduled with uring_event */
+    bool uring;                 /**< the socket is driven by the io_uring backend */
+    scon_event_t uring_event;   /**< runs the send handler */
+    struct scon_pt2pt_tcp_uring_op_t *uring_rx; /**< multishot recv on the socket */
+    struct scon_pt2pt_tcp_uring_op_t *uring_tx; /**< send in flight */
+    bool uring_tx_done;         /**< the last send completed with uring_tx_res */
+    int uring_tx_res;
+    char *uring_rx_ptr;         /**< received bytes the recv handler hasn't taken yet */
+    size_t uring_rx_len;
+    int uring_rx_status;        /**< errno the recv ended with, -1 for end of file */
+    /* zero-copy sends - the kernel numbers each MSG_ZEROCOPY send
+     * on the socket, and reports on the error queue when it no
+     * longer needs their pages */
+    bool zerocopy;              /**< large payloads go with MSG_ZEROCOPY */
+    uint32_t zc_sent;           /**< number of the next MSG_ZEROCOPY send */
+    scon_list_t zc_pending;     /**< sent messages waiting on the kernel, in order */
+    /* socket tuning - the profile follows the sizes of the
+     * messages the connection carries, and is kept for when
+     * it connects again */
+    int profile;                /**< SCON_PT2PT_TCP_PROFILE_LEAF or _BULK */
+    bool quickack;              /**< re-arm TCP_QUICKACK after each message received */
+    uint32_t size_msgs;         /**< messages counted since the profile was last picked */
+    uint32_t size_hist[SCON_PT2PT_TCP_SIZE_BINS];  /**< those messages by log2 of their size */
+    uint64_t size_bytes[SCON_PT2PT_TCP_SIZE_BINS]; /**< and their bytes */
 } scon_pt2pt_tcp_peer_t;
 SCON_CLASS_DECLARATION(scon_pt2pt_tcp_peer_t);
 
+/* start the send/recv handler on a peer's socket. The io_uring
+ * backend runs the recv handler itself as data comes in, and the
+ * send handler is just scheduled */
+#define SCON_PT2PT_TCP_SEND_EV_ADD(p)                                   \
+    do {                                                                \
+        if (!(p)->send_ev_active) {                                     \
+            if ((p)->uring) {                                           \
+                scon_event_active(&(p)->uring_event, SCON_EV_WRITE, 1); \
+            } else {                                                    \
+                scon_event_add(&(p)->send_event, 0);                    \
+            }                                                           \
+            (p)->send_ev_active = true;                                 \
+        }                                                               \
+    } while(0)
+
+#define SCON_PT2PT_TCP_RECV_EV_ADD(p)                                   \
+    do {                                                                \
+        if (!(p)->recv_ev_active) {                                     \
+            if (!(p)->uring) {                                          \
+                scon_event_add(&(p)->recv_event, 0);                    \
+            }                                                           \
+            (p)->recv_ev_active = true;                                 \
+        }                                                               \
+    } while(0)
+
+/* a received message's claim on a credit of the peer it came
+ * from - the credit is returned when the last reference is
+ * released, so a message we relay holds its credit until the
+ * next hop has taken it */
+typedef struct {
+    scon_object_t super;
+    scon_pt2pt_tcp_peer_t *peer;
+} scon_pt2pt_tcp_credit_t;
+SCON_CLASS_DECLARATION(scon_pt2pt_tcp_credit_t);
+
 /* state machine for processing peer data */
 typedef struct {
     scon_comm_scon_t *scon;
@@ -106,4 +203,23 @@ SCON_CLASS_DECLARATION(scon_pt2pt_tcp_peer_op_t);
         scon_event_active(&pop->ev, SCON_EV_WRITE, 1);                  \
     } while(0);
 
+/* coalescing of small messages headed to the same next hop */
+void scon_pt2pt_tcp_coalesce(scon_pt2pt_tcp_peer_t *peer, scon_send_t *msg);
+void scon_pt2pt_tcp_flush_batch(scon_pt2pt_tcp_peer_t *peer);
+void scon_pt2pt_tcp_drop_batch(scon_pt2pt_tcp_peer_t *peer, int status);
+
+/* multi-rail striping */
+void scon_pt2pt_tcp_peer_open_rails(scon_pt2pt_tcp_peer_t *peer);
+scon_pt2pt_tcp_peer_t* scon_pt2pt_tcp_peer_rail(const scon_proc_t *name, int idx);
+bool scon_pt2pt_tcp_stripe(scon_pt2pt_tcp_peer_t *peer, scon_send_t *msg);
+
+/* credit based flow control */
+void scon_pt2pt_tcp_peer_next_send(scon_pt2pt_tcp_peer_t *peer);
+void scon_pt2pt_tcp_peer_add_credits(scon_pt2pt_tcp_peer_t *peer, uint32_t credits);
+void scon_pt2pt_tcp_peer_return_credit(scon_pt2pt_tcp_peer_t *peer);
+
+/* zero-copy sends */
+void scon_pt2pt_tcp_zerocopy_enable(scon_pt2pt_tcp_peer_t *peer);
+void scon_pt2pt_tcp_zerocopy_reap(scon_pt2pt_tcp_peer_t *peer, bool all);
+
 #endif /* _SCON_PT2PT_TCP_PEER_H_ */
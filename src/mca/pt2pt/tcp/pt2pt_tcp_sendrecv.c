@@ -50,6 +50,12 @@
 #ifdef HAVE_NETINET_TCP_H
 #include <netinet/tcp.h>
 #endif
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#ifdef HAVE_LINUX_ERRQUEUE_H
+#include <linux/errqueue.h>
+#endif
 
 #include "scon_stdint.h"
 #include "scon_types.h"
@@ -68,9 +74,561 @@
 #include "pt2pt_tcp.h"
 #include "src/mca/pt2pt/tcp/pt2pt_tcp_component.h"
 #include "src/mca/pt2pt/tcp/pt2pt_tcp_peer.h"
+#include "src/mca/pt2pt/tcp/pt2pt_tcp_uring.h"
 #include "src/mca/pt2pt/tcp/pt2pt_tcp_common.h"
 #include "src/mca/pt2pt/tcp/pt2pt_tcp_connection.h"
 
+#if defined(HAVE_LINUX_ERRQUEUE_H) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+#define PT2PT_TCP_ZEROCOPY 1
+#endif
+
+/* the connection that reassembles what arrives on a rail */
+#define PRIMARY(p) ((NULL == (p)->primary) ? (p) : (p)->primary)
+
+/* a piece of a striped message has gone - the message is
+ * complete with the last of them */
+static void stripe_piece_sent(scon_pt2pt_tcp_stripe_send_t *stripe, int status)
+{
+    if (SCON_SUCCESS != status) {
+        stripe->status = status;
+    }
+    if (0 == --stripe->pending) {
+        stripe->msg->status = stripe->status;
+        PT2PT_SEND_COMPLETE(stripe->msg);
+    }
+}
+
+/* notify the upper layer that the message(s) carried
+ * by this send are complete */
+static void send_complete(scon_pt2pt_tcp_send_t *msg, int status)
+{
+    int i;
+
+    if (0 < msg->nbatched) {
+        for (i=0; i < msg->nbatched; i++) {
+            msg->batched[i]->status = status;
+            PT2PT_SEND_COMPLETE(msg->batched[i]);
+        }
+    } else if (NULL != msg->stripe) {
+        stripe_piece_sent(msg->stripe, status);
+    } else if (NULL != msg->msg) {
+        msg->msg->status = status;
+        PT2PT_SEND_COMPLETE(msg->msg);
+    }
+}
+
+/* a message has left - notify the pt2pt of what it carried
+ * and release it */
+static void msg_sent(scon_pt2pt_tcp_peer_t *peer, scon_pt2pt_tcp_send_t *msg)
+{
+    if (0 < msg->nbatched) {
+        /* a batch of coalesced messages - notify the pt2pt
+         * of each one */
+        scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
+                            "%s BATCH OF %d MESSAGES SEND COMPLETE TO %s OF %d BYTES ON SOCKET %d",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME), msg->nbatched,
+                            SCON_PRINT_PROC(&(peer->name)),
+                            (int)ntohl(msg->hdr.nbytes), peer->sd);
+        send_complete(msg, SCON_SUCCESS);
+    } else if (NULL != msg->stripe) {
+        /* this rail's share of a striped message has gone */
+        scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
+                            "%s STRIPED MESSAGE SHARE COMPLETE TO %s OF %lu BYTES ON SOCKET %d",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                            SCON_PRINT_PROC(&(peer->name)),
+                            (unsigned long)msg->total, peer->sd);
+        stripe_piece_sent(msg->stripe, SCON_SUCCESS);
+    } else if (NULL != msg->data || NULL == msg->msg) {
+        /* this was a relay we have now completed - no need to
+         * notify the upper framework as the local proc didn't initiate
+         * the send. Releasing the message releases the data
+         */
+        scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
+                            "%s MESSAGE RELAY COMPLETE TO %s OF %d BYTES ON SOCKET %d",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                            SCON_PRINT_PROC(&(peer->name)),
+                            (int)ntohl(msg->hdr.nbytes), peer->sd);
+    } else if (NULL != msg->msg->buf) {
+        /* we are done - notify the pt2pt */
+        scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
+                            "%s MESSAGE SEND COMPLETE TO %s OF %d BYTES ON SOCKET %d",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                            SCON_PRINT_PROC(&(peer->name)),
+                            (int)ntohl(msg->hdr.nbytes), peer->sd);
+        msg->msg->status = SCON_SUCCESS;
+        PT2PT_SEND_COMPLETE(msg->msg);
+    }
+    SCON_RELEASE(msg);
+}
+
+/*
+ * Zero-copy sends. A payload of at least zerocopy_min_size goes
+ * with MSG_ZEROCOPY - the kernel sends from our pages instead of
+ * copying them, so the buffer stays in use after the write returns.
+ * The kernel numbers these sends on each socket and posts the
+ * numbers it is done with to the socket's error queue, which makes
+ * the socket poll as errored. Until then the message waits on the
+ * peer's zc_pending list, and the user's callback - or the release
+ * of the data we relayed - waits with it
+ */
+void scon_pt2pt_tcp_zerocopy_enable(scon_pt2pt_tcp_peer_t *peer)
+{
+#ifdef PT2PT_TCP_ZEROCOPY
+    int flag = 1;
+
+    peer->zerocopy = false;
+    peer->zc_sent = 0;
+    /* the io_uring backend does its own writes */
+    if (0 == mca_pt2pt_tcp_component.zerocopy_min_size || peer->uring) {
+        return;
+    }
+    if (0 != setsockopt(peer->sd, SOL_SOCKET, SO_ZEROCOPY, &flag, sizeof(flag))) {
+        scon_output_verbose(5, scon_pt2pt_base_framework.framework_output,
+                            "%s zero-copy sends to %s not available: %s",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                            SCON_PRINT_PROC(&peer->name), strerror(scon_socket_errno));
+        return;
+    }
+    peer->zerocopy = true;
+#endif
+}
+
+/* complete the messages the kernel is done with - or, when the
+ * connection is going away, all of them, failing those it hadn't
+ * confirmed */
+void scon_pt2pt_tcp_zerocopy_reap(scon_pt2pt_tcp_peer_t *peer, bool all)
+{
+    scon_pt2pt_tcp_send_t *msg;
+    bool reaped = false;
+    uint32_t done = 0;
+#ifdef PT2PT_TCP_ZEROCOPY
+    struct sock_extended_err *serr;
+    struct cmsghdr *cm;
+    struct msghdr mh;
+    char control[128];
+
+    while (0 <= peer->sd) {
+        memset(&mh, 0, sizeof(mh));
+        mh.msg_control = control;
+        mh.msg_controllen = sizeof(control);
+        if (recvmsg(peer->sd, &mh, MSG_ERRQUEUE) < 0) {
+            if (EINTR == scon_socket_errno) {
+                continue;
+            }
+            break;
+        }
+        for (cm = CMSG_FIRSTHDR(&mh); NULL != cm; cm = CMSG_NXTHDR(&mh, cm)) {
+            if (!(IPPROTO_IP == cm->cmsg_level && IP_RECVERR == cm->cmsg_type) &&
+                !(IPPROTO_IPV6 == cm->cmsg_level && IPV6_RECVERR == cm->cmsg_type)) {
+                continue;
+            }
+            serr = (struct sock_extended_err*)CMSG_DATA(cm);
+            if (SO_EE_ORIGIN_ZEROCOPY != serr->ee_origin || 0 != serr->ee_errno) {
+                continue;
+            }
+            /* sends ee_info to ee_data are done - tcp reports them
+             * in order, so everything up to ee_data is */
+            done = serr->ee_data;
+            reaped = true;
+            if (peer->zerocopy && (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)) {
+                /* the kernel had to copy anyway, as it does over
+                 * loopback - stop paying for the notifications */
+                scon_output_verbose(5, scon_pt2pt_base_framework.framework_output,
+                                    "%s zero-copy sends to %s are being copied - disabling them",
+                                    SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                                    SCON_PRINT_PROC(&peer->name));
+                peer->zerocopy = false;
+            }
+        }
+    }
+#endif
+    while (!scon_list_is_empty(&peer->zc_pending)) {
+        msg = (scon_pt2pt_tcp_send_t*)scon_list_get_first(&peer->zc_pending);
+        if (!all && (!reaped || 0 < (int32_t)(msg->zc_last - done))) {
+            break;
+        }
+        scon_list_remove_item(&peer->zc_pending, &msg->super);
+        if (reaped && 0 >= (int32_t)(msg->zc_last - done)) {
+            msg_sent(peer, msg);
+        } else {
+            /* the connection went before the kernel was done
+             * with it - we can't tell that it arrived */
+            send_complete(msg, SCON_ERR_COMM_FAILURE);
+            SCON_RELEASE(msg);
+        }
+    }
+}
+
+static ssize_t zerocopy_write(scon_pt2pt_tcp_peer_t *peer, scon_pt2pt_tcp_send_t *msg)
+{
+#ifdef PT2PT_TCP_ZEROCOPY
+    ssize_t rc;
+
+    if (0 <= (rc = send(peer->sd, msg->sdptr, msg->sdbytes, MSG_ZEROCOPY))) {
+        /* every send that takes bytes gets the next number */
+        msg->zerocopy = true;
+        msg->zc_last = peer->zc_sent++;
+        return rc;
+    }
+    if (ENOBUFS != scon_socket_errno) {
+        return rc;
+    }
+    /* out of memory to track the pages - copy this time */
+#endif
+    return write(peer->sd, msg->sdptr, msg->sdbytes);
+}
+
+static void batch_timeout(int fd, short args, void *cbdata)
+{
+    scon_pt2pt_tcp_peer_t *peer = (scon_pt2pt_tcp_peer_t*)cbdata;
+
+    peer->batch_ev_active = false;
+    scon_pt2pt_tcp_flush_batch(peer);
+}
+
+/*
+ * Close the batch currently being built for this peer
+ * and place it on the send queue
+ */
+void scon_pt2pt_tcp_flush_batch(scon_pt2pt_tcp_peer_t *peer)
+{
+    scon_pt2pt_tcp_send_t *batch = peer->batch;
+
+    if (peer->batch_ev_active) {
+        scon_event_del(&peer->batch_event);
+        peer->batch_ev_active = false;
+    }
+    if (NULL == batch) {
+        return;
+    }
+    peer->batch = NULL;
+    scon_output_verbose(5, scon_pt2pt_base_framework.framework_output,
+                        "%s flushing batch of %d messages (%d bytes) to %s",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                        batch->nbatched, (int)batch->hdr.nbytes,
+                        SCON_PRINT_PROC(&peer->name));
+    /* prep header for xmission */
+    SCON_PT2PT_TCP_HDR_HTON(&batch->hdr);
+    batch->sdptr = (char*)&batch->hdr;
+    batch->sdbytes = sizeof(scon_pt2pt_tcp_hdr_t);
+    SCON_PT2PT_TCP_QUEUE_MSG(peer, batch, true);
+}
+
+/*
+ * Fail the batch being built for a peer that is going away -
+ * the messages in it were never sent
+ */
+void scon_pt2pt_tcp_drop_batch(scon_pt2pt_tcp_peer_t *peer, int status)
+{
+    scon_pt2pt_tcp_send_t *batch = peer->batch;
+
+    if (peer->batch_ev_active) {
+        scon_event_del(&peer->batch_event);
+        peer->batch_ev_active = false;
+    }
+    if (NULL == batch) {
+        return;
+    }
+    peer->batch = NULL;
+    scon_output_verbose(5, scon_pt2pt_base_framework.framework_output,
+                        "%s dropping batch of %d messages to %s",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                        batch->nbatched, SCON_PRINT_PROC(&peer->name));
+    send_complete(batch, status);
+    SCON_RELEASE(batch);
+}
+
+/*
+ * Add a small message to the batch being built for this
+ * next hop, flushing the batch when it reaches the byte
+ * or message count thresholds. A partial batch is flushed
+ * by a timer so a lone message is not held indefinitely
+ */
+void scon_pt2pt_tcp_coalesce(scon_pt2pt_tcp_peer_t *peer, scon_send_t *snd)
+{
+    scon_pt2pt_tcp_send_t *batch;
+    scon_pt2pt_tcp_hdr_t hdr;
+    size_t nbytes = snd->buf->bytes_used;
+    struct timeval tv;
+
+    /* if this message won't fit, send what we have */
+    if (NULL != peer->batch &&
+        (int)(peer->batch->hdr.nbytes + sizeof(hdr) + nbytes) > mca_pt2pt_tcp_component.coalesce_max_bytes) {
+        scon_pt2pt_tcp_flush_batch(peer);
+    }
+    if (NULL == (batch = peer->batch)) {
+        batch = SCON_NEW(scon_pt2pt_tcp_send_t);
+        batch->data = (char*)malloc(mca_pt2pt_tcp_component.coalesce_max_bytes);
+        batch->batched = (scon_send_t**)calloc(mca_pt2pt_tcp_component.coalesce_max_msgs,
+                                               sizeof(scon_send_t*));
+        if (NULL == batch->data || NULL == batch->batched) {
+            SCON_ERROR_LOG(SCON_ERR_OUT_OF_RESOURCE);
+            SCON_RELEASE(batch);
+            SCON_PT2PT_TCP_QUEUE_SEND(snd, peer);
+            return;
+        }
+        /* the batch itself is addressed to the next hop */
+        strncpy(batch->hdr.origin.job_name, SCON_PROC_MY_NAME->job_name, SCON_MAX_JOBLEN);
+        batch->hdr.origin.rank = SCON_PROC_MY_NAME->rank;
+        strncpy(batch->hdr.dst.job_name, peer->name.job_name, SCON_MAX_JOBLEN);
+        batch->hdr.dst.rank = peer->name.rank;
+        batch->hdr.type = SCON_PT2PT_TCP_BATCH;
+        batch->hdr.scon_handle = snd->scon_handle;
+        batch->hdr.priority = SCON_MSG_PRIORITY_NORMAL;
+        batch->priority = SCON_MSG_PRIORITY_NORMAL;
+        batch->hdr.nbytes = 0;
+        peer->batch = batch;
+        /* start the flush timer */
+        tv.tv_sec = mca_pt2pt_tcp_component.coalesce_flush_usec / 1000000;
+        tv.tv_usec = mca_pt2pt_tcp_component.coalesce_flush_usec % 1000000;
+        scon_event_evtimer_set(scon_pt2pt_tcp_module.ev_base, &peer->batch_event,
+                               batch_timeout, peer);
+        scon_event_evtimer_add(&peer->batch_event, &tv);
+        peer->batch_ev_active = true;
+    }
+    /* append the message header and data */
+    memset(&hdr, 0, sizeof(hdr));
+    strncpy(hdr.origin.job_name, snd->origin.job_name, SCON_MAX_JOBLEN);
+    hdr.origin.rank = snd->origin.rank;
+    strncpy(hdr.dst.job_name, snd->dst.job_name, SCON_MAX_JOBLEN);
+    hdr.dst.rank = snd->dst.rank;
+    hdr.type = SCON_PT2PT_TCP_USER;
+    hdr.tag = snd->tag;
+    hdr.scon_handle = snd->scon_handle;
+    hdr.priority = snd->priority;
+    hdr.nbytes = nbytes;
+    SCON_PT2PT_TCP_HDR_HTON(&hdr);
+    memcpy(batch->data + batch->hdr.nbytes, &hdr, sizeof(hdr));
+    batch->hdr.nbytes += sizeof(hdr);
+    if (0 < nbytes) {
+        memcpy(batch->data + batch->hdr.nbytes, snd->buf->base_ptr, nbytes);
+        batch->hdr.nbytes += nbytes;
+    }
+    batch->batched[batch->nbatched++] = snd;
+
+    if (mca_pt2pt_tcp_component.coalesce_max_msgs <= batch->nbatched ||
+        mca_pt2pt_tcp_component.coalesce_max_bytes <= (int)batch->hdr.nbytes) {
+        scon_pt2pt_tcp_flush_batch(peer);
+    }
+}
+
+/* a STRIPE or RAIL header for a message being striped */
+static scon_pt2pt_tcp_send_t* stripe_msg(scon_send_t *msg, scon_pt2pt_tcp_msg_type_t type,
+                                         uint32_t id, size_t total)
+{
+    scon_pt2pt_tcp_send_t *snd;
+
+    snd = SCON_NEW(scon_pt2pt_tcp_send_t);
+    memset(&snd->hdr, 0, sizeof(snd->hdr));
+    strncpy(snd->hdr.origin.job_name, msg->origin.job_name, SCON_MAX_JOBLEN);
+    snd->hdr.origin.rank = msg->origin.rank;
+    strncpy(snd->hdr.dst.job_name, msg->dst.job_name, SCON_MAX_JOBLEN);
+    snd->hdr.dst.rank = msg->dst.rank;
+    snd->hdr.type = type;
+    snd->hdr.tag = msg->tag;
+    snd->hdr.scon_handle = msg->scon_handle;
+    snd->hdr.priority = msg->priority;
+    snd->hdr.stripe = id;
+    snd->hdr.seq_num = (uint32_t)total;
+    snd->priority = msg->priority;
+    snd->sdptr = (char*)&snd->hdr;
+    snd->sdbytes = sizeof(scon_pt2pt_tcp_hdr_t);
+    return snd;
+}
+
+/*
+ * Stripe a large message across the connections to this next
+ * hop. The primary connection carries a STRIPE in the message's
+ * place in its class queue - that is what keeps it in order with
+ * everything else, and takes its credit. The payload is split in
+ * equal shares, one per connection, each sent as RAIL pieces of
+ * at most the fragment size. Returns false if no rail is up to
+ * share the message with
+ */
+bool scon_pt2pt_tcp_stripe(scon_pt2pt_tcp_peer_t *peer, scon_send_t *msg)
+{
+    scon_pt2pt_tcp_peer_t *links[SCON_PT2PT_TCP_MAX_RAILS];
+    scon_pt2pt_tcp_stripe_send_t *stripe;
+    scon_pt2pt_tcp_send_t *snd;
+    size_t total, share, offset, nbytes;
+    int i, nlinks = 0;
+
+    links[nlinks++] = peer;
+    for (i=1; i < SCON_PT2PT_TCP_MAX_RAILS; i++) {
+        if (NULL != peer->rails[i] && SCON_PT2PT_TCP_CONNECTED == peer->rails[i]->state) {
+            links[nlinks++] = peer->rails[i];
+        }
+    }
+    if (1 == nlinks) {
+        return false;
+    }
+    total = msg->buf->bytes_used;
+    share = (total + nlinks - 1) / nlinks;
+    ++peer->stripe_next;
+    scon_output_verbose(5, scon_pt2pt_base_framework.framework_output,
+                        "%s striping message %u of %lu bytes to %s over %d connections",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), peer->stripe_next,
+                        (unsigned long)total, SCON_PRINT_PROC(&peer->name), nlinks);
+
+    stripe = SCON_NEW(scon_pt2pt_tcp_stripe_send_t);
+    stripe->msg = msg;
+    /* the pieces hold the stripe until they are all sent */
+    stripe->pending = 1;
+    snd = stripe_msg(msg, SCON_PT2PT_TCP_STRIPE, peer->stripe_next, total);
+    SCON_PT2PT_TCP_HDR_HTON(&snd->hdr);
+    SCON_PT2PT_TCP_QUEUE_MSG(peer, snd, true);
+    for (i=0, offset=0; i < nlinks && offset < total; i++, offset += share) {
+        snd = stripe_msg(msg, SCON_PT2PT_TCP_RAIL, peer->stripe_next, total);
+        snd->stripe = stripe;
+        SCON_RETAIN(stripe);
+        ++stripe->pending;
+        snd->offset = offset;
+        snd->total = (total - offset < share) ? total : offset + share;
+        nbytes = snd->total - offset;
+        if (0 < mca_pt2pt_tcp_component.frag_size &&
+            (size_t)mca_pt2pt_tcp_component.frag_size < nbytes) {
+            nbytes = mca_pt2pt_tcp_component.frag_size;
+        }
+        snd->hdr.nbytes = (uint32_t)nbytes;
+        snd->hdr.offset = (uint32_t)offset;
+        SCON_PT2PT_TCP_HDR_HTON(&snd->hdr);
+        SCON_PT2PT_TCP_QUEUE_MSG(links[i], snd, true);
+    }
+    stripe_piece_sent(stripe, SCON_SUCCESS);
+    SCON_RELEASE(stripe);
+    return true;
+}
+
+/* half of the window we gave the peer - credits owed to it
+ * go back on their own once this many have built up */
+#define CREDIT_THRESHOLD(p) (((p)->recv_window + 1) / 2)
+
+/* a header-only message that returns the credits we owe */
+static scon_pt2pt_tcp_send_t* credit_msg(scon_pt2pt_tcp_peer_t *peer)
+{
+    scon_pt2pt_tcp_send_t *snd;
+
+    snd = SCON_NEW(scon_pt2pt_tcp_send_t);
+    memset(&snd->hdr, 0, sizeof(snd->hdr));
+    strncpy(snd->hdr.origin.job_name, SCON_PROC_MY_NAME->job_name, SCON_MAX_JOBLEN);
+    snd->hdr.origin.rank = SCON_PROC_MY_NAME->rank;
+    strncpy(snd->hdr.dst.job_name, peer->name.job_name, SCON_MAX_JOBLEN);
+    snd->hdr.dst.rank = peer->name.rank;
+    snd->hdr.type = SCON_PT2PT_TCP_CREDIT;
+    /* the credits themselves are filled in as the header goes out */
+    SCON_PT2PT_TCP_HDR_HTON(&snd->hdr);
+    snd->sdptr = (char*)&snd->hdr;
+    snd->sdbytes = sizeof(scon_pt2pt_tcp_hdr_t);
+    return snd;
+}
+
+/* a message larger than the fragment size goes out in pieces,
+ * each a FRAG carrying seq_num = the whole size, with the last
+ * piece sent as the USER message it is. The header is in network
+ * order */
+static void frag_setup(scon_pt2pt_tcp_send_t *snd)
+{
+    size_t nbytes;
+
+    if (0 == mca_pt2pt_tcp_component.frag_size || NULL == snd->msg ||
+        0 < snd->nbatched || NULL != snd->data || NULL == snd->msg->buf ||
+        SCON_PT2PT_TCP_USER != ntohl(snd->hdr.type)) {
+        return;
+    }
+    nbytes = ntohl(snd->hdr.nbytes);
+    if (nbytes <= (size_t)mca_pt2pt_tcp_component.frag_size) {
+        return;
+    }
+    snd->total = nbytes;
+    snd->offset = 0;
+    snd->hdr.type = htonl(SCON_PT2PT_TCP_FRAG);
+    snd->hdr.seq_num = htonl((uint32_t)nbytes);
+    snd->hdr.nbytes = htonl((uint32_t)mca_pt2pt_tcp_component.frag_size);
+}
+
+/*
+ * Move the next message into the "on-deck" position, taking the
+ * class queues highest priority first. A new message needs credit
+ * from the peer - the rest of a message already started does not.
+ * Without credit, return what we owe the peer instead so two peers
+ * waiting on each other cannot stall
+ */
+void scon_pt2pt_tcp_peer_next_send(scon_pt2pt_tcp_peer_t *peer)
+{
+    scon_pt2pt_tcp_send_t *snd;
+    bool queued = false;
+    int i;
+
+    if (NULL != peer->send_msg) {
+        return;
+    }
+    for (i=0; i < SCON_MSG_PRIORITY_CLASSES; i++) {
+        if (scon_list_is_empty(&peer->send_queues[i])) {
+            continue;
+        }
+        queued = true;
+        snd = (scon_pt2pt_tcp_send_t*)scon_list_get_first(&peer->send_queues[i]);
+        if (!snd->started && NULL == snd->stripe &&
+            0 < peer->send_window && 0 == peer->send_credits) {
+            continue;
+        }
+        scon_list_remove_item(&peer->send_queues[i], &snd->super);
+        SCON_PERF_DEC(SCON_PERF_CTR_TCP_SEND_QUEUE);
+        if (!snd->started) {
+            snd->started = true;
+            peer->queued_bytes -= ntohl(snd->hdr.nbytes);
+            if (0 < peer->send_window && NULL == snd->stripe) {
+                --peer->send_credits;
+            }
+            frag_setup(snd);
+        }
+        peer->send_msg = snd;
+        return;
+    }
+    if (0 < peer->credits_owed &&
+        (queued || CREDIT_THRESHOLD(peer) <= peer->credits_owed)) {
+        peer->send_msg = credit_msg(peer);
+    }
+}
+
+/* the peer returned credits - restart a send queue that
+ * was waiting for them */
+void scon_pt2pt_tcp_peer_add_credits(scon_pt2pt_tcp_peer_t *peer, uint32_t credits)
+{
+    if (0 == credits || 0 == peer->send_window) {
+        return;
+    }
+    peer->send_credits += credits;
+    scon_output_verbose(5, scon_pt2pt_base_framework.framework_output,
+                        "%s %u credits returned by %s, %u available",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), credits,
+                        SCON_PRINT_PROC(&peer->name), peer->send_credits);
+    if (SCON_PT2PT_TCP_CONNECTED == peer->state && NULL == peer->send_msg) {
+        scon_pt2pt_tcp_peer_next_send(peer);
+        if (NULL != peer->send_msg) {
+            SCON_PT2PT_TCP_SEND_EV_ADD(peer);
+        }
+    }
+}
+
+/* we are done with a message the peer sent us - the credit
+ * rides on our next message to it, or goes on its own once
+ * half the window is owed */
+void scon_pt2pt_tcp_peer_return_credit(scon_pt2pt_tcp_peer_t *peer)
+{
+    if (0 == peer->recv_window) {
+        return;
+    }
+    ++peer->credits_owed;
+    if (SCON_PT2PT_TCP_CONNECTED != peer->state || NULL != peer->send_msg ||
+        peer->credits_owed < CREDIT_THRESHOLD(peer)) {
+        return;
+    }
+    scon_pt2pt_tcp_peer_next_send(peer);
+    if (NULL != peer->send_msg) {
+        SCON_PT2PT_TCP_SEND_EV_ADD(peer);
+    }
+}
 
 static int send_bytes(scon_pt2pt_tcp_peer_t* peer)
 {
@@ -81,17 +639,26 @@ static int send_bytes(scon_pt2pt_tcp_peer_t* peer)
                        SCON_PRINT_PROC(&(peer->name)), msg->sdbytes));*/
 
     while (0 < msg->sdbytes) {
-        rc = write(peer->sd, msg->sdptr, msg->sdbytes);
+        if (peer->uring) {
+            rc = scon_pt2pt_tcp_uring_write(peer, msg->sdptr, msg->sdbytes);
+        } else if (peer->zerocopy && msg->hdr_sent &&
+                   mca_pt2pt_tcp_component.zerocopy_min_size <= msg->sdbytes) {
+            rc = zerocopy_write(peer, msg);
+        } else {
+            rc = write(peer->sd, msg->sdptr, msg->sdbytes);
+        }
         if (rc < 0) {
             if (scon_socket_errno == EINTR) {
                 continue;
             } else if (scon_socket_errno == EAGAIN) {
+                SCON_PERF_INC(SCON_PERF_CTR_TCP_EAGAIN);
                 /* tell the caller to keep this message on active,
                  * but let the event lib cycle so other messages
                  * can progress while this socket is busy
                  */
                 return SCON_ERR_RESOURCE_BUSY;
             } else if (scon_socket_errno == EWOULDBLOCK) {
+                SCON_PERF_INC(SCON_PERF_CTR_TCP_EAGAIN);
                 /* tell the caller to keep this message on active,
                  * but let the event lib cycle so other messages
                  * can progress while this socket is busy
@@ -130,6 +697,10 @@ void scon_pt2pt_tcp_send_handler(int sd, short flags, void *cbdata)
                         SCON_PRINT_PROC(SCON_PROC_MY_NAME),
                         SCON_PRINT_PROC(&peer->name));
 
+    if (!scon_list_is_empty(&peer->zc_pending)) {
+        scon_pt2pt_tcp_zerocopy_reap(peer, false);
+    }
+
     switch (peer->state) {
     case SCON_PT2PT_TCP_CONNECTING:
     case SCON_PT2PT_TCP_CLOSED:
@@ -154,6 +725,13 @@ void scon_pt2pt_tcp_send_handler(int sd, short flags, void *cbdata)
         if (NULL != msg) {
             /* if the header hasn't been completely sent, send it */
             if (!msg->hdr_sent) {
+                if (msg->sdptr == (char*)&msg->hdr && 0 < peer->credits_owed &&
+                    !peer->uring_tx_done) {
+                    /* return what we owe the peer with this message - unless
+                     * the io_uring backend has already sent the header */
+                    msg->hdr.credits = htonl(ntohl(msg->hdr.credits) + peer->credits_owed);
+                    peer->credits_owed = 0;
+                }
                 if (SCON_SUCCESS == (rc = send_bytes(peer))) {
                     /* header is completely sent */
                     msg->hdr_sent = true;
@@ -162,15 +740,20 @@ void scon_pt2pt_tcp_send_handler(int sd, short flags, void *cbdata)
                         /* relay msg - send that data */
                         msg->sdptr = msg->data;
                         msg->sdbytes = (int)ntohl(msg->hdr.nbytes);
+                    } else if (NULL != msg->stripe) {
+                        /* the next piece of a striped message */
+                        msg->sdptr = msg->stripe->msg->buf->base_ptr + msg->offset;
+                        msg->sdbytes = ntohl(msg->hdr.nbytes);
                     } else if (NULL == msg->msg) {
                         /* this was a zero-byte relay - nothing more to do */
                         SCON_RELEASE(msg);
                         peer->send_msg = NULL;
                         goto next;
                     } else if (NULL != msg->msg->buf) {
-                        /* send the buffer data as a single block */
-                        msg->sdptr = msg->msg->buf->base_ptr;
-                        msg->sdbytes = msg->msg->buf->bytes_used;
+                        /* send the buffer data as a single block, or
+                         * the next piece of it */
+                        msg->sdptr = msg->msg->buf->base_ptr + msg->offset;
+                        msg->sdbytes = ntohl(msg->hdr.nbytes);
                     }
                     /* fall thru and let the send progress */
                 } else if (SCON_ERR_RESOURCE_BUSY == rc ||
@@ -183,8 +766,7 @@ void scon_pt2pt_tcp_send_handler(int sd, short flags, void *cbdata)
                                 SCON_PRINT_PROC(SCON_PROC_MY_NAME),
                                 SCON_PRINT_PROC(&(peer->name)));
                     scon_event_del(&peer->send_event);
-                    msg->msg->status = rc;
-                    PT2PT_SEND_COMPLETE(msg->msg);
+                    send_complete(msg, rc);
                     SCON_RELEASE(msg);
                     peer->send_msg = NULL;
                     goto next;
@@ -194,38 +776,40 @@ void scon_pt2pt_tcp_send_handler(int sd, short flags, void *cbdata)
             if (msg->hdr_sent) {
                 if (SCON_SUCCESS == (rc = send_bytes(peer))) {
                     /* this block is complete */
-                    if (NULL != msg->data || NULL == msg->msg) {
-                        /* the relay is complete - release the data */
-                        scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
-                                            "%s MESSAGE RELAY COMPLETE TO %s OF %d BYTES ON SOCKET %d",
-                                            SCON_PRINT_PROC(SCON_PROC_MY_NAME),
-                                            SCON_PRINT_PROC(&(peer->name)),
-                                            (int)ntohl(msg->hdr.nbytes), peer->sd);
-                        SCON_RELEASE(msg);
+                    SCON_TRACE(SCON_TRACE_WIRE_WRITE, peer->name.rank, ntohl(msg->hdr.nbytes));
+                    if (msg->offset + ntohl(msg->hdr.nbytes) < msg->total) {
+                        /* a piece of a large message - put the rest back
+                         * at the head of its class so anything of a
+                         * higher class goes before the next piece */
+                        msg->offset += ntohl(msg->hdr.nbytes);
+                        if (0 < mca_pt2pt_tcp_component.frag_size &&
+                            (size_t)mca_pt2pt_tcp_component.frag_size < msg->total - msg->offset) {
+                            msg->hdr.nbytes = htonl((uint32_t)mca_pt2pt_tcp_component.frag_size);
+                        } else {
+                            if (NULL == msg->stripe) {
+                                msg->hdr.type = htonl(SCON_PT2PT_TCP_USER);
+                            }
+                            msg->hdr.nbytes = htonl((uint32_t)(msg->total - msg->offset));
+                        }
+                        msg->hdr.offset = htonl((uint32_t)msg->offset);
+                        msg->hdr.credits = 0;
+                        msg->hdr_sent = false;
+                        msg->sdptr = (char*)&msg->hdr;
+                        msg->sdbytes = sizeof(scon_pt2pt_tcp_hdr_t);
+                        scon_list_prepend(&peer->send_queues[msg->priority], &msg->super);
+                        SCON_PERF_INC(SCON_PERF_CTR_TCP_SEND_QUEUE);
                         peer->send_msg = NULL;
-                    } else if (NULL != msg->msg->buf) {
-                        /* we are done - notify the pt2pt */
-                        scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
-                                            "%s MESSAGE SEND COMPLETE TO %s OF %d BYTES ON SOCKET %d",
-                                            SCON_PRINT_PROC(SCON_PROC_MY_NAME),
-                                            SCON_PRINT_PROC(&(peer->name)),
-                                            (int)ntohl(msg->hdr.nbytes), peer->sd);
-                        msg->msg->status = SCON_SUCCESS;
-                        PT2PT_SEND_COMPLETE(msg->msg);
-                        SCON_RELEASE(msg);
+                    } else if (msg->zerocopy || !scon_list_is_empty(&peer->zc_pending)) {
+                        /* the kernel may still be sending from the data -
+                         * hold the message until it is done, and anything
+                         * sent after it so they complete in order */
+                        if (!msg->zerocopy) {
+                            msg->zc_last = peer->zc_sent - 1;
+                        }
+                        scon_list_append(&peer->zc_pending, &msg->super);
                         peer->send_msg = NULL;
-                    } else if (NULL != msg->data) {
-                        /* this was a relay we have now completed - no need to
-                         * notify the upper framework as the local proc didn't initiate
-                         * the send
-                         */
-                        scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
-                                            "%s MESSAGE RELAY COMPLETE TO %s OF %d BYTES ON SOCKET %d",
-                                            SCON_PRINT_PROC(SCON_PROC_MY_NAME),
-                                            SCON_PRINT_PROC(&(peer->name)),
-                                            (int)ntohl(msg->hdr.nbytes), peer->sd);
-                        msg->msg->status = SCON_SUCCESS;
-                        SCON_RELEASE(msg);
+                    } else {
+                        msg_sent(peer, msg);
                         peer->send_msg = NULL;
                     }
                 } else if (SCON_ERR_RESOURCE_BUSY == rc ||
@@ -238,8 +822,7 @@ void scon_pt2pt_tcp_send_handler(int sd, short flags, void *cbdata)
                                 SCON_PRINT_PROC(SCON_PROC_MY_NAME),
                                 SCON_PRINT_PROC(&(peer->name)), peer->sd);
                     scon_event_del(&peer->send_event);
-                    msg->msg->status = rc;
-                    PT2PT_SEND_COMPLETE(msg->msg);
+                    send_complete(msg, rc);
                     SCON_RELEASE(msg);
                     peer->send_msg = NULL;
                     return;
@@ -253,14 +836,17 @@ void scon_pt2pt_tcp_send_handler(int sd, short flags, void *cbdata)
              * wait for another send_event to fire before doing so. This gives
              * us a chance to service any pending recvs.
              */
-            peer->send_msg = (scon_pt2pt_tcp_send_t*)
-                scon_list_remove_first(&peer->send_queue);
+            scon_pt2pt_tcp_peer_next_send(peer);
         }
 
         /* if nothing else to do unregister for send event notifications */
         if (NULL == peer->send_msg && peer->send_ev_active) {
             scon_event_del(&peer->send_event);
             peer->send_ev_active = false;
+        } else if (peer->uring && NULL != peer->send_msg) {
+            /* nothing will poll the socket for us - come back for
+             * the message on deck */
+            scon_event_active(&peer->uring_event, SCON_EV_WRITE, 1);
         }
         break;
     default:
@@ -276,6 +862,200 @@ void scon_pt2pt_tcp_send_handler(int sd, short flags, void *cbdata)
     }
 }
 
+/* a message we relayed has left, or failed to - release its
+ * buffer and the credit of the peer it came from */
+static void relay_complete(scon_status_t status, scon_handle_t scon_handle,
+                           scon_proc_t *peer, scon_buffer_t *buf,
+                           scon_msg_tag_t tag, void *cbdata)
+{
+    scon_pt2pt_tcp_credit_t *credit = (scon_pt2pt_tcp_credit_t*)cbdata;
+
+    if (NULL != buf) {
+        scon_buffer_destruct(buf);
+        free(buf);
+    }
+    if (NULL != credit) {
+        SCON_RELEASE(credit);
+    }
+}
+
+/*
+ * Hand a completely received message to the pt2pt base - either
+ * post it for local delivery or promote it for relay. The data
+ * belongs to the base once this returns. A relay keeps a reference
+ * to the credit until it has been passed on, so a stalled next hop
+ * stops the peer feeding us rather than growing our queue
+ */
+static void deliver_msg(scon_pt2pt_tcp_credit_t *credit,
+                        scon_pt2pt_tcp_hdr_t *hdr, char *data)
+{
+    scon_send_t *snd;
+
+    /* am I the intended recipient (header was already converted back to host order)? */
+    if (SCON_EQUAL == scon_util_compare_name_fields(SCON_NS_CMP_ALL, &hdr->dst,
+                                                    SCON_PROC_MY_NAME)) {
+        /* yes - post it to the base for delivery */
+        scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
+                            "%s DELIVERING msg tag = %d scon_handle = %d",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                            hdr->tag, hdr->scon_handle);
+        PT2PT_POST_MESSAGE(&hdr->origin, hdr->tag, hdr->scon_handle,
+                           data, hdr->nbytes);
+    } else {
+        /* promote this to the PT2PT as some other transport might
+         * be the next best hop */
+        scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
+                            "%s TCP PROMOTING ROUTED MESSAGE FOR %s TO PT2PT",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                            SCON_PRINT_PROC(&hdr->dst));
+        snd = SCON_NEW(scon_send_t);
+        snd->buf = malloc(sizeof(scon_buffer_t));
+        scon_buffer_construct(snd->buf);
+        scon_buffer_load(snd->buf, (void*) data, hdr->nbytes);
+        snd->dst.rank = hdr->dst.rank;
+        strncpy(snd->dst.job_name, hdr->dst.job_name,
+                SCON_MAX_JOBLEN);
+        snd->origin.rank = hdr->origin.rank;
+        strncpy(snd->origin.job_name, hdr->origin.job_name,
+                SCON_MAX_JOBLEN);
+        snd->tag = hdr->tag;
+        snd->scon_handle = hdr->scon_handle;
+        snd->priority = hdr->priority;
+        snd->cbfunc = relay_complete;
+        snd->cbdata = credit;
+        if (NULL != credit) {
+            SCON_RETAIN(credit);
+        }
+        /* activate the PT2PT send state */
+        PT2PT_SEND_MESSAGE(snd);
+        SCON_RELEASE(snd);
+    }
+}
+
+/*
+ * Split a batch of coalesced messages back into the
+ * individual messages it carries
+ */
+static void deliver_batch(scon_pt2pt_tcp_peer_t *peer, scon_pt2pt_tcp_credit_t *credit,
+                          char *data, size_t nbytes)
+{
+    scon_pt2pt_tcp_hdr_t hdr;
+    size_t offset = 0;
+    char *payload;
+    int nmsgs = 0;
+
+    while (offset + sizeof(hdr) <= nbytes) {
+        memcpy(&hdr, data + offset, sizeof(hdr));
+        SCON_PT2PT_TCP_HDR_NTOH(&hdr);
+        offset += sizeof(hdr);
+        if (nbytes - offset < hdr.nbytes) {
+            break;
+        }
+        payload = NULL;
+        if (0 < hdr.nbytes) {
+            if (NULL == (payload = (char*)malloc(hdr.nbytes))) {
+                SCON_ERROR_LOG(SCON_ERR_OUT_OF_RESOURCE);
+                return;
+            }
+            memcpy(payload, data + offset, hdr.nbytes);
+            offset += hdr.nbytes;
+        }
+        deliver_msg(credit, &hdr, payload);
+        ++nmsgs;
+    }
+    if (offset != nbytes) {
+        scon_output(0, "%s-%s scon_pt2pt_tcp_peer_recv_handler: malformed batch - %lu of %lu bytes consumed",
+                    SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                    SCON_PRINT_PROC(&(peer->name)),
+                    (unsigned long)offset, (unsigned long)nbytes);
+    }
+    scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
+                        "%s RECVD BATCH OF %d MESSAGES FROM %s",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), nmsgs,
+                        SCON_PRINT_PROC(&peer->name));
+}
+
+/* deliver a message received from the peer - it holds one
+ * credit of the peer's window, a batch included */
+static void deliver_recv(scon_pt2pt_tcp_peer_t *peer, scon_pt2pt_tcp_recv_t *rcv)
+{
+    scon_pt2pt_tcp_credit_t *credit = NULL;
+
+    if (0 < peer->recv_window) {
+        credit = SCON_NEW(scon_pt2pt_tcp_credit_t);
+        SCON_RETAIN(peer);
+        credit->peer = peer;
+    }
+    if (SCON_PT2PT_TCP_BATCH == rcv->hdr.type) {
+        /* split the batch into its messages */
+        deliver_batch(peer, credit, rcv->data, rcv->hdr.nbytes);
+        free(rcv->data);
+    } else {
+        deliver_msg(credit, &rcv->hdr, rcv->data);
+    }
+    if (NULL != credit) {
+        SCON_RELEASE(credit);
+    }
+    /* protect the data */
+    rcv->data = NULL;
+    SCON_RELEASE(rcv);
+}
+
+/* the striped message being reassembled under this id, started
+ * if this is the first we have heard of it */
+static scon_pt2pt_tcp_stripe_recv_t* stripe_lookup(scon_pt2pt_tcp_peer_t *peer,
+                                                   uint32_t id, size_t size)
+{
+    scon_pt2pt_tcp_stripe_recv_t *stripe;
+
+    SCON_LIST_FOREACH(stripe, &peer->stripes, scon_pt2pt_tcp_stripe_recv_t) {
+        if (stripe->id == id) {
+            return (stripe->size == size) ? stripe : NULL;
+        }
+    }
+    if (0 == size) {
+        return NULL;
+    }
+    stripe = SCON_NEW(scon_pt2pt_tcp_stripe_recv_t);
+    if (NULL == (stripe->data = (char*)malloc(size))) {
+        SCON_ERROR_LOG(SCON_ERR_OUT_OF_RESOURCE);
+        SCON_RELEASE(stripe);
+        return NULL;
+    }
+    stripe->id = id;
+    stripe->size = size;
+    scon_list_append(&peer->stripes, &stripe->super);
+    return stripe;
+}
+
+/* deliver what was held behind striped messages, in the order
+ * it arrived, up to the first striped message still missing
+ * pieces */
+static void deliver_held(scon_pt2pt_tcp_peer_t *peer)
+{
+    scon_pt2pt_tcp_recv_t *rcv;
+    scon_pt2pt_tcp_stripe_recv_t *stripe;
+
+    while (!scon_list_is_empty(&peer->held)) {
+        rcv = (scon_pt2pt_tcp_recv_t*)scon_list_get_first(&peer->held);
+        if (SCON_PT2PT_TCP_STRIPE == rcv->hdr.type) {
+            stripe = stripe_lookup(peer, rcv->hdr.stripe, rcv->hdr.seq_num);
+            if (NULL == stripe || stripe->received < stripe->size) {
+                return;
+            }
+            /* it is all in - deliver it in place of the STRIPE */
+            scon_list_remove_item(&peer->stripes, &stripe->super);
+            rcv->data = stripe->data;
+            rcv->hdr.nbytes = stripe->size;
+            rcv->hdr.type = SCON_PT2PT_TCP_USER;
+            stripe->data = NULL;
+            SCON_RELEASE(stripe);
+        }
+        scon_list_remove_item(&peer->held, &rcv->super);
+        deliver_recv(peer, rcv);
+    }
+}
+
 static int read_bytes(scon_pt2pt_tcp_peer_t* peer)
 {
     int rc;
@@ -285,7 +1065,11 @@ static int read_bytes(scon_pt2pt_tcp_peer_t* peer)
 
     /* read until all bytes recvd or error */
     while (0 < peer->recv_msg->rdbytes) {
-        rc = read(peer->sd, peer->recv_msg->rdptr, peer->recv_msg->rdbytes);
+        if (peer->uring) {
+            rc = scon_pt2pt_tcp_uring_read(peer, peer->recv_msg->rdptr, peer->recv_msg->rdbytes);
+        } else {
+            rc = read(peer->sd, peer->recv_msg->rdptr, peer->recv_msg->rdbytes);
+        }
         if (rc < 0) {
             if(scon_socket_errno == EINTR) {
                 continue;
@@ -364,13 +1148,20 @@ static int read_bytes(scon_pt2pt_tcp_peer_t* peer)
 void scon_pt2pt_tcp_recv_handler(int sd, short flags, void *cbdata)
 {
     scon_pt2pt_tcp_peer_t* peer = (scon_pt2pt_tcp_peer_t*)cbdata;
+    scon_pt2pt_tcp_stripe_recv_t *stripe;
+    uint32_t prio;
     int rc;
-    scon_send_t *snd;
     scon_output_verbose(PT2PT_TCP_DEBUG_CONNECT, scon_pt2pt_base_framework.framework_output,
                         "%s:tcp:recv:handler called for peer %s",
                         SCON_PRINT_PROC(SCON_PROC_MY_NAME),
                         SCON_PRINT_PROC(&peer->name));
 
+    /* the kernel posts the zero-copy sends it is done with
+     * to the socket's error queue, which polls as readable */
+    if (!scon_list_is_empty(&peer->zc_pending)) {
+        scon_pt2pt_tcp_zerocopy_reap(peer, false);
+    }
+
     switch (peer->state) {
     case SCON_PT2PT_TCP_CONNECT_ACK:
         if (SCON_SUCCESS == (rc = scon_pt2pt_tcp_peer_recv_connect_ack(peer, peer->sd, NULL))) {
@@ -378,21 +1169,15 @@ void scon_pt2pt_tcp_recv_handler(int sd, short flags, void *cbdata)
                                 "%s:tcp:recv:handler starting send/recv events",
                                 SCON_PRINT_PROC(SCON_PROC_MY_NAME));
             /* we connected! Start the send/recv events */
-            if (!peer->recv_ev_active) {
-                scon_event_add(&peer->recv_event, 0);
-                peer->recv_ev_active = true;
-            }
+            SCON_PT2PT_TCP_RECV_EV_ADD(peer);
             if (peer->timer_ev_active) {
                 scon_event_del(&peer->timer_event);
                 peer->timer_ev_active = false;
             }
             /* if there is a message waiting to be sent, queue it */
-            if (NULL == peer->send_msg) {
-                peer->send_msg = (scon_pt2pt_tcp_send_t*)scon_list_remove_first(&peer->send_queue);
-            }
-            if (NULL != peer->send_msg && !peer->send_ev_active) {
-                scon_event_add(&peer->send_event, 0);
-                peer->send_ev_active = true;
+            scon_pt2pt_tcp_peer_next_send(peer);
+            if (NULL != peer->send_msg) {
+                SCON_PT2PT_TCP_SEND_EV_ADD(peer);
             }
             /* update our state */
             peer->state = SCON_PT2PT_TCP_CONNECTED;
@@ -439,8 +1224,73 @@ void scon_pt2pt_tcp_recv_handler(int sd, short flags, void *cbdata)
                 peer->recv_msg->hdr_recvd = true;
                 /* convert the header */
                 SCON_PT2PT_TCP_HDR_NTOH(&peer->recv_msg->hdr);
-                /* if this is a zero-byte message, then we are done */
-                if (0 == peer->recv_msg->hdr.nbytes) {
+                /* take any credits the peer returned with it */
+                scon_pt2pt_tcp_peer_add_credits(peer, peer->recv_msg->hdr.credits);
+                if (SCON_PT2PT_TCP_CREDIT == peer->recv_msg->hdr.type) {
+                    /* that was all it carried */
+                    SCON_RELEASE(peer->recv_msg);
+                    peer->recv_msg = NULL;
+                    return;
+                }
+                if (SCON_MSG_PRIORITY_CLASSES <= peer->recv_msg->hdr.priority) {
+                    peer->recv_msg->hdr.priority = SCON_MSG_PRIORITY_NORMAL;
+                }
+                prio = peer->recv_msg->hdr.priority;
+                if (SCON_PT2PT_TCP_RAIL == peer->recv_msg->hdr.type) {
+                    /* a piece of a striped message - read it straight
+                     * into its place in the message */
+                    stripe = stripe_lookup(PRIMARY(peer), peer->recv_msg->hdr.stripe,
+                                           peer->recv_msg->hdr.seq_num);
+                    if (NULL == stripe || stripe->size < peer->recv_msg->hdr.offset ||
+                        stripe->size - peer->recv_msg->hdr.offset < peer->recv_msg->hdr.nbytes) {
+                        scon_output(0, "%s-%s scon_pt2pt_tcp_peer_recv_handler: bad piece of striped message - closing connection",
+                                    SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                                    SCON_PRINT_PROC(&(peer->name)));
+                        scon_pt2pt_tcp_peer_close(peer);
+                        return;
+                    }
+                    peer->recv_msg->data = NULL;
+                    peer->recv_msg->rdptr = stripe->data + peer->recv_msg->hdr.offset;
+                    peer->recv_msg->rdbytes = peer->recv_msg->hdr.nbytes;
+                } else if (SCON_PT2PT_TCP_STRIPE == peer->recv_msg->hdr.type) {
+                    /* make room for the message it announces */
+                    if (NULL == stripe_lookup(peer, peer->recv_msg->hdr.stripe,
+                                              peer->recv_msg->hdr.seq_num)) {
+                        scon_output(0, "%s-%s scon_pt2pt_tcp_peer_recv_handler: bad striped message - closing connection",
+                                    SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                                    SCON_PRINT_PROC(&(peer->name)));
+                        scon_pt2pt_tcp_peer_close(peer);
+                        return;
+                    }
+                    peer->recv_msg->data = NULL;
+                    peer->recv_msg->rdbytes = 0;
+                } else if (SCON_PT2PT_TCP_FRAG == peer->recv_msg->hdr.type ||
+                    (SCON_PT2PT_TCP_USER == peer->recv_msg->hdr.type &&
+                     NULL != peer->frag_data[prio])) {
+                    /* a piece of a large message - read it straight
+                     * into the message being reassembled */
+                    if (NULL == peer->frag_data[prio]) {
+                        if (0 == peer->recv_msg->hdr.seq_num ||
+                            NULL == (peer->frag_data[prio] = (char*)malloc(peer->recv_msg->hdr.seq_num))) {
+                            SCON_ERROR_LOG(SCON_ERR_OUT_OF_RESOURCE);
+                            scon_pt2pt_tcp_peer_close(peer);
+                            return;
+                        }
+                        peer->frag_size[prio] = peer->recv_msg->hdr.seq_num;
+                        peer->frag_bytes[prio] = 0;
+                    }
+                    if (peer->frag_size[prio] - peer->frag_bytes[prio] < peer->recv_msg->hdr.nbytes) {
+                        scon_output(0, "%s-%s scon_pt2pt_tcp_peer_recv_handler: message piece overruns its message - closing connection",
+                                    SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                                    SCON_PRINT_PROC(&(peer->name)));
+                        scon_pt2pt_tcp_peer_close(peer);
+                        return;
+                    }
+                    peer->recv_msg->data = NULL;
+                    peer->recv_msg->rdptr = peer->frag_data[prio] + peer->frag_bytes[prio];
+                    peer->recv_msg->rdbytes = peer->recv_msg->hdr.nbytes;
+                } else if (0 == peer->recv_msg->hdr.nbytes) {
+                    /* a zero-byte message, so we are done */
                     scon_output_verbose(PT2PT_TCP_DEBUG_CONNECT, scon_pt2pt_base_framework.framework_output,
                                         "%s RECVD ZERO-BYTE MESSAGE FROM %s for tag %d",
                                         SCON_PRINT_PROC(SCON_PROC_MY_NAME),
@@ -477,6 +1327,35 @@ void scon_pt2pt_tcp_recv_handler(int sd, short flags, void *cbdata)
              * beginning or somewhere in the message
              */
             if (SCON_SUCCESS == (rc = read_bytes(peer))) {
+                prio = peer->recv_msg->hdr.priority;
+                if (SCON_PT2PT_TCP_RAIL == peer->recv_msg->hdr.type) {
+                    /* the STRIPE holds the credit for the whole message */
+                    stripe = stripe_lookup(PRIMARY(peer), peer->recv_msg->hdr.stripe,
+                                           peer->recv_msg->hdr.seq_num);
+                    stripe->received += peer->recv_msg->hdr.nbytes;
+                    SCON_RELEASE(peer->recv_msg);
+                    peer->recv_msg = NULL;
+                    if (stripe->received == stripe->size) {
+                        deliver_held(PRIMARY(peer));
+                    }
+                    return;
+                }
+                if (SCON_PT2PT_TCP_FRAG == peer->recv_msg->hdr.type) {
+                    /* wait for the rest - the credit is taken by the
+                     * whole message */
+                    peer->frag_bytes[prio] += peer->recv_msg->hdr.nbytes;
+                    SCON_RELEASE(peer->recv_msg);
+                    peer->recv_msg = NULL;
+                    return;
+                }
+                if (NULL != peer->frag_data[prio]) {
+                    /* that was the last piece - deliver the whole */
+                    peer->recv_msg->data = peer->frag_data[prio];
+                    peer->recv_msg->hdr.nbytes = peer->frag_bytes[prio] + peer->recv_msg->hdr.nbytes;
+                    peer->frag_data[prio] = NULL;
+                    peer->frag_bytes[prio] = 0;
+                    peer->frag_size[prio] = 0;
+                }
                 /* we recvd all of the message */
                 scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
                                     "%s RECVD COMPLETE MESSAGE FROM %s (ORIGIN %s) OF %d BYTES FOR DEST %s TAG %d",
@@ -486,52 +1365,17 @@ void scon_pt2pt_tcp_recv_handler(int sd, short flags, void *cbdata)
                                     (int)peer->recv_msg->hdr.nbytes,
                                     SCON_PRINT_PROC(&peer->recv_msg->hdr.dst),
                                     peer->recv_msg->hdr.tag);
-
-                /* am I the intended recipient (header was already converted back to host order)? */
-                if (SCON_EQUAL == scon_util_compare_name_fields(SCON_NS_CMP_ALL, &peer->recv_msg->hdr.dst,
-                            SCON_PROC_MY_NAME)) {
-                    /* yes - post it to the base for delivery */
-                    scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
-                                        "%s DELIVERING msg tag = %d scon_handle = %d",
-                                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
-                                        peer->recv_msg->hdr.tag,
-                                        peer->recv_msg->hdr.scon_handle);
-                    PT2PT_POST_MESSAGE(&peer->recv_msg->hdr.origin,
-                                          peer->recv_msg->hdr.tag,
-                                          peer->recv_msg->hdr.scon_handle,
-                                          peer->recv_msg->data,
-                                          peer->recv_msg->hdr.nbytes);
-                    SCON_RELEASE(peer->recv_msg);
-                } else {
-                    /* promote this to the PT2PT as some other transport might
-                     * be the next best hop */
-                    scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
-                                        "%s TCP PROMOTING ROUTED MESSAGE FOR %s TO PT2PT",
-                                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
-                                        SCON_PRINT_PROC(&peer->recv_msg->hdr.dst));
-                    snd = SCON_NEW(scon_send_t);
-                    snd->buf = malloc(sizeof(scon_buffer_t));
-                    scon_buffer_construct(snd->buf);
-                    scon_buffer_load(snd->buf, (void*) peer->recv_msg->data, peer->recv_msg->hdr.nbytes);
-                    snd->dst.rank = peer->recv_msg->hdr.dst.rank;
-                    strncpy(snd->dst.job_name, peer->recv_msg->hdr.dst.job_name,
-                            SCON_MAX_JOBLEN);
-
-                    snd->origin.rank = peer->recv_msg->hdr.origin.rank;
-                    strncpy(snd->origin.job_name, peer->recv_msg->hdr.origin.job_name,
-                            SCON_MAX_JOBLEN);
-                    snd->tag = peer->recv_msg->hdr.tag;
-                    snd->scon_handle = peer->recv_msg->hdr.scon_handle;
-                   // snd->data = peer->recv_msg->data;
-                    snd->cbfunc = NULL;
-                    snd->cbdata = NULL;
-                    /* activate the PT2PT send state */
-                    PT2PT_SEND_MESSAGE(snd);
-                    /* protect the data */
-                    peer->recv_msg->data = NULL;
-                    /* cleanup */
-                    SCON_RELEASE(peer->recv_msg);
+                scon_pt2pt_tcp_peer_observe(peer, (SCON_PT2PT_TCP_STRIPE == peer->recv_msg->hdr.type) ?
+                                            peer->recv_msg->hdr.seq_num : peer->recv_msg->hdr.nbytes, true);
+                if (SCON_PT2PT_TCP_STRIPE == peer->recv_msg->hdr.type ||
+                    !scon_list_is_empty(&peer->held)) {
+                    /* stay in order behind the striped message */
+                    scon_list_append(&peer->held, &peer->recv_msg->super);
+                    peer->recv_msg = NULL;
+                    deliver_held(peer);
+                    return;
                 }
+                deliver_recv(peer, peer->recv_msg);
                 peer->recv_msg = NULL;
                 return;
             } else if (SCON_ERR_RESOURCE_BUSY == rc ||
@@ -561,12 +1405,22 @@ void scon_pt2pt_tcp_recv_handler(int sd, short flags, void *cbdata)
 
 static void snd_cons(scon_pt2pt_tcp_send_t *ptr)
 {
+    ptr->hdr.credits = 0;
     ptr->msg = NULL;
     ptr->data = NULL;
     ptr->hdr_sent = false;
     ptr->iovnum = 0;
     ptr->sdptr = NULL;
     ptr->sdbytes = 0;
+    ptr->batched = NULL;
+    ptr->nbatched = 0;
+    ptr->priority = SCON_MSG_PRIORITY_NORMAL;
+    ptr->started = false;
+    ptr->total = 0;
+    ptr->offset = 0;
+    ptr->stripe = NULL;
+    ptr->zerocopy = false;
+    ptr->zc_last = 0;
 }
 /* we don't destruct any RML msg that is
  * attached to our send as the RML owns
@@ -579,6 +1433,12 @@ static void snd_des(scon_pt2pt_tcp_send_t *ptr)
     if (NULL != ptr->data) {
         free(ptr->data);
     }
+    if (NULL != ptr->batched) {
+        free(ptr->batched);
+    }
+    if (NULL != ptr->stripe) {
+        SCON_RELEASE(ptr->stripe);
+    }
 }
 SCON_CLASS_INSTANCE(scon_pt2pt_tcp_send_t,
                    scon_list_item_t,
@@ -594,6 +1454,48 @@ SCON_CLASS_INSTANCE(scon_pt2pt_tcp_recv_t,
                    scon_list_item_t,
                    rcv_cons, NULL);
 
+static void stripe_send_cons(scon_pt2pt_tcp_stripe_send_t *ptr)
+{
+    ptr->msg = NULL;
+    ptr->pending = 0;
+    ptr->status = SCON_SUCCESS;
+}
+SCON_CLASS_INSTANCE(scon_pt2pt_tcp_stripe_send_t,
+                   scon_object_t,
+                   stripe_send_cons, NULL);
+
+static void stripe_recv_cons(scon_pt2pt_tcp_stripe_recv_t *ptr)
+{
+    ptr->id = 0;
+    ptr->data = NULL;
+    ptr->size = 0;
+    ptr->received = 0;
+}
+static void stripe_recv_des(scon_pt2pt_tcp_stripe_recv_t *ptr)
+{
+    if (NULL != ptr->data) {
+        free(ptr->data);
+    }
+}
+SCON_CLASS_INSTANCE(scon_pt2pt_tcp_stripe_recv_t,
+                   scon_list_item_t,
+                   stripe_recv_cons, stripe_recv_des);
+
+static void credit_cons(scon_pt2pt_tcp_credit_t *ptr)
+{
+    ptr->peer = NULL;
+}
+static void credit_des(scon_pt2pt_tcp_credit_t *ptr)
+{
+    if (NULL != ptr->peer) {
+        scon_pt2pt_tcp_peer_return_credit(ptr->peer);
+        SCON_RELEASE(ptr->peer);
+    }
+}
+SCON_CLASS_INSTANCE(scon_pt2pt_tcp_credit_t,
+                   scon_object_t,
+                   credit_cons, credit_des);
+
 static void err_cons(scon_pt2pt_tcp_msg_error_t *ptr)
 {
     ptr->rmsg = NULL;
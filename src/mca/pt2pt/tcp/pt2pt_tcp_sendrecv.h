@@ -31,6 +31,16 @@
 #include "pt2pt_tcp.h"
 #include "pt2pt_tcp_hdr.h"
 
+/* a message we striped across the rails - complete once
+ * every piece has gone */
+typedef struct {
+    scon_object_t super;
+    scon_send_t *msg;
+    int pending;
+    int status;
+} scon_pt2pt_tcp_stripe_send_t;
+SCON_CLASS_DECLARATION(scon_pt2pt_tcp_stripe_send_t);
+
 /* tcp structure for sending a message */
 typedef struct {
     scon_list_item_t super;
@@ -41,6 +51,26 @@ typedef struct {
     int iovnum;
     char *sdptr;
     size_t sdbytes;
+    /* coalesced messages carried by a batch send */
+    scon_send_t **batched;
+    int nbatched;
+    /* class queue the message waits in */
+    uint8_t priority;
+    /* true once the message has been taken off its queue - a
+     * message sent in pieces goes back between them */
+    bool started;
+    /* for a message sent in pieces, the size of the whole buffer
+     * and how much of it has gone */
+    size_t total;
+    size_t offset;
+    /* for a RAIL piece, the striped message it is from - total
+     * and offset then bound this rail's share of it */
+    scon_pt2pt_tcp_stripe_send_t *stripe;
+    /* some of the data went with MSG_ZEROCOPY - the message is
+     * only complete once the kernel is done with the send
+     * numbered zc_last */
+    bool zerocopy;
+    uint32_t zc_last;
 } scon_pt2pt_tcp_send_t;
 SCON_CLASS_DECLARATION(scon_pt2pt_tcp_send_t);
 
@@ -55,11 +85,21 @@ typedef struct {
 } scon_pt2pt_tcp_recv_t;
 SCON_CLASS_DECLARATION(scon_pt2pt_tcp_recv_t);
 
-/* Queue a message to be sent to a specified peer. The macro
- * checks to see if a message is already in position to be
- * sent - if it is, then the message provided is simply added
- * to the peer's message queue. If not, then the provided message
- * is placed in the "ready" position
+/* a striped message being put back together - the pieces
+ * and the STRIPE announcing it may arrive in any order */
+typedef struct {
+    scon_list_item_t super;
+    uint32_t id;
+    char *data;
+    size_t size;
+    size_t received;
+} scon_pt2pt_tcp_stripe_recv_t;
+SCON_CLASS_DECLARATION(scon_pt2pt_tcp_stripe_recv_t);
+
+/* Queue a message to be sent to a specified peer. The message
+ * is added to the peer's queue for its priority class, and moves
+ * into the "ready" position once no higher class has anything
+ * waiting and the peer has given us credit for another message
  *
  * If the provided boolean is true, then the send event for the
  * peer is checked and activated if not already active. This allows
@@ -68,28 +108,31 @@ SCON_CLASS_DECLARATION(scon_pt2pt_tcp_recv_t);
  * connection procedure is completed
  *
  * p => pointer to scon_pt2pt_tcp_peer_t
- * s => pointer to scon_pt2pt_tcp_send_t
+ * s => pointer to scon_pt2pt_tcp_send_t (header in network order)
  * f => true if send event is to be activated
  */
 #define SCON_PT2PT_TCP_QUEUE_MSG(p, s, f)                                  \
     do {                                                                \
-        /* if there is no message on-deck, put this one there */        \
-        if (NULL == (p)->send_msg) {                                    \
-            (p)->send_msg = (s);                                        \
-        } else {                                                        \
-            /* add it to the queue */                                   \
-            scon_list_append(&(p)->send_queue, &(s)->super);            \
+        /* add it to the queue */                                       \
+        if (SCON_MSG_PRIORITY_CLASSES <= (s)->priority) {               \
+            (s)->priority = SCON_MSG_PRIORITY_NORMAL;                   \
         }                                                               \
+        scon_list_append(&(p)->send_queues[(s)->priority], &(s)->super); \
+        (p)->queued_bytes += ntohl((s)->hdr.nbytes);                    \
+        SCON_PERF_INC(SCON_PERF_CTR_TCP_SEND_QUEUE);                    \
+        SCON_PERF_HIST(SCON_PERF_HIST_TCP_SEND_QUEUE,                   \
+                       scon_list_get_size(&(p)->send_queues[(s)->priority])); \
         if ((f)) {                                                      \
             /* if we aren't connected, then start connecting */         \
             if (SCON_PT2PT_TCP_CONNECTED != (p)->state) {                  \
                 (p)->state = SCON_PT2PT_TCP_CONNECTING;                    \
                 SCON_ACTIVATE_TCP_CONN_STATE((p), scon_pt2pt_tcp_peer_try_connect); \
             } else {                                                    \
-                /* ensure the send event is active */                   \
-                if (!(p)->send_ev_active) {                             \
-                   scon_event_add(&(p)->send_event, 0);                \
-                   (p)->send_ev_active = true;                         \
+                /* put it on deck if we can, and ensure the send       \
+                 * event is active */                                   \
+                scon_pt2pt_tcp_peer_next_send((p));                     \
+                if (NULL != (p)->send_msg) {                            \
+                    SCON_PT2PT_TCP_SEND_EV_ADD((p));                    \
                 }                                                       \
             }                                                           \
         }                                                               \
@@ -120,6 +163,8 @@ SCON_CLASS_DECLARATION(scon_pt2pt_tcp_recv_t);
         msg->hdr.type = SCON_PT2PT_TCP_USER;                            \
         msg->hdr.tag = (m)->tag;                                        \
         msg->hdr.scon_handle = (m)->scon_handle;                        \
+        msg->hdr.priority = (m)->priority;                              \
+        msg->priority = (m)->priority;                                  \
         /* point to the actual message */                               \
         msg->msg = (m);                                                 \
         msg->hdr.nbytes = (m)->buf->bytes_used;                         \
@@ -157,6 +202,8 @@ SCON_CLASS_DECLARATION(scon_pt2pt_tcp_recv_t);
         msg->hdr.type = SCON_PT2PT_TCP_USER;                            \
         msg->hdr.tag = (m)->tag;                                        \
         msg->hdr.scon_handle = (m)->scon_handle;                        \
+        msg->hdr.priority = (m)->priority;                              \
+        msg->priority = (m)->priority;                                  \
         /* point to the actual message */                               \
         msg->msg = (m);                                                 \
         /* set the total number of bytes to be sent */                  \
@@ -194,6 +241,8 @@ SCON_CLASS_DECLARATION(scon_pt2pt_tcp_recv_t);
         msg->hdr.dst.rank = (m)->hdr.dst.rank;                          \
         msg->hdr.type = SCON_PT2PT_TCP_USER;                            \
         msg->hdr.tag = (m)->hdr.tag;                                    \
+        msg->hdr.priority = (m)->hdr.priority;                          \
+        msg->priority = (m)->hdr.priority;                              \
         /* point to the actual message */                               \
         msg->data = (m)->data;                                          \
         /* set the total number of bytes to be sent */                  \
@@ -261,6 +310,8 @@ SCON_CLASS_DECLARATION(scon_pt2pt_tcp_msg_error_t);
             mop->snd = snd;                                             \
             /* transfer and prep the header */                          \
             snd->hdr = proxy->hdr;                                      \
+            snd->hdr.credits = 0;                                       \
+            snd->priority = proxy->hdr.priority;                        \
             SCON_PT2PT_TCP_HDR_HTON(&snd->hdr);                          \
             /* point to the data */                                     \
             snd->data = proxy->data;                                    \
@@ -0,0 +1,768 @@
+/*
+ * Copyright (c) 2017      Intel, Inc.  All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * io_uring backend for the connected sockets.
+ *
+ * With the event backend every socket is polled, and each wakeup
+ * costs a read(2) or write(2). Here the sockets are driven from a
+ * single ring on the module's event base instead:
+ *
+ *  - each socket has a multishot recv posted, which receives into
+ *    a pool of buffers provided to the kernel. The recv handler is
+ *    run on each buffer as it completes, and its reads are served
+ *    from the buffer
+ *  - a write by the send handler is submitted, and its result is
+ *    returned to the send handler when it completes
+ *  - everything queued during a pass of the event loop goes to the
+ *    kernel in one io_uring_enter(2), and the kernel signals
+ *    completions on an eventfd polled by the event base
+ *
+ * The connect handshake stays with the event backend - a socket
+ * is attached once it is connected. The ring is set up with raw
+ * system calls, so no library is needed, and the kernel has to
+ * support provided buffer rings and multishot recv (Linux 6.0). If
+ * it doesn't, the event backend is used.
+ */
+#include "scon_config.h"
+
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+
+#include "scon_types.h"
+#include "scon_common.h"
+#include "src/util/output.h"
+#include "src/util/error.h"
+#include "src/util/name_fns.h"
+#include "src/include/scon_globals.h"
+
+#include "pt2pt_tcp.h"
+#include "src/mca/pt2pt/tcp/pt2pt_tcp_component.h"
+#include "src/mca/pt2pt/tcp/pt2pt_tcp_peer.h"
+#include "src/mca/pt2pt/tcp/pt2pt_tcp_uring.h"
+
+#if defined(HAVE_LINUX_IO_URING_H) && defined(HAVE_SYS_EVENTFD_H)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <linux/io_uring.h>
+#if defined(__NR_io_uring_setup) && defined(IORING_RECV_MULTISHOT)
+#define URING_SUPPORTED 1
+#endif
+#endif
+
+#ifdef URING_SUPPORTED
+
+/* buffer group of the receive pool */
+#define URING_BGID      0
+/* most buffers a provided buffer ring takes */
+#define URING_MAX_BUFS  32768
+
+typedef enum {
+    URING_RECV,
+    URING_SEND
+} uring_op_type_t;
+
+/* a request in flight - it holds the peer until its last
+ * completion has been seen */
+typedef struct scon_pt2pt_tcp_uring_op_t {
+    scon_list_item_t super;
+    scon_pt2pt_tcp_peer_t *peer;
+    uring_op_type_t type;
+} scon_pt2pt_tcp_uring_op_t;
+static void op_cons(scon_pt2pt_tcp_uring_op_t *op)
+{
+    op->peer = NULL;
+}
+static void op_des(scon_pt2pt_tcp_uring_op_t *op)
+{
+    if (NULL != op->peer) {
+        SCON_RELEASE(op->peer);
+    }
+}
+static SCON_CLASS_INSTANCE(scon_pt2pt_tcp_uring_op_t,
+                           scon_list_item_t,
+                           op_cons, op_des);
+
+static struct {
+    bool active;
+    int fd;
+    int efd;                    /* eventfd the kernel signals completions on */
+    scon_event_t ev;            /* reaps the completions */
+    scon_event_t submit_ev;     /* submits what was queued in this pass of the event loop */
+    bool submit_pending;
+    unsigned to_submit;
+    /* submission queue */
+    void *sq_ring;
+    size_t sq_ring_size;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned sq_entries;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+    /* completion queue */
+    void *cq_ring;
+    size_t cq_ring_size;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+    /* the receive pool */
+    struct io_uring_buf_ring *br;
+    size_t br_size;
+    char *pool;
+    unsigned nbufs;
+    size_t bufsize;
+    uint16_t br_tail;
+    scon_list_t ops;            /* requests in flight */
+} ring = {
+    .active = false,
+    .fd = -1,
+    .efd = -1
+};
+
+static int sys_setup(unsigned entries, struct io_uring_params *p)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_enter(unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return (int)syscall(__NR_io_uring_enter, ring.fd, to_submit, min_complete,
+                        flags, NULL, 0);
+}
+
+static int sys_register(unsigned opcode, void *arg, unsigned nargs)
+{
+    return (int)syscall(__NR_io_uring_register, ring.fd, opcode, arg, nargs);
+}
+
+/* give a buffer of the pool back to the kernel */
+static void recycle(unsigned bid)
+{
+    struct io_uring_buf *buf;
+
+    buf = &ring.br->bufs[ring.br_tail & (ring.nbufs - 1)];
+    buf->addr = (uint64_t)(uintptr_t)(ring.pool + (size_t)bid * ring.bufsize);
+    buf->len = (uint32_t)ring.bufsize;
+    buf->bid = (uint16_t)bid;
+    ++ring.br_tail;
+    __atomic_store_n(&ring.br->tail, ring.br_tail, __ATOMIC_RELEASE);
+}
+
+static void submit(void)
+{
+    int rc;
+
+    while (0 < ring.to_submit) {
+        rc = sys_enter(ring.to_submit, 0, 0);
+        if (rc < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            if (EAGAIN == errno || EBUSY == errno) {
+                /* the kernel is short of resources or completions
+                 * have backed up - try again after the next reap */
+                return;
+            }
+            scon_output(0, "%s pt2pt:tcp:uring submit failed: %s (%d)",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), strerror(errno), errno);
+            return;
+        }
+        if (0 == rc) {
+            return;
+        }
+        ring.to_submit -= rc;
+    }
+}
+
+static void submit_cb(int fd, short flags, void *cbdata)
+{
+    ring.submit_pending = false;
+    submit();
+}
+
+/* the next free submission queue entry - the entry is queued by
+ * commit() once filled in */
+static struct io_uring_sqe* get_sqe(void)
+{
+    struct io_uring_sqe *sqe;
+    unsigned tail = *ring.sq_tail, idx;
+
+    if (ring.sq_entries <= tail - __atomic_load_n(ring.sq_head, __ATOMIC_ACQUIRE)) {
+        submit();
+        if (ring.sq_entries <= tail - __atomic_load_n(ring.sq_head, __ATOMIC_ACQUIRE)) {
+            return NULL;
+        }
+    }
+    idx = tail & *ring.sq_mask;
+    sqe = &ring.sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    ring.sq_array[idx] = idx;
+    return sqe;
+}
+
+static void commit(void)
+{
+    __atomic_store_n(ring.sq_tail, *ring.sq_tail + 1, __ATOMIC_RELEASE);
+    ++ring.to_submit;
+    if (!ring.submit_pending) {
+        ring.submit_pending = true;
+        scon_event_active(&ring.submit_ev, SCON_EV_WRITE, 1);
+    }
+}
+
+static scon_pt2pt_tcp_uring_op_t* new_op(scon_pt2pt_tcp_peer_t *peer, uring_op_type_t type)
+{
+    scon_pt2pt_tcp_uring_op_t *op;
+
+    op = SCON_NEW(scon_pt2pt_tcp_uring_op_t);
+    SCON_RETAIN(peer);
+    op->peer = peer;
+    op->type = type;
+    scon_list_append(&ring.ops, &op->super);
+    return op;
+}
+
+static void release_op(scon_pt2pt_tcp_uring_op_t *op)
+{
+    scon_list_remove_item(&ring.ops, &op->super);
+    SCON_RELEASE(op);
+}
+
+static int post_recv(scon_pt2pt_tcp_peer_t *peer)
+{
+    struct io_uring_sqe *sqe;
+
+    if (NULL == (sqe = get_sqe())) {
+        return SCON_ERR_OUT_OF_RESOURCE;
+    }
+    peer->uring_rx = new_op(peer, URING_RECV);
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = peer->sd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BGID;
+    sqe->user_data = (uint64_t)(uintptr_t)peer->uring_rx;
+    commit();
+    return SCON_SUCCESS;
+}
+
+static void recv_complete(scon_pt2pt_tcp_uring_op_t *op, int res, unsigned flags)
+{
+    scon_pt2pt_tcp_peer_t *peer = op->peer;
+    size_t left;
+
+    if (op == peer->uring_rx) {
+        if (0 < res) {
+            peer->uring_rx_ptr = ring.pool + (size_t)(flags >> IORING_CQE_BUFFER_SHIFT) * ring.bufsize;
+            peer->uring_rx_len = res;
+            /* the handler takes a message at a time */
+            while (0 < peer->uring_rx_len && op == peer->uring_rx && peer->recv_ev_active) {
+                left = peer->uring_rx_len;
+                scon_pt2pt_tcp_recv_handler(peer->sd, SCON_EV_READ, peer);
+                if (left == peer->uring_rx_len) {
+                    break;
+                }
+            }
+            peer->uring_rx_ptr = NULL;
+            peer->uring_rx_len = 0;
+        } else if (-ENOBUFS != res) {
+            /* end of file or an error - let the handler see it */
+            peer->uring_rx_status = (0 == res) ? -1 : -res;
+            if (peer->recv_ev_active) {
+                scon_pt2pt_tcp_recv_handler(peer->sd, SCON_EV_READ, peer);
+            }
+        }
+    }
+    if (flags & IORING_CQE_F_BUFFER) {
+        recycle(flags >> IORING_CQE_BUFFER_SHIFT);
+    }
+    if (!(flags & IORING_CQE_F_MORE)) {
+        if (op == peer->uring_rx) {
+            peer->uring_rx = NULL;
+            /* the kernel ended the recv, or ran out of buffers
+             * while we were busy - start another */
+            if (0 < res || -ENOBUFS == res) {
+                if (SCON_SUCCESS != post_recv(peer)) {
+                    SCON_ERROR_LOG(SCON_ERR_OUT_OF_RESOURCE);
+                }
+            }
+        }
+        release_op(op);
+    }
+}
+
+static void send_complete(scon_pt2pt_tcp_uring_op_t *op, int res)
+{
+    scon_pt2pt_tcp_peer_t *peer = op->peer;
+
+    if (op == peer->uring_tx) {
+        peer->uring_tx = NULL;
+        peer->uring_tx_done = true;
+        peer->uring_tx_res = res;
+        if (peer->send_ev_active) {
+            scon_pt2pt_tcp_send_handler(peer->sd, SCON_EV_WRITE, peer);
+        }
+    }
+    release_op(op);
+}
+
+static void reap(void)
+{
+    struct io_uring_cqe *cqe;
+    scon_pt2pt_tcp_uring_op_t *op;
+    unsigned head, flags;
+    int res;
+
+    head = *ring.cq_head;
+    while (head != __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE)) {
+        cqe = &ring.cqes[head & *ring.cq_mask];
+        op = (scon_pt2pt_tcp_uring_op_t*)(uintptr_t)cqe->user_data;
+        res = cqe->res;
+        flags = cqe->flags;
+        /* free the slot before the handlers queue more */
+        __atomic_store_n(ring.cq_head, ++head, __ATOMIC_RELEASE);
+        if (NULL == op) {
+            /* a cancel */
+            continue;
+        }
+        if (URING_RECV == op->type) {
+            recv_complete(op, res, flags);
+        } else {
+            send_complete(op, res);
+        }
+        head = *ring.cq_head;
+    }
+}
+
+static void completion_cb(int fd, short flags, void *cbdata)
+{
+    uint64_t count;
+
+    while (0 < read(ring.efd, &count, sizeof(count)));
+    reap();
+    submit();
+}
+
+static void uring_send_cb(int fd, short flags, void *cbdata)
+{
+    scon_pt2pt_tcp_peer_t *peer = (scon_pt2pt_tcp_peer_t*)cbdata;
+
+    if (peer->uring && peer->send_ev_active) {
+        scon_pt2pt_tcp_send_handler(peer->sd, flags, peer);
+    }
+}
+
+static void teardown(void)
+{
+    scon_list_item_t *item;
+
+    if (0 <= ring.fd) {
+        close(ring.fd);
+        ring.fd = -1;
+    }
+    if (0 <= ring.efd) {
+        close(ring.efd);
+        ring.efd = -1;
+    }
+    if (NULL != ring.sqes) {
+        munmap(ring.sqes, ring.sqes_size);
+        ring.sqes = NULL;
+    }
+    if (NULL != ring.cq_ring && ring.cq_ring != ring.sq_ring) {
+        munmap(ring.cq_ring, ring.cq_ring_size);
+    }
+    ring.cq_ring = NULL;
+    if (NULL != ring.sq_ring) {
+        munmap(ring.sq_ring, ring.sq_ring_size);
+        ring.sq_ring = NULL;
+    }
+    if (NULL != ring.br) {
+        munmap(ring.br, ring.br_size);
+        ring.br = NULL;
+    }
+    if (NULL != ring.pool) {
+        free(ring.pool);
+        ring.pool = NULL;
+    }
+    /* the ring is gone, and everything in flight with it */
+    while (NULL != (item = scon_list_remove_first(&ring.ops))) {
+        SCON_RELEASE(item);
+    }
+    SCON_DESTRUCT(&ring.ops);
+}
+
+static int map_rings(unsigned entries)
+{
+    struct io_uring_params p;
+    void *ptr;
+
+    memset(&p, 0, sizeof(p));
+    /* a socket can complete many receives per submission */
+    p.flags = IORING_SETUP_CQSIZE;
+    p.cq_entries = 4 * entries;
+    if (0 > (ring.fd = sys_setup(entries, &p))) {
+        return SCON_ERR_NOT_SUPPORTED;
+    }
+    if (!(p.features & IORING_FEAT_NODROP)) {
+        /* completions could be lost under load */
+        return SCON_ERR_NOT_SUPPORTED;
+    }
+    ring.sq_entries = p.sq_entries;
+    ring.sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    ring.cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring.sq_ring_size < ring.cq_ring_size) {
+            ring.sq_ring_size = ring.cq_ring_size;
+        }
+        ring.cq_ring_size = ring.sq_ring_size;
+    }
+    ptr = mmap(NULL, ring.sq_ring_size, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQ_RING);
+    if (MAP_FAILED == ptr) {
+        return SCON_ERR_OUT_OF_RESOURCE;
+    }
+    ring.sq_ring = ptr;
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        ring.cq_ring = ring.sq_ring;
+    } else {
+        ptr = mmap(NULL, ring.cq_ring_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_CQ_RING);
+        if (MAP_FAILED == ptr) {
+            return SCON_ERR_OUT_OF_RESOURCE;
+        }
+        ring.cq_ring = ptr;
+    }
+    ring.sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    ptr = mmap(NULL, ring.sqes_size, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQES);
+    if (MAP_FAILED == ptr) {
+        return SCON_ERR_OUT_OF_RESOURCE;
+    }
+    ring.sqes = (struct io_uring_sqe*)ptr;
+
+    ring.sq_head = (unsigned*)((char*)ring.sq_ring + p.sq_off.head);
+    ring.sq_tail = (unsigned*)((char*)ring.sq_ring + p.sq_off.tail);
+    ring.sq_mask = (unsigned*)((char*)ring.sq_ring + p.sq_off.ring_mask);
+    ring.sq_array = (unsigned*)((char*)ring.sq_ring + p.sq_off.array);
+    ring.cq_head = (unsigned*)((char*)ring.cq_ring + p.cq_off.head);
+    ring.cq_tail = (unsigned*)((char*)ring.cq_ring + p.cq_off.tail);
+    ring.cq_mask = (unsigned*)((char*)ring.cq_ring + p.cq_off.ring_mask);
+    ring.cqes = (struct io_uring_cqe*)((char*)ring.cq_ring + p.cq_off.cqes);
+    return SCON_SUCCESS;
+}
+
+static int setup_pool(void)
+{
+    struct io_uring_buf_reg reg;
+    unsigned n;
+    void *ptr;
+
+    ring.bufsize = (0 < mca_pt2pt_tcp_component.uring_recv_buffer_size) ?
+                   (size_t)mca_pt2pt_tcp_component.uring_recv_buffer_size : 65536;
+    for (ring.nbufs = 1; ring.nbufs < URING_MAX_BUFS &&
+         (int)ring.nbufs < mca_pt2pt_tcp_component.uring_recv_buffers; ring.nbufs <<= 1);
+    if (0 != posix_memalign(&ptr, sysconf(_SC_PAGESIZE), ring.nbufs * ring.bufsize)) {
+        return SCON_ERR_OUT_OF_RESOURCE;
+    }
+    ring.pool = (char*)ptr;
+    ring.br_size = ring.nbufs * sizeof(struct io_uring_buf);
+    ptr = mmap(NULL, ring.br_size, PROT_READ | PROT_WRITE,
+               MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (MAP_FAILED == ptr) {
+        return SCON_ERR_OUT_OF_RESOURCE;
+    }
+    ring.br = (struct io_uring_buf_ring*)ptr;
+    ring.br_tail = 0;
+
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)ring.br;
+    reg.ring_entries = ring.nbufs;
+    reg.bgid = URING_BGID;
+    if (0 > sys_register(IORING_REGISTER_PBUF_RING, &reg, 1)) {
+        /* older than 5.19 */
+        return SCON_ERR_NOT_SUPPORTED;
+    }
+    for (n=0; n < ring.nbufs; n++) {
+        recycle(n);
+    }
+    return SCON_SUCCESS;
+}
+
+/* multishot recv came after provided buffer rings, and an older
+ * kernel just fails it - so try one on a socket pair */
+static bool probe_multishot(void)
+{
+    struct io_uring_cqe *cqe;
+    struct io_uring_sqe *sqe;
+    unsigned head;
+    bool more = true, ok = false;
+    int sv[2];
+    char c = 0;
+
+    if (0 != socketpair(AF_UNIX, SOCK_STREAM, 0, sv)) {
+        return false;
+    }
+    sqe = get_sqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = sv[0];
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BGID;
+    __atomic_store_n(ring.sq_tail, *ring.sq_tail + 1, __ATOMIC_RELEASE);
+    if (1 != sys_enter(1, 0, 0) || 1 != write(sv[1], &c, 1)) {
+        close(sv[0]);
+        close(sv[1]);
+        return false;
+    }
+    /* the byte arrives with more to come if multishot works, and
+     * closing the other end finishes the recv */
+    while (more) {
+        if (0 > sys_enter(0, 1, IORING_ENTER_GETEVENTS) && EINTR != errno) {
+            break;
+        }
+        head = *ring.cq_head;
+        while (more && head != __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE)) {
+            cqe = &ring.cqes[head & *ring.cq_mask];
+            if (1 == cqe->res && (cqe->flags & IORING_CQE_F_MORE)) {
+                ok = true;
+                close(sv[1]);
+                sv[1] = -1;
+            }
+            if (cqe->flags & IORING_CQE_F_BUFFER) {
+                recycle(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+            }
+            more = (0 != (cqe->flags & IORING_CQE_F_MORE));
+            __atomic_store_n(ring.cq_head, ++head, __ATOMIC_RELEASE);
+        }
+    }
+    close(sv[0]);
+    if (0 <= sv[1]) {
+        close(sv[1]);
+    }
+    return ok;
+}
+
+int scon_pt2pt_tcp_uring_init(void)
+{
+    unsigned entries;
+    int rc;
+
+    SCON_CONSTRUCT(&ring.ops, scon_list_t);
+    entries = (0 < mca_pt2pt_tcp_component.uring_entries) ?
+              (unsigned)mca_pt2pt_tcp_component.uring_entries : 4096;
+    if (SCON_SUCCESS != (rc = map_rings(entries)) ||
+        SCON_SUCCESS != (rc = setup_pool())) {
+        scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
+                            "%s pt2pt:tcp:uring setup failed: %s",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME), strerror(errno));
+        teardown();
+        return rc;
+    }
+    if (!probe_multishot()) {
+        scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
+                            "%s pt2pt:tcp:uring kernel has no multishot recv",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME));
+        teardown();
+        return SCON_ERR_NOT_SUPPORTED;
+    }
+    if (0 > (ring.efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) ||
+        0 > sys_register(IORING_REGISTER_EVENTFD, &ring.efd, 1)) {
+        teardown();
+        return SCON_ERR_NOT_SUPPORTED;
+    }
+    scon_event_set(scon_pt2pt_tcp_module.ev_base, &ring.ev, ring.efd,
+                   SCON_EV_READ | SCON_EV_PERSIST, completion_cb, NULL);
+    scon_event_set_priority(&ring.ev, SCON_MSG_PRI);
+    scon_event_add(&ring.ev, 0);
+    scon_event_set(scon_pt2pt_tcp_module.ev_base, &ring.submit_ev, -1,
+                   SCON_EV_WRITE, submit_cb, NULL);
+    scon_event_set_priority(&ring.submit_ev, SCON_MSG_PRI);
+    ring.submit_pending = false;
+    ring.to_submit = 0;
+    ring.active = true;
+
+    scon_output_verbose(2, scon_pt2pt_base_framework.framework_output,
+                        "%s pt2pt:tcp:uring %u entries, %u receive buffers of %lu bytes",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), ring.sq_entries,
+                        ring.nbufs, (unsigned long)ring.bufsize);
+    return SCON_SUCCESS;
+}
+
+void scon_pt2pt_tcp_uring_finalize(void)
+{
+    if (!ring.active) {
+        return;
+    }
+    scon_event_del(&ring.ev);
+    scon_event_del(&ring.submit_ev);
+    ring.active = false;
+    teardown();
+}
+
+void scon_pt2pt_tcp_uring_attach(scon_pt2pt_tcp_peer_t *peer)
+{
+    if (!ring.active || peer->uring || 0 > peer->sd) {
+        return;
+    }
+    peer->uring_tx_done = false;
+    peer->uring_rx_ptr = NULL;
+    peer->uring_rx_len = 0;
+    peer->uring_rx_status = 0;
+    if (SCON_SUCCESS != post_recv(peer)) {
+        /* leave it with the event backend */
+        return;
+    }
+    peer->uring = true;
+    scon_event_set(scon_pt2pt_tcp_module.ev_base, &peer->uring_event, -1,
+                   SCON_EV_WRITE, uring_send_cb, peer);
+    scon_event_set_priority(&peer->uring_event, SCON_MSG_PRI);
+    /* the socket isn't polled from now on */
+    if (peer->recv_ev_active) {
+        scon_event_del(&peer->recv_event);
+    }
+    if (peer->send_ev_active) {
+        scon_event_del(&peer->send_event);
+        scon_event_active(&peer->uring_event, SCON_EV_WRITE, 1);
+    }
+    scon_output_verbose(PT2PT_TCP_DEBUG_CONNECT, scon_pt2pt_base_framework.framework_output,
+                        "%s pt2pt:tcp:uring attached socket %d to %s",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), peer->sd,
+                        SCON_PRINT_PROC(&peer->name));
+}
+
+void scon_pt2pt_tcp_uring_detach(scon_pt2pt_tcp_peer_t *peer)
+{
+    struct io_uring_sqe *sqe;
+    scon_pt2pt_tcp_uring_op_t *ops[2];
+    int i;
+
+    if (!peer->uring) {
+        return;
+    }
+    peer->uring = false;
+    scon_event_del(&peer->uring_event);
+    /* whatever is still in flight completes as stale */
+    ops[0] = peer->uring_rx;
+    ops[1] = peer->uring_tx;
+    peer->uring_rx = NULL;
+    peer->uring_tx = NULL;
+    for (i=0; i < 2; i++) {
+        if (NULL != ops[i] && NULL != (sqe = get_sqe())) {
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->addr = (uint64_t)(uintptr_t)ops[i];
+            commit();
+        }
+    }
+    /* the requests hold the socket open - make sure they end
+     * before it is closed */
+    shutdown(peer->sd, SHUT_RDWR);
+    submit();
+    peer->uring_tx_done = false;
+    peer->uring_rx_ptr = NULL;
+    peer->uring_rx_len = 0;
+}
+
+ssize_t scon_pt2pt_tcp_uring_read(scon_pt2pt_tcp_peer_t *peer, void *buf, size_t len)
+{
+    if (0 < peer->uring_rx_len) {
+        if (peer->uring_rx_len < len) {
+            len = peer->uring_rx_len;
+        }
+        memcpy(buf, peer->uring_rx_ptr, len);
+        peer->uring_rx_ptr += len;
+        peer->uring_rx_len -= len;
+        return len;
+    }
+    if (-1 == peer->uring_rx_status) {
+        return 0;
+    }
+    errno = (0 == peer->uring_rx_status) ? EAGAIN : peer->uring_rx_status;
+    return -1;
+}
+
+ssize_t scon_pt2pt_tcp_uring_write(scon_pt2pt_tcp_peer_t *peer, const void *buf, size_t len)
+{
+    struct io_uring_sqe *sqe;
+
+    if (NULL != peer->uring_tx) {
+        errno = EAGAIN;
+        return -1;
+    }
+    if (peer->uring_tx_done) {
+        /* the bytes we were called with last time */
+        peer->uring_tx_done = false;
+        if (0 <= peer->uring_tx_res) {
+            return peer->uring_tx_res;
+        }
+        if (-EAGAIN != peer->uring_tx_res && -EINTR != peer->uring_tx_res) {
+            errno = -peer->uring_tx_res;
+            return -1;
+        }
+    }
+    if (NULL == (sqe = get_sqe())) {
+        errno = ENOBUFS;
+        return -1;
+    }
+    peer->uring_tx = new_op(peer, URING_SEND);
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = peer->sd;
+    sqe->addr = (uint64_t)(uintptr_t)buf;
+    sqe->len = (uint32_t)len;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = (uint64_t)(uintptr_t)peer->uring_tx;
+    commit();
+    errno = EAGAIN;
+    return -1;
+}
+
+#else
+
+/* no io_uring in this build - everything stays with the event backend */
+int scon_pt2pt_tcp_uring_init(void)
+{
+    return SCON_ERR_NOT_SUPPORTED;
+}
+
+void scon_pt2pt_tcp_uring_finalize(void)
+{
+}
+
+void scon_pt2pt_tcp_uring_attach(scon_pt2pt_tcp_peer_t *peer)
+{
+}
+
+void scon_pt2pt_tcp_uring_detach(scon_pt2pt_tcp_peer_t *peer)
+{
+}
+
+ssize_t scon_pt2pt_tcp_uring_read(scon_pt2pt_tcp_peer_t *peer, void *buf, size_t len)
+{
+    errno = ENOSYS;
+    return -1;
+}
+
+ssize_t scon_pt2pt_tcp_uring_write(scon_pt2pt_tcp_peer_t *peer, const void *buf, size_t len)
+{
+    errno = ENOSYS;
+    return -1;
+}
+
+#endif
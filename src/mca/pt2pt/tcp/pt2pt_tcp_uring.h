@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2017      Intel, Inc.  All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#ifndef _SCON_PT2PT_TCP_URING_H_
+#define _SCON_PT2PT_TCP_URING_H_
+
+#include "scon_config.h"
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+
+#include "pt2pt_tcp_peer.h"
+
+/* setup the io_uring backend on the module's event base - returns
+ * SCON_ERR_NOT_SUPPORTED if the kernel can't support it, in which
+ * case the sockets stay with the event backend */
+int scon_pt2pt_tcp_uring_init(void);
+void scon_pt2pt_tcp_uring_finalize(void);
+
+/* hand a connected socket to the backend, and take it back before
+ * the socket is closed */
+void scon_pt2pt_tcp_uring_attach(scon_pt2pt_tcp_peer_t *peer);
+void scon_pt2pt_tcp_uring_detach(scon_pt2pt_tcp_peer_t *peer);
+
+/* read(2) and write(2) on a socket driven by the backend. Neither
+ * blocks - a write is submitted, and its result is returned by the
+ * next call for the same bytes once it has completed */
+ssize_t scon_pt2pt_tcp_uring_read(scon_pt2pt_tcp_peer_t *peer, void *buf, size_t len);
+ssize_t scon_pt2pt_tcp_uring_write(scon_pt2pt_tcp_peer_t *peer, const void *buf, size_t len);
+
+#endif /* _SCON_PT2PT_TCP_URING_H_ */
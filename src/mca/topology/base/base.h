@@ -32,11 +32,32 @@ int scon_topology_base_select(void);
 /* return module of the requested component */
 scon_topology_module_t * scon_topology_base_get_module(char *component_name);
 
-void scon_topology_base_convert_topoid_to_procid( scon_proc_t *route,
+/* lay the topology out over the given members instead of the
+ * ranks of the job. Must be called before the module's initialize */
+int scon_topology_base_set_members(scon_topology_t *topo,
+                                   const scon_proc_t *members,
+                                   size_t nmembers);
+void scon_topology_base_release_members(scon_topology_t *topo);
+
+/* a private instance of module laid out over the given members, for a
+ * scon that does not span its job. The module itself is shared by the
+ * scons of the job, so this is how a scon gets a tree of its own */
+scon_topology_module_t* scon_topology_base_clone_module(scon_topology_module_t *module,
+                                                        const scon_proc_t *members,
+                                                        size_t nmembers);
+void scon_topology_base_release_module(scon_topology_module_t *module);
+
+/* topology id of proc, SCON_RANK_UNDEF if it isn't a member */
+unsigned int scon_topology_base_get_topoid(scon_topology_t *topo,
+                                           const scon_proc_t *proc);
+
+void scon_topology_base_convert_topoid_to_procid(scon_topology_t *topo,
+        scon_proc_t *route,
         unsigned int route_rank,
         scon_proc_t *target);
 
-void scon_topology_base_xcast_routing(scon_list_t *routes,
+void scon_topology_base_xcast_routing(scon_topology_t *topo,
+                                      scon_list_t *routes,
                                       scon_list_t *children);
 
 #define SCON_TOPO_ID_INVALID INT_MAX;
@@ -37,17 +37,120 @@ int scon_topology_base_open(scon_mca_base_open_flag_t flags)
     return scon_mca_base_framework_components_open(&scon_topology_base_framework, flags);
 }
 
-SCON_EXPORT void scon_topology_base_convert_topoid_to_procid( scon_proc_t *route,
+static int by_rank_cmp(const void *a, const void *b)
+{
+    uint64_t ka = *(const uint64_t*)a, kb = *(const uint64_t*)b;
+
+    return (ka < kb) ? -1 : (ka > kb);
+}
+
+SCON_EXPORT int scon_topology_base_set_members(scon_topology_t *topo,
+                                               const scon_proc_t *members,
+                                               size_t nmembers)
+{
+    size_t i;
+
+    topo->members = (scon_proc_t*)malloc(nmembers * sizeof(scon_proc_t));
+    topo->by_rank = (uint64_t*)malloc(nmembers * sizeof(uint64_t));
+    if (NULL == topo->members || NULL == topo->by_rank) {
+        scon_topology_base_release_members(topo);
+        return SCON_ERR_OUT_OF_RESOURCE;
+    }
+    memcpy(topo->members, members, nmembers * sizeof(scon_proc_t));
+    topo->nmembers = nmembers;
+    for (i = 0; i < nmembers; i++) {
+        topo->by_rank[i] = ((uint64_t)members[i].rank << 32) | i;
+    }
+    qsort(topo->by_rank, nmembers, sizeof(uint64_t), by_rank_cmp);
+    return SCON_SUCCESS;
+}
+
+SCON_EXPORT void scon_topology_base_release_members(scon_topology_t *topo)
+{
+    free(topo->members);
+    free(topo->by_rank);
+    topo->members = NULL;
+    topo->by_rank = NULL;
+    topo->nmembers = 0;
+}
+
+SCON_EXPORT scon_topology_module_t* scon_topology_base_clone_module(scon_topology_module_t *module,
+                                                                    const scon_proc_t *members,
+                                                                    size_t nmembers)
+{
+    scon_topology_module_t *clone;
+
+    if (NULL == (clone = (scon_topology_module_t*)malloc(sizeof(scon_topology_module_t)))) {
+        return NULL;
+    }
+    clone->api = module->api;
+    SCON_CONSTRUCT(&clone->topology, scon_topology_t);
+    if (SCON_SUCCESS != scon_topology_base_set_members(&clone->topology, members, nmembers)) {
+        SCON_DESTRUCT(&clone->topology);
+        free(clone);
+        return NULL;
+    }
+    clone->api.initialize(&clone->topology);
+    clone->api.update_topology(&clone->topology, nmembers);
+    return clone;
+}
+
+SCON_EXPORT void scon_topology_base_release_module(scon_topology_module_t *module)
+{
+    if (NULL == module) {
+        return;
+    }
+    /* finalize releases the peers and destructs their list */
+    module->api.finalize(&module->topology);
+    SCON_DESTRUCT(&module->topology.my_topo);
+    scon_topology_base_release_members(&module->topology);
+    free(module);
+}
+
+SCON_EXPORT unsigned int scon_topology_base_get_topoid(scon_topology_t *topo,
+                                                       const scon_proc_t *proc)
+{
+    size_t lo = 0, hi, mid;
+    uint32_t idx;
+
+    if (NULL == topo->members) {
+        return proc->rank;
+    }
+    hi = topo->nmembers;
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if ((topo->by_rank[mid] >> 32) < proc->rank) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < topo->nmembers && (topo->by_rank[lo] >> 32) == proc->rank) {
+        idx = (uint32_t)topo->by_rank[lo];
+        /* a scon spans a single job for now, but check */
+        if (0 == strncmp(topo->members[idx].job_name, proc->job_name, SCON_MAX_JOBLEN)) {
+            return idx;
+        }
+    }
+    return SCON_RANK_UNDEF;
+}
+
+SCON_EXPORT void scon_topology_base_convert_topoid_to_procid(scon_topology_t *topo,
+                                                   scon_proc_t *route,
                                                    unsigned int route_rank,
                                                    scon_proc_t *target)
 {
-    /** TO DO : this translation will be different when the
-     SCON topology gets updated and for multi job scons */
+    if (NULL != topo->members && route_rank < topo->nmembers) {
+        *route = topo->members[route_rank];
+        return;
+    }
+    /** TO DO : this translation will be different for multi job scons */
     route->rank = route_rank;
     strncpy(route->job_name, target->job_name, SCON_MAX_JOBLEN);
 }
 
-SCON_EXPORT void scon_topology_base_xcast_routing(scon_list_t *peers,
+SCON_EXPORT void scon_topology_base_xcast_routing(scon_topology_t *topo,
+                                             scon_list_t *peers,
                                              scon_list_t *children)
 {
     scon_topo_t *child_topo;
@@ -59,7 +162,8 @@ SCON_EXPORT void scon_topology_base_xcast_routing(scon_list_t *peers,
          item = scon_list_get_next(item)) {
         child_topo = (scon_topo_t*) item;
         child_proc = SCON_NEW(scon_proc_list_t);
-        scon_topology_base_convert_topoid_to_procid(child_proc->name, child_topo->my_id, SCON_PROC_MY_NAME);
+        scon_topology_base_convert_topoid_to_procid(topo, child_proc->name, child_topo->my_id,
+                                                    SCON_PROC_MY_NAME);
         scon_list_append(children, &child_proc->super);
     }
 }
@@ -97,11 +201,15 @@ static void tply_cons(scon_topology_t *ptr)
 
     SCON_CONSTRUCT(&ptr->my_topo, scon_topo_t);
     SCON_CONSTRUCT(&ptr->my_peers, scon_list_t);
+    ptr->members = NULL;
+    ptr->nmembers = 0;
+    ptr->by_rank = NULL;
 }
 static void tply_des(scon_topology_t *ptr)
 {
     SCON_DESTRUCT(&ptr->my_topo);
     SCON_DESTRUCT(&ptr->my_peers);
+    scon_topology_base_release_members(ptr);
 }
 SCON_CLASS_INSTANCE(scon_topology_t,
                     scon_object_t,
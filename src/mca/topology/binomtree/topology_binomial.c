@@ -71,7 +71,7 @@ scon_topology_module_api_t binomtree_module_api = {
 
 static int binom_init(scon_topology_t *topo)
 {
-    topo->my_topo.my_id = SCON_PROC_MY_NAME->rank;
+    topo->my_topo.my_id = scon_topology_base_get_topoid(topo, SCON_PROC_MY_NAME);
     /* TO  DO remove hardcoding and set lifeline to scon master process's topo id */
     topo->my_topo.mylifeline_id = 0;
     /* setup the list of peers */
@@ -81,15 +81,7 @@ static int binom_init(scon_topology_t *topo)
 
 static int binom_finalize(scon_topology_t *topo)
 {
-    scon_topo_t *peer;
-    scon_list_item_t *item;
-    for (item = scon_list_get_first(&topo->my_peers);
-            item != scon_list_get_end(&topo->my_peers);
-            item = scon_list_get_next(item)) {
-        peer = (scon_topo_t*)item;
-        SCON_RELEASE(peer);
-    }
-    SCON_DESTRUCT(&topo->my_peers);
+    SCON_LIST_DESTRUCT(&topo->my_peers);
     return SCON_SUCCESS;
 }
 
@@ -117,22 +109,26 @@ static scon_proc_t binom_get_nexthop(scon_topology_t *topo,
     scon_proc_t *route;
     scon_list_item_t *item;
     scon_topo_t *child;
-    unsigned int route_rank = SCON_RANK_UNDEF;
+    unsigned int route_rank = SCON_RANK_UNDEF, target_id;
     /* sanity check */
     if ((SCON_RANK_WILDCARD == target->rank) ||
         (SCON_RANK_UNDEF == target->rank)) {
         route = NULL;
         goto found;
     }
+    if (SCON_RANK_UNDEF == (target_id = scon_topology_base_get_topoid(topo, target))) {
+        /* not a member of this topology */
+        goto found;
+    }
 
     /* if it is me, then the route is just direct */
     if (SCON_EQUAL == scon_util_compare_name_fields(SCON_NS_CMP_ALL, target, SCON_PROC_MY_NAME)) {
-        route_rank = target->rank;
+        route_rank = target_id;
         goto found;
     }
     /* if we are trying to reach the lifeline/master process, then route it thru
      the parent */
-    if(target->rank == topo->my_topo.mylifeline_id) {
+    if(target_id == topo->my_topo.mylifeline_id) {
         route_rank = topo->my_topo.myparent_id;
         goto found;
     }
@@ -141,13 +137,13 @@ static scon_proc_t binom_get_nexthop(scon_topology_t *topo,
             item != scon_list_get_end(&topo->my_peers);
             item = scon_list_get_next(item)) {
         child = (scon_topo_t*)item;
-        if (child->my_id == target->rank) {
+        if (child->my_id == target_id) {
             /* this is my direct downward link  */
             route_rank = child->my_id;
             goto found;
         }
         /* otherwise, see if the target is rechable through this child */
-        if (scon_bitmap_is_set_bit(&child->relatives, target->rank)) {
+        if (scon_bitmap_is_set_bit(&child->relatives, target_id)) {
             /* yep - we need to route through this child */
             route_rank = child->my_id;
             goto found;
@@ -161,7 +157,7 @@ static scon_proc_t binom_get_nexthop(scon_topology_t *topo,
 
  found:
     route = (scon_proc_t*) malloc(sizeof(scon_proc_t));
-    scon_topology_base_convert_topoid_to_procid( route, route_rank, target);
+    scon_topology_base_convert_topoid_to_procid(topo, route, route_rank, target);
     scon_output_verbose(2, scon_topology_base_framework.framework_output,
                         "binomial_topology:get route - route to %s from %s is %s",
                          SCON_PRINT_PROC(target),
@@ -185,7 +181,7 @@ static int binom_route_lost(scon_topology_t *topo,
          item != scon_list_get_end(&topo->my_peers);
          item = scon_list_get_next(item)) {
         child = (scon_topo_t*)item;
-        if (child->my_id == route->rank) {
+        if (child->my_id == scon_topology_base_get_topoid(topo, route)) {
                 scon_output_verbose(2, scon_topology_base_framework.framework_output,
                                      "%s topology_binomial: removing route to child  %s",
                                      SCON_PRINT_PROC(SCON_PROC_MY_NAME),
@@ -312,13 +308,13 @@ static void binom_update_topology(scon_topology_t *topo, int num_nodes)
     /* compute my direct children and the bitmap that shows which ranks
      * lie underneath their branch
      */
-    topo->my_topo.myparent_id = binomial_tree(0, 0, SCON_PROC_MY_NAME->rank,
+    topo->my_topo.myparent_id = binomial_tree(0, 0, topo->my_topo.my_id,
                                    num_nodes,
                                    &num_children, &topo->my_peers, NULL, true);
 
     if (0 < scon_output_get_verbosity(scon_topology_base_framework.framework_output)) {
         scon_output(0, "%s: parent %d num_children %d", SCON_PRINT_PROC(SCON_PROC_MY_NAME),
-                    SCON_PROC_MY_NAME->rank, num_children);
+                    topo->my_topo.my_id, num_children);
         for (item = scon_list_get_first(&topo->my_peers);
              item != scon_list_get_end(&topo->my_peers);
              item = scon_list_get_next(item)) {
@@ -336,7 +332,7 @@ static void binom_update_topology(scon_topology_t *topo, int num_nodes)
 static void binom_get_routing_list(scon_topology_t *topo,
                              scon_list_t *coll)
 {
-    scon_topology_base_xcast_routing(&topo->my_peers, coll);
+    scon_topology_base_xcast_routing(topo, &topo->my_peers, coll);
 }
 
 static size_t binom_num_routes(scon_topology_t *topo)
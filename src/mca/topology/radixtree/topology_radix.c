@@ -78,7 +78,7 @@ static int radix_init_routes (scon_topology_t *topo,
 
 static int radix_init(scon_topology_t *topo)
 {
-    topo->my_topo.my_id = SCON_PROC_MY_NAME->rank;
+    topo->my_topo.my_id = scon_topology_base_get_topoid(topo, SCON_PROC_MY_NAME);
     /** TO DO we need to set the scon master process here **/
     topo->my_topo.mylifeline_id = 0;
     /* setup the list of peers */
@@ -88,15 +88,7 @@ static int radix_init(scon_topology_t *topo)
 
 static int radix_finalize(scon_topology_t *topo)
 {
-    scon_topo_t *peer;
-    scon_list_item_t *item;
-    for (item = scon_list_get_first(&topo->my_peers);
-            item != scon_list_get_end(&topo->my_peers);
-            item = scon_list_get_next(item)) {
-        peer = (scon_topo_t*)item;
-        SCON_RELEASE(peer);
-    }
-    SCON_DESTRUCT(&topo->my_peers);
+    SCON_LIST_DESTRUCT(&topo->my_peers);
     return SCON_SUCCESS;
 }
 
@@ -124,21 +116,25 @@ static scon_proc_t radix_get_nexthop(scon_topology_t *topo,
     scon_proc_t route;
     scon_list_item_t *item;
     scon_topo_t *child;
-    unsigned int route_rank;
+    unsigned int route_rank, target_id;
     /* sanity check */
     if (target->rank == SCON_RANK_WILDCARD ||
         target->rank == SCON_RANK_UNDEF) {
         return *(SCON_PROC_WILDCARD);
     }
+    if (SCON_RANK_UNDEF == (target_id = scon_topology_base_get_topoid(topo, target))) {
+        /* not a member of this topology */
+        return *(SCON_PROC_WILDCARD);
+    }
     /* if we are trying to reach the lifeline/master process, then route it thru
        the parent */
-    if(target->rank == topo->my_topo.mylifeline_id) {
+    if(target_id == topo->my_topo.mylifeline_id) {
         route_rank = topo->my_topo.myparent_id;
         goto found;
     }
     /* if it is me, then the route is just direct */
     if (SCON_EQUAL == scon_util_compare_name_fields(SCON_NS_CMP_ALL, target, SCON_PROC_MY_NAME)) {
-        route_rank = target->rank;
+        route_rank = target_id;
         goto found;
     }
 
@@ -147,13 +143,13 @@ static scon_proc_t radix_get_nexthop(scon_topology_t *topo,
             item != scon_list_get_end(&topo->my_peers);
             item = scon_list_get_next(item)) {
         child = (scon_topo_t*)item;
-        if (child->my_id == target->rank) {
+        if (child->my_id == target_id) {
             /* this is my direct downward link  */
             route_rank = child->my_id;
             goto found;
         }
         /* otherwise, see if the target is rechable through this child */
-        if (scon_bitmap_is_set_bit(&child->relatives, target->rank)) {
+        if (scon_bitmap_is_set_bit(&child->relatives, target_id)) {
             /* yep - we need to route through this child */
             route_rank = child->my_id;
             goto found;
@@ -166,7 +162,7 @@ static scon_proc_t radix_get_nexthop(scon_topology_t *topo,
     route_rank = topo->my_topo.myparent_id;
 
  found:
-    scon_topology_base_convert_topoid_to_procid( &route, route_rank, target);
+    scon_topology_base_convert_topoid_to_procid(topo, &route, route_rank, target);
     scon_output_verbose(2, scon_topology_base_framework.framework_output,
                         "radix_topology:get route - route to %s from %s is %s",
                          SCON_PRINT_PROC(target),
@@ -190,7 +186,7 @@ static int radix_route_lost(scon_topology_t *topo,
          item != scon_list_get_end(&topo->my_peers);
          item = scon_list_get_next(item)) {
         child = (scon_topo_t*)item;
-        if (child->my_id == route->rank) {
+        if (child->my_id == scon_topology_base_get_topoid(topo, route)) {
                 scon_output_verbose(2, scon_topology_base_framework.framework_output,
                                      "%s topology_radix: removing route to child  %s",
                                      SCON_PRINT_PROC(SCON_PROC_MY_NAME),
@@ -285,7 +281,7 @@ static void radix_update_topology(scon_topology_t *topo, int num_nodes)
     num_children = 0;
 
     /* compute my parent */
-    Ii =  SCON_PROC_MY_NAME->rank;
+    Ii =  topo->my_topo.my_id;
     Level=0;
     Sum=1;
     NInLevel=1;
@@ -314,7 +310,7 @@ static void radix_update_topology(scon_topology_t *topo, int num_nodes)
 
     if (0 < scon_output_get_verbosity(scon_topology_base_framework.framework_output)) {
         scon_output(0, "%s: parent %d num_children %d", SCON_PRINT_PROC(SCON_PROC_MY_NAME),
-                    SCON_PROC_MY_NAME->rank, num_children);
+                    topo->my_topo.my_id, num_children);
         for (item = scon_list_get_first(&topo->my_peers);
              item != scon_list_get_end(&topo->my_peers);
              item = scon_list_get_next(item)) {
@@ -332,7 +328,7 @@ static void radix_update_topology(scon_topology_t *topo, int num_nodes)
 static void radix_get_routing_list(scon_topology_t *topo,
                              scon_list_t *coll)
 {
-    scon_topology_base_xcast_routing(&topo->my_peers, coll);
+    scon_topology_base_xcast_routing(topo, &topo->my_peers, coll);
 }
 
 static size_t radix_num_routes(scon_topology_t *topo)
@@ -46,6 +46,14 @@ SCON_CLASS_DECLARATION(scon_topo_t);
 typedef struct {
     scon_topo_t my_topo;
     scon_list_t my_peers;
+    /* the members in topology id order, for a scon that does not
+     * span its job (see scon_topology_base_set_members). NULL when
+     * the topology id of a member is its rank */
+    scon_proc_t *members;
+    size_t nmembers;
+    /* (rank << 32 | index) of each member, sorted, to look up
+     * the id of a member */
+    uint64_t *by_rank;
 } scon_topology_t;
 SCON_CLASS_DECLARATION(scon_topology_t);
 
@@ -27,6 +27,8 @@
 #include "src/mca/pt2pt/base/base.h"
 #include "src/util/error.h"
 #include "src/util/keyval_parse.h"
+#include "src/util/perf.h"
+#include "src/util/trace.h"
 #include "src/runtime/scon_progress_threads.h"
 #include "src/buffer_ops/buffer_ops.h"
 #include "src/runtime/scon_rte.h"
@@ -53,6 +55,7 @@ SCON_EXPORT scon_status_t scon_init(scon_info_t info[],
     size_t n, sz;
     uint32_t *nmembers;
     scon_proc_t *me;
+    uint64_t t_init, t0;
     if( ++scon_initialized != 1 ) {
         if( scon_initialized < 1 ) {
             return SCON_ERROR;
@@ -71,6 +74,7 @@ SCON_EXPORT scon_status_t scon_init(scon_info_t info[],
 #endif
 
     scon_init_called = true;
+    t_init = t0 = scon_perf_now_usec();
 
     /* initialize the output system */
     if (!scon_output_init()) {
@@ -116,11 +120,14 @@ SCON_EXPORT scon_status_t scon_init(scon_info_t info[],
         error = "failed to cache files";
         goto return_error;
     }
+    scon_perf_startup_phase("setup", t0);
     /* initialize the mca */
+    t0 = scon_perf_now_usec();
     if (SCON_SUCCESS != (ret = scon_mca_base_open())) {
         error = "mca_base_open";
         goto return_error;
     }
+    scon_perf_startup_phase("mca_base_open", t0);
     /* setup the globals structure */
     SCON_CONSTRUCT(&scon_globals.scons, scon_list_t);
     /* get our effective id's */
@@ -146,11 +153,24 @@ SCON_EXPORT scon_status_t scon_init(scon_info_t info[],
     scon_event_use_threads();
     if (!scon_globals.external_evbase) {
         /* create an event base and progress thread for us */
+        t0 = scon_perf_now_usec();
         if (NULL == (scon_globals.evbase = scon_progress_thread_init(NULL))) {
             error = "progress thread";
             ret = SCON_ERROR;
             goto return_error;
         }
+        scon_perf_startup_phase("progress thread", t0);
+    }
+
+    /* start the performance counters and the tracer - the periodic dump
+     * runs in our event base */
+    if (SCON_SUCCESS != (ret = scon_perf_init())) {
+        error = "scon_perf_init";
+        goto return_error;
+    }
+    if (SCON_SUCCESS != (ret = scon_trace_init())) {
+        error = "scon_trace_init";
+        goto return_error;
     }
 
     /* get our identity information - namespace and rank
@@ -190,17 +210,25 @@ SCON_EXPORT scon_status_t scon_init(scon_info_t info[],
         error = "scon_comm_base_open";
         goto return_error;
     }
+    t0 = scon_perf_now_usec();
     if (SCON_SUCCESS != (ret = scon_comm_base_select())) {
         scon_output_verbose(0, scon_globals.debug_output, "scon_init failed : error = comm_base_select");
         error = "scon_comm_base_select";
         goto return_error;
     }
+    scon_perf_startup_phase("select comm", t0);
 
+    t0 = scon_perf_now_usec();
     if (SCON_SUCCESS != (ret = scon_comm_module.init(info, ninfo))) {
         scon_output_verbose(0, scon_globals.debug_output, "scon_init failed : error = scon_comm.init");
         error = "scon_comm.init";
         goto return_error;
     }
+    scon_perf_startup_phase("comm init", t0);
+    scon_perf_startup_phase("scon_init", t_init);
+    if (scon_perf_startup && 0 == SCON_PROC_MY_NAME->rank) {
+        scon_perf_startup_dump(0);
+    }
     /* All done */
     return SCON_SUCCESS;
 
@@ -223,6 +251,17 @@ SCON_EXPORT scon_handle_t scon_create(scon_proc_t procs[],
     return scon_comm_module.create( procs, nprocs, info, ninfo, cbfunc, cbdata);
 }
 
+SCON_EXPORT scon_handle_t scon_split(scon_handle_t parent,
+                         int color,
+                         int key,
+                         scon_info_t info[],
+                         size_t ninfo,
+                         scon_create_cbfunc_t cbfunc,
+                         void *cbdata)
+{
+    return scon_comm_module.split(parent, color, key, info, ninfo, cbfunc, cbdata);
+}
+
 SCON_EXPORT scon_status_t scon_get_info (scon_handle_t scon_handle,
                              scon_info_t **info,
                              size_t *ninfo)
@@ -288,6 +327,72 @@ SCON_EXPORT scon_status_t scon_barrier(scon_handle_t scon_handle,
     return collectives_base_api_barrier(scon_handle, procs, nprocs, cbfunc, cbdata, info, ninfo);
 }
 
+SCON_EXPORT scon_status_t scon_allgather(scon_handle_t scon_handle,
+                           scon_proc_t procs[],
+                           size_t nprocs,
+                           scon_buffer_t *buf,
+                           scon_allgather_cbfunc_t cbfunc,
+                           void *cbdata,
+                           scon_info_t info[],
+                           size_t ninfo)
+{
+    return collectives_base_api_allgather(scon_handle, procs, nprocs, buf, cbfunc, cbdata,
+                                          info, ninfo);
+}
+
+SCON_EXPORT scon_status_t scon_allgatherv(scon_handle_t scon_handle,
+                              scon_proc_t procs[],
+                              size_t nprocs,
+                              scon_buffer_t *buf,
+                              scon_allgatherv_cbfunc_t cbfunc,
+                              void *cbdata,
+                              scon_info_t info[],
+                              size_t ninfo)
+{
+    return collectives_base_api_allgatherv(scon_handle, procs, nprocs, buf, cbfunc, cbdata,
+                                           info, ninfo);
+}
+
+SCON_EXPORT scon_status_t scon_allreduce(scon_handle_t scon_handle,
+                             scon_proc_t procs[],
+                             size_t nprocs,
+                             const void *sendbuf,
+                             void *recvbuf,
+                             size_t count,
+                             scon_data_type_t type,
+                             scon_reduce_op_t op,
+                             scon_reduce_cbfunc_t cbfunc,
+                             void *cbdata,
+                             scon_info_t info[],
+                             size_t ninfo)
+{
+    return collectives_base_api_reduce(scon_handle, procs, nprocs, sendbuf, recvbuf,
+                                       count, type, op, NULL, cbfunc, cbdata,
+                                       info, ninfo);
+}
+
+SCON_EXPORT scon_status_t scon_reduce(scon_handle_t scon_handle,
+                          scon_proc_t procs[],
+                          size_t nprocs,
+                          const void *sendbuf,
+                          void *recvbuf,
+                          size_t count,
+                          scon_data_type_t type,
+                          scon_reduce_op_t op,
+                          scon_proc_t *root,
+                          scon_reduce_cbfunc_t cbfunc,
+                          void *cbdata,
+                          scon_info_t info[],
+                          size_t ninfo)
+{
+    if (NULL == root) {
+        return SCON_ERR_BAD_PARAM;
+    }
+    return collectives_base_api_reduce(scon_handle, procs, nprocs, sendbuf, recvbuf,
+                                       count, type, op, root, cbfunc, cbdata,
+                                       info, ninfo);
+}
+
 SCON_EXPORT scon_status_t scon_delete(scon_handle_t scon_handle,
                           scon_op_cbfunc_t cbfunc,
                           void *cbdata,
@@ -299,6 +404,11 @@ SCON_EXPORT scon_status_t scon_delete(scon_handle_t scon_handle,
 
 SCON_EXPORT scon_status_t scon_finalize(void)
 {
+    int rc;
+
+    rc = scon_comm_module.finalize();
+    scon_perf_finalize();
+    scon_trace_finalize();
     free(scon_globals.myid);
-    return scon_comm_module.finalize();
+    return rc;
 }
@@ -35,6 +35,8 @@
 #include "src/mca/base/scon_mca_base_var.h"
 #include "src/runtime/scon_rte.h"
 #include "src/util/timings.h"
+#include "src/util/perf.h"
+#include "src/util/trace.h"
 
 
 static bool scon_register_done = false;
@@ -59,6 +61,65 @@ scon_status_t scon_register_params(void)
         return ret;
     }
 
+    ret = scon_mca_base_var_register ("scon", "scon", "perf", "enable",
+                                      "Keep the built-in performance counters that can be queried with scon_get_info (default: true)",
+                                      SCON_MCA_BASE_VAR_TYPE_BOOL, NULL, 0, SCON_MCA_BASE_VAR_FLAG_SETTABLE,
+                                      SCON_INFO_LVL_5, SCON_MCA_BASE_VAR_SCOPE_LOCAL,
+                                      &scon_perf_enabled);
+    if (0 > ret) {
+        return ret;
+    }
+    ret = scon_mca_base_var_register ("scon", "scon", "perf", "peer_stats",
+                                      "Also count messages per peer and per tag (default: true)",
+                                      SCON_MCA_BASE_VAR_TYPE_BOOL, NULL, 0, SCON_MCA_BASE_VAR_FLAG_SETTABLE,
+                                      SCON_INFO_LVL_5, SCON_MCA_BASE_VAR_SCOPE_LOCAL,
+                                      &scon_perf_peer_stats);
+    if (0 > ret) {
+        return ret;
+    }
+    ret = scon_mca_base_var_register ("scon", "scon", "perf", "dump_interval",
+                                      "Print the performance counters every this many seconds (default: 0, never)",
+                                      SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, SCON_MCA_BASE_VAR_FLAG_SETTABLE,
+                                      SCON_INFO_LVL_5, SCON_MCA_BASE_VAR_SCOPE_LOCAL,
+                                      &scon_perf_dump_interval);
+    if (0 > ret) {
+        return ret;
+    }
+    ret = scon_mca_base_var_register ("scon", "scon", "perf", "startup",
+                                      "Print how long each phase of scon_init took on rank 0 (default: false)",
+                                      SCON_MCA_BASE_VAR_TYPE_BOOL, NULL, 0, SCON_MCA_BASE_VAR_FLAG_SETTABLE,
+                                      SCON_INFO_LVL_5, SCON_MCA_BASE_VAR_SCOPE_LOCAL,
+                                      &scon_perf_startup);
+    if (0 > ret) {
+        return ret;
+    }
+
+    ret = scon_mca_base_var_register ("scon", "scon", "trace", "enable",
+                                      "Record a trace of the messaging and collective events and write it out at finalize (default: false)",
+                                      SCON_MCA_BASE_VAR_TYPE_BOOL, NULL, 0, SCON_MCA_BASE_VAR_FLAG_SETTABLE,
+                                      SCON_INFO_LVL_5, SCON_MCA_BASE_VAR_SCOPE_LOCAL,
+                                      &scon_trace_enabled);
+    if (0 > ret) {
+        return ret;
+    }
+    ret = scon_mca_base_var_register ("scon", "scon", "trace", "events",
+                                      "Number of trace events kept per thread, older events are overwritten (default: 65536)",
+                                      SCON_MCA_BASE_VAR_TYPE_INT, NULL, 0, SCON_MCA_BASE_VAR_FLAG_SETTABLE,
+                                      SCON_INFO_LVL_5, SCON_MCA_BASE_VAR_SCOPE_LOCAL,
+                                      &scon_trace_events);
+    if (0 > ret) {
+        return ret;
+    }
+    scon_trace_file = "scon-trace";
+    ret = scon_mca_base_var_register ("scon", "scon", "trace", "file",
+                                      "Prefix of the trace files, each member writes <prefix>.<job>.<rank>.json (default: scon-trace)",
+                                      SCON_MCA_BASE_VAR_TYPE_STRING, NULL, 0, SCON_MCA_BASE_VAR_FLAG_SETTABLE,
+                                      SCON_INFO_LVL_5, SCON_MCA_BASE_VAR_SCOPE_LOCAL,
+                                      &scon_trace_file);
+    if (0 > ret) {
+        return ret;
+    }
+
     return SCON_SUCCESS;
 }
 
@@ -129,6 +129,8 @@ SCON_EXPORT const char* SCON_Error_string(scon_status_t errnum)
         return "NETWORK_NOT_PARSEABLE";
     case SCON_ERR_WOULD_BLOCK:
         return "OPERATION_WOULD_BLOCK";
+    case SCON_ERR_QUEUE_FULL:
+        return "QUEUE-FULL";
     default:
         return "ERROR STRING NOT FOUND";
     }
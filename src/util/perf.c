@@ -0,0 +1,608 @@
+/*
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+#include "scon_config.h"
+#include <scon_common.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "src/include/prefetch.h"
+#include "src/include/scon_globals.h"
+#include "src/class/scon_hash_table.h"
+#include "src/util/error.h"
+#include "src/util/name_fns.h"
+#include "src/util/output.h"
+#include "src/util/tsd.h"
+#include "src/util/perf.h"
+
+bool scon_perf_enabled = true;
+bool scon_perf_peer_stats = true;
+int scon_perf_dump_interval = 0;
+bool scon_perf_startup = false;
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint64_t buckets[SCON_PERF_HIST_BUCKETS];
+} perf_hist_t;
+
+/* traffic with one peer or on one tag, indexed by sent */
+typedef struct {
+    uint64_t msgs[2];
+    uint64_t bytes[2];
+} perf_msg_stats_t;
+
+/* one per thread that has touched a counter. Only the owner
+ * writes to the slab - the lock serializes the owner growing
+ * the tables against a reader walking them */
+typedef struct perf_slab {
+    struct perf_slab *next;
+    pthread_mutex_t lock;
+    int64_t counters[SCON_PERF_NUM_COUNTERS];
+    perf_hist_t hists[SCON_PERF_NUM_HISTS];
+    scon_hash_table_t peers;
+    scon_hash_table_t tags;
+} perf_slab_t;
+
+static const char *counter_names[SCON_PERF_NUM_COUNTERS] = {
+    SCON_PERF_MSGS_SENT,
+    SCON_PERF_BYTES_SENT,
+    SCON_PERF_MSGS_RECVD,
+    SCON_PERF_BYTES_RECVD,
+    SCON_PERF_UNMATCHED_MSGS,
+    SCON_PERF_COLL_TRACKERS,
+    SCON_PERF_COLL_COMPLETED,
+    SCON_PERF_TCP_SEND_QUEUE,
+    SCON_PERF_TCP_EAGAIN,
+    SCON_PERF_TCP_RETRIES
+};
+
+static const char *hist_names[SCON_PERF_NUM_HISTS] = {
+    SCON_PERF_COLL_LATENCY,
+    SCON_PERF_MSG_SIZE,
+    SCON_PERF_UNMATCHED_DEPTH,
+    SCON_PERF_TCP_QUEUE_DEPTH
+};
+
+/* a startup phase - there are only a few dozen of them, most
+ * recorded by the thread running scon_init */
+#define PERF_MAX_PHASES 64
+typedef struct {
+    char name[48];
+    uint64_t start;
+    uint64_t usec;
+} perf_phase_t;
+
+static pthread_mutex_t phases_lock = PTHREAD_MUTEX_INITIALIZER;
+static perf_phase_t phases[PERF_MAX_PHASES];
+static int nphases = 0;
+
+static bool initialized = false;
+static scon_tsd_key_t slab_key;
+static pthread_mutex_t slabs_lock = PTHREAD_MUTEX_INITIALIZER;
+static perf_slab_t *slabs = NULL;
+static scon_event_t dump_ev;
+static bool dump_active = false;
+
+static perf_slab_t* get_slab(void)
+{
+    perf_slab_t *slab = NULL;
+
+    scon_tsd_getspecific(slab_key, (void**)&slab);
+    if (SCON_LIKELY(NULL != slab)) {
+        return slab;
+    }
+    if (NULL == (slab = (perf_slab_t*)calloc(1, sizeof(perf_slab_t)))) {
+        return NULL;
+    }
+    pthread_mutex_init(&slab->lock, NULL);
+    SCON_CONSTRUCT(&slab->peers, scon_hash_table_t);
+    scon_hash_table_init(&slab->peers, 64);
+    SCON_CONSTRUCT(&slab->tags, scon_hash_table_t);
+    scon_hash_table_init(&slab->tags, 16);
+    scon_tsd_setspecific(slab_key, slab);
+    /* slabs outlive their thread so its counts aren't lost */
+    pthread_mutex_lock(&slabs_lock);
+    slab->next = slabs;
+    slabs = slab;
+    pthread_mutex_unlock(&slabs_lock);
+    return slab;
+}
+
+static void free_stats(scon_hash_table_t *table, bool ptr_keys)
+{
+    perf_msg_stats_t *stats;
+    uint32_t tag;
+    void *key;
+    size_t keylen;
+    void *node;
+    int rc;
+
+    if (ptr_keys) {
+        rc = scon_hash_table_get_first_key_ptr(table, &key, &keylen, (void**)&stats, &node);
+        while (SCON_SUCCESS == rc) {
+            free(stats);
+            rc = scon_hash_table_get_next_key_ptr(table, &key, &keylen, (void**)&stats, node, &node);
+        }
+    } else {
+        rc = scon_hash_table_get_first_key_uint32(table, &tag, (void**)&stats, &node);
+        while (SCON_SUCCESS == rc) {
+            free(stats);
+            rc = scon_hash_table_get_next_key_uint32(table, &tag, (void**)&stats, node, &node);
+        }
+    }
+    SCON_DESTRUCT(table);
+}
+
+static void dump_cb(int fd, short args, void *cbdata)
+{
+    struct timeval tv;
+
+    scon_perf_dump(0);
+    tv.tv_sec = scon_perf_dump_interval;
+    tv.tv_usec = 0;
+    scon_event_evtimer_add(&dump_ev, &tv);
+}
+
+int scon_perf_init(void)
+{
+    struct timeval tv;
+    int rc;
+
+    if (initialized) {
+        return SCON_SUCCESS;
+    }
+    if (SCON_SUCCESS != (rc = scon_tsd_key_create(&slab_key, NULL))) {
+        SCON_ERROR_LOG(rc);
+        scon_perf_enabled = false;
+        return rc;
+    }
+    initialized = true;
+    if (scon_perf_enabled && 0 < scon_perf_dump_interval &&
+        NULL != scon_globals.evbase) {
+        scon_event_evtimer_set(scon_globals.evbase, &dump_ev, dump_cb, NULL);
+        tv.tv_sec = scon_perf_dump_interval;
+        tv.tv_usec = 0;
+        scon_event_evtimer_add(&dump_ev, &tv);
+        dump_active = true;
+    }
+    return SCON_SUCCESS;
+}
+
+void scon_perf_finalize(void)
+{
+    perf_slab_t *slab;
+
+    if (!initialized) {
+        return;
+    }
+    if (dump_active) {
+        scon_event_evtimer_del(&dump_ev);
+        dump_active = false;
+    }
+    scon_perf_enabled = false;
+    pthread_mutex_lock(&slabs_lock);
+    while (NULL != (slab = slabs)) {
+        slabs = slab->next;
+        free_stats(&slab->peers, true);
+        free_stats(&slab->tags, false);
+        pthread_mutex_destroy(&slab->lock);
+        free(slab);
+    }
+    pthread_mutex_unlock(&slabs_lock);
+    scon_tsd_key_delete(slab_key);
+    initialized = false;
+}
+
+void scon_perf_add(scon_perf_counter_t counter, int64_t delta)
+{
+    perf_slab_t *slab;
+
+    if (!initialized || NULL == (slab = get_slab())) {
+        return;
+    }
+    slab->counters[counter] += delta;
+}
+
+static inline unsigned int hist_bucket(uint64_t value)
+{
+    unsigned int b = 0;
+
+    while (0 != value && b < SCON_PERF_HIST_BUCKETS - 1) {
+        value >>= 1;
+        b++;
+    }
+    return b;
+}
+
+void scon_perf_hist_add(scon_perf_hist_t hist, uint64_t value)
+{
+    perf_slab_t *slab;
+    perf_hist_t *h;
+
+    if (!initialized || NULL == (slab = get_slab())) {
+        return;
+    }
+    h = &slab->hists[hist];
+    h->count++;
+    h->sum += value;
+    if (h->max < value) {
+        h->max = value;
+    }
+    h->buckets[hist_bucket(value)]++;
+}
+
+/* peers are keyed by their job name, including the terminator,
+ * followed by their rank */
+static size_t peer_key(const scon_proc_t *peer, char *key)
+{
+    size_t len = strnlen(peer->job_name, SCON_MAX_NSLEN);
+
+    memcpy(key, peer->job_name, len);
+    key[len++] = '\0';
+    memcpy(key + len, &peer->rank, sizeof(peer->rank));
+    return len + sizeof(peer->rank);
+}
+
+static perf_msg_stats_t* lookup_stats(perf_slab_t *slab, const void *key,
+                                      size_t keylen, uint32_t tag)
+{
+    perf_msg_stats_t *stats = NULL;
+    int rc;
+
+    if (NULL != key) {
+        rc = scon_hash_table_get_value_ptr(&slab->peers, key, keylen, (void**)&stats);
+    } else {
+        rc = scon_hash_table_get_value_uint32(&slab->tags, tag, (void**)&stats);
+    }
+    if (SCON_LIKELY(SCON_SUCCESS == rc)) {
+        return stats;
+    }
+    if (NULL == (stats = (perf_msg_stats_t*)calloc(1, sizeof(perf_msg_stats_t)))) {
+        return NULL;
+    }
+    pthread_mutex_lock(&slab->lock);
+    if (NULL != key) {
+        scon_hash_table_set_value_ptr(&slab->peers, key, keylen, stats);
+    } else {
+        scon_hash_table_set_value_uint32(&slab->tags, tag, stats);
+    }
+    pthread_mutex_unlock(&slab->lock);
+    return stats;
+}
+
+void scon_perf_msg(bool sent, const scon_proc_t *peer,
+                   scon_msg_tag_t tag, size_t bytes)
+{
+    char key[SCON_MAX_NSLEN + 1 + sizeof(scon_rank_t)];
+    perf_msg_stats_t *stats;
+    perf_slab_t *slab;
+    int dir = sent ? 1 : 0;
+
+    if (!initialized || NULL == (slab = get_slab())) {
+        return;
+    }
+    if (sent) {
+        slab->counters[SCON_PERF_CTR_MSGS_SENT]++;
+        slab->counters[SCON_PERF_CTR_BYTES_SENT] += bytes;
+        scon_perf_hist_add(SCON_PERF_HIST_MSG_SIZE, bytes);
+    } else {
+        slab->counters[SCON_PERF_CTR_MSGS_RECVD]++;
+        slab->counters[SCON_PERF_CTR_BYTES_RECVD] += bytes;
+    }
+    if (!scon_perf_peer_stats) {
+        return;
+    }
+    if (NULL != peer &&
+        NULL != (stats = lookup_stats(slab, key, peer_key(peer, key), 0))) {
+        stats->msgs[dir]++;
+        stats->bytes[dir] += bytes;
+    }
+    if (NULL != (stats = lookup_stats(slab, NULL, 0, tag))) {
+        stats->msgs[dir]++;
+        stats->bytes[dir] += bytes;
+    }
+}
+
+uint64_t scon_perf_now_usec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* sum of a counter over all slabs - called with slabs_lock held */
+static int64_t counter_total(scon_perf_counter_t counter)
+{
+    perf_slab_t *slab;
+    int64_t total = 0;
+
+    for (slab = slabs; NULL != slab; slab = slab->next) {
+        total += slab->counters[counter];
+    }
+    return total;
+}
+
+/* called with slabs_lock held */
+static void hist_total(scon_perf_hist_t hist, perf_hist_t *h)
+{
+    perf_slab_t *slab;
+    int b;
+
+    memset(h, 0, sizeof(*h));
+    for (slab = slabs; NULL != slab; slab = slab->next) {
+        h->count += slab->hists[hist].count;
+        h->sum += slab->hists[hist].sum;
+        if (h->max < slab->hists[hist].max) {
+            h->max = slab->hists[hist].max;
+        }
+        for (b = 0; b < SCON_PERF_HIST_BUCKETS; b++) {
+            h->buckets[b] += slab->hists[hist].buckets[b];
+        }
+    }
+}
+
+/* upper bound of the bucket holding the given percentile */
+static uint64_t hist_percentile(const perf_hist_t *h, unsigned int pct)
+{
+    uint64_t seen = 0, want;
+    int b;
+
+    if (0 == h->count) {
+        return 0;
+    }
+    want = (h->count * pct + 99) / 100;
+    for (b = 0; b < SCON_PERF_HIST_BUCKETS - 1; b++) {
+        seen += h->buckets[b];
+        if (seen >= want) {
+            return (0 == b) ? 0 : ((uint64_t)1 << b) - 1;
+        }
+    }
+    return h->max;
+}
+
+static void hist_print(const perf_hist_t *h, char *str, size_t len)
+{
+    snprintf(str, len, "count=%llu avg=%llu p50<=%llu p99<=%llu max=%llu",
+             (unsigned long long)h->count,
+             (unsigned long long)(0 == h->count ? 0 : h->sum / h->count),
+             (unsigned long long)hist_percentile(h, 50),
+             (unsigned long long)hist_percentile(h, 99),
+             (unsigned long long)h->max);
+}
+
+void scon_perf_startup_phase(const char *phase, uint64_t start)
+{
+    uint64_t now = scon_perf_now_usec();
+    perf_phase_t *p;
+
+    pthread_mutex_lock(&phases_lock);
+    if (nphases < PERF_MAX_PHASES) {
+        p = &phases[nphases++];
+        snprintf(p->name, sizeof(p->name), "%s", phase);
+        p->start = start;
+        p->usec = now - start;
+    }
+    pthread_mutex_unlock(&phases_lock);
+}
+
+/* by start, an enclosing phase before the phases it contains */
+static int phase_cmp(const void *a, const void *b)
+{
+    const perf_phase_t *pa = (const perf_phase_t*)a;
+    const perf_phase_t *pb = (const perf_phase_t*)b;
+
+    if (pa->start != pb->start) {
+        return (pa->start < pb->start) ? -1 : 1;
+    }
+    if (pa->usec != pb->usec) {
+        return (pa->usec > pb->usec) ? -1 : 1;
+    }
+    return 0;
+}
+
+/* order the phases and count the phases each one ran in - called
+ * with phases_lock held */
+static void phases_sort(int *depth)
+{
+    int i, j;
+
+    qsort(phases, nphases, sizeof(perf_phase_t), phase_cmp);
+    for (i = 0; i < nphases; i++) {
+        depth[i] = 0;
+        for (j = 0; j < i; j++) {
+            if (phases[i].start + phases[i].usec <= phases[j].start + phases[j].usec) {
+                depth[i]++;
+            }
+        }
+    }
+}
+
+void scon_perf_startup_dump(int output_id)
+{
+    int depth[PERF_MAX_PHASES];
+    int i;
+
+    pthread_mutex_lock(&phases_lock);
+    phases_sort(depth);
+    scon_output(output_id, "%s startup:", SCON_PRINT_PROC(SCON_PROC_MY_NAME));
+    for (i = 0; i < nphases; i++) {
+        scon_output(output_id, "    %*s%s: %llu usec", 2 * depth[i], "",
+                    phases[i].name, (unsigned long long)phases[i].usec);
+    }
+    pthread_mutex_unlock(&phases_lock);
+}
+
+/* the phases as "name=usec,..." in the order they started */
+static void startup_print(char *str, size_t len)
+{
+    int depth[PERF_MAX_PHASES];
+    size_t off = 0;
+    int i;
+
+    str[0] = '\0';
+    pthread_mutex_lock(&phases_lock);
+    phases_sort(depth);
+    for (i = 0; i < nphases && off < len; i++) {
+        off += snprintf(str + off, len - off, "%s%s=%llu", (0 == i) ? "" : ",",
+                        phases[i].name, (unsigned long long)phases[i].usec);
+    }
+    pthread_mutex_unlock(&phases_lock);
+}
+
+int scon_perf_get_info(const char *key, scon_value_t *val)
+{
+    perf_hist_t h;
+    uint64_t total;
+    char str[256], *phases_str;
+    int i;
+
+    if (0 == strncmp(key, SCON_PERF_STARTUP, SCON_MAX_KEYLEN)) {
+        if (NULL == (phases_str = (char*)malloc(PERF_MAX_PHASES * 80))) {
+            return SCON_ERR_OUT_OF_RESOURCE;
+        }
+        startup_print(phases_str, PERF_MAX_PHASES * 80);
+        scon_value_load(val, phases_str, SCON_STRING);
+        free(phases_str);
+        return SCON_SUCCESS;
+    }
+
+    for (i = 0; i < SCON_PERF_NUM_COUNTERS; i++) {
+        if (0 == strncmp(key, counter_names[i], SCON_MAX_KEYLEN)) {
+            pthread_mutex_lock(&slabs_lock);
+            total = (uint64_t)counter_total(i);
+            pthread_mutex_unlock(&slabs_lock);
+            scon_value_load(val, &total, SCON_UINT64);
+            return SCON_SUCCESS;
+        }
+    }
+    for (i = 0; i < SCON_PERF_NUM_HISTS; i++) {
+        if (0 == strncmp(key, hist_names[i], SCON_MAX_KEYLEN)) {
+            pthread_mutex_lock(&slabs_lock);
+            hist_total(i, &h);
+            pthread_mutex_unlock(&slabs_lock);
+            hist_print(&h, str, sizeof(str));
+            scon_value_load(val, str, SCON_STRING);
+            return SCON_SUCCESS;
+        }
+    }
+    return SCON_ERR_NOT_FOUND;
+}
+
+/* fold the per thread tables into a single one - called
+ * with slabs_lock held */
+static void merge_stats(scon_hash_table_t *dst, bool ptr_keys)
+{
+    perf_msg_stats_t *stats, *total;
+    perf_slab_t *slab;
+    scon_hash_table_t *src;
+    void *key, *node;
+    size_t keylen;
+    uint32_t tag;
+    int rc, d;
+
+    for (slab = slabs; NULL != slab; slab = slab->next) {
+        pthread_mutex_lock(&slab->lock);
+        src = ptr_keys ? &slab->peers : &slab->tags;
+        if (ptr_keys) {
+            rc = scon_hash_table_get_first_key_ptr(src, &key, &keylen, (void**)&stats, &node);
+        } else {
+            rc = scon_hash_table_get_first_key_uint32(src, &tag, (void**)&stats, &node);
+        }
+        while (SCON_SUCCESS == rc) {
+            total = NULL;
+            if (ptr_keys) {
+                scon_hash_table_get_value_ptr(dst, key, keylen, (void**)&total);
+            } else {
+                scon_hash_table_get_value_uint32(dst, tag, (void**)&total);
+            }
+            if (NULL == total &&
+                NULL != (total = (perf_msg_stats_t*)calloc(1, sizeof(perf_msg_stats_t)))) {
+                if (ptr_keys) {
+                    scon_hash_table_set_value_ptr(dst, key, keylen, total);
+                } else {
+                    scon_hash_table_set_value_uint32(dst, tag, total);
+                }
+            }
+            if (NULL != total) {
+                for (d = 0; d < 2; d++) {
+                    total->msgs[d] += stats->msgs[d];
+                    total->bytes[d] += stats->bytes[d];
+                }
+            }
+            if (ptr_keys) {
+                rc = scon_hash_table_get_next_key_ptr(src, &key, &keylen, (void**)&stats, node, &node);
+            } else {
+                rc = scon_hash_table_get_next_key_uint32(src, &tag, (void**)&stats, node, &node);
+            }
+        }
+        pthread_mutex_unlock(&slab->lock);
+    }
+}
+
+void scon_perf_dump(int output_id)
+{
+    scon_hash_table_t peers, tags;
+    perf_msg_stats_t *stats;
+    perf_hist_t h;
+    void *key, *node;
+    size_t keylen;
+    uint32_t tag;
+    scon_rank_t rank;
+    char str[256];
+    int i, rc;
+
+    if (!initialized) {
+        return;
+    }
+    SCON_CONSTRUCT(&peers, scon_hash_table_t);
+    scon_hash_table_init(&peers, 64);
+    SCON_CONSTRUCT(&tags, scon_hash_table_t);
+    scon_hash_table_init(&tags, 16);
+
+    pthread_mutex_lock(&slabs_lock);
+    scon_output(output_id, "%s perf counters:", SCON_PRINT_PROC(SCON_PROC_MY_NAME));
+    for (i = 0; i < SCON_PERF_NUM_COUNTERS; i++) {
+        scon_output(output_id, "    %s: %lld", counter_names[i],
+                    (long long)counter_total(i));
+    }
+    for (i = 0; i < SCON_PERF_NUM_HISTS; i++) {
+        hist_total(i, &h);
+        hist_print(&h, str, sizeof(str));
+        scon_output(output_id, "    %s: %s", hist_names[i], str);
+    }
+    merge_stats(&peers, true);
+    merge_stats(&tags, false);
+    pthread_mutex_unlock(&slabs_lock);
+
+    rc = scon_hash_table_get_first_key_ptr(&peers, &key, &keylen, (void**)&stats, &node);
+    while (SCON_SUCCESS == rc) {
+        memcpy(&rank, (char*)key + keylen - sizeof(rank), sizeof(rank));
+        scon_output(output_id, "    peer %s:%u sent %llu msgs %llu bytes recvd %llu msgs %llu bytes",
+                    (char*)key, rank,
+                    (unsigned long long)stats->msgs[1], (unsigned long long)stats->bytes[1],
+                    (unsigned long long)stats->msgs[0], (unsigned long long)stats->bytes[0]);
+        rc = scon_hash_table_get_next_key_ptr(&peers, &key, &keylen, (void**)&stats, node, &node);
+    }
+    rc = scon_hash_table_get_first_key_uint32(&tags, &tag, (void**)&stats, &node);
+    while (SCON_SUCCESS == rc) {
+        scon_output(output_id, "    tag %u sent %llu msgs %llu bytes recvd %llu msgs %llu bytes",
+                    tag,
+                    (unsigned long long)stats->msgs[1], (unsigned long long)stats->bytes[1],
+                    (unsigned long long)stats->msgs[0], (unsigned long long)stats->bytes[0]);
+        rc = scon_hash_table_get_next_key_uint32(&tags, &tag, (void**)&stats, node, &node);
+    }
+    free_stats(&peers, true);
+    free_stats(&tags, false);
+}
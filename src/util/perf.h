@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+/** @file : built-in performance counters
+ *
+ * Counters and histograms describing the messaging and collective
+ * activity of this process, summed over all scons. Every thread
+ * updates its own slab without locking and the slabs are only
+ * combined when the values are read, either through scon_get_info
+ * or by the periodic dump to scon_output.
+ *
+ * Gauges such as the unmatched queue length are counters that
+ * are both incremented and decremented, possibly from different
+ * threads - only the sum over all slabs is meaningful.
+ */
+#ifndef SCON_PERF_H
+#define SCON_PERF_H
+
+#include "scon_config.h"
+#include <scon.h>
+#include <scon_common.h>
+
+BEGIN_C_DECLS
+
+typedef enum {
+    SCON_PERF_CTR_MSGS_SENT,
+    SCON_PERF_CTR_BYTES_SENT,
+    SCON_PERF_CTR_MSGS_RECVD,
+    SCON_PERF_CTR_BYTES_RECVD,
+    /* gauge - messages waiting for a matching recv */
+    SCON_PERF_CTR_UNMATCHED_MSGS,
+    /* gauge - collective trackers alive */
+    SCON_PERF_CTR_COLL_TRACKERS,
+    SCON_PERF_CTR_COLL_COMPLETED,
+    /* gauge - messages queued on tcp connections */
+    SCON_PERF_CTR_TCP_SEND_QUEUE,
+    /* writes that returned EAGAIN/EWOULDBLOCK */
+    SCON_PERF_CTR_TCP_EAGAIN,
+    SCON_PERF_CTR_TCP_CONNECT_RETRIES,
+    SCON_PERF_NUM_COUNTERS
+} scon_perf_counter_t;
+
+typedef enum {
+    /* usecs from posting a collective to its callback */
+    SCON_PERF_HIST_COLL_LATENCY,
+    /* payload bytes of each message sent */
+    SCON_PERF_HIST_MSG_SIZE,
+    /* length of the unmatched queue of a scon on each append */
+    SCON_PERF_HIST_UNMATCHED_DEPTH,
+    /* length of the send queue of a tcp peer on each append */
+    SCON_PERF_HIST_TCP_SEND_QUEUE,
+    SCON_PERF_NUM_HISTS
+} scon_perf_hist_t;
+
+/* bucket 0 holds zeroes, bucket b holds [2^(b-1), 2^b) and
+ * the last bucket everything above */
+#define SCON_PERF_HIST_BUCKETS  32
+
+/* MCA params, registered in scon_register_params */
+SCON_EXPORT extern bool scon_perf_enabled;
+SCON_EXPORT extern bool scon_perf_peer_stats;
+SCON_EXPORT extern int scon_perf_dump_interval;
+SCON_EXPORT extern bool scon_perf_startup;
+
+SCON_EXPORT int scon_perf_init(void);
+SCON_EXPORT void scon_perf_finalize(void);
+
+SCON_EXPORT void scon_perf_add(scon_perf_counter_t counter, int64_t delta);
+SCON_EXPORT void scon_perf_hist_add(scon_perf_hist_t hist, uint64_t value);
+/* account a message to/from peer on tag in the totals and,
+ * if enabled, the per peer and per tag tables */
+SCON_EXPORT void scon_perf_msg(bool sent, const scon_proc_t *peer,
+                               scon_msg_tag_t tag, size_t bytes);
+SCON_EXPORT uint64_t scon_perf_now_usec(void);
+
+/* answer a SCON_PERF_* info key. Returns SCON_ERR_NOT_FOUND if
+ * key isn't one of ours */
+SCON_EXPORT int scon_perf_get_info(const char *key, scon_value_t *val);
+
+/* print all counters to output_id */
+SCON_EXPORT void scon_perf_dump(int output_id);
+
+/* startup time breakdown - record that phase ran from start (a
+ * scon_perf_now_usec() timestamp) until now. The phases of
+ * scon_init, the framework opens and the component dlopens are
+ * recorded this way, before and regardless of scon_perf_init */
+SCON_EXPORT void scon_perf_startup_phase(const char *phase, uint64_t start);
+/* print the phases in the order they started, nested phases
+ * indented under the phase they ran in */
+SCON_EXPORT void scon_perf_startup_dump(int output_id);
+
+/* the hooks used by the library - they cost a single branch
+ * when the counters are disabled */
+#define SCON_PERF_ADD(c, d)                     \
+    do {                                        \
+        if (scon_perf_enabled) {                \
+            scon_perf_add((c), (d));            \
+        }                                       \
+    } while (0)
+
+#define SCON_PERF_INC(c)    SCON_PERF_ADD((c), 1)
+#define SCON_PERF_DEC(c)    SCON_PERF_ADD((c), -1)
+
+#define SCON_PERF_HIST(h, v)                    \
+    do {                                        \
+        if (scon_perf_enabled) {                \
+            scon_perf_hist_add((h), (v));       \
+        }                                       \
+    } while (0)
+
+#define SCON_PERF_MSG(s, p, t, b)               \
+    do {                                        \
+        if (scon_perf_enabled) {                \
+            scon_perf_msg((s), (p), (t), (b));  \
+        }                                       \
+    } while (0)
+
+END_C_DECLS
+
+#endif /* SCON_PERF_H */
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+/** @file : local key-value store implementation
+ *
+ * Each key lives in its own file, <dir>/<rank>.<key>, holding a small
+ * header followed by the payload. Files are written under a temporary
+ * name and renamed into place so a reader never sees a partial value.
+ * All members run on the same host from the same binary, so scalar
+ * values are stored in their native representation.
+ */
+#include "scon_config.h"
+#include <scon_common.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "scon_globals.h"
+#include "src/util/error.h"
+#include "src/util/name_fns.h"
+#include "src/util/output.h"
+#include "src/util/scon_local_kvs.h"
+
+typedef struct {
+    int32_t type;
+    uint32_t pad;
+    uint64_t size;
+} kvs_header_t;
+
+static char *kvs_dir = NULL;
+static int kvs_timeout = 60;
+
+bool scon_local_kvs_enabled(void)
+{
+    return (NULL != getenv(SCON_LOCAL_KVS_DIR_ENV));
+}
+
+int scon_local_kvs_init(scon_proc_t *me, uint32_t *job_size)
+{
+    char *job, *rank, *size, *timeout;
+
+    if (NULL == (kvs_dir = getenv(SCON_LOCAL_KVS_DIR_ENV)) ||
+        NULL == (job = getenv(SCON_LOCAL_KVS_JOB_ENV)) ||
+        NULL == (rank = getenv(SCON_LOCAL_KVS_RANK_ENV)) ||
+        NULL == (size = getenv(SCON_LOCAL_KVS_SIZE_ENV))) {
+        scon_output(0, "scon_local_kvs_init: incomplete launch environment, %s, %s, "
+                    "%s and %s must all be set", SCON_LOCAL_KVS_DIR_ENV,
+                    SCON_LOCAL_KVS_JOB_ENV, SCON_LOCAL_KVS_RANK_ENV,
+                    SCON_LOCAL_KVS_SIZE_ENV);
+        kvs_dir = NULL;
+        return SCON_ERR_BAD_PARAM;
+    }
+    if (NULL != (timeout = getenv(SCON_LOCAL_KVS_TIMEOUT_ENV))) {
+        kvs_timeout = strtol(timeout, NULL, 10);
+    }
+    memset(me->job_name, 0, sizeof(me->job_name));
+    strncpy(me->job_name, job, SCON_MAX_JOBLEN);
+    me->rank = strtoul(rank, NULL, 10);
+    *job_size = strtoul(size, NULL, 10);
+    scon_output_verbose(2, scon_globals.debug_output,
+                        "scon_local_kvs_init: job %s rank %u of %u, store %s",
+                        me->job_name, me->rank, *job_size, kvs_dir);
+    return SCON_SUCCESS;
+}
+
+static char* key_path(scon_rank_t rank, const char key[], const char *suffix)
+{
+    char *path, *p;
+
+    if (0 > asprintf(&path, "%s/%u.%s%s", kvs_dir, rank, key, suffix)) {
+        return NULL;
+    }
+    /* keep the key within the store directory */
+    for (p = path + strlen(kvs_dir) + 1; '\0' != *p; p++) {
+        if ('/' == *p) {
+            *p = '_';
+        }
+    }
+    return path;
+}
+
+static int write_all(int fd, const void *data, size_t size)
+{
+    const char *ptr = (const char*)data;
+    ssize_t rc;
+
+    while (0 < size) {
+        if (0 > (rc = write(fd, ptr, size))) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return SCON_ERROR;
+        }
+        ptr += rc;
+        size -= rc;
+    }
+    return SCON_SUCCESS;
+}
+
+int scon_local_kvs_put(const scon_proc_t *me, const char key[],
+                       const scon_value_t *val)
+{
+    kvs_header_t hdr;
+    const void *payload;
+    char *path, *tmp;
+    int fd, rc;
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.type = val->type;
+    switch (val->type) {
+        case SCON_STRING:
+            payload = val->data.string;
+            hdr.size = (NULL == payload) ? 0 : strlen(val->data.string) + 1;
+            break;
+        case SCON_BYTE_OBJECT:
+            payload = val->data.bo.bytes;
+            hdr.size = (NULL == payload) ? 0 : val->data.bo.size;
+            break;
+        case SCON_PROC:
+            payload = val->data.proc;
+            hdr.size = sizeof(scon_proc_t);
+            break;
+        case SCON_POINTER:
+        case SCON_DATA_ARRAY:
+        case SCON_INFO_ARRAY:
+            /* nothing that refers to our address space can be shared */
+            return SCON_ERR_NOT_SUPPORTED;
+        default:
+            payload = &val->data;
+            hdr.size = sizeof(val->data);
+            break;
+    }
+    if (NULL == (path = key_path(me->rank, key, ""))) {
+        return SCON_ERR_OUT_OF_RESOURCE;
+    }
+    if (NULL == (tmp = key_path(me->rank, key, ".tmp"))) {
+        free(path);
+        return SCON_ERR_OUT_OF_RESOURCE;
+    }
+    if (0 > (fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0600))) {
+        scon_output(0, "scon_local_kvs_put: cannot create %s: %s", tmp, strerror(errno));
+        free(path);
+        free(tmp);
+        return SCON_ERROR;
+    }
+    rc = write_all(fd, &hdr, sizeof(hdr));
+    if (SCON_SUCCESS == rc && 0 < hdr.size) {
+        rc = write_all(fd, payload, hdr.size);
+    }
+    close(fd);
+    if (SCON_SUCCESS != rc || 0 != rename(tmp, path)) {
+        SCON_ERROR_LOG(SCON_ERROR);
+        unlink(tmp);
+        rc = SCON_ERROR;
+    }
+    free(path);
+    free(tmp);
+    return rc;
+}
+
+static int read_value(FILE *fp, scon_value_t *sv)
+{
+    kvs_header_t hdr;
+    char *payload = NULL;
+
+    if (1 != fread(&hdr, sizeof(hdr), 1, fp)) {
+        return SCON_ERROR;
+    }
+    if (0 < hdr.size) {
+        if (NULL == (payload = (char*)malloc(hdr.size))) {
+            return SCON_ERR_OUT_OF_RESOURCE;
+        }
+        if (1 != fread(payload, hdr.size, 1, fp)) {
+            free(payload);
+            return SCON_ERROR;
+        }
+    }
+    sv->type = hdr.type;
+    switch (sv->type) {
+        case SCON_STRING:
+            /* the payload carries the terminating NUL */
+            sv->data.string = payload;
+            break;
+        case SCON_BYTE_OBJECT:
+            sv->data.bo.bytes = payload;
+            sv->data.bo.size = hdr.size;
+            break;
+        case SCON_PROC:
+            sv->data.proc = (scon_proc_t*)payload;
+            break;
+        default:
+            if (NULL != payload) {
+                memcpy(&sv->data, payload, hdr.size < sizeof(sv->data) ?
+                       hdr.size : sizeof(sv->data));
+                free(payload);
+            }
+            break;
+    }
+    return SCON_SUCCESS;
+}
+
+int scon_local_kvs_get(const scon_proc_t *proc, const char key[],
+                       scon_value_t **val)
+{
+    struct timespec delay = {0, 100000};
+    time_t deadline;
+    scon_value_t *sv;
+    char *path;
+    FILE *fp;
+    int rc;
+
+    if (NULL == kvs_dir) {
+        return SCON_ERR_INIT;
+    }
+    if (NULL == (path = key_path(proc->rank, key, ""))) {
+        return SCON_ERR_OUT_OF_RESOURCE;
+    }
+    /* the peer may not have published yet, so poll with a
+     * backoff capped at 10ms until the timeout expires */
+    deadline = time(NULL) + kvs_timeout;
+    while (NULL == (fp = fopen(path, "r"))) {
+        if (ENOENT != errno || time(NULL) >= deadline) {
+            scon_output(0, "%s scon_local_kvs_get: key %s of rank %u not found",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME), key, proc->rank);
+            free(path);
+            return SCON_ERR_NOT_FOUND;
+        }
+        nanosleep(&delay, NULL);
+        if (delay.tv_nsec < 10000000) {
+            delay.tv_nsec *= 2;
+        }
+    }
+    free(path);
+    SCON_VALUE_CREATE(sv, 1);
+    if (SCON_SUCCESS != (rc = read_value(fp, sv))) {
+        SCON_ERROR_LOG(rc);
+        fclose(fp);
+        free(sv);
+        return rc;
+    }
+    fclose(fp);
+    *val = sv;
+    return SCON_SUCCESS;
+}
+
+void scon_local_kvs_finalize(void)
+{
+    /* the launcher removes the store once all the members are done,
+     * as peers may still be reading our keys */
+    kvs_dir = NULL;
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+/** @file : local key-value store used in place of a PMIx server
+ *
+ * When SCON is started by scon_local_run every member finds its
+ * identity in the environment and the members exchange their keys
+ * through files in a directory shared by the job. This lets a job
+ * be launched and wired up on a single box without a PMIx server.
+ */
+#ifndef SCON_LOCAL_KVS_H
+#define SCON_LOCAL_KVS_H
+
+#include <scon_common.h>
+
+/** environment set by the launcher for each member */
+#define SCON_LOCAL_KVS_DIR_ENV       "SCON_LOCAL_KVS"
+#define SCON_LOCAL_KVS_JOB_ENV       "SCON_LOCAL_JOB"
+#define SCON_LOCAL_KVS_RANK_ENV      "SCON_LOCAL_RANK"
+#define SCON_LOCAL_KVS_SIZE_ENV      "SCON_LOCAL_SIZE"
+/** seconds to wait for a key published by a peer, default 60 */
+#define SCON_LOCAL_KVS_TIMEOUT_ENV   "SCON_LOCAL_KVS_TIMEOUT"
+
+/* true if this process was started by the local launcher */
+bool scon_local_kvs_enabled(void);
+
+/* set our identity and the job size from the environment */
+int scon_local_kvs_init(scon_proc_t *me, uint32_t *job_size);
+
+/* publish a value under key for proc me */
+int scon_local_kvs_put(const scon_proc_t *me, const char key[],
+                       const scon_value_t *val);
+
+/* retrieve the value published by proc under key, waiting
+ * for the peer to publish it if it hasn't yet */
+int scon_local_kvs_get(const scon_proc_t *proc, const char key[],
+                       scon_value_t **val);
+
+void scon_local_kvs_finalize(void);
+
+#endif /* SCON_LOCAL_KVS_H */
@@ -15,8 +15,12 @@
 #include "scon_globals.h"
 #include "src/util/error.h"
 #include "src/util/name_fns.h"
+#include "src/util/scon_local_kvs.h"
 #include "scon_pmix.h"
 
+/* true when launched by scon_local_run rather than under a PMIx server */
+static bool use_local_kvs = false;
+
 void scon_pmix_value_load(pmix_value_t *pv,
                        scon_value_t *sv)
 {
@@ -268,6 +272,13 @@ SCON_EXPORT int scon_pmix_init ( scon_proc_t *me,
     scon_output_verbose(2, scon_globals.debug_output,
                          "%s scon_pmix_init: initializing pmix client",
                          SCON_PRINT_PROC(SCON_PROC_MY_NAME));
+    if (scon_local_kvs_enabled()) {
+        if (SCON_SUCCESS != (rc = scon_local_kvs_init(me, &scon_globals.num_peers))) {
+            return SCON_ERR_PMIXINIT_FAILED;
+        }
+        use_local_kvs = true;
+        return SCON_SUCCESS;
+    }
 #if SCON_HAVE_PMIX_VERSION == 2
     if (PMIX_SUCCESS != (rc = PMIx_Init(&myproc, NULL, 0))) {
         scon_output(0, "%s pmix init failed with error %d",
@@ -319,6 +330,13 @@ SCON_EXPORT int scon_pmix_get (const scon_proc_t *proc, const char key[],
     pmix_proc_t *pproc = (pmix_proc_t*) proc;
     pmix_value_t *pval;
     scon_value_t *sval;
+
+    if (use_local_kvs) {
+        if (SCON_SUCCESS != scon_local_kvs_get(proc, key, val)) {
+            return SCON_ERR_PMIXGET_FAILED;
+        }
+        return SCON_SUCCESS;
+    }
     if (PMIX_SUCCESS != (rc = PMIx_Get(pproc, key, NULL, 0, &pval))) {
         scon_output(0, "%s scon_pmix_get: PMIx_Get for key %s failed: with status %d\n",
                     SCON_PRINT_PROC(SCON_PROC_MY_NAME), key,
@@ -333,6 +351,10 @@ SCON_EXPORT int scon_pmix_get (const scon_proc_t *proc, const char key[],
 SCON_EXPORT int scon_pmix_put (const char key[], scon_value_t *sval)
 {
     pmix_value_t *pval;
+
+    if (use_local_kvs) {
+        return scon_local_kvs_put(SCON_PROC_MY_NAME, key, sval);
+    }
     PMIX_VALUE_CREATE(pval,1);
     /* load scon_value_t into pmix_value_t */
     scon_pmix_value_load( pval, sval);
@@ -346,6 +368,13 @@ SCON_EXPORT int scon_pmix_put (const char key[], scon_value_t *sval)
 SCON_EXPORT int scon_pmix_put_string (const char key[], char *string_val)
 {
     pmix_value_t *pval;
+    scon_value_t sval;
+
+    if (use_local_kvs) {
+        sval.type = SCON_STRING;
+        sval.data.string = string_val;
+        return scon_local_kvs_put(SCON_PROC_MY_NAME, key, &sval);
+    }
     PMIX_VALUE_CREATE(pval,1);
     pmix_value_load(pval, (void*)string_val, PMIX_STRING);
     PMIx_Put(PMIX_GLOBAL, key, pval);
@@ -368,6 +397,11 @@ SCON_EXPORT int scon_pmix_finalize (scon_info_t  info[],
     scon_output_verbose(2, scon_globals.debug_output,
                         "%s scon_pmix_finalize: finalizing pmix client",
                         SCON_PRINT_PROC(SCON_PROC_MY_NAME));
+    if (use_local_kvs) {
+        scon_local_kvs_finalize();
+        use_local_kvs = false;
+        return SCON_SUCCESS;
+    }
 #if SCON_HAVE_PMIX_VERSION == 2
     return PMIx_Finalize(NULL, 0);
 #else
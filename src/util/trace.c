@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+#include "scon_config.h"
+#include <scon_common.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "src/include/prefetch.h"
+#include "src/include/scon_globals.h"
+#include "src/util/error.h"
+#include "src/util/name_fns.h"
+#include "src/util/output.h"
+#include "src/util/tsd.h"
+#include "src/util/trace.h"
+
+bool scon_trace_enabled = false;
+int scon_trace_events = 65536;
+char *scon_trace_file = NULL;
+
+typedef struct {
+    uint64_t ts;
+    uint64_t id;
+    int64_t args[2];
+    uint16_t point;
+    char phase;
+} trace_event_t;
+
+/* one per thread that has recorded an event. Only the owner
+ * writes to it - the rings are read after the progress has
+ * stopped, at finalize */
+typedef struct trace_ring {
+    struct trace_ring *next;
+    uint32_t tid;
+    uint64_t head;
+    uint64_t mask;
+    trace_event_t *events;
+} trace_ring_t;
+
+static const struct {
+    const char *name;
+    const char *cat;
+    const char *arg0;
+    const char *arg1;
+} points[SCON_TRACE_NUM_POINTS] = {
+    {"send.post",  "pt2pt", "dst",   "tag"},
+    {"wire.write", "tcp",   "dst",   "bytes"},
+    {"recv",       "pt2pt", "src",   "tag"},
+    {"match",      "pt2pt", "src",   "tag"},
+    {"recv.cb",    "pt2pt", "src",   "tag"},
+    {"coll",       "coll",  "type",  "status"},
+    {"coll.round", "coll",  "round", "seq"},
+    {"coll.cb",    "coll",  "type",  "status"}
+};
+
+static bool initialized = false;
+static scon_tsd_key_t ring_key;
+static pthread_mutex_t rings_lock = PTHREAD_MUTEX_INITIALIZER;
+static trace_ring_t *rings = NULL;
+static uint32_t nrings = 0;
+/* added to the monotonic timestamps to put them on the wall
+ * clock, so traces from different members line up */
+static int64_t wall_offset = 0;
+
+static inline uint64_t now_nsec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static trace_ring_t* get_ring(void)
+{
+    trace_ring_t *ring = NULL;
+    uint64_t size;
+
+    scon_tsd_getspecific(ring_key, (void**)&ring);
+    if (SCON_LIKELY(NULL != ring)) {
+        return ring;
+    }
+    /* keep the ring a power of two so wrapping is a mask */
+    for (size = 1; size < (uint64_t)scon_trace_events; size <<= 1);
+    if (NULL == (ring = (trace_ring_t*)calloc(1, sizeof(trace_ring_t))) ||
+        NULL == (ring->events = (trace_event_t*)calloc(size, sizeof(trace_event_t)))) {
+        free(ring);
+        return NULL;
+    }
+    ring->mask = size - 1;
+    scon_tsd_setspecific(ring_key, ring);
+    pthread_mutex_lock(&rings_lock);
+    ring->tid = nrings++;
+    ring->next = rings;
+    rings = ring;
+    pthread_mutex_unlock(&rings_lock);
+    return ring;
+}
+
+int scon_trace_init(void)
+{
+    struct timespec wall;
+    int rc;
+
+    if (initialized || !scon_trace_enabled) {
+        return SCON_SUCCESS;
+    }
+    if (SCON_SUCCESS != (rc = scon_tsd_key_create(&ring_key, NULL))) {
+        SCON_ERROR_LOG(rc);
+        scon_trace_enabled = false;
+        return rc;
+    }
+    if (0 >= scon_trace_events) {
+        scon_trace_events = 1;
+    }
+    clock_gettime(CLOCK_REALTIME, &wall);
+    wall_offset = (int64_t)((uint64_t)wall.tv_sec * 1000000000 + wall.tv_nsec) -
+                  (int64_t)now_nsec();
+    initialized = true;
+    return SCON_SUCCESS;
+}
+
+void scon_trace_finalize(void)
+{
+    trace_ring_t *ring;
+    char path[4096];
+
+    if (!initialized) {
+        return;
+    }
+    scon_trace_enabled = false;
+    snprintf(path, sizeof(path), "%s.%s.%u.json",
+             (NULL == scon_trace_file) ? "scon-trace" : scon_trace_file,
+             SCON_PROC_MY_NAME->job_name, SCON_PROC_MY_NAME->rank);
+    scon_trace_write(path);
+    pthread_mutex_lock(&rings_lock);
+    while (NULL != (ring = rings)) {
+        rings = ring->next;
+        free(ring->events);
+        free(ring);
+    }
+    nrings = 0;
+    pthread_mutex_unlock(&rings_lock);
+    scon_tsd_key_delete(ring_key);
+    initialized = false;
+}
+
+void scon_trace_record(scon_trace_point_t point, char phase,
+                       uint64_t id, int64_t arg0, int64_t arg1)
+{
+    trace_ring_t *ring;
+    trace_event_t *ev;
+
+    if (!initialized || NULL == (ring = get_ring())) {
+        return;
+    }
+    ev = &ring->events[ring->head & ring->mask];
+    ev->ts = now_nsec();
+    ev->id = id;
+    ev->args[0] = arg0;
+    ev->args[1] = arg1;
+    ev->point = point;
+    ev->phase = phase;
+    ring->head++;
+}
+
+int scon_trace_write(const char *path)
+{
+    trace_ring_t *ring;
+    trace_event_t *ev;
+    uint64_t n, first, ts;
+    uint32_t pid = SCON_PROC_MY_NAME->rank;
+    FILE *fp;
+
+    if (!initialized) {
+        return SCON_ERR_INIT;
+    }
+    if (NULL == (fp = fopen(path, "w"))) {
+        scon_output(0, "%s trace: cannot open %s: %s",
+                    SCON_PRINT_PROC(SCON_PROC_MY_NAME), path, strerror(errno));
+        return SCON_ERROR;
+    }
+    /* one event per line so that traces can be merged line by line */
+    fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":0,"
+            "\"args\":{\"name\":\"%s:%u\"}}",
+            pid, SCON_PROC_MY_NAME->job_name, SCON_PROC_MY_NAME->rank);
+    pthread_mutex_lock(&rings_lock);
+    for (ring = rings; NULL != ring; ring = ring->next) {
+        first = (ring->head > ring->mask) ? ring->head - ring->mask - 1 : 0;
+        if (0 < first) {
+            scon_output_verbose(1, scon_globals.debug_output,
+                                "%s trace: thread %u lost its %llu oldest events",
+                                SCON_PRINT_PROC(SCON_PROC_MY_NAME), ring->tid,
+                                (unsigned long long)first);
+        }
+        for (n = first; n < ring->head; n++) {
+            ev = &ring->events[n & ring->mask];
+            ts = ev->ts + wall_offset;
+            /* Chrome wants usecs, keep the nsecs as the fraction */
+            fprintf(fp, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\","
+                    "\"ts\":%llu.%03llu,\"pid\":%u,\"tid\":%u",
+                    points[ev->point].name, points[ev->point].cat, ev->phase,
+                    (unsigned long long)(ts / 1000), (unsigned long long)(ts % 1000),
+                    pid, ring->tid);
+            if ('b' == ev->phase || 'e' == ev->phase) {
+                fprintf(fp, ",\"id\":\"0x%llx\"", (unsigned long long)ev->id);
+            } else if ('i' == ev->phase) {
+                fprintf(fp, ",\"s\":\"t\"");
+            }
+            fprintf(fp, ",\"args\":{\"%s\":%lld,\"%s\":%lld}}",
+                    points[ev->point].arg0, (long long)ev->args[0],
+                    points[ev->point].arg1, (long long)ev->args[1]);
+        }
+    }
+    pthread_mutex_unlock(&rings_lock);
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+    return SCON_SUCCESS;
+}
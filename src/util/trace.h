@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+/** @file : event tracer
+ *
+ * Records timestamped events at fixed points of the messaging and
+ * collective paths. Every thread appends to its own ring of events
+ * without locking - once a ring is full the oldest events are
+ * overwritten. At finalize the rings are written out in the Chrome
+ * trace event format (chrome://tracing, ui.perfetto.dev), one file
+ * per member with the member's rank as the pid and timestamps on the
+ * wall clock, so the files of all members can be merged into one
+ * trace with bench/trace_merge.
+ */
+#ifndef SCON_TRACE_H
+#define SCON_TRACE_H
+
+#include "scon_config.h"
+#include <scon_common.h>
+
+BEGIN_C_DECLS
+
+typedef enum {
+    /* a message handed to pt2pt - dst rank, tag */
+    SCON_TRACE_SEND_POST,
+    /* the last byte of a message written to the wire - dst rank, bytes */
+    SCON_TRACE_WIRE_WRITE,
+    /* a message delivered by the transport - src rank, tag */
+    SCON_TRACE_RECV,
+    /* a message matched to a posted recv - src rank, tag */
+    SCON_TRACE_MATCH,
+    /* the user's recv callback - src rank, tag */
+    SCON_TRACE_RECV_CB,
+    /* a collective from post to delivery - type, status */
+    SCON_TRACE_COLL,
+    /* a collective sending its contribution for a round - round, seq */
+    SCON_TRACE_COLL_ROUND,
+    /* the user's collective callback - type, status */
+    SCON_TRACE_COLL_CB,
+    SCON_TRACE_NUM_POINTS
+} scon_trace_point_t;
+
+/* MCA params, registered in scon_register_params */
+SCON_EXPORT extern bool scon_trace_enabled;
+SCON_EXPORT extern int scon_trace_events;
+SCON_EXPORT extern char *scon_trace_file;
+
+SCON_EXPORT int scon_trace_init(void);
+/* write the trace if tracing is on and release the rings */
+SCON_EXPORT void scon_trace_finalize(void);
+
+/* phase is one of the Chrome trace phases: 'i' instant, 'B'/'E'
+ * begin and end on this thread, 'b'/'e' begin and end of an async
+ * span matched by id */
+SCON_EXPORT void scon_trace_record(scon_trace_point_t point, char phase,
+                                   uint64_t id, int64_t arg0, int64_t arg1);
+
+/* write everything recorded so far to path */
+SCON_EXPORT int scon_trace_write(const char *path);
+
+#define SCON_TRACE_EVENT(p, ph, id, a0, a1)                                  \
+    do {                                                                     \
+        if (scon_trace_enabled) {                                            \
+            scon_trace_record((p), (ph), (uint64_t)(id),                     \
+                              (int64_t)(a0), (int64_t)(a1));                 \
+        }                                                                    \
+    } while (0)
+
+#define SCON_TRACE(p, a0, a1)               SCON_TRACE_EVENT((p), 'i', 0, (a0), (a1))
+#define SCON_TRACE_BEGIN(p, a0, a1)         SCON_TRACE_EVENT((p), 'B', 0, (a0), (a1))
+#define SCON_TRACE_END(p, a0, a1)           SCON_TRACE_EVENT((p), 'E', 0, (a0), (a1))
+#define SCON_TRACE_ASYNC_BEGIN(p, id, a0, a1) SCON_TRACE_EVENT((p), 'b', (id), (a0), (a1))
+#define SCON_TRACE_ASYNC_END(p, id, a0, a1) SCON_TRACE_EVENT((p), 'e', (id), (a0), (a1))
+
+END_C_DECLS
+
+#endif /* SCON_TRACE_H */
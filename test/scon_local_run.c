@@ -0,0 +1,162 @@
+/**
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Minimal launcher for running SCON jobs on one box without a PMIx
+ * server:
+ *
+ *   scon_local_run -n <members> [-t timeout] <program> [args]
+ *
+ * Forks the members on localhost with the environment that puts
+ * the library in local bootstrap mode, where the members exchange
+ * their contact info through a key-value store in a temporary
+ * directory. If a member fails the rest are terminated. The exit
+ * status is that of the first member to fail, 0 otherwise.
+ */
+#include "scon_config.h"
+#include "src/util/scon_local_kvs.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s -n <members> [-t timeout] <program> [args]\n", prog);
+}
+
+static void remove_store(const char *dir)
+{
+    struct dirent *ent;
+    char path[4096];
+    DIR *dp;
+
+    if (NULL == (dp = opendir(dir))) {
+        return;
+    }
+    while (NULL != (ent = readdir(dp))) {
+        if (0 == strcmp(ent->d_name, ".") || 0 == strcmp(ent->d_name, "..")) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+        unlink(path);
+    }
+    closedir(dp);
+    rmdir(dir);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int nmembers = 0, i, nalive;
+    char *timeout = NULL, *tmpdir, dir[4096], job[64], val[32];
+    pid_t *pids, pid;
+    int opt, status, exit_code = 0;
+
+    while (-1 != (opt = getopt(argc, argv, "+n:t:h"))) {
+        switch (opt) {
+            case 'n':
+                nmembers = strtoul(optarg, NULL, 10);
+                break;
+            case 't':
+                timeout = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (0 == nmembers || optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (NULL == (tmpdir = getenv("TMPDIR"))) {
+        tmpdir = "/tmp";
+    }
+    snprintf(dir, sizeof(dir), "%s/scon-local.XXXXXX", tmpdir);
+    if (NULL == mkdtemp(dir)) {
+        fprintf(stderr, "%s: cannot create %s: %s\n", argv[0], dir, strerror(errno));
+        return 1;
+    }
+    snprintf(job, sizeof(job), "scon-local-%lu", (unsigned long)getpid());
+    setenv(SCON_LOCAL_KVS_DIR_ENV, dir, 1);
+    setenv(SCON_LOCAL_KVS_JOB_ENV, job, 1);
+    snprintf(val, sizeof(val), "%u", nmembers);
+    setenv(SCON_LOCAL_KVS_SIZE_ENV, val, 1);
+    if (NULL != timeout) {
+        setenv(SCON_LOCAL_KVS_TIMEOUT_ENV, timeout, 1);
+    }
+
+    pids = (pid_t*)calloc(nmembers, sizeof(pid_t));
+    for (i = 0; i < nmembers; i++) {
+        snprintf(val, sizeof(val), "%u", i);
+        setenv(SCON_LOCAL_KVS_RANK_ENV, val, 1);
+        if (0 > (pid = fork())) {
+            fprintf(stderr, "%s: fork failed for rank %u: %s\n", argv[0], i, strerror(errno));
+            exit_code = 1;
+            break;
+        }
+        if (0 == pid) {
+            execvp(argv[optind], &argv[optind]);
+            fprintf(stderr, "%s: cannot exec %s: %s\n", argv[0], argv[optind], strerror(errno));
+            _exit(127);
+        }
+        pids[i] = pid;
+    }
+    nalive = i;
+    if (0 != exit_code) {
+        /* couldn't start them all, the rest would wait forever */
+        for (i = 0; i < nmembers; i++) {
+            if (0 < pids[i]) {
+                kill(pids[i], SIGTERM);
+            }
+        }
+    }
+
+    while (0 < nalive) {
+        if (0 > (pid = wait(&status))) {
+            if (EINTR == errno) {
+                continue;
+            }
+            break;
+        }
+        for (i = 0; i < nmembers && pids[i] != pid; i++);
+        if (i == nmembers) {
+            continue;
+        }
+        pids[i] = 0;
+        nalive--;
+        if (WIFEXITED(status) && 0 == WEXITSTATUS(status)) {
+            continue;
+        }
+        if (0 == exit_code) {
+            if (WIFEXITED(status)) {
+                fprintf(stderr, "%s: rank %u exited with status %d\n",
+                        argv[0], i, WEXITSTATUS(status));
+                exit_code = WEXITSTATUS(status);
+            } else {
+                fprintf(stderr, "%s: rank %u killed by signal %d\n",
+                        argv[0], i, WTERMSIG(status));
+                exit_code = 128 + WTERMSIG(status);
+            }
+            /* the job can't complete without this member */
+            for (i = 0; i < nmembers; i++) {
+                if (0 < pids[i]) {
+                    kill(pids[i], SIGTERM);
+                }
+            }
+        }
+    }
+    free(pids);
+    remove_store(dir);
+    return exit_code;
+}
@@ -0,0 +1,296 @@
+/**
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Stress the non-blocking collectives by keeping several of them
+ * in flight at once. Every round each member issues depth
+ * barriers, allgathers and allgathervs back to back without
+ * waiting, while rank 0 xcasts a message in the middle of them.
+ * The callbacks must arrive in issue order, every allgather must
+ * carry one contribution per member and the contribution of member
+ * i of an allgatherv must be its rank.
+ *
+ * usage: test_coll_stress [-n rounds] [-d depth]
+ */
+#include "scon.h"
+#include "scon_common.h"
+#include "src/util/name_fns.h"
+#include "src/util/output.h"
+#include "src/buffer_ops/buffer_ops.h"
+#include "src/buffer_ops/types.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#define STRESS_XCAST_TAG 20000
+
+static volatile bool create = false;
+static scon_handle_t handle;
+static unsigned int nmembers = 0;
+/* issue index of the next callback we expect */
+static volatile unsigned int next_cb = 0;
+static volatile unsigned int ncompleted = 0;
+static volatile unsigned int nxcasts = 0;
+static volatile unsigned int nerrors = 0;
+
+void create_cbfunc (scon_status_t status,
+                    scon_handle_t scon_handle,
+                    void *cbdata);
+void delete_cbfunc (scon_status_t status,
+                    void *cbdata);
+
+void create_cbfunc (scon_status_t status,
+                    scon_handle_t scon_handle,
+                    void *cbdata)
+{
+    handle = scon_handle;
+    create = true;
+}
+
+void delete_cbfunc (scon_status_t status,
+                    void *cbdata)
+{
+    create = false;
+}
+
+static void check_order(scon_status_t status, void *cbdata)
+{
+    unsigned int idx = (unsigned int)(uintptr_t)cbdata;
+
+    if (SCON_SUCCESS != status) {
+        scon_output(0, "%s collective %u failed with %d",
+                    SCON_PRINT_PROC(SCON_PROC_MY_NAME), idx, status);
+        nerrors++;
+    }
+    if (idx != next_cb) {
+        scon_output(0, "%s collective %u completed out of order, expected %u",
+                    SCON_PRINT_PROC(SCON_PROC_MY_NAME), idx, next_cb);
+        nerrors++;
+    }
+    next_cb = idx + 1;
+    ncompleted++;
+}
+
+static void barrier_cbfunc (scon_status_t status,
+                            scon_handle_t scon_handle,
+                            scon_proc_t procs[],
+                            size_t nprocs,
+                            scon_info_t info[],
+                            size_t ninfo,
+                            void *cbdata)
+{
+    check_order(status, cbdata);
+}
+
+static void allgather_cbfunc (scon_status_t status,
+                              scon_handle_t scon_handle,
+                              scon_proc_t procs[],
+                              size_t nprocs,
+                              scon_buffer_t *buf,
+                              scon_info_t info[],
+                              size_t ninfo,
+                              void *cbdata)
+{
+    size_t expected = nmembers * sizeof(uint32_t);
+
+    /* each contribution is a single packed uint32 */
+    if (SCON_SUCCESS == status &&
+        (NULL == buf || (size_t)(buf->pack_ptr - buf->unpack_ptr) < expected)) {
+        scon_output(0, "%s allgather %u returned %lu bytes, expected at least %lu",
+                    SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                    (unsigned int)(uintptr_t)cbdata,
+                    NULL == buf ? 0UL : (unsigned long)(buf->pack_ptr - buf->unpack_ptr),
+                    (unsigned long)expected);
+        nerrors++;
+    }
+    check_order(status, cbdata);
+}
+
+static void allgatherv_cbfunc (scon_status_t status,
+                               scon_handle_t scon_handle,
+                               scon_proc_t procs[],
+                               size_t nprocs,
+                               scon_allgather_result_t *result,
+                               scon_info_t info[],
+                               size_t ninfo,
+                               void *cbdata)
+{
+    scon_buffer_t view;
+    uint32_t val;
+    int32_t cnt;
+    size_t i;
+
+    if (SCON_SUCCESS == status) {
+        if (NULL == result || result->nprocs != nmembers) {
+            scon_output(0, "%s allgatherv %u returned %lu contributions, expected %u",
+                        SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                        (unsigned int)(uintptr_t)cbdata,
+                        NULL == result ? 0UL : (unsigned long)result->nprocs, nmembers);
+            nerrors++;
+        } else {
+            /* the members of the scon are in rank order */
+            for (i = 0; i < result->nprocs; i++) {
+                SCON_ALLGATHER_RESULT_VIEW(&view, result, i);
+                cnt = 1;
+                if (SCON_SUCCESS != scon_bfrop.unpack(&view, &val, &cnt, SCON_UINT32) ||
+                    val != i) {
+                    scon_output(0, "%s allgatherv %u: bad contribution for member %lu",
+                                SCON_PRINT_PROC(SCON_PROC_MY_NAME),
+                                (unsigned int)(uintptr_t)cbdata, (unsigned long)i);
+                    nerrors++;
+                    break;
+                }
+            }
+        }
+    }
+    check_order(status, cbdata);
+}
+
+static void xcast_cbfunc (scon_status_t status,
+                          scon_handle_t scon_handle,
+                          scon_proc_t procs[],
+                          size_t nprocs,
+                          scon_buffer_t *buf,
+                          scon_msg_tag_t tag,
+                          scon_info_t info[],
+                          size_t ninfo,
+                          void *cbdata)
+{
+    scon_buffer_destruct(buf);
+    free(buf);
+}
+
+static void xcast_recv_cbfunc (scon_status_t status,
+                               scon_handle_t scon_handle,
+                               scon_proc_t *peer,
+                               scon_buffer_t *buf,
+                               scon_msg_tag_t tag,
+                               void *cbdata)
+{
+    nxcasts++;
+}
+
+static double now(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+    int rc, opt;
+    scon_info_t *info;
+    size_t ninfo = 1;
+    size_t nqueries = 1;
+    unsigned int rounds = 100, depth = 8;
+    unsigned int r, d, issued = 0;
+    uint32_t val;
+    scon_buffer_t **bufs;
+    scon_buffer_t *xbuf;
+    double start, elapsed;
+
+    while (-1 != (opt = getopt(argc, argv, "n:d:"))) {
+        switch (opt) {
+            case 'n':
+                rounds = strtoul(optarg, NULL, 10);
+                break;
+            case 'd':
+                depth = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n rounds] [-d depth]\n", argv[0]);
+                return -1;
+        }
+    }
+    if (0 == depth) {
+        depth = 1;
+    }
+    if (SCON_SUCCESS != (rc = scon_init(NULL, 0))) {
+        fprintf(stderr, "scon_init returned error %d\n", rc);
+        return -1;
+    }
+    scon_create(NULL, 0, NULL, 0, create_cbfunc, NULL);
+    while (!create) {
+        usleep(1000);
+    }
+    SCON_INFO_CREATE(info, ninfo);
+    SCON_INFO_LOAD(&info[0], SCON_NUM_MEMBERS, &nmembers, SCON_UINT32);
+    scon_get_info(handle, &info, &nqueries);
+    nmembers = info[0].value.data.uint32;
+    scon_recv_nb(handle, SCON_PROC_WILDCARD, STRESS_XCAST_TAG, true,
+                 xcast_recv_cbfunc, NULL, NULL, 0);
+    /* the allgather buffers must stay around until the callback */
+    bufs = (scon_buffer_t**)calloc(depth, sizeof(scon_buffer_t*));
+    for (d = 0; d < depth; d++) {
+        bufs[d] = (scon_buffer_t*)malloc(sizeof(scon_buffer_t));
+        scon_buffer_construct(bufs[d]);
+        val = SCON_PROC_MY_NAME->rank;
+        scon_bfrop.pack(bufs[d], &val, 1, SCON_UINT32);
+    }
+    scon_output(0, "%s stressing collectives on scon %d: %u members, %u rounds, depth %u",
+                SCON_PRINT_PROC(SCON_PROC_MY_NAME), handle, nmembers, rounds, depth);
+
+    start = now();
+    for (r = 0; r < rounds; r++) {
+        for (d = 0; d < depth; d++) {
+            if (1 == d % 4) {
+                rc = scon_allgather(handle, NULL, 0, bufs[d], allgather_cbfunc,
+                                    (void*)(uintptr_t)issued, NULL, 0);
+            } else if (3 == d % 4) {
+                rc = scon_allgatherv(handle, NULL, 0, bufs[d], allgatherv_cbfunc,
+                                     (void*)(uintptr_t)issued, NULL, 0);
+            } else {
+                rc = scon_barrier(handle, NULL, 0, barrier_cbfunc,
+                                  (void*)(uintptr_t)issued, NULL, 0);
+            }
+            if (SCON_SUCCESS != rc) {
+                scon_output(0, "%s collective %u could not be issued: %d",
+                            SCON_PRINT_PROC(SCON_PROC_MY_NAME), issued, rc);
+                nerrors++;
+                continue;
+            }
+            ++issued;
+            if (d == depth / 2 && 0 == SCON_PROC_MY_NAME->rank) {
+                xbuf = (scon_buffer_t*)malloc(sizeof(scon_buffer_t));
+                scon_buffer_construct(xbuf);
+                scon_bfrop.pack(xbuf, &r, 1, SCON_UINT32);
+                scon_xcast(handle, NULL, 0, xbuf, STRESS_XCAST_TAG,
+                           xcast_cbfunc, NULL, NULL, 0);
+            }
+        }
+        /* let the round drain so the allgather buffers can be reused */
+        while (ncompleted < issued) {
+            usleep(10);
+        }
+    }
+    elapsed = now() - start;
+    /* the xcasts are not ordered with the collectives, wait for them too */
+    while (nxcasts < rounds && 0 == nerrors) {
+        usleep(1000);
+    }
+
+    scon_output(0, "%s %u collectives in %.3f s, %.2f us per collective, %u xcasts, %u errors",
+                SCON_PRINT_PROC(SCON_PROC_MY_NAME), issued, elapsed,
+                issued ? elapsed * 1e6 / issued : 0.0, nxcasts, nerrors);
+
+    scon_delete(handle, delete_cbfunc, NULL, NULL, 0);
+    while (create) {
+        usleep(1000);
+    }
+    for (d = 0; d < depth; d++) {
+        scon_buffer_destruct(bufs[d]);
+        free(bufs[d]);
+    }
+    free(bufs);
+    scon_finalize();
+    SCON_INFO_FREE(info, ninfo);
+    return (0 == nerrors) ? 0 : 1;
+}
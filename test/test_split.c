@@ -0,0 +1,234 @@
+/**
+ * Copyright (c) 2017 Intel, Inc. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Split the scon of the job twice - by the parity of the rank, with
+ * the members of a child in reverse rank order, and in blocks of
+ * consecutive members with SCON_SPLIT_BLOCK. Each child must have
+ * the expected number of members and must be able to run a barrier
+ * and an xcast from its master, while the other child does the same.
+ *
+ * usage: test_split [-b block]
+ */
+#include "scon.h"
+#include "scon_common.h"
+#include "src/util/name_fns.h"
+#include "src/util/output.h"
+#include "src/buffer_ops/buffer_ops.h"
+#include "src/buffer_ops/types.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#define SPLIT_XCAST_TAG 21000
+
+static volatile bool done = false;
+static scon_handle_t handle;
+static volatile unsigned int nerrors = 0;
+
+void create_cbfunc (scon_status_t status,
+                    scon_handle_t scon_handle,
+                    void *cbdata);
+void delete_cbfunc (scon_status_t status,
+                    void *cbdata);
+
+void create_cbfunc (scon_status_t status,
+                    scon_handle_t scon_handle,
+                    void *cbdata)
+{
+    if (SCON_SUCCESS != status) {
+        scon_output(0, "%s create/split failed with %d",
+                    SCON_PRINT_PROC(SCON_PROC_MY_NAME), status);
+        nerrors++;
+    }
+    handle = scon_handle;
+    done = true;
+}
+
+void delete_cbfunc (scon_status_t status,
+                    void *cbdata)
+{
+    done = true;
+}
+
+static void barrier_cbfunc (scon_status_t status,
+                            scon_handle_t scon_handle,
+                            scon_proc_t procs[],
+                            size_t nprocs,
+                            scon_info_t info[],
+                            size_t ninfo,
+                            void *cbdata)
+{
+    if (SCON_SUCCESS != status) {
+        nerrors++;
+    }
+    done = true;
+}
+
+static void xcast_cbfunc (scon_status_t status,
+                          scon_handle_t scon_handle,
+                          scon_proc_t procs[],
+                          size_t nprocs,
+                          scon_buffer_t *buf,
+                          scon_msg_tag_t tag,
+                          scon_info_t info[],
+                          size_t ninfo,
+                          void *cbdata)
+{
+    scon_buffer_destruct(buf);
+    free(buf);
+}
+
+static void xcast_recv_cbfunc (scon_status_t status,
+                               scon_handle_t scon_handle,
+                               scon_proc_t *peer,
+                               scon_buffer_t *buf,
+                               scon_msg_tag_t tag,
+                               void *cbdata)
+{
+    uint32_t master;
+    int32_t cnt = 1;
+
+    /* the master of the child is the member with the lowest key */
+    if (SCON_SUCCESS != scon_bfrop.unpack(buf, &master, &cnt, SCON_UINT32) ||
+        master != *(uint32_t*)cbdata) {
+        scon_output(0, "%s xcast on scon %d came from rank %u, expected %u",
+                    SCON_PRINT_PROC(SCON_PROC_MY_NAME), scon_handle,
+                    master, *(uint32_t*)cbdata);
+        nerrors++;
+    }
+    done = true;
+}
+
+static double now(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static void wait_done(void)
+{
+    while (!done) {
+        usleep(1000);
+    }
+    done = false;
+}
+
+static unsigned int get_nmembers(scon_handle_t h)
+{
+    scon_info_t *info;
+    size_t nqueries = 1;
+    unsigned int n = 0;
+
+    SCON_INFO_CREATE(info, 1);
+    SCON_INFO_LOAD(&info[0], SCON_NUM_MEMBERS, &n, SCON_UINT32);
+    scon_get_info(h, &info, &nqueries);
+    n = info[0].value.data.uint32;
+    SCON_INFO_FREE(info, 1);
+    return n;
+}
+
+/* run a barrier and an xcast from the master on the child */
+static void check_child(scon_handle_t child, const char *name,
+                        unsigned int expected, uint32_t master, double elapsed)
+{
+    scon_buffer_t *buf;
+    unsigned int n = get_nmembers(child);
+
+    scon_output(0, "%s %s split: scon %d with %u members in %.1f us",
+                SCON_PRINT_PROC(SCON_PROC_MY_NAME), name, child, n, elapsed * 1e6);
+    if (n != expected) {
+        scon_output(0, "%s %s split: expected %u members",
+                    SCON_PRINT_PROC(SCON_PROC_MY_NAME), name, expected);
+        nerrors++;
+    }
+    scon_barrier(child, NULL, 0, barrier_cbfunc, NULL, NULL, 0);
+    wait_done();
+    scon_recv_nb(child, SCON_PROC_WILDCARD, SPLIT_XCAST_TAG, false,
+                 xcast_recv_cbfunc, &master, NULL, 0);
+    if (master == SCON_PROC_MY_NAME->rank) {
+        buf = (scon_buffer_t*)malloc(sizeof(scon_buffer_t));
+        scon_buffer_construct(buf);
+        scon_bfrop.pack(buf, &master, 1, SCON_UINT32);
+        scon_xcast(child, NULL, 0, buf, SPLIT_XCAST_TAG, xcast_cbfunc, NULL, NULL, 0);
+    }
+    wait_done();
+}
+
+int main(int argc, char **argv)
+{
+    int rc, opt;
+    scon_handle_t parent, by_parity, by_block;
+    scon_info_t *info;
+    uint32_t block = 4, rank, master, size;
+    unsigned int nmembers;
+    double start;
+
+    while (-1 != (opt = getopt(argc, argv, "b:"))) {
+        switch (opt) {
+            case 'b':
+                block = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-b block]\n", argv[0]);
+                return -1;
+        }
+    }
+    if (0 == block) {
+        block = 1;
+    }
+    if (SCON_SUCCESS != (rc = scon_init(NULL, 0))) {
+        fprintf(stderr, "scon_init returned error %d\n", rc);
+        return -1;
+    }
+    start = now();
+    scon_create(NULL, 0, NULL, 0, create_cbfunc, NULL);
+    wait_done();
+    parent = handle;
+    nmembers = get_nmembers(parent);
+    rank = SCON_PROC_MY_NAME->rank;
+    scon_output(0, "%s created scon %d with %u members in %.1f us",
+                SCON_PRINT_PROC(SCON_PROC_MY_NAME), parent, nmembers,
+                (now() - start) * 1e6);
+
+    /* the odd and the even ranks, highest rank first */
+    start = now();
+    scon_split(parent, rank % 2, -(int)rank, NULL, 0, create_cbfunc, NULL);
+    wait_done();
+    by_parity = handle;
+    /* the highest rank of our parity */
+    master = (nmembers - 1) - ((nmembers - 1 - rank) % 2);
+    check_child(by_parity, "parity", nmembers / 2 + ((nmembers % 2) > (rank % 2)),
+                master, now() - start);
+
+    /* runs of block consecutive ranks, no messages exchanged */
+    SCON_INFO_CREATE(info, 1);
+    SCON_INFO_LOAD(&info[0], SCON_SPLIT_BLOCK, &block, SCON_UINT32);
+    start = now();
+    scon_split(parent, 0, 0, info, 1, create_cbfunc, NULL);
+    wait_done();
+    by_block = handle;
+    master = rank - rank % block;
+    size = (nmembers - master < block) ? nmembers - master : block;
+    check_child(by_block, "block", size, master, now() - start);
+    SCON_INFO_FREE(info, 1);
+
+    scon_delete(by_block, delete_cbfunc, NULL, NULL, 0);
+    wait_done();
+    scon_delete(by_parity, delete_cbfunc, NULL, NULL, 0);
+    wait_done();
+    scon_delete(parent, delete_cbfunc, NULL, NULL, 0);
+    wait_done();
+    scon_output(0, "%s split test done, %u errors",
+                SCON_PRINT_PROC(SCON_PROC_MY_NAME), nerrors);
+    scon_finalize();
+    return (0 == nerrors) ? 0 : 1;
+}